@@ -79,11 +79,12 @@
   if( aktool_check_command( "test", argv[1] )) return aktool_test( argc, argv );
   if( aktool_check_command( "k", argv[1] )) return aktool_key( argc, argv );
   if( aktool_check_command( "key", argv[1] )) return aktool_key( argc, argv );
-
-/*
-    if( aktool_check_command( "i", argv[1] )) return aktool_icode( argc, argv );
-    if( aktool_check_command( "icode", argv[1] )) return aktool_icode( argc, argv );
- */
+  if( aktool_check_command( "i", argv[1] )) return aktool_icode( argc, argv );
+  if( aktool_check_command( "icode", argv[1] )) return aktool_icode( argc, argv );
+  if( aktool_check_command( "e", argv[1] )) return aktool_encrypt( argc, argv );
+  if( aktool_check_command( "encrypt", argv[1] )) return aktool_encrypt( argc, argv );
+  if( aktool_check_command( "d", argv[1] )) return aktool_decrypt( argc, argv );
+  if( aktool_check_command( "decrypt", argv[1] )) return aktool_decrypt( argc, argv );
 
  /* ничего не подошло, выводим сообщение об ошибке */
   ak_log_set_function( ak_function_log_stderr );
@@ -224,6 +225,8 @@
   printf(_("  aktool command [options] [files]\n\n"));
   printf(_("available commands (in short and long forms):\n"));
   printf(_("  a, asn1parse  -  decode and print the ASN.1 data\n"));
+  printf(_("  d, decrypt    -  decrypt files created by encrypt command\n"));
+  printf(_("  e, encrypt    -  encrypt files using authenticated encryption\n"));
   printf(_("  i, icode      -  calculate or check integrity codes\n"));
   printf(_("  k, key        -  key generation and management functions\n"));
   printf(_("  s, show       -  show useful information\n"));
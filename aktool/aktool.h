@@ -28,6 +28,17 @@
 /* ----------------------------------------------------------------------------------------------- */
  #define aktool_password_max_length (256)
 
+/* генератор случайных чисел, используемый по-умолчанию */
+#if defined(__unix__) || defined(__APPLE__)
+  #define aktool_default_generator "dev-random"
+#else
+  #ifdef AK_HAVE_WINDOWS_H
+    #define aktool_default_generator "winrtl"
+  #else
+    #define aktool_default_generator "lcg"
+  #endif
+#endif
+
 /* ----------------------------------------------------------------------------------------------- */
  extern int aktool_log_level;
  extern bool_t aktool_openssl_compability;
@@ -60,6 +71,9 @@
  int aktool_test( int argc, tchar *argv[] );
  int aktool_asn1( int argc, tchar *argv[] );
  int aktool_key( int argc, tchar *argv[] );
+ int aktool_icode( int argc, tchar *argv[] );
+ int aktool_encrypt( int argc, tchar *argv[] );
+ int aktool_decrypt( int argc, tchar *argv[] );
 
  #endif
 /* ----------------------------------------------------------------------------------------------- */
@@ -0,0 +1,570 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  Copyright (c) 2020 by Axel Kenzo, axelkenzo@mail.ru                                            */
+/*                                                                                                 */
+/*  Файл aktool_encrypt.c                                                                          */
+/*  - содержит реализацию команд зашифрования и расшифрования файлов                               */
+/* ----------------------------------------------------------------------------------------------- */
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <aktool.h>
+#ifdef AK_HAVE_PTHREAD_H
+ #include <pthread.h>
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*  Формат зашифрованного файла и преобразования отдельных фрагментов реализуются библиотекой
+    (см. функции ak_aead_chunks_...). Здесь реализуется только конвейерная обработка:
+    группы фрагментов обрабатываются пулом потоков, в то время как отдельный поток записывает
+    предыдущую группу и считывает следующую.                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+/* количество фрагментов, обрабатываемых одним потоком за одно обращение к пулу потоков */
+ #define aktool_encrypt_chunks_per_thread          (16)
+
+/* ----------------------------------------------------------------------------------------------- */
+ int aktool_encrypt_help( bool_t );
+ int aktool_encrypt_run( int argc, tchar *argv[], bool_t );
+ int aktool_encrypt_file( const char * , const char * );
+
+/* ----------------------------------------------------------------------------------------------- */
+/* группа фрагментов, обрабатываемая за одно обращение к пулу потоков */
+ typedef struct encrypt_slot {
+   ak_uint8 *in, *out;
+   int *errors;
+   ak_uint64 first;  /* номер первого фрагмента группы */
+   size_t count;     /* количество фрагментов в группе */
+   size_t insize, outsize;
+ } *ak_encrypt_slot;
+
+/* ----------------------------------------------------------------------------------------------- */
+ static struct encrypt_info {
+   ak_oid algorithm;
+   bool_t decrypt;
+   size_t chunk;
+   char password[aktool_password_max_length];
+   size_t lenpass;
+   ak_int64 threads;
+
+   ak_uint64 size;   /* длина открытого текста */
+   ak_uint64 count;  /* общее количество фрагментов */
+   size_t last;      /* длина последнего фрагмента открытого текста */
+   ak_aead_chunks workers; /* контексты, используемые потоками */
+   size_t nworkers, created, batch;
+   struct encrypt_slot slots[3];
+   struct file ifp, ofp;
+   int ioerror;
+ } ec;
+
+/* ----------------------------------------------------------------------------------------------- */
+/* проверка того, что алгоритм является режимом mgm или xtsmac */
+ static bool_t aktool_encrypt_check_oid( ak_oid oid )
+{
+  if(( oid == NULL ) || ( oid->engine != block_cipher ) || ( oid->mode != aead )) return ak_false;
+  if(( oid->func.direct == ( ak_function_run_object *) ak_bckey_encrypt_mgm ) ||
+     ( oid->func.direct == ( ak_function_run_object *) ak_bckey_encrypt_xtsmac )) return ak_true;
+ return ak_false;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int aktool_encrypt( int argc, tchar *argv[] )
+{
+  return aktool_encrypt_run( argc, argv, ak_false );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int aktool_decrypt( int argc, tchar *argv[] )
+{
+  return aktool_encrypt_run( argc, argv, ak_true );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int aktool_encrypt_run( int argc, tchar *argv[], bool_t decrypt )
+{
+  size_t len = 0;
+  ak_int64 chunk = 0;
+  int idx = 0, next_option = 0, errors = 0, exit_status = EXIT_FAILURE;
+  char *outname = NULL, buffer[FILENAME_MAX];
+  tchar *command = argv[1];
+
+  const struct option long_options[] = {
+    /* сначала уникальные */
+     { "algorithm",        1, NULL, 'a' },
+     { "output",           1, NULL, 'o' },
+     { "chunk-size",       1, NULL, 250 },
+     { "threads",          1, NULL, 249 },
+     { "password",         1, NULL, 248 },
+
+    /* потом общие */
+     { "openssl-style",    0, NULL,   5  },
+     { "audit",            1, NULL,   4  },
+     { "dont-use-colors",  0, NULL,   3  },
+     { "audit-file",       1, NULL,   2  },
+     { "help",             0, NULL,   1  },
+     { NULL,               0, NULL,   0  },
+  };
+
+ /* параметры по-умолчанию */
+  memset( &ec, 0, sizeof( struct encrypt_info ));
+  ec.decrypt = decrypt;
+  ec.algorithm = ak_oid_find_by_name( "mgm-kuznechik" );
+  ec.chunk = ak_aead_chunks_default_size;
+  ec.threads = -1;
+
+ /* разбираем опции командной строки */
+  do {
+       next_option = getopt_long( argc, argv, "a:o:", long_options, NULL );
+       switch( next_option )
+      {
+       /* сначала обработка стандартных опций */
+        case  1  :   return aktool_encrypt_help( decrypt );
+        case  2  : /* получили от пользователя имя файла для вывода аудита */
+                     aktool_set_audit( optarg );
+                     break;
+        case  3  : /* установка флага запрета вывода символов смены цветовой палитры */
+                     ak_error_set_color_output( ak_false );
+                     ak_libakrypt_set_option( "use_color_output", 0 );
+                     break;
+        case  4  : /* устанавливаем уровень аудита */
+                     aktool_log_level = atoi( optarg );
+                     break;
+        case  5  : /* переходим к стилю openssl */
+                     aktool_openssl_compability = ak_true;
+                     break;
+
+       /* теперь опции, уникальные для encrypt/decrypt */
+        case 'a' :  if(( ec.algorithm = ak_oid_find_by_ni( optarg )) == NULL ) {
+                      aktool_error(
+                        _("using unsupported name or identifier \"%s\" for aead mode"), optarg );
+                      printf(
+                     _("try \"aktool s --oid aead\" for list of all available algorithms\n"));
+                      return EXIT_FAILURE;
+                    }
+                    break;
+
+        case 'o' :  outname = optarg;
+                    break;
+
+        case 250 :  chunk = atoll( optarg );
+                    if(( chunk < 4096 ) || ( chunk > 16777216 ) || ( chunk%16 )) {
+                      aktool_error(_("the chunk size must be a multiple of 16 "
+                                                              "in the range from 4096 to 16777216"));
+                      return EXIT_FAILURE;
+                    }
+                    ec.chunk = ( size_t )chunk;
+                    break;
+
+        case 249 :  ec.threads = atoi( optarg );
+                    break;
+
+        case 248 :  memset( ec.password, 0, sizeof( ec.password ));
+                    strncpy( ec.password, optarg, sizeof( ec.password ) -1 );
+                    ec.lenpass = strlen( ec.password );
+                    break;
+
+       /* обрабатываем ошибочные параметры */
+        default:
+                    break;
+       }
+  } while( next_option != -1 );
+
+ /* проверяем, что задан поддерживаемый режим шифрования */
+  if( !aktool_encrypt_check_oid( ec.algorithm )) {
+    aktool_error(_("only mgm and xtsmac modes are supported for file encryption"));
+    return EXIT_FAILURE;
+  }
+  for( idx = optind, len = 0; idx < argc; idx++ ) if( argv[idx] != command ) len++;
+  if( !len ) return aktool_encrypt_help( decrypt );
+  if(( outname != NULL ) && ( len > 1 )) {
+    aktool_error(_("the output file name can be used with one input file only"));
+    return EXIT_FAILURE;
+  }
+
+ /* начинаем работу с криптографическими примитивами */
+  if( !aktool_create_libakrypt( )) return EXIT_FAILURE;
+  if( ec.threads >= 0 ) ak_libakrypt_set_option( "threads_count", ec.threads );
+
+ /* считываем пароль */
+  if( !ec.lenpass ) {
+    char twice[aktool_password_max_length];
+
+    fprintf( stdout, _("password: ")); fflush( stdout );
+    ak_password_read( ec.password, sizeof( ec.password ));
+    fprintf( stdout, "\n" );
+    if( !decrypt ) {
+      fprintf( stdout, _("retype password: ")); fflush( stdout );
+      ak_password_read( twice, sizeof( twice ));
+      fprintf( stdout, "\n" );
+      if( strncmp( ec.password, twice, sizeof( twice ))) {
+        aktool_error(_("the passwords are not equal"));
+        memset( twice, 0, sizeof( twice ));
+        goto labex;
+      }
+      memset( twice, 0, sizeof( twice ));
+    }
+    if(( ec.lenpass = strlen( ec.password )) == 0 ) {
+      aktool_error(_("using a password of zero length"));
+      goto labex;
+    }
+  }
+
+ /* обрабатываем заданные файлы */
+  for( idx = optind; idx < argc; idx++ ) {
+     if( argv[idx] == command ) continue;
+     if( outname == NULL ) {
+       len = strlen( argv[idx] );
+       if( !decrypt ) ak_snprintf( buffer, sizeof( buffer ), "%s.akc", argv[idx] );
+        else {
+          if(( len < 5 ) || strcmp( argv[idx] + len - 4, ".akc" )) {
+            aktool_error(_("use -o option to set the output file name for %s"), argv[idx] );
+            errors++;
+            continue;
+          }
+          memset( buffer, 0, sizeof( buffer ));
+          memcpy( buffer, argv[idx], ak_min( len - 4, sizeof( buffer ) - 1 ));
+        }
+       if( aktool_encrypt_file( argv[idx], buffer ) != ak_error_ok ) errors++;
+     } else if( aktool_encrypt_file( argv[idx], outname ) != ak_error_ok ) errors++;
+  }
+  if( !errors ) exit_status = EXIT_SUCCESS;
+
+  labex:
+   memset( ec.password, 0, sizeof( ec.password ));
+   aktool_destroy_libakrypt();
+
+ return exit_status;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* длина фрагмента открытого текста с заданным номером */
+ static inline size_t aktool_encrypt_length( ak_uint64 k )
+{
+  return ( k == ec.count - 1 ) ? ec.last : ec.chunk;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* обработка части группы фрагментов; функция вызывается из нескольких потоков */
+ static int aktool_encrypt_part( ak_pointer ptr, const size_t idx )
+{
+  size_t j = 0;
+  ak_uint64 k = 0;
+  ak_encrypt_slot slot = ( ak_encrypt_slot )ptr;
+  ak_aead_chunks wk = ec.workers + idx;
+  size_t istride = ec.decrypt ? ec.chunk + wk->bsize : ec.chunk,
+         ostride = ec.decrypt ? ec.chunk : ec.chunk + wk->bsize;
+
+  for( j = idx; j < slot->count; j += ec.nworkers ) {
+     k = slot->first + j;
+     if( ec.decrypt ) slot->errors[j] = ak_aead_chunks_decrypt( wk, k, k == ec.count - 1,
+                          slot->in + j*istride, slot->out + j*ostride, aktool_encrypt_length( k ));
+      else slot->errors[j] = ak_aead_chunks_encrypt( wk, k, k == ec.count - 1,
+                          slot->in + j*istride, slot->out + j*ostride, aktool_encrypt_length( k ));
+  }
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* чтение или запись заданного количества октетов */
+ static int aktool_encrypt_io( ak_file fp, ak_uint8 *ptr, size_t size, bool_t write )
+{
+  ssize_t done = 0;
+  while( size > 0 ) {
+    if(( done = write ? ak_file_write( fp, ptr, size ) : ak_file_read( fp, ptr, size )) <= 0 )
+      return write ? ak_error_write_data : ak_error_read_data;
+    ptr += done; size -= ( size_t )done;
+  }
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* чтение следующей группы фрагментов */
+ static int aktool_encrypt_read_slot( ak_encrypt_slot slot, ak_uint64 first )
+{
+  size_t bsize = ec.workers->bsize, tag = ec.decrypt ? bsize : 0;
+
+  slot->first = first;
+  slot->count = ( size_t )ak_min( ec.count - first, ( ak_uint64 )ec.batch );
+  slot->insize = slot->outsize = 0;
+  if( !slot->count ) return ak_error_ok;
+
+  slot->insize = ( slot->count - 1 )*( ec.chunk + tag ) +
+                                           aktool_encrypt_length( first + slot->count - 1 ) + tag;
+  slot->outsize = slot->insize - tag*slot->count + ( ec.decrypt ? 0 : bsize*slot->count );
+ return aktool_encrypt_io( &ec.ifp, slot->in, slot->insize, ak_false );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* запись обработанной группы фрагментов; фрагменты записываются плотно, друг за другом */
+ static int aktool_encrypt_write_slot( ak_encrypt_slot slot )
+{
+  if( !slot->count ) return ak_error_ok;
+ return aktool_encrypt_io( &ec.ofp, slot->out, slot->outsize, ak_true );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* задание для потока ввода/вывода: запись предыдущей группы и чтение следующей */
+ typedef struct encrypt_io_job {
+   ak_encrypt_slot write, read;
+   ak_uint64 first;
+ } *ak_encrypt_io_job;
+
+ static void *aktool_encrypt_io_thread( void *ptr )
+{
+  ak_encrypt_io_job job = ( ak_encrypt_io_job )ptr;
+
+  if( job->write != NULL )
+    if( aktool_encrypt_write_slot( job->write ) != ak_error_ok ) ec.ioerror = ak_error_write_data;
+  if( aktool_encrypt_read_slot( job->read, job->first ) != ak_error_ok )
+    ec.ioerror = ak_error_read_data;
+ return NULL;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* создание контекстов для всех потоков (первый контекст уже создан) и буфферов */
+ static int aktool_encrypt_prepare( void )
+{
+  size_t i = 0;
+  int error = ak_error_ok;
+
+  for( ; ec.created < ec.nworkers; ec.created++ )
+     if(( error = ak_aead_chunks_create_copy( ec.workers + ec.created, ec.workers )) != ak_error_ok )
+       return error;
+
+  ec.chunk = ec.workers->chunk;
+  ec.batch = ec.nworkers*aktool_encrypt_chunks_per_thread;
+  for( i = 0; i < 3; i++ ) {
+     size_t size = ec.batch*( ec.chunk + ec.workers->bsize ) + 16;
+     if((( ec.slots[i].in = malloc( size )) == NULL ) ||
+        (( ec.slots[i].out = malloc( size )) == NULL ) ||
+        (( ec.slots[i].errors = malloc( ec.batch*sizeof( int ))) == NULL ))
+       return ak_error_out_of_memory;
+  }
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static void aktool_encrypt_release( void )
+{
+  size_t i = 0, size = 0;
+
+  if( ec.workers == NULL ) return;
+  size = ec.batch*( ec.chunk + ec.workers->bsize ) + 16;
+
+  for( i = 0; i < 3; i++ ) {
+    /* один из буфферов содержит открытый текст */
+     if( ec.slots[i].in ) {
+       memset( ec.slots[i].in, 0, size );
+       free( ec.slots[i].in );
+     }
+     if( ec.slots[i].out ) {
+       memset( ec.slots[i].out, 0, size );
+       free( ec.slots[i].out );
+     }
+     if( ec.slots[i].errors ) free( ec.slots[i].errors );
+  }
+  memset( ec.slots, 0, sizeof( ec.slots ));
+  for( i = 0; i < ec.created; i++ ) ak_aead_chunks_destroy( ec.workers + i );
+  ec.created = 0;
+  free( ec.workers );
+  ec.workers = NULL;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* конвейерная обработка всех фрагментов файла */
+ static int aktool_encrypt_pipeline( void )
+{
+  size_t j = 0, k = 0;
+  ak_encrypt_slot cur = NULL;
+  struct encrypt_io_job job;
+#ifdef AK_HAVE_PTHREAD_H
+  pthread_t thread;
+  bool_t started = ak_false;
+#endif
+
+  ec.ioerror = ak_error_ok;
+  if( aktool_encrypt_read_slot( ec.slots, 0 ) != ak_error_ok ) return ak_error_read_data;
+
+  for( k = 0; ec.slots[k%3].count > 0; k++ ) {
+     cur = ec.slots + k%3;
+     job.write = k > 0 ? ec.slots + ( k + 2 )%3 : NULL;
+     job.read = ec.slots + ( k + 1 )%3;
+     job.first = cur->first + cur->count;
+
+    /* пока потоки пула обрабатывают текущую группу фрагментов,
+       отдельный поток записывает предыдущую группу и считывает следующую */
+#ifdef AK_HAVE_PTHREAD_H
+     started = ( pthread_create( &thread, NULL, aktool_encrypt_io_thread, &job ) == 0 );
+     if( !started ) aktool_encrypt_io_thread( &job );
+#endif
+     ak_libakrypt_parallel_run( aktool_encrypt_part, cur, ak_min( ec.nworkers, cur->count ));
+#ifdef AK_HAVE_PTHREAD_H
+     if( started ) pthread_join( thread, NULL );
+#else
+     aktool_encrypt_io_thread( &job );
+#endif
+     if( ec.ioerror != ak_error_ok ) return ec.ioerror;
+
+    /* группа записывается только в том случае, если все фрагменты обработаны успешно */
+     for( j = 0; j < cur->count; j++ )
+        if( cur->errors[j] != ak_error_ok ) {
+          if( ec.decrypt ) aktool_error(_("incorrect integrity code of chunk %llu"),
+                                                        ( unsigned long long )( cur->first + j ));
+          return cur->errors[j];
+        }
+  }
+
+ /* записываем последнюю обработанную группу */
+  if( k > 0 ) return aktool_encrypt_write_slot( ec.slots + ( k + 2 )%3 );
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* создание контекста по заголовку и завершающей записи зашифрованного файла */
+ static int aktool_encrypt_open_encrypted( const char *filename )
+{
+  int error = ak_error_ok;
+  ak_uint64 total = 0;
+  size_t fsize = 0;
+  ak_uint8 header[ak_aead_chunks_header_size], footer[ak_aead_chunks_footer_data_size +16];
+
+  if(( error = aktool_encrypt_io( &ec.ifp, header, sizeof( header ), ak_false )) != ak_error_ok )
+    return error;
+  if(( error = ak_aead_chunks_create_from_header( ec.workers, header,
+                                                   ec.password, ec.lenpass )) != ak_error_ok ) {
+    aktool_error(_("%s is not a correct encrypted file"), filename );
+    return error;
+  }
+  ec.created = 1;
+
+ /* завершающая запись содержит длину открытого текста */
+  fsize = ak_aead_chunks_get_footer_size( ec.workers );
+  if(( ec.ifp.size < ( ak_int64 )( sizeof( header ) + fsize )) ||
+     (( error = ak_file_seek( &ec.ifp, ec.ifp.size - ( ak_int64 )fsize )) != ak_error_ok ) ||
+     (( error = aktool_encrypt_io( &ec.ifp, footer, fsize, ak_false )) != ak_error_ok ) ||
+     (( error = ak_aead_chunks_check_footer( ec.workers, footer, &ec.size )) != ak_error_ok )) {
+    aktool_error(_("incorrect password or damaged footer of file %s"), filename );
+    return error == ak_error_ok ? ak_error_wrong_length : error;
+  }
+  ec.count = ak_aead_chunks_get_count( ec.workers, ec.size, &ec.last );
+  total = sizeof( header ) + fsize +
+             ( ec.count - 1 )*( ec.workers->chunk + ec.workers->bsize ) + ec.last + ec.workers->bsize;
+  if( total != ( ak_uint64 )ec.ifp.size ) {
+    aktool_error(_("%s has unexpected length"), filename );
+    return ak_error_wrong_length;
+  }
+ return ak_file_seek( &ec.ifp, sizeof( header ));
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* зашифрование или расшифрование одного файла */
+ int aktool_encrypt_file( const char *filename, const char *outname )
+{
+  int error = ak_error_ok;
+  bool_t created = ak_false;
+  ak_uint8 footer[ak_aead_chunks_footer_data_size +16];
+
+  if(( error = ak_file_open_to_read( &ec.ifp, filename )) != ak_error_ok ) {
+    aktool_error(_("incorrect opening of file %s"), filename );
+    return error;
+  }
+  ec.nworkers = ak_max( 1, ak_libakrypt_get_threads_count( ));
+  if(( ec.workers = ak_aligned_malloc( ec.nworkers*sizeof( struct aead_chunks ))) == NULL ) {
+    aktool_error(_("incorrect memory allocation"));
+    error = ak_error_out_of_memory;
+    goto labex;
+  }
+  memset( ec.workers, 0, ec.nworkers*sizeof( struct aead_chunks ));
+
+ /* создаем основной контекст: вырабатываем мастер-ключ из пароля и формируем
+    или считываем заголовок файла */
+  if( ec.decrypt ) {
+    if(( error = aktool_encrypt_open_encrypted( filename )) != ak_error_ok ) goto labex;
+  } else {
+     ak_oid oid = ak_oid_find_by_name( aktool_default_generator );
+     ak_random generator = ak_oid_new_object( oid );
+
+     if( generator == NULL ) error = ak_error_get_value();
+      else {
+        error = ak_aead_chunks_create( ec.workers, ec.algorithm, ec.chunk,
+                                                          ec.password, ec.lenpass, generator );
+        ak_oid_delete_object( oid, generator );
+      }
+     if( error != ak_error_ok ) {
+       aktool_error(_("incorrect creation of secret keys"));
+       goto labex;
+     }
+     ec.created = 1;
+     ec.size = ( ak_uint64 )ec.ifp.size;
+     ec.count = ak_aead_chunks_get_count( ec.workers, ec.size, &ec.last );
+     if(( ec.size > 0 ) && ( ec.last < ec.workers->minimal )) {
+       aktool_error(_("%s is too short for %s mode"), filename, ec.algorithm->name[0] );
+       error = ak_error_wrong_length;
+       goto labex;
+     }
+  }
+  if(( error = aktool_encrypt_prepare( )) != ak_error_ok ) {
+    aktool_error(_("incorrect creation of secret keys"));
+    goto labex;
+  }
+
+ /* создаем выходной файл и обрабатываем данные */
+  if(( error = ak_file_create_to_write( &ec.ofp, outname )) != ak_error_ok ) {
+    aktool_error(_("incorrect creation of file %s"), outname );
+    goto labex;
+  }
+  created = ak_true;
+  if( !ec.decrypt ) error = aktool_encrypt_io( &ec.ofp, ec.workers->header,
+                                                           ak_aead_chunks_header_size, ak_true );
+  if( error == ak_error_ok ) error = aktool_encrypt_pipeline();
+  if(( error == ak_error_ok ) && !ec.decrypt ) {
+    if(( error = ak_aead_chunks_create_footer( ec.workers, ec.size, footer )) == ak_error_ok )
+      error = aktool_encrypt_io( &ec.ofp, footer,
+                                           ak_aead_chunks_get_footer_size( ec.workers ), ak_true );
+  }
+  if( error != ak_error_ok )
+    aktool_error(_("incorrect %s of file %s"), ec.decrypt ? _("decryption") : _("encryption"),
+                                                                                         filename );
+  labex:
+   aktool_encrypt_release();
+   ak_file_close( &ec.ifp );
+   if( created ) {
+     ak_file_close( &ec.ofp );
+     if( error != ak_error_ok ) remove( outname );
+   }
+
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int aktool_encrypt_help( bool_t decrypt )
+{
+  if( decrypt ) printf(
+   _("aktool decrypt [options] [files] - decrypt files created by \"aktool encrypt\" command\n"
+     "usage:\n"
+     "  aktool d file.akc            - decrypt a file and save the result as file\n"
+     "  aktool d -o file data.akc    - decrypt a file and save the result as file\n\n"
+     "available options:\n"
+     " -o, --output <file>     set the name of output file\n"
+     "     --password <pass>   set the password directly in command line\n"
+     "     --threads <count>   set the number of threads [ default: number of processors ]\n"
+  ));
+   else printf(
+   _("aktool encrypt [options] [files] - encrypt files using authenticated encryption\n"
+     "usage:\n"
+     "  aktool e file                - encrypt a file and save the result as file.akc\n"
+     "  aktool e -o data.akc file    - encrypt a file and save the result as data.akc\n\n"
+     "available options:\n"
+     " -a, --algorithm <name>  set the aead mode of block cipher [ default: mgm-kuznechik ]\n"
+     "     --chunk-size <size> set the length of independently encrypted chunks [ default: 65536 ]\n"
+     " -o, --output <file>     set the name of output file\n"
+     "     --password <pass>   set the password directly in command line\n"
+     "     --threads <count>   set the number of threads [ default: number of processors ]\n"
+  ));
+
+ return aktool_print_common_options();
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                                                                               aktool_encrypt.c  */
+/* ----------------------------------------------------------------------------------------------- */
@@ -0,0 +1,379 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  Copyright (c) 2020 by Axel Kenzo, axelkenzo@mail.ru                                            */
+/*                                                                                                 */
+/*  Файл aktool_icode.c                                                                            */
+/*  - содержит реализацию команды вычисления и проверки кодов целостности файлов                   */
+/* ----------------------------------------------------------------------------------------------- */
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <aktool.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+/* количество файлов, коды целостности которых вычисляются за одно обращение к пулу потоков */
+ #define aktool_icode_batch_size (4096)
+/* максимальная длина кода целостности (в октетах) */
+ #define aktool_icode_max_size     (64)
+
+/* ----------------------------------------------------------------------------------------------- */
+ int aktool_icode_help( void );
+ int aktool_icode_add_file( const tchar * , ak_pointer );
+ int aktool_icode_add_line( const char * , ak_pointer );
+ int aktool_icode_flush( void );
+
+/* ----------------------------------------------------------------------------------------------- */
+/* описание одного обрабатываемого файла */
+ typedef struct icode_item {
+   char *filename;
+   ak_oid algorithm;
+   int error;
+   size_t size; /* длина кода целостности */
+   ak_uint8 icode[aktool_icode_max_size]; /* вычисленное или ожидаемое значение */
+ } *ak_icode_item;
+
+/* ----------------------------------------------------------------------------------------------- */
+ static struct icode_info {
+   ak_oid algorithm;
+   char *pattern;
+   bool_t tree, check, quiet;
+   ak_uint8 key[aktool_icode_max_size];
+   size_t keysize;
+   ak_int64 threads;
+   FILE *fp;
+   struct icode_item items[aktool_icode_batch_size];
+   size_t count;     /* количество файлов в текущей группе */
+   size_t total;     /* общее количество обработанных файлов */
+   size_t errors;    /* количество файлов, для которых обнаружены ошибки */
+ } ic;
+
+/* ----------------------------------------------------------------------------------------------- */
+ int aktool_icode( int argc, tchar *argv[] )
+{
+  int idx = 0, next_option = 0, exit_status = EXIT_FAILURE, error = ak_error_ok;
+  char *outname = NULL, *checkname = NULL;
+  tchar *command = argv[1];
+
+  const struct option long_options[] = {
+    /* сначала уникальные */
+     { "algorithm",        1, NULL, 'a' },
+     { "check",            1, NULL, 'c' },
+     { "output",           1, NULL, 'o' },
+     { "pattern",          1, NULL, 'p' },
+     { "recursive",        0, NULL, 'r' },
+     { "hexkey",           1, NULL, 250 },
+     { "threads",          1, NULL, 249 },
+     { "quiet",            0, NULL, 248 },
+
+    /* потом общие */
+     { "openssl-style",    0, NULL,   5  },
+     { "audit",            1, NULL,   4  },
+     { "dont-use-colors",  0, NULL,   3  },
+     { "audit-file",       1, NULL,   2  },
+     { "help",             0, NULL,   1  },
+     { NULL,               0, NULL,   0  },
+  };
+
+ /* параметры по-умолчанию */
+  memset( &ic, 0, sizeof( struct icode_info ));
+  ic.algorithm = ak_oid_find_by_name( "streebog256" );
+  ic.pattern = "*";
+  ic.tree = ak_false;
+  ic.quiet = ak_false;
+  ic.threads = -1;
+
+ /* разбираем опции командной строки */
+  do {
+       next_option = getopt_long( argc, argv, "a:c:o:p:r", long_options, NULL );
+       switch( next_option )
+      {
+       /* сначала обработка стандартных опций */
+        case  1  :   return aktool_icode_help();
+        case  2  : /* получили от пользователя имя файла для вывода аудита */
+                     aktool_set_audit( optarg );
+                     break;
+        case  3  : /* установка флага запрета вывода символов смены цветовой палитры */
+                     ak_error_set_color_output( ak_false );
+                     ak_libakrypt_set_option( "use_color_output", 0 );
+                     break;
+        case  4  : /* устанавливаем уровень аудита */
+                     aktool_log_level = atoi( optarg );
+                     break;
+        case  5  : /* переходим к стилю openssl */
+                     aktool_openssl_compability = ak_true;
+                     break;
+
+       /* теперь опции, уникальные для icode */
+        case 'a' :  if(( ic.algorithm = ak_oid_find_by_ni( optarg )) == NULL ) {
+                      aktool_error(
+                        _("using unsupported name or identifier \"%s\" for hash function"), optarg );
+                      printf(
+                     _("try \"aktool s --oid hash\" for list of all available algorithms\n"));
+                      return EXIT_FAILURE;
+                    }
+                    if((( ic.algorithm->engine != hash_function ) &&
+                        ( ic.algorithm->engine != hmac_function )) ||
+                                                           ( ic.algorithm->mode != algorithm )) {
+                      aktool_error(_("%s is not valid identifier for integrity function"), optarg );
+                      return EXIT_FAILURE;
+                    }
+                    break;
+
+        case 'c' :  checkname = optarg;
+                    break;
+        case 'o' :  outname = optarg;
+                    break;
+        case 'p' :  ic.pattern = optarg;
+                    break;
+        case 'r' :  ic.tree = ak_true;
+                    break;
+
+        case 250 :  ic.keysize = ak_min( strlen( optarg ) >> 1, sizeof( ic.key ));
+                    if( ak_hexstr_to_ptr( optarg, ic.key, ic.keysize, ak_false ) != ak_error_ok ) {
+                      aktool_error(_("%s is not valid hexademal string"), optarg );
+                      return EXIT_FAILURE;
+                    }
+                    break;
+
+        case 249 :  ic.threads = atoi( optarg );
+                    break;
+
+        case 248 :  ic.quiet = ak_true;
+                    break;
+
+       /* обрабатываем ошибочные параметры */
+        default:
+                    break;
+       }
+  } while( next_option != -1 );
+
+  if(( checkname == NULL ) && ( optind >= argc )) return aktool_icode_help();
+ /* ключ алгоритма выработки имитовставки проверяем до начала обработки файлов */
+  if(( checkname == NULL ) && ( ic.algorithm->engine == hmac_function ) && ( ic.keysize == 0 )) {
+    aktool_error(_("the secret key for %s is not defined, use --hexkey option"),
+                                                                         ic.algorithm->name[0] );
+    return EXIT_FAILURE;
+  }
+
+ /* начинаем работу с криптографическими примитивами */
+  if( !aktool_create_libakrypt( )) return EXIT_FAILURE;
+  if( ic.threads >= 0 ) ak_libakrypt_set_option( "threads_count", ic.threads );
+
+  if( outname != NULL ) {
+    if(( ic.fp = fopen( outname, "w" )) == NULL ) {
+      aktool_error(_("incorrect creation of file %s"), outname );
+      goto labex;
+    }
+  } else ic.fp = stdout;
+
+  if( checkname != NULL ) {
+   /* проверяем коды целостности, записанные в заданном файле */
+    ic.check = ak_true;
+    if(( error = ak_file_read_by_lines( checkname,
+                                              aktool_icode_add_line, NULL )) != ak_error_ok ) {
+     /* об отсутствии ключа уже сообщено функцией aktool_icode_add_line() */
+      if( error != ak_error_wrong_key_length )
+        aktool_error(_("incorrect reading of file %s"), checkname );
+      ic.errors++;
+    }
+  } else {
+     /* вычисляем коды целостности для заданных файлов и каталогов */
+      for( idx = optind; idx < argc; idx++ ) {
+         if( argv[idx] == command ) continue;
+         switch( ak_file_or_directory( argv[idx] )) {
+           case DT_DIR: ak_file_find( argv[idx], ic.pattern, aktool_icode_add_file, NULL, ic.tree );
+                        break;
+           case DT_REG: aktool_icode_add_file( argv[idx], NULL );
+                        break;
+           default:     aktool_error(_("%s is not a file or directory"), argv[idx] );
+                        ic.errors++;
+                        break;
+         }
+      }
+    }
+  aktool_icode_flush();
+
+  if( ic.check ) {
+    if( ic.errors ) fprintf( ic.fp, _("%u file(s) checked, %u error(s) found\n"),
+                                               (unsigned int) ic.total, (unsigned int) ic.errors );
+     else if( !ic.quiet ) fprintf( ic.fp,
+                                _("%u file(s) checked, no errors\n"), (unsigned int) ic.total );
+  }
+  if( !ic.errors ) exit_status = EXIT_SUCCESS;
+  if( ic.fp != stdout ) fclose( ic.fp );
+
+  labex:
+   memset( ic.key, 0, sizeof( ic.key ));
+   aktool_destroy_libakrypt();
+
+ return exit_status;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* вычисление кода целостности одного файла; функция вызывается из нескольких потоков */
+ static int aktool_icode_file( ak_pointer ptr, const size_t idx )
+{
+  ak_uint8 out[aktool_icode_max_size];
+  ak_icode_item item = ( ak_icode_item )ptr + idx;
+  int error = ak_error_ok;
+
+  memset( out, 0, sizeof( out ));
+  switch( item->algorithm->engine ) {
+    case hash_function: {
+      struct hash ctx;
+      if(( error = ak_hash_create_oid( &ctx, item->algorithm )) != ak_error_ok ) break;
+     /* при проверке длина сохраненного кода должна совпадать с длиной кода алгоритма */
+      if( ic.check && ( item->size != ak_hash_get_tag_size( &ctx ))) error = ak_error_wrong_length;
+       else
+      if(( error = ak_hash_file( &ctx, item->filename, out, sizeof( out ))) == ak_error_ok )
+        if( !ic.check ) item->size = ak_hash_get_tag_size( &ctx );
+      ak_hash_destroy( &ctx );
+    } break;
+
+    case hmac_function: {
+      struct hmac ctx;
+      if(( error = ak_hmac_create_oid( &ctx, item->algorithm )) != ak_error_ok ) break;
+      if( ic.check && ( item->size != ak_hmac_get_tag_size( &ctx ))) error = ak_error_wrong_length;
+       else
+      if((( error = ak_hmac_set_key( &ctx, ic.key, ic.keysize )) == ak_error_ok ) &&
+         (( error = ak_hmac_file( &ctx, item->filename, out, sizeof( out ))) == ak_error_ok ))
+        if( !ic.check ) item->size = ak_hmac_get_tag_size( &ctx );
+      ak_hmac_destroy( &ctx );
+    } break;
+
+    default: error = ak_error_wrong_oid;
+  }
+
+  if( error == ak_error_ok ) {
+    if( !ic.check ) memcpy( item->icode, out, item->size );
+     else if( !ak_ptr_is_equal( item->icode, out, item->size )) error = ak_error_not_equal_data;
+  }
+  item->error = error;
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* вычисление кодов целостности для накопленной группы файлов и вывод результатов */
+ int aktool_icode_flush( void )
+{
+  size_t i = 0;
+  ak_icode_item item = NULL;
+
+  if( !ic.count ) return ak_error_ok;
+  ak_libakrypt_parallel_run( aktool_icode_file, ic.items, ic.count );
+
+ /* результаты выводятся в порядке добавления файлов */
+  for( i = 0; i < ic.count; i++ ) {
+     item = ic.items + i;
+     if( item->error != ak_error_ok ) ic.errors++;
+     if( ic.check ) {
+       if( item->error == ak_error_ok ) {
+         if( !ic.quiet ) fprintf( ic.fp, _("%s: Ok\n"), item->filename );
+       } else fprintf( ic.fp, _("%s: Wrong\n"), item->filename );
+     } else {
+         if( item->error == ak_error_ok )
+           fprintf( ic.fp, "%s (%s) = %s\n", item->algorithm->name[0], item->filename,
+                                          ak_ptr_to_hexstr( item->icode, item->size, ak_false ));
+          else aktool_error(_("incorrect evaluation of integrity code for %s"), item->filename );
+       }
+     free( item->filename );
+  }
+  ic.total += ic.count;
+  ic.count = 0;
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* добавление файла в группу обрабатываемых файлов */
+ int aktool_icode_add_file( const tchar *filename, ak_pointer ptr )
+{
+  size_t len = strlen( filename );
+  ak_icode_item item = ic.items + ic.count;
+  (void)ptr;
+
+  memset( item, 0, sizeof( struct icode_item ));
+  if(( item->filename = malloc( len + 1 )) == NULL ) {
+    ic.errors++;
+    return ak_error_out_of_memory;
+  }
+  memcpy( item->filename, filename, len + 1 );
+  item->algorithm = ic.algorithm;
+  if( ++ic.count == aktool_icode_batch_size ) aktool_icode_flush();
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* разбор строки вида "algorithm (filename) = icode" и добавление файла в группу */
+ int aktool_icode_add_line( const char *line, ak_pointer ptr )
+{
+  ak_oid oid = NULL;
+  const char *lb = NULL, *rb = NULL, *hex = NULL;
+  char name[64];
+  ak_icode_item item = ic.items + ic.count;
+  (void)ptr;
+
+  if( !strlen( line )) return ak_error_ok;
+  if((( lb = strstr( line, " (" )) == NULL ) || (( rb = strstr( lb, ") = " )) == NULL ))
+    goto labwrong;
+ /* имя файла может содержать последовательность ") = ", поэтому ищем последнее вхождение */
+  while(( hex = strstr( rb+1, ") = " )) != NULL ) rb = hex;
+  hex = rb + 4;
+
+  memset( name, 0, sizeof( name ));
+  memcpy( name, line, ak_min(( size_t )( lb - line ), sizeof( name ) - 1 ));
+  if((( oid = ak_oid_find_by_name( name )) == NULL ) ||
+     (( oid->engine != hash_function ) && ( oid->engine != hmac_function ))) goto labwrong;
+ /* без ключа проверка имитовставок невозможна, поэтому прекращаем чтение файла */
+  if(( oid->engine == hmac_function ) && ( ic.keysize == 0 )) {
+    aktool_error(_("the secret key for %s is not defined, use --hexkey option"), oid->name[0] );
+    return ak_error_wrong_key_length;
+  }
+
+  memset( item, 0, sizeof( struct icode_item ));
+  item->algorithm = oid;
+  if(( strlen( hex )&1 ) || (( item->size = strlen( hex ) >> 1 ) > sizeof( item->icode )) ||
+     ( ak_hexstr_to_ptr( hex, item->icode, item->size, ak_false ) != ak_error_ok )) goto labwrong;
+  if(( item->filename = malloc(( size_t )( rb - lb ) - 1 )) == NULL ) {
+    ic.errors++;
+    return ak_error_out_of_memory;
+  }
+  memcpy( item->filename, lb + 2, ( size_t )( rb - lb ) - 2 );
+  item->filename[( size_t )( rb - lb ) - 2] = 0;
+  if( ++ic.count == aktool_icode_batch_size ) aktool_icode_flush();
+
+ return ak_error_ok;
+
+  labwrong:
+   aktool_error(_("unsupported line format: %s"), line );
+   ic.errors++;
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int aktool_icode_help( void )
+{
+  printf(
+   _("aktool icode [options] [files or directories] - calculate or check integrity codes\n"
+     "usage:\n"
+     "  aktool i file                - calculate the integrity code of a given file\n"
+     "  aktool i -r -o list.txt dir  - calculate the integrity codes of all files in a directory tree\n"
+     "  aktool i -c list.txt         - check the integrity codes stored in a file\n\n"
+     "available options:\n"
+     " -a, --algorithm <name>  set the hash function or HMAC algorithm [ default: streebog256 ]\n"
+     " -c, --check <file>      check the integrity codes stored in a given file\n"
+     "     --hexkey <key>      set the secret key for HMAC algorithm as hexademal string\n"
+     " -o, --output <file>     set the name of output file\n"
+     " -p, --pattern <mask>    set the mask of file names in directories [ default: \"*\" ]\n"
+     "     --quiet             print only information about incorrect files\n"
+     " -r, --recursive         walk through all subdirectories\n"
+     "     --threads <count>   set the number of threads [ default: number of processors ]\n"
+  ));
+
+ return aktool_print_common_options();
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                                                                                 aktool_icode.c  */
+/* ----------------------------------------------------------------------------------------------- */
@@ -16,16 +16,6 @@
  int aktool_key_load_user_password( char * , const size_t );
 
 /* ----------------------------------------------------------------------------------------------- */
-#if defined(__unix__) || defined(__APPLE__)
-  #define aktool_default_generator "dev-random"
-#else
-  #ifdef AK_HAVE_WINDOWS_H
-    #define aktool_default_generator "winrtl"
-  #else
-    #define aktool_default_generator "lcg"
-  #endif
-#endif
-
 #define aktool_magic_number (113)
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -51,8 +41,25 @@
    char req_file[FILENAME_MAX];      /* читаем открытый ключ */
    char key_file[FILENAME_MAX];     /* читаем секретный ключ */
    char pubkey_file[FILENAME_MAX];   /* читаем открытый ключ */
+   char id_file[FILENAME_MAX]; /* читаем идентификаторы абонентов */
  } ki;
 
+/* ----------------------------------------------------------------------------------------------- */
+/* список идентификаторов абонентов, для которых вырабатываются ключи схемы Блома */
+ static struct id_list {
+   ak_pointer *ids;
+   size_t *sizes;
+   size_t count, allocated;
+ } il;
+
+/* мастер-ключ схемы Блома: либо контейнер, строки которого расшифровываются по мере
+   необходимости, либо ключ, полностью считанный в память (для ключей, сохраненных ранее) */
+ static struct blom_source {
+   struct blomkey_container container;
+   struct blomkey master;
+   bool_t mapped;
+ } bs;
+
 /* ----------------------------------------------------------------------------------------------- */
  int aktool_key( int argc, tchar *argv[] )
 {
@@ -104,6 +111,7 @@
      { "id",                  1, NULL,  182 },
      { "hexid",               1, NULL,  183 },
      { "target",              1, NULL,  184 },
+     { "id-file",             1, NULL,  185 },
 
    /* это стандартые для всех программ опции */
      { "openssl-style",       0, NULL,   5  },
@@ -399,6 +407,11 @@
                    strncpy( ki.target, optarg, sizeof( ki.target ) -1 );
                    break;
 
+        case 185: /* --id-file */
+                   memset( ki.id_file, 0, sizeof( ki.id_file ));
+                   strncpy( ki.id_file, optarg, sizeof( ki.id_file ) -1 );
+                   break;
+
         default:  /* обрабатываем ошибочные параметры */
                    if( next_option != -1 ) work = do_nothing;
                    break;
@@ -613,15 +626,114 @@
  return exitcode;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/* добавление в список идентификатора, считанного из файла (пустые строки пропускаются) */
+ static int aktool_key_add_id( const char *line, ak_pointer ptr )
+{
+  size_t len = strlen( line );
+  ak_pointer *ids = NULL;
+  size_t *sizes = NULL;
+
+  ( void )ptr;
+  if( !len ) return ak_error_ok;
+  if( il.count == il.allocated ) {
+    size_t allocated = il.allocated ? 2*il.allocated : 64;
+    if(( ids = realloc( il.ids, allocated*sizeof( ak_pointer ))) == NULL )
+      return ak_error_out_of_memory;
+    il.ids = ids;
+    if(( sizes = realloc( il.sizes, allocated*sizeof( size_t ))) == NULL )
+      return ak_error_out_of_memory;
+    il.sizes = sizes;
+    il.allocated = allocated;
+  }
+  if(( il.ids[il.count] = strdup( line )) == NULL ) return ak_error_out_of_memory;
+  il.sizes[il.count++] = len;
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* выработка ключей абонентов из мастер-ключа, указанного в bs */
+ static int aktool_key_create_abonent_keys( ak_blomkey keys, const size_t count,
+                                                            ak_pointer *ids, const size_t *sizes )
+{
+  if( bs.mapped ) return ak_blomkey_container_create_abonent_keys( &bs.container,
+                                                                     keys, count, ids, sizes );
+ return ak_blomkey_create_abonent_keys( keys, &bs.master, count, ids, sizes );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* выработка ключей для всех абонентов, идентификаторы которых содержатся в файле ki.id_file */
+ static int aktool_key_new_blom_abonents( void )
+{
+  size_t i = 0;
+  ak_blomkey keys = NULL;
+  char filename[FILENAME_MAX];
+  int exitcode = EXIT_FAILURE;
+
+  if( ak_file_read_by_lines( ki.id_file, aktool_key_add_id, NULL ) != ak_error_ok ) {
+    aktool_error(_("incorrect reading of abonent's identifiers from %s file"), ki.id_file );
+    goto labex;
+  }
+  if( il.count == 0 ) {
+    aktool_error(_("the file %s does not contain any abonent's identifiers"), ki.id_file );
+    goto labex;
+  }
+  if(( keys = malloc( il.count*sizeof( struct blomkey ))) == NULL ) {
+    aktool_error(_("incorrect memory allocation"));
+    goto labex;
+  }
+
+ /* создаем ключи абонентов за один проход по мастер-ключу */
+  if( ki.verbose ) {
+    printf(_("generation a %s keys for %u abonents: "),
+                                          ki.algorithm->name[0], (unsigned int) il.count );
+    fflush( stdout );
+  }
+  if( aktool_key_create_abonent_keys( keys, il.count, il.ids, il.sizes ) != ak_error_ok ) {
+    aktool_error(_("incorrect creation of the abonent's keys"));
+    goto labex;
+  }
+  if( ki.verbose ) { printf(_("Ok\n")); }
+
+ /* запрашиваем пароль, общий для всех ключей абонентов, и сохраняем ключи */
+  ki.lenpass = 0;
+  memset( ki.password, 0, sizeof( ki.password ));
+  if( aktool_key_load_user_password_twice() == ak_error_ok ) {
+    exitcode = EXIT_SUCCESS;
+    for( i = 0; i < il.count; i++ ) {
+       memset( filename, 0, sizeof( filename ));
+       if( ak_blomkey_export_to_file_with_password( keys + i, ki.password, ki.lenpass,
+                                                 filename, sizeof( filename )) != ak_error_ok ) {
+         aktool_error(_("wrong export a secret key for %s"), ( char * )il.ids[i] );
+         exitcode = EXIT_FAILURE;
+       }
+        else printf(_("secret key for %s stored in %s\n"), ( char * )il.ids[i], filename );
+    }
+  }
+  for( i = 0; i < il.count; i++ ) ak_blomkey_destroy( keys + i );
+
+ labex:
+  if( keys != NULL ) free( keys );
+  for( i = 0; i < il.count; i++ ) free( il.ids[i] );
+  if( il.ids != NULL ) free( il.ids );
+  if( il.sizes != NULL ) free( il.sizes );
+  memset( &il, 0, sizeof( struct id_list ));
+
+ return exitcode;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
  static int aktool_key_new_blom_abonent( void )
 {
+  int error = ak_error_ok;
   int exitcode = EXIT_FAILURE;
-  struct blomkey master, abonent;
+  struct blomkey abonent;
+  ak_pointer id = ki.user_id;
 
  /* проверяем наличие имени пользователя */
-  if( ki.lenuser == 0 ) {
-    aktool_error(_("user or abonent's name is undefined, use \"--id\" option" ));
+  if(( ki.lenuser == 0 ) && ( strlen( ki.id_file ) == 0 )) {
+    aktool_error(_("user or abonent's name is undefined, use \"--id\" or \"--id-file\" option" ));
     return exitcode;
   }
   if( strlen( ki.key_file ) == 0 ) {
@@ -639,12 +751,23 @@
      }
   }
 
- /* считываем ключ из заданного файла
-    если пароль определен в командой строке, то используем именно его */
-  if( ak_blomkey_import_from_file_with_password( &master,
-                                         ki.password, ki.lenpass, ki.key_file ) != ak_error_ok ) {
-    aktool_error(_("incorrect loading a master key from %s file\n"), ki.key_file );
-    return exitcode;
+ /* открываем контейнер с мастер-ключом без расшифрования ключевых данных; мастер-ключи,
+    сохраненные в прежнем формате, считываем в память полностью
+    (если пароль определен в командой строке, то используем именно его) */
+  memset( &bs, 0, sizeof( struct blom_source ));
+  if(( error = ak_blomkey_container_open( &bs.container,
+                                   ki.password, ki.lenpass, ki.key_file )) == ak_error_ok )
+    bs.mapped = ak_true;
+   else
+    if(( error != ak_error_wrong_key_type ) || ( ak_blomkey_import_from_file_with_password(
+                         &bs.master, ki.password, ki.lenpass, ki.key_file ) != ak_error_ok )) {
+      aktool_error(_("incorrect loading a master key from %s file\n"), ki.key_file );
+      return exitcode;
+    }
+ /* создаем ключи всех абонентов из заданного списка */
+  if( strlen( ki.id_file ) > 0 ) {
+    exitcode = aktool_key_new_blom_abonents();
+    goto labex1;
   }
  /* создаем ключ абонента */
   if( ki.verbose ) {
@@ -654,7 +777,7 @@
                                              ak_ptr_to_hexstr( ki.user_id, ki.lenuser, ak_false ));
     fflush( stdout );
   }
-  if( ak_blomkey_create_abonent_key( &abonent, &master, ki.user_id, ki.lenuser ) != ak_error_ok ) {
+  if( aktool_key_create_abonent_keys( &abonent, 1, &id, &ki.lenuser ) != ak_error_ok ) {
     aktool_error(_("incorrect creation of the abonent's key"));
     goto labex1;
   }
@@ -683,7 +806,8 @@
  labex2:
    ak_blomkey_destroy( &abonent );
  labex1:
-   ak_blomkey_destroy( &master );
+   if( bs.mapped ) ak_blomkey_container_close( &bs.container );
+    else ak_blomkey_destroy( &bs.master );
 
  return exitcode;
 }
@@ -1095,6 +1219,8 @@
      "     --hexload           input the password from console as hexademal string\n"
      "     --hexpass           specify the password directly in command line as hexademal string\n"
      "     --id                user or abonent's identifier\n"
+     "     --id-file           set the name of file with abonent's identifiers (one identifier per line)\n"
+     "                         all abonent's keys are created by a single pass over the master key\n"
      "     --key               specify the name of file with the secret key\n"
      "                         (this can be a master key or issuer's key which is used to sign a certificate)\n"
      "     --label             assign the user-defined label to secret key\n"
@@ -11,6 +11,7 @@
  int aktool_test_speed_block_cipher( ak_oid );
  int aktool_test_speed_hash_function( ak_oid );
  int aktool_test_speed_sign_function( ak_oid );
+ int aktool_test_speed_random_generator( ak_oid );
 
 /* ----------------------------------------------------------------------------------------------- */
   bool_t aktool_test_verbose = ak_false;
@@ -19,6 +20,7 @@
  int aktool_test( int argc, tchar *argv[] )
 {
   ak_oid oid = NULL;
+  control_test_group_t group = gfn_control_test;
   char *value = NULL;
   int next_option = 0, exit_status = EXIT_SUCCESS;
 
@@ -88,6 +90,12 @@
           printf(_("complete crypto test is Wrong\n"));
           exit_status = EXIT_FAILURE;
         }
+      /* выводим время выполнения каждой группы тестов */
+       for( group = 0; group < control_tests_count; group++ ) {
+          double time = 0;
+          if( ak_libakrypt_get_control_test_result( group, &time ) == ak_error_ok )
+            printf(" %-14s %f sec\n", ak_libakrypt_get_control_test_name( group ), time );
+       }
        break;
 
      case do_speed_oid:
@@ -107,7 +115,9 @@
         case sign_function:
            exit_status = aktool_test_speed_sign_function( oid );
            break;
-
+        case random_generator:
+           exit_status = aktool_test_speed_random_generator( oid );
+           break;
 
          default:
            printf(_("algorithm engine \"%s\" is not supported yet for testing, sorry ... \n"),
@@ -136,6 +146,8 @@
      "     --crypto            complete test of cryptographic algorithms\n"
      "                         run all available algorithms on test values taken from standards and recommendations\n"
      "     --speed <ni>        measuring the speed of the crypto algorithm with a given name or identifier\n"
+     "                         for random generators the bulk fill speed, the rate of short requests\n"
+     "                         and the multi-threaded scaling are measured\n"
      " -v, --verbose           detailed information output\n"
      "\n"
      "for more information run tests with \"--audit 2 --audit-file stderr\" options or see /var/log/auth.log file\n"
@@ -493,6 +505,136 @@
  return exit_status;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция возвращает значение монотонного времени (в секундах); используется для оценки
+    скорости многопоточных вычислений, для которых значение clock() не подходит. */
+/* ----------------------------------------------------------------------------------------------- */
+ static double aktool_test_wall_time( void )
+{
+#if defined(CLOCK_MONOTONIC)
+  struct timespec ts;
+  if( clock_gettime( CLOCK_MONOTONIC, &ts ) == 0 )
+    return ( double )ts.tv_sec + ( double )ts.tv_nsec*1e-9;
+#endif
+ return ( double )clock()/( double )CLOCKS_PER_SEC;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Задание для многопоточного теста скорости генератора: каждый элемент задания
+    создает собственный контекст генератора и вырабатывает `count` мегабайт данных. */
+ typedef struct random_speed_job {
+  /*! \brief идентификатор генератора */
+   ak_oid oid;
+  /*! \brief количество мегабайт, вырабатываемых каждым элементом задания */
+   size_t count;
+ } *ak_random_speed_job;
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int aktool_test_speed_random_part( ak_pointer ptr, const size_t idx )
+{
+  size_t i = 0;
+  struct random generator;
+  ak_uint8 *data = NULL;
+  int error = ak_error_ok;
+  ak_random_speed_job job = ptr;
+
+  (void)idx;
+  if(( data = malloc( 1024*1024 )) == NULL ) return ak_error_out_of_memory;
+  if(( error = ak_random_create_oid( &generator, job->oid )) == ak_error_ok ) {
+    for( i = 0; ( i < job->count ) && ( error == ak_error_ok ); i++ )
+       error = ak_random_ptr( &generator, data, 1024*1024 );
+    ak_random_destroy( &generator );
+  }
+  free( data );
+
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Тест скорости генератора псевдо-случайных чисел:
+     - скорость заполнения больших областей памяти,
+     - количество запросов малой длины (4, 8 и 32 октета), выполняемых за секунду
+       (такие запросы используются при маскировании секретных ключей),
+     - зависимость суммарной скорости от количества потоков,
+       каждый из которых использует собственный контекст генератора.                              */
+/* ----------------------------------------------------------------------------------------------- */
+ int aktool_test_speed_random_generator( ak_oid oid )
+{
+  double timea = 0, speed = 0, base = 0;
+  size_t i = 0, j = 0, count = 0, threads = 0;
+  size_t sizes[3] = { 4, 8, 32 };
+  struct random_speed_job job;
+  struct random generator;
+  ak_uint8 *data = NULL;
+  int error = ak_error_ok, exit_status = EXIT_FAILURE;
+
+  if( oid->mode != algorithm ) {
+    printf(_("random generator's mode \"%s\" is not supported yet for testing, sorry ... \n"),
+                                                           ak_libakrypt_get_mode_name( oid->mode ));
+    return EXIT_SUCCESS;
+  }
+  if(( error = ak_random_create_oid( &generator, oid )) != ak_error_ok ) {
+    aktool_error(_("incorrect creation of random generator context (code: %d)"), error );
+    return exit_status;
+  }
+  if(( data = malloc( 1024*1024 )) == NULL ) {
+    aktool_error(_("incorrect memory allocation"));
+    goto exit;
+  }
+
+ /* заполнение больших областей памяти */
+  printf(_("%s:\n bulk fill: "), oid->name[0] );
+  fflush( stdout );
+  timea = aktool_test_wall_time();
+  for( i = 0; i < 64; i++ ) {
+     if(( error = ak_random_ptr( &generator, data, 1024*1024 )) != ak_error_ok ) {
+       aktool_error(_("computational error (%d)"), error );
+       goto exit;
+     }
+  }
+  timea = aktool_test_wall_time() - timea;
+  printf(_("%f MBs (64MB, time = %fs)\n"), 64./timea, timea );
+
+ /* запросы малой длины */
+  for( j = 0; j < 3; j++ ) {
+     count = 1 << 20;
+     timea = aktool_test_wall_time();
+     for( i = 0; i < count; i++ ) {
+        if(( error = ak_random_ptr( &generator, data, sizes[j] )) != ak_error_ok ) {
+          aktool_error(_("computational error (%d)"), error );
+          goto exit;
+        }
+     }
+     timea = aktool_test_wall_time() - timea;
+     printf(_(" %2u-byte requests: %f ops/sec (%f MBs)\n"), (unsigned int)sizes[j],
+                   ( double )count/timea, ( double )( count*sizes[j] )/( timea*1024*1024 ));
+  }
+
+ /* многопоточная выработка данных */
+  job.oid = oid;
+  job.count = 16;
+  threads = ak_libakrypt_get_threads_count();
+  for( i = 1; i <= threads; i = ( i < threads ) ? ak_min( i << 1, threads ) : i + 1 ) {
+     timea = aktool_test_wall_time();
+     if(( error = ak_libakrypt_parallel_run( aktool_test_speed_random_part,
+                                                                   &job, i )) != ak_error_ok ) {
+       aktool_error(_("computational error (%d)"), error );
+       goto exit;
+     }
+     timea = aktool_test_wall_time() - timea;
+     speed = ( double )( i*job.count )/timea;
+     if( i == 1 ) base = speed;
+     printf(_(" %3u thread(s): %f MBs (scaling: %.2fx)\n"), (unsigned int)i, speed, speed/base );
+  }
+
+  exit_status = EXIT_SUCCESS;
+  exit:
+   if( data ) free( data );
+   ak_random_destroy( &generator );
+
+ return exit_status;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*                                                                                  aktool_test.c  */
 /* ----------------------------------------------------------------------------------------------- */
@@ -226,6 +226,14 @@ check_c_source_compiles("
      return 0;
   }" AK_HAVE_BYTESWAP_H )
 
+# -------------------------------------------------------------------------------------------------- #
+check_c_source_compiles("
+  #define _GNU_SOURCE
+  #include <link.h>
+  int main( void ) {
+     return dl_iterate_phdr( 0, 0 );
+  }" AK_HAVE_LINK_H )
+
 # -------------------------------------------------------------------------------------------------- #
 if( LIBAKRYPT_PTHREAD )
   check_c_source_compiles("
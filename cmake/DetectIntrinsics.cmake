@@ -53,3 +53,36 @@ check_c_source_compiles("
 if( AK_HAVE_BUILTIN_MM256_SLL )
     set( CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DAK_HAVE_BUILTIN_MM256_SLL" )
 endif()
+
+# -------------------------------------------------------------------------------------------------- #
+# -------------------------------------------------------------------------------------------------- #
+check_c_source_compiles("
+  #include <tmmintrin.h>
+  int main( void ) {
+
+   __m128i a = _mm_set1_epi8( 1 ), b = _mm_set1_epi8( 2 );
+   __m128i c = _mm_maddubs_epi16( _mm_shuffle_epi8( a, b ), b );
+
+  return _mm_movemask_epi8( c );
+ }" AK_HAVE_BUILTIN_SHUFFLE_EPI8 )
+
+if( AK_HAVE_BUILTIN_SHUFFLE_EPI8 )
+    set( CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DAK_HAVE_BUILTIN_SHUFFLE_EPI8" )
+endif()
+
+# -------------------------------------------------------------------------------------------------- #
+# -------------------------------------------------------------------------------------------------- #
+check_c_source_compiles("
+  #include <immintrin.h>
+  int main( void ) {
+
+   __m256i a = _mm256_set1_epi8( 1 ), b = _mm256_set1_epi8( 2 );
+   __m256i c = _mm256_maddubs_epi16( _mm256_shuffle_epi8( a, b ), b );
+   c = _mm256_permutevar8x32_epi32( c, _mm256_setr_epi32( 0, 1, 2, 4, 5, 6, 7, 7 ));
+
+  return _mm256_testz_si256( c, c );
+ }" AK_HAVE_BUILTIN_MM256_SHUFFLE_EPI8 )
+
+if( AK_HAVE_BUILTIN_MM256_SHUFFLE_EPI8 )
+    set( CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DAK_HAVE_BUILTIN_MM256_SHUFFLE_EPI8" )
+endif()
@@ -0,0 +1,121 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  Тестовый пример для иллюстрации шифрования больших объемов данных в режиме CTR-ACPKM
+    с использованием нескольких потоков. Результат параллельного шифрования сравнивается
+    с результатом последовательного шифрования.
+
+    test-acpkm-parallel.c                                                                          */
+/* ----------------------------------------------------------------------------------------------- */
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <time.h>
+ #include <libakrypt.h>
+#if defined(__unix__) || defined(__APPLE__)
+ #include <unistd.h>
+ #include <sys/wait.h>
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+ static ak_uint8 key[32] = {
+  0xef, 0xcd, 0xab, 0x89, 0x67, 0x45, 0x23, 0x01, 0x10, 0x32, 0x54, 0x76, 0x98, 0xba, 0xdc, 0xfe,
+  0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x00, 0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88 };
+
+ static ak_uint8 iv[8] = { 0xf0, 0xce, 0xab, 0x90, 0x78, 0x56, 0x34, 0x12 };
+
+/* ----------------------------------------------------------------------------------------------- */
+/* шифрование данных при заданном количестве потоков */
+ static int test_encrypt( ak_function_bckey_create *create, const char *name, size_t threads,
+                ak_uint8 *in, ak_uint8 *out, const size_t size, const size_t section_size )
+{
+  struct bckey bkey;
+  clock_t timea = 0;
+  int error = ak_error_ok;
+
+  ak_libakrypt_set_option( "threads_count", ( ak_int64 )threads );
+  if(( error = create( &bkey )) != ak_error_ok ) return error;
+  if(( error = ak_bckey_set_key( &bkey, key, sizeof( key ))) == ak_error_ok ) {
+    timea = clock();
+    error = ak_bckey_ctr_acpkm( &bkey, in, out, size, section_size, iv, bkey.bsize >> 1 );
+    timea = clock() - timea;
+    printf(" %s: %u thread(s), %u bytes (%f sec)\n", name, (unsigned int)threads,
+                                     (unsigned int)size, (double)timea / CLOCKS_PER_SEC );
+  }
+  ak_bckey_destroy( &bkey );
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t test_cipher( ak_function_bckey_create *create, const char *name,
+                                                      const size_t size, const size_t section_size )
+{
+  bool_t result = ak_false;
+  ak_uint8 *data = malloc( size ), *out1 = malloc( size ), *out2 = malloc( size );
+
+  if(( data == NULL ) || ( out1 == NULL ) || ( out2 == NULL )) goto labex;
+  memset( data, 0x5a, size );
+
+  if( test_encrypt( create, name, 1, data, out1, size, section_size ) != ak_error_ok ) goto labex;
+  if( test_encrypt( create, name, 4, data, out2, size, section_size ) != ak_error_ok ) goto labex;
+  if( memcmp( out1, out2, size ) != 0 ) {
+    printf(" %s: parallel encryption: Wrong\n", name );
+    goto labex;
+  }
+ /* расшифровываем данные параллельно */
+  if( test_encrypt( create, name, 3, out2, out1, size, section_size ) != ak_error_ok ) goto labex;
+  if( memcmp( data, out1, size ) != 0 ) {
+    printf(" %s: parallel decryption: Wrong\n", name );
+    goto labex;
+  }
+  printf(" %s: Ok\n", name );
+  result = ak_true;
+
+  labex:
+   if( data ) free( data );
+   if( out1 ) free( out1 );
+   if( out2 ) free( out2 );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+#if defined(__unix__) || defined(__APPLE__)
+/* дочерний процесс использует пул потоков, созданный родительским процессом до вызова fork() */
+ static bool_t test_fork( void )
+{
+  pid_t pid;
+  int status = EXIT_FAILURE;
+
+  if(( pid = fork()) == 0 ) {
+    status = test_cipher( ak_bckey_create_magma, "magma (child)", 65536 + 3, 1024 );
+    ak_libakrypt_destroy();
+    _exit( status == ak_true ? EXIT_SUCCESS : EXIT_FAILURE );
+  }
+  if(( pid < 0 ) || ( waitpid( pid, &status, 0 ) != pid ) ||
+     !WIFEXITED( status ) || ( WEXITSTATUS( status ) != EXIT_SUCCESS )) {
+    printf(" thread pool after fork: Wrong\n");
+    return ak_false;
+  }
+  printf(" thread pool after fork: Ok\n");
+ return ak_true;
+}
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+  int result = EXIT_FAILURE;
+
+ /* инициализируем библиотеку */
+  if( ak_libakrypt_create( ak_function_log_stderr ) != ak_true )
+    return ak_libakrypt_destroy();
+
+ /* длина данных не кратна ни длине секции, ни длине блока */
+  if(( test_cipher( ak_bckey_create_magma, "magma", 1048576 + 1029, 1024 ) == ak_true ) &&
+     ( test_cipher( ak_bckey_create_kuznechik, "kuznechik", 4194304 + 77, 8192 ) == ak_true ))
+    result = EXIT_SUCCESS;
+#if defined(__unix__) || defined(__APPLE__)
+  if( test_fork() != ak_true ) result = EXIT_FAILURE;
+#endif
+
+  ak_libakrypt_destroy();
+ return result;
+}
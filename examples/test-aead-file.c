@@ -0,0 +1,185 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  Тестовый пример для иллюстрации зашифрования данных, разбитых на фрагменты, и последующего
+    чтения произвольных участков зашифрованного файла без его полного расшифрования.
+    Также проверяется обнаружение искажений зашифрованного файла.
+
+    test-aead-file.c                                                                               */
+/* ----------------------------------------------------------------------------------------------- */
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <libakrypt.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+ static const char *filename = "test-aead-file.akc";
+ static char password[] = "aead-file password";
+
+/* ----------------------------------------------------------------------------------------------- */
+/* зашифрование данных и запись их в файл */
+ static int create_file( const char *name, ak_uint8 *plain, const size_t size )
+{
+  struct file fp;
+  struct random generator;
+  struct aead_chunks ctx;
+  ak_uint8 out[4096 +16 +16], footer[ak_aead_chunks_footer_data_size +16];
+  size_t last = 0;
+  ak_uint64 i = 0, count = 0;
+  int error = ak_error_ok;
+
+  ak_random_create_lcg( &generator );
+  error = ak_aead_chunks_create( &ctx, ak_oid_find_by_name( name ), 4096,
+                                                       password, strlen( password ), &generator );
+  ak_random_destroy( &generator );
+  if( error != ak_error_ok ) return error;
+
+  if(( error = ak_file_create_to_write( &fp, filename )) != ak_error_ok ) goto labex;
+  ak_file_write( &fp, ctx.header, ak_aead_chunks_header_size );
+  count = ak_aead_chunks_get_count( &ctx, size, &last );
+  for( i = 0; i < count; i++ ) {
+     size_t len = ( i == count - 1 ) ? last : ctx.chunk;
+     if(( error = ak_aead_chunks_encrypt( &ctx, i, i == count - 1,
+                                          plain + i*ctx.chunk, out, len )) != ak_error_ok ) break;
+     ak_file_write( &fp, out, len + ctx.bsize );
+  }
+  if( error == ak_error_ok ) {
+    if(( error = ak_aead_chunks_create_footer( &ctx, size, footer )) == ak_error_ok )
+      ak_file_write( &fp, footer, ak_aead_chunks_get_footer_size( &ctx ));
+  }
+  ak_file_close( &fp );
+
+  labex:
+   ak_aead_chunks_destroy( &ctx );
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* чтение произвольных участков файла и сравнение с открытым текстом */
+ static bool_t read_file( ak_uint8 *plain, const size_t size, ak_uint8 *out )
+{
+  struct aead_file af;
+  size_t i = 0, offset = 0, len = 0;
+  bool_t result = ak_true;
+
+  if( ak_aead_file_open( &af, filename, password, strlen( password )) != ak_error_ok )
+    return ak_false;
+  if( af.size != size ) result = ak_false;
+  for( i = 0; ( i < 64 ) && result; i++ ) {
+     offset = ( i*7919 )%size;
+     len = ( i*4241 + 1 )%9000;
+     if( ak_aead_file_read( &af, offset, out, len ) != ( ssize_t )ak_min( len, size - offset ))
+       result = ak_false;
+      else if( memcmp( out, plain + offset, ak_min( len, size - offset )) != 0 ) result = ak_false;
+  }
+ /* чтение за границей файла */
+  if( ak_aead_file_read( &af, size, out, 16 ) != 0 ) result = ak_false;
+  ak_aead_file_close( &af );
+
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* искажение одного октета зашифрованного файла */
+ static void damage_file( ak_int64 offset )
+{
+  struct file fp;
+  ak_uint8 *buffer = NULL;
+  size_t size = 0;
+
+  if( ak_file_open_to_read( &fp, filename ) != ak_error_ok ) return;
+  if(( buffer = malloc(( size = ( size_t )fp.size ))) != NULL )
+    if( ak_file_read( &fp, buffer, size ) != ( ssize_t )size ) size = 0;
+  ak_file_close( &fp );
+  if(( buffer == NULL ) || ( size <= ( size_t )offset )) goto labex;
+
+  buffer[offset] ^= 0x01;
+  if( ak_file_create_to_write( &fp, filename ) == ak_error_ok ) {
+    ak_file_write( &fp, buffer, size );
+    ak_file_close( &fp );
+  }
+  labex:
+   if( buffer ) free( buffer );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t test_file( const char *name, ak_uint8 *plain, const size_t size, ak_uint8 *out )
+{
+  struct aead_file af;
+  int error = ak_error_ok;
+  bool_t result = ak_false;
+
+  if( create_file( name, plain, size ) != ak_error_ok ) {
+    printf(" %s: encryption is Wrong\n", name );
+    return ak_false;
+  }
+  if( !read_file( plain, size, out )) {
+    printf(" %s: random access reading is Wrong\n", name );
+    goto labex;
+  }
+
+ /* искажаем второй фрагмент: первый фрагмент должен читаться, второй нет */
+  damage_file( ak_aead_chunks_header_size + 4096 +16 +100 );
+  if( ak_aead_file_open( &af, filename, password, strlen( password )) != ak_error_ok ) goto labex;
+  if(( ak_aead_file_read( &af, 100, out, 1000 ) != 1000 ) ||
+     ( ak_aead_file_read( &af, 5000, out, 1000 ) >= 0 )) {
+    printf(" %s: integrity checking is Wrong\n", name );
+    ak_aead_file_close( &af );
+    goto labex;
+  }
+  ak_aead_file_close( &af );
+
+ /* неверный пароль обнаруживается при открытии файла */
+  if( ak_aead_file_open( &af, filename, "wrong", 5 ) == ak_error_ok ) {
+    printf(" %s: password checking is Wrong\n", name );
+    ak_aead_file_close( &af );
+    goto labex;
+  }
+ /* завышенное количество итераций PBKDF2 в заголовке отвергается без выработки ключа */
+  damage_file( 15 );
+  if(( error = ak_aead_file_open( &af, filename,
+                                     password, strlen( password ))) != ak_error_wrong_length ) {
+    printf(" %s: iteration count checking is Wrong\n", name );
+    if( error == ak_error_ok ) ak_aead_file_close( &af );
+    goto labex;
+  }
+  printf(" %s: Ok\n", name );
+  result = ak_true;
+
+  labex:
+   remove( filename );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+  size_t i = 0, size = 50003;
+  ak_uint8 *plain = NULL, *out = NULL;
+  int result = EXIT_SUCCESS;
+
+ /* инициализируем библиотеку */
+  if( ak_libakrypt_create( NULL ) != ak_true )
+    return ak_libakrypt_destroy();
+
+  plain = malloc( size );
+  out = malloc( size );
+  if(( plain == NULL ) || ( out == NULL )) {
+    result = EXIT_FAILURE;
+    goto labex;
+  }
+  for( i = 0; i < size; i++ ) plain[i] = ( ak_uint8 )( i*7 + ( i >> 8 ));
+
+  if( !test_file( "mgm-magma", plain, size, out ) ||
+      !test_file( "mgm-kuznechik", plain, size, out ) ||
+      !test_file( "xtsmac-kuznechik", plain, size, out )) result = EXIT_FAILURE;
+
+  labex:
+   if( plain ) free( plain );
+   if( out ) free( out );
+   ak_libakrypt_destroy();
+
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                                                                               test-aead-file.c  */
+/* ----------------------------------------------------------------------------------------------- */
@@ -0,0 +1,217 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  Тестовый пример для иллюстрации потокового аутентифицированного шифрования в режимах
+    xtsmac, ctr-cmac и ctr-hmac. Данные зашифровываются и расшифровываются фрагментами
+    различной длины; результаты сравниваются с результатами однократного вызова функций
+    аутентифицированного шифрования, а также с результатами последовательного вычисления
+    имитовставки и гаммирования.
+
+    test-aead-stream.c                                                                             */
+/* ----------------------------------------------------------------------------------------------- */
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <libakrypt.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+ static ak_uint8 ekey_value[32] = {
+  0xef, 0xcd, 0xab, 0x89, 0x67, 0x45, 0x23, 0x01, 0x10, 0x32, 0x54, 0x76, 0x98, 0xba, 0xdc, 0xfe,
+  0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x00, 0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88 };
+
+ static ak_uint8 akey_value[32] = {
+  0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef, 0x10, 0x32, 0x54, 0x76, 0x98, 0xba, 0xdc, 0xfe,
+  0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff };
+
+ static ak_uint8 iv[16] = {
+  0x12, 0x34, 0x56, 0x78, 0x90, 0xab, 0xce, 0xf0, 0xa1, 0xb2, 0xc3, 0xd4, 0xe5, 0xf6, 0x07, 0x18 };
+
+/* ----------------------------------------------------------------------------------------------- */
+/* обработка данных фрагментами, длины которых кратны 16 октетам (кроме последнего) */
+ static int stream_process( ak_aead_stream ctx, const bool_t decrypt,
+                                                   ak_uint8 *in, ak_uint8 *out, const size_t size )
+{
+  size_t k = 0, len = 0, done = 0;
+  int error = ak_error_ok;
+
+  for( k = 0; ; k++ ) {
+     len = (( k*37 )%13 )*16 + (( k%5 ) ? 16 : 8192 );
+     if( done + len + 32 > size ) break;
+     if(( error = decrypt ? ak_aead_stream_decrypt( ctx, in + done, out + done, len ) :
+                            ak_aead_stream_encrypt( ctx, in + done, out + done, len )) != ak_error_ok )
+       return error;
+     done += len;
+  }
+  if( decrypt ) return ak_aead_stream_decrypt( ctx, in + done, out + done, size - done );
+ return ak_aead_stream_encrypt( ctx, in + done, out + done, size - done );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t test_mode( const char *name, ak_pointer ekey, ak_pointer akey,
+                ak_uint8 *adata, const size_t asize, ak_uint8 *plain, ak_uint8 *etalon,
+                                                            ak_uint8 *out, const size_t size )
+{
+  struct aead_stream ctx;
+  ak_uint8 icode[16], icode2[16];
+  ak_oid oid = ak_oid_find_by_name( name );
+
+  if( oid == NULL ) return ak_false;
+ /* эталонное значение вырабатываем однократным вызовом функции */
+  if((( ak_function_aead *)oid->func.direct)( ekey, akey, adata, asize, plain, etalon, size,
+                                            iv, sizeof( iv ), icode, sizeof( icode )) != ak_error_ok )
+    return ak_false;
+
+ /* зашифровываем данные фрагментами */
+  memset( out, 0, size );
+  if(( ak_aead_stream_clean( &ctx, oid, ekey, akey, iv, sizeof( iv )) != ak_error_ok ) ||
+     ( ak_aead_stream_authenticate( &ctx, adata, 32 ) != ak_error_ok ) ||
+     ( ak_aead_stream_authenticate( &ctx, adata + 32, asize - 32 ) != ak_error_ok ) ||
+     ( stream_process( &ctx, ak_false, plain, out, size ) != ak_error_ok ) ||
+     ( ak_aead_stream_finalize( &ctx, icode2, sizeof( icode2 )) != ak_error_ok )) {
+    printf(" %s: stream encryption is Wrong\n", name );
+    return ak_false;
+  }
+  if(( memcmp( out, etalon, size ) != 0 ) || ( memcmp( icode, icode2, sizeof( icode )) != 0 )) {
+    printf(" %s: stream encryption result is Wrong\n", name );
+    return ak_false;
+  }
+
+ /* расшифровываем данные на месте */
+  if(( ak_aead_stream_clean( &ctx, oid, ekey, akey, iv, sizeof( iv )) != ak_error_ok ) ||
+     ( ak_aead_stream_authenticate( &ctx, adata, asize ) != ak_error_ok ) ||
+     ( stream_process( &ctx, ak_true, out, out, size ) != ak_error_ok ) ||
+     ( ak_aead_stream_finalize( &ctx, icode2, sizeof( icode2 )) != ak_error_ok ) ||
+     ( memcmp( out, plain, size ) != 0 ) || ( memcmp( icode, icode2, sizeof( icode )) != 0 )) {
+    printf(" %s: stream decryption is Wrong\n", name );
+    return ak_false;
+  }
+
+ /* ассоциированные данные не могут следовать за шифруемыми */
+  if(( ak_aead_stream_clean( &ctx, oid, ekey, akey, iv, sizeof( iv )) != ak_error_ok ) ||
+     ( ak_aead_stream_encrypt( &ctx, plain, out, 64 ) != ak_error_ok ) ||
+     ( ak_aead_stream_authenticate( &ctx, adata, asize ) == ak_error_ok )) {
+    printf(" %s: order of data is Wrong\n", name );
+    return ak_false;
+  }
+  memset( &ctx, 0, sizeof( struct aead_stream ));
+
+  printf(" %s: Ok\n", name );
+ return ak_true;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* проверка режимов ctr-xxx: имитовставка вычисляется от объединения ассоциированных данных и
+   открытого текста, после чего открытый текст гаммируется */
+ static bool_t test_composition( ak_bckey ekey, ak_bckey ckey, ak_hmac hkey,
+                   ak_uint8 *adata, const size_t asize, ak_uint8 *plain, ak_uint8 *out,
+                                                    ak_uint8 *buffer, const size_t size )
+{
+  ak_uint8 icode[32], icode2[32];
+
+  memcpy( buffer, adata, asize );
+  memcpy( buffer + asize, plain, size );
+
+ /* ctr-cmac */
+  if(( ak_bckey_cmac( ckey, buffer, asize + size, icode, ckey->bsize ) != ak_error_ok ) ||
+     ( ak_bckey_encrypt_ctr_cmac( ekey, ckey, adata, asize, plain, out, size,
+                                         iv, sizeof( iv ), icode2, ckey->bsize ) != ak_error_ok ) ||
+     ( memcmp( icode, icode2, ckey->bsize ) != 0 )) {
+    printf(" ctr-cmac: integrity code is Wrong\n" );
+    return ak_false;
+  }
+  if(( ak_bckey_ctr( ekey, plain, buffer, size, iv, sizeof( iv )) != ak_error_ok ) ||
+     ( memcmp( out, buffer, size ) != 0 )) {
+    printf(" ctr-cmac: encryption is Wrong\n" );
+    return ak_false;
+  }
+
+ /* ctr-cmac на одном ключе */
+  memcpy( buffer, adata, asize );
+  memcpy( buffer + asize, plain, size );
+  if(( ak_bckey_cmac( ekey, buffer, asize + size, icode, ekey->bsize ) != ak_error_ok ) ||
+     ( ak_bckey_encrypt_ctr_cmac( ekey, ekey, adata, asize, plain, out, size,
+                                         iv, sizeof( iv ), icode2, ekey->bsize ) != ak_error_ok ) ||
+     ( memcmp( icode, icode2, ekey->bsize ) != 0 )) {
+    printf(" ctr-cmac: integrity code with one key is Wrong\n" );
+    return ak_false;
+  }
+
+ /* ctr-hmac */
+  if(( ak_hmac_ptr( hkey, buffer, asize + size, icode, 32 ) != ak_error_ok ) ||
+     ( ak_bckey_encrypt_ctr_hmac( ekey, hkey, adata, asize, plain, out, size,
+                                                 iv, sizeof( iv ), icode2, 32 ) != ak_error_ok ) ||
+     ( memcmp( icode, icode2, 32 ) != 0 )) {
+    printf(" ctr-hmac: integrity code is Wrong\n" );
+    return ak_false;
+  }
+  if(( ak_bckey_decrypt_ctr_hmac( ekey, hkey, adata, asize, out, out, size,
+                                                 iv, sizeof( iv ), icode2, 32 ) != ak_error_ok ) ||
+     ( memcmp( out, plain, size ) != 0 )) {
+    printf(" ctr-hmac: decryption is Wrong\n" );
+    return ak_false;
+  }
+
+  printf(" composition of ctr and mac: Ok\n" );
+ return ak_true;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+  size_t i = 0, size = 100003, asize = 45;
+  ak_uint8 adata[45], *plain = NULL, *etalon = NULL, *out = NULL, *buffer = NULL;
+  struct bckey mkey, mkey2, kkey, kkey2;
+  struct hmac hkey;
+  int result = EXIT_FAILURE;
+
+ /* инициализируем библиотеку (сообщения об ожидаемых ошибках не выводятся) */
+  if( ak_libakrypt_create( NULL ) != ak_true )
+    return ak_libakrypt_destroy();
+
+  plain = malloc( size );
+  etalon = malloc( size );
+  out = malloc( size );
+  buffer = malloc( size + asize );
+  if(( plain == NULL ) || ( etalon == NULL ) || ( out == NULL ) || ( buffer == NULL ))
+    goto labex;
+  for( i = 0; i < size; i++ ) plain[i] = ( ak_uint8 )( i*13 + ( i >> 9 ));
+  for( i = 0; i < asize; i++ ) adata[i] = ( ak_uint8 )( 3*i + 1 );
+
+  ak_bckey_create_magma( &mkey );
+  ak_bckey_create_magma( &mkey2 );
+  ak_bckey_create_kuznechik( &kkey );
+  ak_bckey_create_kuznechik( &kkey2 );
+  ak_hmac_create_streebog256( &hkey );
+  ak_bckey_set_key( &mkey, ekey_value, sizeof( ekey_value ));
+  ak_bckey_set_key( &mkey2, akey_value, sizeof( akey_value ));
+  ak_bckey_set_key( &kkey, ekey_value, sizeof( ekey_value ));
+  ak_bckey_set_key( &kkey2, akey_value, sizeof( akey_value ));
+  ak_hmac_set_key( &hkey, akey_value, sizeof( akey_value ));
+
+  if( test_mode( "xtsmac-magma", &mkey, &mkey2, adata, asize, plain, etalon, out, size ) &&
+      test_mode( "xtsmac-kuznechik", &kkey, &kkey2, adata, asize, plain, etalon, out, size ) &&
+      test_mode( "ctr-cmac-magma", &mkey, &mkey2, adata, asize, plain, etalon, out, size ) &&
+      test_mode( "ctr-cmac-kuznechik", &kkey, &kkey2, adata, asize, plain, etalon, out, size ) &&
+      test_mode( "ctr-hmac-kuznechik-streebog256",
+                                          &kkey, &hkey, adata, asize, plain, etalon, out, size ) &&
+      test_composition( &mkey, &mkey2, &hkey, adata, asize, plain, out, buffer, size ) &&
+      test_composition( &kkey, &kkey2, &hkey, adata, asize, plain, out, buffer, size ))
+    result = EXIT_SUCCESS;
+
+  ak_bckey_destroy( &mkey );
+  ak_bckey_destroy( &mkey2 );
+  ak_bckey_destroy( &kkey );
+  ak_bckey_destroy( &kkey2 );
+  ak_hmac_destroy( &hkey );
+
+  labex:
+   if( plain ) free( plain );
+   if( etalon ) free( etalon );
+   if( out ) free( out );
+   if( buffer ) free( buffer );
+   ak_libakrypt_destroy();
+
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                                                                             test-aead-stream.c  */
+/* ----------------------------------------------------------------------------------------------- */
@@ -36,7 +36,7 @@
   ak_uint32 i = 0;
   int result = EXIT_FAILURE;
   ak_uint8 buf[13] = { 0x01, 0x02, 0x03, 4, 5, 6, 7, 8, 9, 0xa, 0xb, 0xc, 0xe },
-           array[1024];
+           array[1024], pem[2048];
   struct asn1 root, *asn1 = NULL, *asn_down_level = NULL;
   struct hash ctx;
   const char *str = NULL;
@@ -133,6 +133,34 @@
     printf(" Ok\n");
   }
    else printf(" Wrong\n");
+
+ /* повторяем проверку для потокового экспорта дерева в файл */
+  ak_asn1_export_to_derfile( &root, "test.der" );
+  ak_hash_file( &ctx, "test.der", out, len = ak_hash_get_tag_size( &ctx ));
+  printf("streebog256 (export to der file): %s", ak_ptr_to_hexstr( out, len, ak_false ));
+  if( ak_ptr_is_equal_with_log( out, tmp, len )) printf(" Ok\n");
+   else { result = EXIT_FAILURE; printf(" Wrong\n"); }
+
+ /* экспортируем дерево в pem формате в память, после чего считываем его из файла */
+  len = sizeof( pem );
+  if( ak_asn1_export_to_ptr( &root, pem, &len,
+                                    asn1_pem_format, plain_content ) == ak_error_ok ) {
+    struct asn1 copy;
+
+    ak_file_create_to_write( &file, "test.pem" );
+    ak_file_write( &file, pem, len );
+    ak_file_close( &file );
+
+    ak_asn1_create( &copy );
+    len = sizeof( pem );
+    if(( ak_asn1_import_from_file( &copy, "test.pem" ) == ak_error_ok ) &&
+       ( ak_asn1_encode( &copy, pem, &len ) == ak_error_ok ) &&
+       ( ak_hash_ptr( &ctx, pem, len, out, 32 ) == ak_error_ok ) &&
+       ( ak_ptr_is_equal_with_log( out, tmp, 32 ))) printf("export to pem format: Ok\n");
+      else { result = EXIT_FAILURE; printf("export to pem format: Wrong\n"); }
+    ak_asn1_destroy( &copy );
+  }
+   else { result = EXIT_FAILURE; printf("export to pem format: Wrong\n"); }
   ak_hash_destroy( &ctx );
 
  /* уничтожаем дерево и выходим */
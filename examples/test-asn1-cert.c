@@ -1,38 +1,158 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  Тестовый пример для иллюстрации импорта открытых ключей из сертификатов.
+    В примере создаются корневой сертификат и сертификат пользователя, подписанный корневым
+    ключом; после этого сертификат пользователя импортируется с явно заданным ключом эмитента
+    и с ключом, найденным в хранилище доверенных сертификатов.
+
+    test-asn1-cert.c                                                                               */
+/* ----------------------------------------------------------------------------------------------- */
+ #include <stdio.h>
  #include <stdlib.h>
  #include <time.h>
  #include <string.h>
  #include <libakrypt.h>
+#ifdef _WIN32
+ #include <direct.h>
+ #define test_mkdir( name ) _mkdir( name )
+#else
+ #include <sys/stat.h>
+ #define test_mkdir( name ) mkdir( name, 0700 )
+#endif
 
+/* ----------------------------------------------------------------------------------------------- */
+ static const char *ca_path = "test-asn1-cert.ca";
+ static const char *ca_file = "test-asn1-cert.ca/ca.cer";
+ static const char *user_file = "test-asn1-cert.crt";
 
- int main( int argc, char *argv[] )
+/* ----------------------------------------------------------------------------------------------- */
+/* создание пары ключей с заданным именем владельца */
+ static int create_keys( ak_signkey sk, ak_verifykey vk, ak_random generator, const char *name )
 {
-  struct verifykey vkey;
-  struct certificate_opts opts;
   int error = ak_error_ok;
+  time_t now = time( NULL );
+
+  if(( error = ak_signkey_create_streebog256( sk )) != ak_error_ok ) return error;
+  if(( error = ak_signkey_set_key_random( sk, generator )) != ak_error_ok ) return error;
+  if(( error = ak_skey_set_validity( &sk->key, now - 60, now + 86400 )) != ak_error_ok )
+    return error;
+  if(( error = ak_verifykey_create_from_signkey( vk, sk )) != ak_error_ok ) return error;
+ return ak_verifykey_add_name_string( vk, "cn", name );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+  struct random generator;
+  struct signkey ca_skey, user_skey;
+  struct verifykey ca_vkey, user_vkey, vkey;
+ /* SEQUENCE { SEQUENCE {}, SEQUENCE {}, BIT STRING {} } */
+  ak_uint8 empty_tbs[9] = { 0x30, 0x07, 0x30, 0x00, 0x30, 0x00, 0x03, 0x01, 0x00 };
+  struct certificate_opts opts;
+  int result = EXIT_FAILURE;
+
+ /* инициализируем библиотеку */
+  if( ak_libakrypt_create( ak_function_log_stderr ) != ak_true )
+    return ak_libakrypt_destroy();
+
+  ak_random_create_lcg( &generator );
+  if( create_keys( &ca_skey, &ca_vkey, &generator, "Test CA" ) != ak_error_ok ) goto lab1;
+  if( create_keys( &user_skey, &user_vkey, &generator, "Test User" ) != ak_error_ok ) goto lab2;
+
+ /* корневой сертификат в der формате */
+  test_mkdir( ca_path );
+  memset( &opts, 0, sizeof( struct certificate_opts ));
+  opts.ca.is_present = opts.ca.value = ak_true;
+  opts.key_usage.is_present = ak_true;
+  opts.key_usage.bits = bit_keyCertSign;
+  if( ak_verifykey_export_to_certificate( &ca_vkey, &ca_skey, &ca_vkey, &generator,
+                               &opts, (char *)ca_file, 0, asn1_der_format ) != ak_error_ok ) goto lab3;
 
-  ak_libakrypt_create( ak_function_log_stderr );
+ /* сертификат пользователя в pem формате */
+  memset( &opts, 0, sizeof( struct certificate_opts ));
+  opts.key_usage.is_present = ak_true;
+  opts.key_usage.bits = bit_digitalSignature;
+  opts.authority_key_identifier.is_present = ak_true;
+  if( ak_verifykey_export_to_certificate( &user_vkey, &ca_skey, &ca_vkey, &generator,
+                             &opts, (char *)user_file, 0, asn1_pem_format ) != ak_error_ok ) goto lab3;
 
-//  printf("verify: %d\n",
-//                     error = ak_verifykey_import_from_certificate( &vkey, NULL, "ca.crt", &opts ));
-//  if( error != ak_error_ok ) goto lab1;
+ /* 1. импорт с явно заданным ключом эмитента */
+  if( ak_verifykey_import_from_certificate( &vkey, &ca_vkey, user_file, &opts ) != ak_error_ok ) {
+    printf(" import with given issuer's key: Wrong\n");
+    goto lab3;
+  }
+  if(( memcmp( vkey.number, user_vkey.number, 32 ) != 0 ) ||
+     ( opts.key_usage.bits != bit_digitalSignature ) || opts.ca.is_present ) {
+    printf(" import with given issuer's key: Wrong values\n");
+    ak_verifykey_destroy( &vkey );
+    goto lab3;
+  }
+  ak_verifykey_destroy( &vkey );
+  printf(" import with given issuer's key: Ok\n");
 
-//  printf(" public key: %s (%s)\n", vkey.oid->name[0], vkey.oid->id[0] );
-//  printf(" subject key number: %s\n", ak_ptr_to_hexstr( vkey.number, 32, ak_false ));
+ /* 2. импорт с поиском ключа эмитента в хранилище */
+  if( ak_certificate_store_load( ca_path ) != ak_error_ok ) goto lab3;
+  if( ak_certificate_store_count() != 1 ) {
+    printf(" loading of certificate store: Wrong\n");
+    goto lab3;
+  }
+  if( ak_certificate_store_find_by_key_identifier( &vkey, ca_vkey.number, 32 ) != ak_error_ok )
+    goto lab3;
+  if( memcmp( vkey.number, ca_vkey.number, 32 ) != 0 ) {
+    printf(" search in certificate store: Wrong\n");
+    ak_verifykey_destroy( &vkey );
+    goto lab3;
+  }
+  ak_verifykey_destroy( &vkey );
+  if( ak_certificate_store_find_by_name( &vkey, ca_vkey.name ) != ak_error_ok ) goto lab3;
+  ak_verifykey_destroy( &vkey );
+  printf(" loading of certificate store: Ok\n");
 
-//  if( opts.key_usage.is_present ) {
-//    printf("key usage: ");
-//    if( opts.key_usage.bits&bit_decipherOnly) printf("decipher, ");
-//    if( opts.key_usage.bits&bit_encipherOnly) printf("encipher, ");
-//    if( opts.key_usage.bits&bit_cRLSign) printf("crl sign, ");
-//    if( opts.key_usage.bits&bit_keyCertSign) printf("cert sign, ");
-//    printf("\n");
-//  }
+  if( ak_verifykey_import_from_certificate( &vkey, NULL, user_file, NULL ) != ak_error_ok ) {
+    printf(" import with key from certificate store: Wrong\n");
+    goto lab3;
+  }
+  ak_verifykey_destroy( &vkey );
+  printf(" import with key from certificate store: Ok\n");
 
+ /* 3. повторный импорт (результат проверки подписи берется из кеша) */
+  if( ak_verifykey_import_from_certificate( &vkey, NULL, user_file, NULL ) != ak_error_ok ) {
+    printf(" repeated import: Wrong\n");
+    goto lab3;
+  }
+  ak_verifykey_destroy( &vkey );
+  printf(" repeated import: Ok\n");
 
+ /* 4. сертификат не должен проверяться ключом, отличным от ключа эмитента */
+  ak_certificate_cache_clean();
+  if( ak_verifykey_import_from_certificate( &vkey, &user_vkey, user_file, NULL ) == ak_error_ok ) {
+    printf(" import with wrong issuer's key: Wrong\n");
+    ak_verifykey_destroy( &vkey );
+    goto lab3;
+  }
+  printf(" import with wrong issuer's key: Ok\n");
 
+ /* 5. сертификат с пустым полем tbsCertificate должен отвергаться */
+  if( ak_verifykey_import_from_ptr_as_certificate( &vkey, &ca_vkey,
+                                                 empty_tbs, sizeof( empty_tbs ), NULL ) == ak_error_ok ) {
+    printf(" import of certificate with empty tbsCertificate: Wrong\n");
+    ak_verifykey_destroy( &vkey );
+    goto lab3;
+  }
+  printf(" import of certificate with empty tbsCertificate: Ok\n");
+  result = EXIT_SUCCESS;
 
-//  ak_verifykey_destroy( &vkey );
+  lab3:
+   ak_verifykey_destroy( &user_vkey );
+   ak_signkey_destroy( &user_skey );
+   remove( user_file );
+   remove( ca_file );
+   remove( ca_path );
+  lab2:
+   ak_verifykey_destroy( &ca_vkey );
+   ak_signkey_destroy( &ca_skey );
+  lab1:
+   ak_random_destroy( &generator );
+   ak_libakrypt_destroy();
 
-  lab1: ak_libakrypt_destroy();
- return EXIT_SUCCESS;
+ return result;
 }
@@ -0,0 +1,121 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  Тестовый пример для иллюстрации последовательного чтения der-последовательности с помощью
+    курсора, без построения ASN.1 дерева. Чтение выполняется из памяти и из файла, размер которого
+    превышает размер внутреннего буффера курсора.
+
+    test-asn1-cursor.c                                                                             */
+/* ----------------------------------------------------------------------------------------------- */
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <libakrypt.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+ static ak_uint8 large[3*ak_asn1_cursor_buffer_size + 17];
+
+/* ----------------------------------------------------------------------------------------------- */
+/* обход последовательности, сформированной в функции main(), с проверкой значений узлов           */
+ static bool_t test_cursor( ak_asn1_cursor cursor, ak_uint8 *der, size_t dersize )
+{
+  ak_uint8 out[sizeof( large )], enc[128];
+  size_t size = 0, count = 0;
+  ak_asn1 asn = NULL;
+  bool_t result = ak_false;
+
+ /* первый узел верхнего уровня: SEQUENCE */
+  if( !ak_asn1_cursor_next( cursor )) return ak_false;
+  if( cursor->tag != ( TSEQUENCE^CONSTRUCTED )) return ak_false;
+  if( ak_asn1_cursor_enter( cursor ) != ak_error_ok ) return ak_false;
+
+ /* INTEGER: проверяем, что пропускаем его без чтения */
+  if( !ak_asn1_cursor_next( cursor )) return ak_false;
+  if( cursor->tag != TINTEGER ) return ak_false;
+
+ /* OCTET STRING большой длины: проверяем соглашение о размере буффера */
+  if( !ak_asn1_cursor_next( cursor )) return ak_false;
+  if( ak_asn1_cursor_get_primitive( cursor, out, &size ) != ak_error_wrong_length ) return ak_false;
+  if( size != sizeof( large )) return ak_false;
+  if( ak_asn1_cursor_get_primitive( cursor, out, &size ) != ak_error_ok ) return ak_false;
+  if( memcmp( out, large, sizeof( large )) != 0 ) return ak_false;
+
+ /* вложенный SEQUENCE пропускаем, не заходя в него */
+  if( !ak_asn1_cursor_next( cursor )) return ak_false;
+  if( ak_asn1_cursor_next( cursor )) return ak_false; /* уровень должен быть исчерпан */
+  if( ak_asn1_cursor_leave( cursor ) != ak_error_ok ) return ak_false;
+
+ /* второй узел верхнего уровня декодируем в ASN.1 дерево и кодируем обратно */
+  if( !ak_asn1_cursor_next( cursor )) return ak_false;
+  if(( asn = ak_asn1_new()) == NULL ) return ak_false;
+  if( ak_asn1_cursor_get_asn1( cursor, asn ) != ak_error_ok ) goto labex;
+  if( ak_asn1_cursor_next( cursor )) goto labex;
+  if( cursor->offset != dersize ) goto labex;
+
+  count = sizeof( enc );
+  if( ak_asn1_encode( asn, enc, &count ) != ak_error_ok ) goto labex;
+  if( memcmp( enc, der + dersize - count, count ) != 0 ) goto labex;
+  result = ak_true;
+
+  labex:
+   ak_asn1_delete( asn );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+  size_t i, size = 0;
+  ak_uint8 *der = NULL;
+  struct asn1_cursor cursor;
+  int result = EXIT_FAILURE;
+  ak_asn1 asn = NULL, down = NULL, inner = NULL;
+  const char *filename = "test-asn1-cursor.der";
+
+ /* инициализируем библиотеку */
+  if( ak_libakrypt_create( ak_function_log_stderr ) != ak_true )
+    return ak_libakrypt_destroy();
+
+ /* формируем дерево
+    SEQUENCE { INTEGER, OCTET STRING, SEQUENCE { BOOLEAN } }, SEQUENCE { OID, UTF8 STRING } */
+  for( i = 0; i < sizeof( large ); i++ ) large[i] = ( ak_uint8 )( i*7 + 1 );
+  asn = ak_asn1_new();
+  ak_asn1_add_asn1( asn, TSEQUENCE^CONSTRUCTED, down = ak_asn1_new( ));
+  ak_asn1_add_uint32( down, 0x12345678 );
+  ak_asn1_add_octet_string( down, large, sizeof( large ));
+  ak_asn1_add_asn1( down, TSEQUENCE^CONSTRUCTED, inner = ak_asn1_new( ));
+  ak_asn1_add_bool( inner, ak_true );
+  ak_asn1_add_asn1( asn, TSEQUENCE^CONSTRUCTED, down = ak_asn1_new( ));
+  ak_asn1_add_oid( down, "1.2.643.7.1.1.1.1" );
+  ak_asn1_add_utf8_string( down, "asn1 cursor" );
+
+  if( ak_asn1_encode( asn, NULL, &size ) != ak_error_wrong_length ) goto labex;
+  if(( der = malloc( size )) == NULL ) goto labex;
+  if( ak_asn1_encode( asn, der, &size ) != ak_error_ok ) goto labex;
+  if( ak_asn1_export_to_derfile( asn, filename ) != ak_error_ok ) goto labex;
+
+ /* чтение из памяти */
+  if( ak_asn1_cursor_create_ptr( &cursor, der, size ) != ak_error_ok ) goto labex;
+  if( !test_cursor( &cursor, der, size )) {
+    printf(" reading from memory: Wrong\n");
+    ak_asn1_cursor_destroy( &cursor );
+    goto labex;
+  }
+  printf(" reading from memory: Ok\n");
+  ak_asn1_cursor_destroy( &cursor );
+
+ /* чтение из файла */
+  if( ak_asn1_cursor_create_file( &cursor, filename ) != ak_error_ok ) goto labex;
+  if( test_cursor( &cursor, der, size )) {
+    printf(" reading from file %s: Ok\n", filename );
+    result = EXIT_SUCCESS;
+  }
+   else printf(" reading from file %s: Wrong\n", filename );
+  ak_asn1_cursor_destroy( &cursor );
+
+  labex:
+   if( der != NULL ) free( der );
+   ak_asn1_delete( asn );
+   remove( filename );
+   ak_libakrypt_destroy();
+
+ return result;
+}
@@ -0,0 +1,81 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  Тестовый пример для проверки кодирования и декодирования данных в формате base64.
+    Результат кодирования сравнивается с результатом поблочного кодирования функцией
+    ak_base64_encodeblock(), декодирование проверяется для данных, содержащих переводы строк
+    и пробелы в произвольных местах.
+
+    test-base64.c                                                                                  */
+/* ----------------------------------------------------------------------------------------------- */
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <libakrypt.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+ static ak_uint8 in[2048], enc[3000], ref[3000], spaced[6000], dec[3000];
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+  struct random generator;
+  size_t i, j, len, esize, dsize;
+  int result = EXIT_SUCCESS;
+
+ /* инициализируем библиотеку */
+  if( ak_libakrypt_create( ak_function_log_stderr ) != ak_true )
+    return ak_libakrypt_destroy();
+
+  ak_random_create_lcg( &generator );
+  ak_random_ptr( &generator, in, sizeof( in ));
+
+  for( len = 0; len <= sizeof( in ); len += ( len < 128 ? 1 : 61 )) {
+    ak_uint8 tail[3] = { 0, 0, 0 }, ch = 0;
+
+   /* эталонное значение */
+    for( i = 0; i + 3 <= len; i += 3 ) ak_base64_encodeblock( in + i, ref + 4*i/3, 3 );
+    if( len > i ) {
+      memcpy( tail, in + i, len - i );
+      ak_base64_encodeblock( tail, ref + 4*i/3, ( int )( len - i ));
+    }
+
+    esize = sizeof( enc );
+    if(( ak_base64_encode( in, len, enc, &esize ) != ak_error_ok ) ||
+       ( esize != 4*(( len + 2 )/3 )) || memcmp( enc, ref, esize )) {
+      printf(" encoding of %u octets: Wrong\n", ( unsigned int )len );
+      result = EXIT_FAILURE;
+      break;
+    }
+
+   /* вставляем переводы строк и пробелы */
+    for( i = 0, j = 0; i < esize; i++ ) {
+       spaced[j++] = enc[i];
+       ak_random_ptr( &generator, &ch, 1 );
+       if( ch < 16 ) spaced[j++] = '\n';
+        else if( ch < 24 ) spaced[j++] = ' ';
+    }
+    dsize = sizeof( dec );
+    if(( ak_base64_decode( spaced, j, dec, &dsize ) != ak_error_ok ) ||
+       ( dsize != len ) || memcmp( dec, in, len )) {
+      printf(" decoding of %u octets: Wrong\n", ( unsigned int )len );
+      result = EXIT_FAILURE;
+      break;
+    }
+
+   /* некорректный символ должен приводить к ошибке */
+    if( esize > 40 ) {
+      enc[esize/2] = '*';
+      dsize = sizeof( dec );
+      if( ak_base64_decode( enc, esize, dec, &dsize ) == ak_error_ok ) {
+        printf(" decoding of incorrect data with %u octets: Wrong\n", ( unsigned int )len );
+        result = EXIT_FAILURE;
+        break;
+      }
+    }
+  }
+  if( result == EXIT_SUCCESS ) printf(" base64 encoding and decoding: Ok\n");
+
+  ak_random_destroy( &generator );
+  ak_libakrypt_destroy();
+
+ return result;
+}
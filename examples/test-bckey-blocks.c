@@ -0,0 +1,142 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  Тестовый пример для иллюстрации расшифрования в режимах простой замены, простой замены
+    с зацеплением (CBC) и гаммирования с обратной связью (CFB), в которых блоки данных
+    обрабатываются группами, а большие объемы данных - несколькими потоками.
+    Результаты сравниваются с результатами поблочного зашифрования.
+
+    test-bckey-blocks.c                                                                            */
+/* ----------------------------------------------------------------------------------------------- */
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <time.h>
+ #include <libakrypt.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+ static ak_uint8 key[32] = {
+  0xef, 0xcd, 0xab, 0x89, 0x67, 0x45, 0x23, 0x01, 0x10, 0x32, 0x54, 0x76, 0x98, 0xba, 0xdc, 0xfe,
+  0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x00, 0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88 };
+
+ static ak_uint8 iv[32] = {
+  0x12, 0x34, 0x56, 0x78, 0x90, 0xab, 0xcd, 0xef, 0x23, 0x45, 0x67, 0x89, 0x0a, 0xbc, 0xde, 0xf1,
+  0x34, 0x56, 0x78, 0x90, 0xab, 0xcd, 0xef, 0x12, 0xa1, 0xb2, 0xc3, 0xd4, 0xe5, 0xf0, 0x01, 0x12 };
+
+/* ----------------------------------------------------------------------------------------------- */
+/* проверка одного алгоритма при заданном объеме данных и количестве потоков */
+ static int test_cipher( ak_function_bckey_create *create, const char *name,
+                                ak_uint8 *plain, ak_uint8 *cipher, ak_uint8 *out, size_t size )
+{
+  struct bckey bkey;
+  size_t i = 0, z = 0, len = 0;
+  clock_t timea = 0;
+  int result = ak_false;
+
+  if( create( &bkey ) != ak_error_ok ) return ak_false;
+  if( ak_bckey_set_key( &bkey, key, sizeof( key )) != ak_error_ok ) goto labex;
+  len = size - size%bkey.bsize;
+
+ /* режим простой замены: сравниваем с поблочным зашифрованием */
+  for( i = 0; i < len; i += bkey.bsize ) bkey.encrypt( &bkey.key, plain + i, cipher + i );
+  if(( ak_bckey_encrypt_ecb( &bkey, plain, out, len ) != ak_error_ok ) ||
+     ( memcmp( out, cipher, len ) != 0 )) {
+    printf(" %s: ecb encryption of %u bytes is Wrong\n", name, (unsigned int)len );
+    goto labex;
+  }
+  timea = clock();
+  if(( ak_bckey_decrypt_ecb( &bkey, out, out, len ) != ak_error_ok ) ||
+     ( memcmp( out, plain, len ) != 0 )) {
+    printf(" %s: ecb decryption of %u bytes is Wrong\n", name, (unsigned int)len );
+    goto labex;
+  }
+  printf(" %s: ecb, %u bytes Ok (%f sec)\n", name, (unsigned int)len,
+                                                      (double)( clock() - timea ) / CLOCKS_PER_SEC );
+
+ /* режимы CBC и CFB при различных длинах синхропосылки;
+    расшифрование выполняется как на месте, так и в отдельный буффер */
+  for( z = 1; z <= 2; z++ ) {
+     if( ak_bckey_encrypt_cbc( &bkey, plain, cipher, len, iv, z*bkey.bsize ) != ak_error_ok )
+       goto labex;
+     timea = clock();
+     if(( ak_bckey_decrypt_cbc( &bkey, cipher, out, len, iv, z*bkey.bsize ) != ak_error_ok ) ||
+        ( memcmp( out, plain, len ) != 0 )) {
+       printf(" %s: cbc decryption (%u blocks iv) is Wrong\n", name, (unsigned int)z );
+       goto labex;
+     }
+     timea = clock() - timea;
+     if(( ak_bckey_decrypt_cbc( &bkey, cipher, cipher, len, iv, z*bkey.bsize ) != ak_error_ok ) ||
+        ( memcmp( cipher, plain, len ) != 0 )) {
+       printf(" %s: in-place cbc decryption (%u blocks iv) is Wrong\n", name, (unsigned int)z );
+       goto labex;
+     }
+     printf(" %s: cbc, %u blocks iv Ok (%f sec)\n", name, (unsigned int)z,
+                                                                 (double)timea / CLOCKS_PER_SEC );
+
+     if( ak_bckey_encrypt_cfb( &bkey, plain, cipher, size, iv, z*bkey.bsize ) != ak_error_ok )
+       goto labex;
+     timea = clock();
+     if(( ak_bckey_decrypt_cfb( &bkey, cipher, out, size, iv, z*bkey.bsize ) != ak_error_ok ) ||
+        ( memcmp( out, plain, size ) != 0 )) {
+       printf(" %s: cfb decryption (%u blocks iv) is Wrong\n", name, (unsigned int)z );
+       goto labex;
+     }
+     timea = clock() - timea;
+     if(( ak_bckey_decrypt_cfb( &bkey, cipher, cipher, size, iv, z*bkey.bsize ) != ak_error_ok ) ||
+        ( memcmp( cipher, plain, size ) != 0 )) {
+       printf(" %s: in-place cfb decryption (%u blocks iv) is Wrong\n", name, (unsigned int)z );
+       goto labex;
+     }
+     printf(" %s: cfb, %u blocks iv Ok (%f sec)\n", name, (unsigned int)z,
+                                                                 (double)timea / CLOCKS_PER_SEC );
+  }
+  result = ak_true;
+
+  labex:
+   ak_bckey_destroy( &bkey );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+  size_t i = 0, j = 0, threads[2] = { 1, 4 }, sizes[2] = { 1003, 262149 };
+  ak_uint8 *plain = NULL, *cipher = NULL, *out = NULL;
+  int oc = 0, result = EXIT_SUCCESS;
+
+ /* инициализируем библиотеку */
+  if( ak_libakrypt_create( ak_function_log_stderr ) != ak_true )
+    return ak_libakrypt_destroy();
+
+  plain = malloc( sizes[1] );
+  cipher = malloc( sizes[1] );
+  out = malloc( sizes[1] );
+  if(( plain == NULL ) || ( cipher == NULL ) || ( out == NULL )) {
+    result = EXIT_FAILURE;
+    goto labex;
+  }
+  for( i = 0; i < sizes[1]; i++ ) plain[i] = ( ak_uint8 )( i*7 + ( i >> 8 ));
+
+  for( oc = 0; oc < 2; oc++ ) {
+     ak_libakrypt_set_openssl_compability( oc );
+     for( i = 0; i < 2; i++ )
+        for( j = 0; j < 2; j++ ) {
+           ak_libakrypt_set_option( "threads_count", ( ak_int64 )threads[j] );
+           printf("openssl compability: %d, %u bytes, %u thread(s)\n",
+                                         oc, (unsigned int)sizes[i], (unsigned int)threads[j] );
+           if( !test_cipher( ak_bckey_create_magma, "magma", plain, cipher, out, sizes[i] ) ||
+               !test_cipher( ak_bckey_create_kuznechik, "kuznechik", plain, cipher, out, sizes[i] ) ||
+               !test_cipher( ak_bckey_create_rc6, "rc6", plain, cipher, out, sizes[i] )) {
+             result = EXIT_FAILURE;
+             goto labex;
+           }
+        }
+  }
+
+  labex:
+   ak_libakrypt_set_openssl_compability( ak_false );
+   if( plain ) free( plain );
+   if( cipher ) free( cipher );
+   if( out ) free( out );
+   ak_libakrypt_destroy();
+
+ return result;
+}
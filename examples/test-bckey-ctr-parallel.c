@@ -0,0 +1,120 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  Тестовый пример для иллюстрации многопоточного шифрования в режиме гаммирования.
+    Результаты зашифрования, полученные с использованием нескольких потоков, а также
+    результат наложения заранее выработанной гаммы, сравниваются с результатом
+    однопоточного зашифрования.
+
+    test-bckey-ctr-parallel.c                                                                      */
+/* ----------------------------------------------------------------------------------------------- */
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <time.h>
+ #include <libakrypt.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+ static ak_uint8 key[32] = {
+  0xef, 0xcd, 0xab, 0x89, 0x67, 0x45, 0x23, 0x01, 0x10, 0x32, 0x54, 0x76, 0x98, 0xba, 0xdc, 0xfe,
+  0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x00, 0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88 };
+
+ static ak_uint8 iv[8] = { 0x12, 0x34, 0x56, 0x78, 0x90, 0xab, 0xce, 0xf0 };
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int test_ctr( ak_function_bckey_create *create, const char *name,
+                             ak_uint8 *plain, ak_uint8 *etalon, ak_uint8 *out, const size_t size )
+{
+  struct bckey bkey;
+  clock_t timea = 0;
+  ak_int64 counter = 0;
+  size_t i = 0, first = 0;
+  int result = ak_false;
+
+  if( create( &bkey ) != ak_error_ok ) return ak_false;
+  if( ak_bckey_set_key( &bkey, key, sizeof( key )) != ak_error_ok ) goto labex;
+  first = 4099*bkey.bsize;
+
+ /* эталонное значение вырабатываем в одном потоке */
+  ak_libakrypt_set_option( "threads_count", 1 );
+  counter = bkey.key.resource.value.counter;
+  timea = clock();
+  if( ak_bckey_ctr( &bkey, plain, etalon, size, iv, bkey.bsize >> 1 ) != ak_error_ok ) goto labex;
+  printf(" %s: one thread (%f sec)\n", name, (double)( clock() - timea ) / CLOCKS_PER_SEC );
+  counter -= bkey.key.resource.value.counter;
+
+ /* зашифрование в несколько потоков, в том числе фрагментами */
+  ak_libakrypt_set_option( "threads_count", 4 );
+  timea = clock();
+  if(( ak_bckey_ctr( &bkey, plain, out, size, iv, bkey.bsize >> 1 ) != ak_error_ok ) ||
+     ( memcmp( out, etalon, size ) != 0 )) {
+    printf(" %s: multithreaded encryption is Wrong\n", name );
+    goto labex;
+  }
+  timea = clock() - timea;
+  if( counter != ( ak_int64 )(( size + bkey.bsize - 1 )/bkey.bsize )) {
+    printf(" %s: key resource is Wrong\n", name );
+    goto labex;
+  }
+  memset( out, 0, size );
+  if(( ak_bckey_ctr( &bkey, plain, out, first, iv, bkey.bsize >> 1 ) != ak_error_ok ) ||
+     ( ak_bckey_ctr( &bkey, plain + first, out + first, size - first, NULL, 0 ) != ak_error_ok ) ||
+     ( memcmp( out, etalon, size ) != 0 )) {
+    printf(" %s: multithreaded encryption of fragments is Wrong\n", name );
+    goto labex;
+  }
+  printf(" %s: 4 threads Ok (%f sec)\n", name, (double)timea / CLOCKS_PER_SEC );
+
+ /* выработка гаммы с последующим наложением на данные */
+  if( ak_bckey_ctr_keystream( &bkey, out, size, iv, bkey.bsize >> 1 ) != ak_error_ok ) goto labex;
+  for( i = 0; i < size; i++ ) out[i] ^= plain[i];
+  if( memcmp( out, etalon, size ) != 0 ) {
+    printf(" %s: keystream generation is Wrong\n", name );
+    goto labex;
+  }
+  printf(" %s: keystream generation Ok\n", name );
+  result = ak_true;
+
+  labex:
+   ak_bckey_destroy( &bkey );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+  size_t i = 0, size = 524293;
+  ak_uint8 *plain = NULL, *etalon = NULL, *out = NULL;
+  int oc = 0, result = EXIT_SUCCESS;
+
+ /* инициализируем библиотеку */
+  if( ak_libakrypt_create( ak_function_log_stderr ) != ak_true )
+    return ak_libakrypt_destroy();
+
+  plain = malloc( size );
+  etalon = malloc( size );
+  out = malloc( size );
+  if(( plain == NULL ) || ( etalon == NULL ) || ( out == NULL )) {
+    result = EXIT_FAILURE;
+    goto labex;
+  }
+  for( i = 0; i < size; i++ ) plain[i] = ( ak_uint8 )( i*13 + ( i >> 9 ));
+
+  for( oc = 0; oc < 2; oc++ ) {
+     ak_libakrypt_set_openssl_compability( oc );
+     printf("openssl compability: %d, %u bytes\n", oc, (unsigned int)size );
+     if( !test_ctr( ak_bckey_create_magma, "magma", plain, etalon, out, size ) ||
+         !test_ctr( ak_bckey_create_kuznechik, "kuznechik", plain, etalon, out, size ) ||
+         !test_ctr( ak_bckey_create_rc6, "rc6", plain, etalon, out, size )) {
+       result = EXIT_FAILURE;
+       break;
+     }
+  }
+
+  labex:
+   ak_libakrypt_set_openssl_compability( ak_false );
+   if( plain ) free( plain );
+   if( etalon ) free( etalon );
+   if( out ) free( out );
+   ak_libakrypt_destroy();
+
+ return result;
+}
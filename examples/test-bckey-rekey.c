@@ -0,0 +1,90 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  Тестовый пример для иллюстрации замены значения ключа блочного шифрования без повторной
+    инициализации контекста. Результат шифрования на ключе, замененном с помощью функции
+    ak_bckey_rekey(), сравнивается с результатом шифрования на вновь созданном ключе;
+    проверка выполняется как в обычном режиме, так и в режиме совместимости с openssl.
+
+    test-bckey-rekey.c                                                                             */
+/* ----------------------------------------------------------------------------------------------- */
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <time.h>
+ #include <libakrypt.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+ static ak_uint8 key[32] = {
+  0xef, 0xcd, 0xab, 0x89, 0x67, 0x45, 0x23, 0x01, 0x10, 0x32, 0x54, 0x76, 0x98, 0xba, 0xdc, 0xfe,
+  0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x00, 0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88 };
+
+ static ak_uint8 plain[32] = {
+  0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff, 0x00, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11,
+  0x0a, 0xff, 0xee, 0xcc, 0xbb, 0xaa, 0x99, 0x88, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x00 };
+
+/* ----------------------------------------------------------------------------------------------- */
+/* сравнение результатов шифрования на замененном и на вновь созданном ключах */
+ static int test_rekey( ak_function_bckey_create *create, const char *name )
+{
+  size_t i = 0, count = 1000;
+  clock_t timea = 0;
+  struct bckey bkey, fresh;
+  ak_uint8 newkey[32], etalon[32], out[32];
+  int error = ak_error_ok, result = ak_false;
+
+  if(( error = create( &bkey )) != ak_error_ok ) return ak_false;
+  if(( error = ak_bckey_set_key( &bkey, key, sizeof( key ))) != ak_error_ok ) goto labex;
+
+  memcpy( newkey, key, sizeof( key ));
+  timea = clock();
+  for( i = 0; i < count; i++ ) {
+     newkey[i%32] ^= ( ak_uint8 )( i+1 );
+     if(( error = ak_bckey_rekey( &bkey, newkey, sizeof( newkey ))) != ak_error_ok ) goto labex;
+  }
+  timea = clock() - timea;
+
+ /* вычисляем эталон на вновь созданном ключе */
+  if(( error = create( &fresh )) != ak_error_ok ) goto labex;
+  if(( error = ak_bckey_set_key( &fresh, newkey, sizeof( newkey ))) == ak_error_ok )
+    error = ak_bckey_encrypt_ecb( &fresh, plain, etalon, sizeof( plain ));
+  ak_bckey_destroy( &fresh );
+  if( error != ak_error_ok ) goto labex;
+
+  if(( ak_bckey_encrypt_ecb( &bkey, plain, out, sizeof( plain )) != ak_error_ok ) ||
+     ( memcmp( out, etalon, sizeof( out )) != 0 )) {
+    printf(" %s: encryption with replaced key is Wrong\n", name );
+    goto labex;
+  }
+  if(( ak_bckey_decrypt_ecb( &bkey, etalon, out, sizeof( out )) != ak_error_ok ) ||
+     ( memcmp( out, plain, sizeof( plain )) != 0 )) {
+    printf(" %s: decryption with replaced key is Wrong\n", name );
+    goto labex;
+  }
+  printf(" %s: %u key replacements Ok (%f sec)\n", name, (unsigned int)count,
+                                                               (double)timea / CLOCKS_PER_SEC );
+  result = ak_true;
+
+  labex:
+   ak_bckey_destroy( &bkey );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+  int oc = 0, result = EXIT_SUCCESS;
+
+ /* инициализируем библиотеку */
+  if( ak_libakrypt_create( ak_function_log_stderr ) != ak_true )
+    return ak_libakrypt_destroy();
+
+  for( oc = 0; oc < 2; oc++ ) {
+     ak_libakrypt_set_openssl_compability( oc );
+     printf("openssl compability: %d\n", oc );
+     if( !test_rekey( ak_bckey_create_magma, "magma" )) result = EXIT_FAILURE;
+     if( !test_rekey( ak_bckey_create_kuznechik, "kuznechik" )) result = EXIT_FAILURE;
+  }
+  ak_libakrypt_set_openssl_compability( ak_false );
+
+  ak_libakrypt_destroy();
+ return result;
+}
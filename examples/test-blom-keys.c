@@ -1,4 +1,5 @@
 /* ----------------------------------------------------------------------------------------------- */
+ #include <stdio.h>
  #include <stdlib.h>
  #include <time.h>
  #include <string.h>
@@ -7,6 +8,9 @@
  int user_test( const ak_uint32 , const ak_uint32 );
  int user_generate_test( const ak_uint32 , const ak_uint32 , ak_uint8 * );
  int user_generate_abonent_test( ak_blomkey , ak_uint8 * );
+ int user_generate_batch_test( ak_blomkey );
+ int user_container_test( ak_blomkey );
+ int user_pairwise_batch_test( ak_blomkey );
  int user_generate_pairwise_test( ak_blomkey , ak_blomkey , ak_uint8 *, bool_t );
  int user_import_matrix_test( ak_uint8 * );
  int user_import_abonent_test( ak_uint8 * );
@@ -83,6 +87,15 @@
     printf("%s - generation of initial matrix is Ok\n", __func__ );
    else goto labex;
 
+ /* проверяем симметричность матрицы */
+  for( i = 0; i < master.size; i++ )
+     for( j = 0; j < i; j++ )
+        if( memcmp( ak_blomkey_get_element_by_index( &master, i, j ),
+                    ak_blomkey_get_element_by_index( &master, j, i ), master.count ) != 0 ) {
+          printf("%s - initial matrix is not symmetric\n", __func__ );
+          goto labex1;
+        }
+
  /* вывод ключевой информации */
   if( master.size <= 5 ) {
     printf("matrix (%u bytes):\n", master.size*master.size*master.count );
@@ -105,7 +118,9 @@
     goto labex1;
   }
 
-  exitcode = user_generate_abonent_test( &master, check );
+  if((( exitcode = user_generate_batch_test( &master )) == EXIT_SUCCESS ) &&
+     (( exitcode = user_container_test( &master )) == EXIT_SUCCESS ))
+    exitcode = user_generate_abonent_test( &master, check );
 
   labex1:
     ak_blomkey_destroy( &master );
@@ -154,6 +169,7 @@
                                                                                  __func__, IDtwo );
      goto labex2;
    }
+   if(( exitcode = user_pairwise_batch_test( &abonent_one )) != EXIT_SUCCESS ) goto labex2;
                           /* false => значение вектора check вырабатывается, но не проверяется */
    exitcode = user_generate_pairwise_test( &abonent_one, &abonent_two, check, ak_false );
 
@@ -166,6 +182,160 @@
  return exitcode;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/* ключи, выработанные за один проход по мастер-ключу, должны совпадать с ключами,
+   выработанными для каждого абонента по отдельности */
+ int user_generate_batch_test( ak_blomkey master )
+{
+  size_t i = 0, count = 0;
+  struct blomkey keys[3], abonent;
+  ak_pointer ids[3] = { IDone, IDtwo, "abonent #3" };
+  size_t sizes[3];
+  int exitcode = EXIT_SUCCESS;
+
+  for( i = 0; i < 3; i++ ) sizes[i] = strlen( ids[i] );
+  if( ak_blomkey_create_abonent_keys( keys, master, 3, ids, sizes ) != ak_error_ok ) {
+    printf("%s - incorrect generation of secret keys for three abonents\n", __func__ );
+    return EXIT_FAILURE;
+  }
+  for( i = 0; i < 3; i++ ) {
+     if( ak_blomkey_create_abonent_key( &abonent, master, ids[i], sizes[i] ) != ak_error_ok ) {
+       exitcode = EXIT_FAILURE;
+       break;
+     }
+     if( memcmp( abonent.data, keys[i].data, abonent.size*abonent.count ) == 0 &&
+         memcmp( abonent.icode, keys[i].icode, sizeof( abonent.icode )) == 0 ) count++;
+     ak_blomkey_destroy( &abonent );
+  }
+  for( i = 0; i < 3; i++ ) ak_blomkey_destroy( keys + i );
+
+  if(( exitcode == EXIT_SUCCESS ) && ( count == 3 ))
+    printf("%s - generation of secret keys for three abonents is Ok\n", __func__ );
+   else {
+     printf("%s - secret keys for three abonents are Wrong\n", __func__ );
+     exitcode = EXIT_FAILURE;
+   }
+
+ return exitcode;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* строки мастер-ключа и ключи абонентов, полученные из контейнера без расшифрования
+   всего мастер-ключа, должны совпадать с вычисленными в памяти */
+ int user_container_test( ak_blomkey master )
+{
+  size_t i = 0;
+  ak_uint8 *row = NULL;
+  struct blomkey keys[2], abonent;
+  struct blomkey_container ctx;
+  ak_pointer ids[2] = { IDtwo, IDone };
+  size_t sizes[2];
+  int exitcode = EXIT_FAILURE;
+
+  if( ak_blomkey_container_open( &ctx, "wrong", 5, "master.key" ) == ak_error_ok ) {
+    printf("%s - container is opened with wrong password\n", __func__ );
+    ak_blomkey_container_close( &ctx );
+    return EXIT_FAILURE;
+  }
+  if( ak_blomkey_container_open( &ctx, "hello", 5, "master.key" ) != ak_error_ok ) {
+    printf("%s - incorrect opening of container\n", __func__ );
+    return EXIT_FAILURE;
+  }
+  if(( row = malloc( master->size*master->count )) == NULL ) goto labex;
+  for( i = 0; i < master->size; i++ ) {
+     if( ak_blomkey_container_read_row( &ctx, i, row, master->size*master->count ) != ak_error_ok )
+       goto labex;
+     if( memcmp( row, ak_blomkey_get_element_by_index( master, i, i ),
+                                                 ( master->size - i )*master->count ) != 0 ) {
+       printf("%s - row %u of container is Wrong\n", __func__, (unsigned int) i );
+       goto labex;
+     }
+  }
+
+  for( i = 0; i < 2; i++ ) sizes[i] = strlen( ids[i] );
+  if( ak_blomkey_container_create_abonent_keys( &ctx, keys, 2, ids, sizes ) != ak_error_ok ) {
+    printf("%s - incorrect generation of secret keys from container\n", __func__ );
+    goto labex;
+  }
+  exitcode = EXIT_SUCCESS;
+  for( i = 0; i < 2; i++ ) {
+     if( ak_blomkey_create_abonent_key( &abonent, master, ids[i], sizes[i] ) != ak_error_ok ) {
+       exitcode = EXIT_FAILURE;
+       continue;
+     }
+     if( memcmp( abonent.data, keys[i].data, abonent.size*abonent.count ) != 0 ||
+         memcmp( abonent.icode, keys[i].icode, sizeof( abonent.icode )) != 0 )
+       exitcode = EXIT_FAILURE;
+     ak_blomkey_destroy( &abonent );
+  }
+  for( i = 0; i < 2; i++ ) ak_blomkey_destroy( keys + i );
+  if( exitcode == EXIT_SUCCESS )
+    printf("%s - generation of secret keys from container is Ok\n", __func__ );
+   else printf("%s - secret keys generated from container are Wrong\n", __func__ );
+
+  labex:
+   if( row ) free( row );
+   ak_blomkey_container_close( &ctx );
+ return exitcode;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* ключи парной связи, выработанные за один проход по ключу абонента, а также ключи,
+   полученные с использованием кэша, должны совпадать с ключами, выработанными по отдельности */
+ int user_pairwise_batch_test( ak_blomkey abonent )
+{
+  size_t i = 0, j = 0;
+  char names[150][16];
+  ak_pointer ids[150];
+  size_t sizes[150];
+  ak_uint8 *keys = NULL, key[64];
+  struct blomkey_cache cache;
+  int exitcode = EXIT_FAILURE;
+
+  for( i = 0; i < 150; i++ ) {
+     sprintf( names[i], "abonent #%u", (unsigned int) i );
+     ids[i] = names[i];
+     sizes[i] = strlen( names[i] );
+  }
+  if(( keys = malloc( 150*abonent->count )) == NULL ) return EXIT_FAILURE;
+  if( ak_blomkey_create_pairwise_keys_as_ptr( abonent, 150, ids, sizes,
+                                                    keys, 150*abonent->count ) != ak_error_ok ) {
+    printf("%s - incorrect generation of pairwise keys\n", __func__ );
+    goto labex;
+  }
+  for( i = 0; i < 150; i++ ) {
+     if(( ak_blomkey_create_pairwise_key_as_ptr( abonent, ids[i], sizes[i],
+                                                          key, sizeof( key )) != ak_error_ok ) ||
+        ( memcmp( key, keys + i*abonent->count, abonent->count ) != 0 )) {
+       printf("%s - pairwise key for \"%s\" is Wrong\n", __func__, names[i] );
+       goto labex;
+     }
+  }
+  printf("%s - generation of %u pairwise keys is Ok\n", __func__, 150 );
+
+ /* кэш меньше количества абонентов: часть ключей вытесняется и вырабатывается повторно */
+  if( ak_blomkey_cache_create( &cache, abonent, 16 ) != ak_error_ok ) goto labex;
+  for( j = 0; j < 3; j++ ) {
+     for( i = 0; i < 40; i++ ) {
+        size_t idx = ( i*7 + j )%40;
+        if(( ak_blomkey_cache_get_pairwise_key( &cache, ids[idx], sizes[idx],
+                                                          key, sizeof( key )) != ak_error_ok ) ||
+           ( memcmp( key, keys + idx*abonent->count, abonent->count ) != 0 )) {
+          printf("%s - cached pairwise key for \"%s\" is Wrong\n", __func__, names[idx] );
+          ak_blomkey_cache_destroy( &cache );
+          goto labex;
+        }
+     }
+  }
+  ak_blomkey_cache_destroy( &cache );
+  printf("%s - cached pairwise keys are Ok\n", __func__ );
+  exitcode = EXIT_SUCCESS;
+
+  labex:
+   free( keys );
+ return exitcode;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
  int user_generate_pairwise_test( ak_blomkey abonent_one, ak_blomkey abonent_two,
                                                                ak_uint8 *check, bool_t check_flag )
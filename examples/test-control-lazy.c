@@ -0,0 +1,91 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  Тестовый пример для иллюстрации динамического контроля криптографических механизмов
+    при их первом использовании: группа тестов выполняется при создании первого контекста
+    соответствующего механизма, группы тестов неиспользуемых механизмов (например, алгоритмов
+    электронной подписи) не выполняются.
+
+    test-control-lazy.c                                                                            */
+/* ----------------------------------------------------------------------------------------------- */
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <libakrypt.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+ static void print_results( void )
+{
+  double time = 0;
+  control_test_group_t group = gfn_control_test;
+
+  for( group = 0; group < control_tests_count; group++ ) {
+     if( ak_libakrypt_get_control_test_result( group, &time ) == ak_error_ok )
+       printf(" %-14s passed (%f sec)\n", ak_libakrypt_get_control_test_name( group ), time );
+      else printf(" %-14s not run\n", ak_libakrypt_get_control_test_name( group ));
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* создание ключа в одном из потоков: каждый поток должен дождаться завершения тестирования,
+   начатого другим потоком, и только после этого использовать ключ */
+ static int create_key( ak_pointer ptr, const size_t idx )
+{
+  struct bckey bkey;
+  int error = ak_error_ok;
+
+  (void)ptr;
+  if(( error = ak_bckey_create_kuznechik( &bkey )) != ak_error_ok ) return error;
+  ak_bckey_destroy( &bkey );
+  if( ak_libakrypt_get_control_test_result( block_cipher_control_test, NULL ) != ak_error_ok ) {
+    printf(" thread %u: key is created before the end of testing\n", (unsigned int)idx );
+    return ak_error_control_test;
+  }
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+  struct bckey bkey;
+  struct hash hctx;
+  int result = EXIT_FAILURE;
+
+ /* инициализируем библиотеку */
+  if( ak_libakrypt_create( NULL ) != ak_true )
+    return ak_libakrypt_destroy();
+  ak_libakrypt_set_option( "dynamic_control_test", 1 );
+  ak_libakrypt_set_option( "threads_count", 4 );
+
+ /* одновременное создание ключей блочного шифрования в нескольких потоках приводит
+    к однократному тестированию только блочных шифров */
+  if( ak_libakrypt_parallel_run( create_key, NULL, 8 ) != ak_error_ok ) goto labex;
+  if(( ak_libakrypt_get_control_test_result( block_cipher_control_test, NULL ) != ak_error_ok ) ||
+     ( ak_libakrypt_get_control_test_result( gfn_control_test, NULL ) != ak_error_ok ) ||
+     ( ak_libakrypt_get_control_test_result( asymmetric_control_test, NULL ) != ak_error_not_ready )) {
+    printf(" testing of block ciphers on first use: Wrong\n");
+    goto labex;
+  }
+
+ /* повторное создание ключа не приводит к повторному тестированию */
+  if( ak_bckey_create_magma( &bkey ) != ak_error_ok ) goto labex;
+  ak_bckey_destroy( &bkey );
+
+ /* создание контекста функции хеширования */
+  if( ak_hash_create_streebog256( &hctx ) != ak_error_ok ) goto labex;
+  ak_hash_destroy( &hctx );
+  if( ak_libakrypt_get_control_test_result( hash_control_test, NULL ) != ak_error_ok ) {
+    printf(" testing of hash functions on first use: Wrong\n");
+    goto labex;
+  }
+  print_results();
+  printf(" dynamic control on first use: Ok\n");
+  result = EXIT_SUCCESS;
+
+  labex:
+   ak_libakrypt_set_option( "dynamic_control_test", 0 );
+   ak_libakrypt_destroy();
+
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                                                                            test-control-lazy.c  */
+/* ----------------------------------------------------------------------------------------------- */
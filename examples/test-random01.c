@@ -10,6 +10,10 @@
  #include <string.h>
  #include <stdlib.h>
  #include <libakrypt.h>
+#if defined(__unix__) || defined(__APPLE__)
+ #include <unistd.h>
+ #include <sys/wait.h>
+#endif
 
 /* основная тестирующая функция */
  int test_function( ak_function_random create, const char *result )
@@ -47,6 +51,85 @@
  return retval;
 }
 
+/* проверка генератора mt19937-64 на контрольном примере эталонной реализации:
+   init_by_array64( { 0x12345, 0x23456, 0x34567, 0x45678 } ) */
+ int test_mt19937( void )
+{
+ struct random generator;
+ ak_uint64 key[4] = { 0x12345, 0x23456, 0x34567, 0x45678 }, out[1000];
+ int retval = ak_false;
+
+ /* значения должны совпадать с 1-м и 1000-м значениями эталонной реализации */
+  ak_random_create_mt19937( &generator );
+  ak_random_randomize( &generator, key, sizeof( key ));
+  ak_random_ptr( &generator, out, sizeof( out ));
+  if(( out[0] == 7266447313870364031ULL ) && ( out[999] == 994412663058993407ULL )) {
+    printf("mt19937-64 reference values: Ok\n");
+    retval = ak_true;
+  } else printf("mt19937-64 reference values: Wrong\n");
+  ak_random_destroy( &generator );
+
+ return retval;
+}
+
+/* проверка способов очистки памяти */
+ int test_wipe( void )
+{
+ size_t i = 0, zeros = 0;
+ struct random generator;
+ ak_uint8 buffer[1024];
+ int retval = ak_true;
+
+  ak_random_create_xorshift128( &generator );
+ /* при нулевом значении опции память обнуляется */
+  ak_libakrypt_set_option( "wipe_with_random", 0 );
+  memset( buffer, 0xa5, sizeof( buffer ));
+  ak_ptr_wipe( buffer, sizeof( buffer ), &generator );
+  for( i = 0; i < sizeof( buffer ); i++ ) if( buffer[i] != 0 ) retval = ak_false;
+
+ /* при установленной опции память заполняется случайными данными */
+  ak_libakrypt_set_option( "wipe_with_random", 1 );
+  memset( buffer, 0, sizeof( buffer ));
+  ak_ptr_wipe( buffer, sizeof( buffer ), &generator );
+  for( i = 0; i < sizeof( buffer ); i++ ) if( buffer[i] == 0 ) zeros++;
+  if( zeros > 32 ) retval = ak_false;
+  ak_libakrypt_set_option( "wipe_with_random", 0 );
+  ak_random_destroy( &generator );
+
+  printf("memory wiping: %s\n", retval ? "Ok" : "Wrong" );
+ return retval;
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+/* после вызова fork() родительский и дочерний процессы должны вырабатывать разные значения */
+ int test_fork( ak_function_random create )
+{
+ pid_t pid;
+ int fd[2], retval = ak_false;
+ struct random generator;
+ ak_uint8 parent[16], child[16];
+
+  if( create( &generator ) != ak_error_ok ) return ak_false;
+  ak_random_ptr( &generator, parent, sizeof( parent ));
+  if( pipe( fd ) != 0 ) goto labex;
+  if(( pid = fork()) == 0 ) {
+    ak_random_ptr( &generator, child, sizeof( child ));
+    if( write( fd[1], child, sizeof( child )) != sizeof( child )) _exit( EXIT_FAILURE );
+    _exit( EXIT_SUCCESS );
+  }
+  ak_random_ptr( &generator, parent, sizeof( parent ));
+  if(( pid > 0 ) && ( read( fd[0], child, sizeof( child )) == sizeof( child )) &&
+     ( memcmp( parent, child, sizeof( child )) != 0 )) retval = ak_true;
+  if( pid > 0 ) waitpid( pid, NULL, 0 );
+  close( fd[0] ); close( fd[1] );
+
+  labex:
+  printf("%s after fork: %s\n", generator.oid->name[0], retval ? "Ok" : "Wrong" );
+  ak_random_destroy( &generator );
+ return retval;
+}
+#endif
+
  int main( void )
 {
  int error = EXIT_SUCCESS;
@@ -58,6 +141,20 @@
    if( test_function( ak_random_create_lcg,
       "47b7ef2b729133a3e9853e0f4ffe040154a7622b7827e71bc6e48dff98c27f61" ) != ak_true )
      error = EXIT_FAILURE;
+   if( test_function( ak_random_create_xorshift128,
+      "c9b8ffaefdc8a4f6dd609c1777df508b1baab9b78db1752d47db2fd926825719" ) != ak_true )
+     error = EXIT_FAILURE;
+   if( test_function( ak_random_create_mt19937,
+      "9546ae02c8ac96ec2be090d5e4321f7db702c9f030bee296f6e7126227e44012" ) != ak_true )
+     error = EXIT_FAILURE;
+   if( test_mt19937() != ak_true ) error = EXIT_FAILURE;
+   if( test_wipe() != ak_true ) error = EXIT_FAILURE;
+   if( test_function( ak_random_create_drbg, NULL ) != ak_true ) error = EXIT_FAILURE;
+   if( test_function( ak_random_create_drbg_thread, NULL ) != ak_true ) error = EXIT_FAILURE;
+#if defined(__unix__) || defined(__APPLE__)
+   if( test_fork( ak_random_create_drbg ) != ak_true ) error = EXIT_FAILURE;
+   if( test_fork( ak_random_create_drbg_thread ) != ak_true ) error = EXIT_FAILURE;
+#endif
 
 #ifdef _WIN32
  if( test_function( ak_random_create_winrtl, NULL ) != ak_true ) error = EXIT_FAILURE;
@@ -0,0 +1,154 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  Тестовый пример для иллюстрации многократного создания и удаления кратковременных ключей
+    блочного шифрования. Память под ключи выделяется из пула ранее освобожденных блоков,
+    а уникальные номера ключей вырабатываются без вычисления хеш-функции.
+    Также проверяется одновременное существование большого количества ключей, размещенных
+    в защищенной куче.
+
+    test-skey-pool.c                                                                               */
+/* ----------------------------------------------------------------------------------------------- */
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <time.h>
+ #include <libakrypt.h>
+#if defined(__unix__) || defined(__APPLE__)
+ #include <unistd.h>
+ #include <sys/wait.h>
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+ static ak_uint8 key[32] = {
+  0xef, 0xcd, 0xab, 0x89, 0x67, 0x45, 0x23, 0x01, 0x10, 0x32, 0x54, 0x76, 0x98, 0xba, 0xdc, 0xfe,
+  0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x00, 0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88 };
+
+ static ak_uint8 plain[32] = {
+  0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff, 0x00, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11,
+  0x0a, 0xff, 0xee, 0xcc, 0xbb, 0xaa, 0x99, 0x88, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x00 };
+
+/* ----------------------------------------------------------------------------------------------- */
+/* создание множества одновременно существующих ключей в защищенной куче */
+ static struct bckey keys[3000];
+
+ static bool_t test_secure_keys( ak_uint8 *etalon )
+{
+  size_t i = 0, count = sizeof( keys )/sizeof( struct bckey );
+  ak_uint8 out[32];
+  bool_t result = ak_true;
+
+  ak_libakrypt_set_option( "skey_secure_memory", 1 );
+  for( i = 0; i < count; i++ ) {
+     if((( i&1 ) ? ak_bckey_create_magma( &keys[i] ) :
+                   ak_bckey_create_kuznechik( &keys[i] )) != ak_error_ok ) break;
+     if(( ak_bckey_set_key( &keys[i], key, sizeof( key )) != ak_error_ok ) ||
+        ( keys[i].key.policy != secure_policy )) {
+       result = ak_false;
+       i++;
+       break;
+     }
+  }
+  ak_libakrypt_set_option( "skey_secure_memory", 0 );
+  if( i != count ) result = ak_false;
+  count = i;
+
+ /* все ключи остаются корректными */
+  for( i = 0; ( i < count ) && result; i += 2 ) {
+     if(( ak_bckey_encrypt_ecb( &keys[i], plain, out, sizeof( plain )) != ak_error_ok ) ||
+        ( memcmp( out, etalon, sizeof( out )) != 0 )) result = ak_false;
+  }
+  for( i = 0; i < count; i++ ) ak_bckey_destroy( &keys[i] );
+
+  printf(" creation of %u keys in secure memory: %s\n", (unsigned int)count,
+                                                                    result ? "Ok" : "Wrong" );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+#if defined(__unix__) || defined(__APPLE__)
+/* номера ключей, созданных родительским и дочерним процессами после fork(), должны различаться */
+ static bool_t test_fork( void )
+{
+  pid_t pid;
+  int fd[2];
+  bool_t result = ak_false;
+  ak_uint8 parent[32], child[32];
+
+  if( pipe( fd ) != 0 ) return ak_false;
+  if(( pid = fork()) == 0 ) {
+    if(( ak_libakrypt_generate_unique_number( child, sizeof( child )) != ak_error_ok ) ||
+       ( write( fd[1], child, sizeof( child )) != sizeof( child ))) _exit( EXIT_FAILURE );
+    _exit( EXIT_SUCCESS );
+  }
+  if(( pid > 0 ) &&
+     ( ak_libakrypt_generate_unique_number( parent, sizeof( parent )) == ak_error_ok ) &&
+     ( read( fd[0], child, sizeof( child )) == sizeof( child )) &&
+     ( memcmp( parent, child, sizeof( child )) != 0 )) result = ak_true;
+  if( pid > 0 ) waitpid( pid, NULL, 0 );
+  close( fd[0] ); close( fd[1] );
+
+  printf(" unique numbers after fork: %s\n", result ? "Ok" : "Wrong" );
+ return result;
+}
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+  size_t i = 0, count = 10000;
+  clock_t timea = 0;
+  struct bckey first, bkey;
+  ak_uint8 etalon[32], out[32];
+  int result = EXIT_FAILURE;
+
+ /* инициализируем библиотеку */
+  if( ak_libakrypt_create( ak_function_log_stderr ) != ak_true )
+    return ak_libakrypt_destroy();
+
+ /* эталонный ключ, существующий все время работы программы */
+  if( ak_bckey_create_kuznechik( &first ) != ak_error_ok ) goto labex;
+  if( ak_bckey_set_key( &first, key, sizeof( key )) != ak_error_ok ) goto lab1;
+  if( ak_bckey_encrypt_ecb( &first, plain, etalon, sizeof( plain )) != ak_error_ok ) goto lab1;
+  if( first.key.policy != pool_policy ) {
+    printf(" memory allocation policy: Wrong\n");
+    goto lab1;
+  }
+
+ /* многократно создаем и удаляем ключ с тем же значением */
+  timea = clock();
+  for( i = 0; i < count; i++ ) {
+     if( ak_bckey_create_kuznechik( &bkey ) != ak_error_ok ) goto lab1;
+     if( memcmp( bkey.key.number, first.key.number, sizeof( first.key.number )) == 0 ) {
+       printf(" unique number of key: Wrong\n");
+       ak_bckey_destroy( &bkey );
+       goto lab1;
+     }
+     if(( ak_bckey_set_key( &bkey, key, sizeof( key )) != ak_error_ok ) ||
+        ( ak_bckey_encrypt_ecb( &bkey, plain, out, sizeof( plain )) != ak_error_ok ) ||
+        ( memcmp( out, etalon, sizeof( out )) != 0 )) {
+       printf(" encryption with %u-th key: Wrong\n", (unsigned int)i );
+       ak_bckey_destroy( &bkey );
+       goto lab1;
+     }
+     ak_bckey_destroy( &bkey );
+  }
+  timea = clock() - timea;
+  printf(" creation of %u short-lived keys: Ok (%f sec)\n", (unsigned int)count,
+                                                               (double)timea / CLOCKS_PER_SEC );
+ /* проверяем расшифрование эталонным ключом */
+  if(( ak_bckey_decrypt_ecb( &first, etalon, out, sizeof( out )) == ak_error_ok ) &&
+     ( memcmp( out, plain, sizeof( plain )) == 0 )) {
+    printf(" decryption with long-lived key: Ok\n");
+    if( test_secure_keys( etalon )) result = EXIT_SUCCESS;
+  }
+   else printf(" decryption with long-lived key: Wrong\n");
+#if defined(__unix__) || defined(__APPLE__)
+  if( test_fork() != ak_true ) result = EXIT_FAILURE;
+#endif
+
+  lab1:
+   ak_bckey_destroy( &first );
+  labex:
+   ak_libakrypt_destroy();
+
+ return result;
+}
@@ -8,25 +8,17 @@
  #include <libakrypt-internal.h>
 
 /* ----------------------------------------------------------------------------------------------- */
-/*! \details Функция вычисляет новое значение секретного ключа в соответствии с соотношениями
-    из раздела 4.1, см. Р 1323565.1.017—2018.
-    После выработки новое значение помещается вместо старого.
-    Одновременно, изменяется ресурс нового ключа: его тип принимает значение - \ref key_using_resource,
-    а счетчик принимает значение, определяемое одной из опций
+/*! \brief Функция вычисляет следующее значение секретного ключа в соответствии с соотношениями
+    из раздела 4.1 Р 1323565.1.017—2018, не изменяя текущего значения ключа.
 
-     - `ackpm_section_magma_block_count`,
-     - `ackpm_section_kuznechik_block_count`.
-
-    @param bkey Контекст ключа алгоритма блочного шифрования, для которого вычисляется
-    новое значение. Контекст должен быть инициализирован и содержать ключевое значение.
+    @param bkey Контекст ключа алгоритма блочного шифрования.
+    @param new_key Массив, куда помещается новое значение ключа (32 октета).
     @return В случае возникновения ошибки функция возвращает ее код, в противном случае
     возвращается \ref ak_error_ok (ноль)                                                           */
 /* ----------------------------------------------------------------------------------------------- */
- int ak_bckey_next_acpkm_key( ak_bckey bkey )
+ static int ak_bckey_acpkm_derive_key( ak_bckey bkey, ak_uint8 *new_key )
 {
-  ssize_t counter = 0;
-  int error = ak_error_ok;
-  ak_uint8 new_key[32], acpkm[32] = {
+  ak_uint8 acpkm[32] = {
      0x9f, 0x9e, 0x9d, 0x9c, 0x9b, 0x9a, 0x99, 0x98, 0x97, 0x96, 0x95, 0x94, 0x93, 0x92, 0x91, 0x90,
      0x8f, 0x8e, 0x8d, 0x8c, 0x8b, 0x8a, 0x89, 0x88, 0x87, 0x86, 0x85, 0x84, 0x83, 0x82, 0x81, 0x80 };
 
@@ -46,19 +38,48 @@
          bkey->encrypt( &bkey->key, acpkm +8, new_key +8 );
          bkey->encrypt( &bkey->key, acpkm +16, new_key +16 );
          bkey->encrypt( &bkey->key, acpkm +24, new_key +24 );
-         counter = ak_libakrypt_get_option_by_name( "acpkm_section_magma_block_count" );
          break;
       case 16: /* шифр с длиной блока 128 бит */
          bkey->encrypt( &bkey->key, acpkm, new_key );
          bkey->encrypt( &bkey->key, acpkm +16, new_key +16 );
-         counter = ak_libakrypt_get_option_by_name( "acpkm_section_kuznechik_block_count" );
          break;
       default: return ak_error_message( ak_error_wrong_block_cipher,
                                            __func__ , "incorrect block size of block cipher key" );
    }
 
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \details Функция вычисляет новое значение секретного ключа в соответствии с соотношениями
+    из раздела 4.1, см. Р 1323565.1.017—2018.
+    После выработки новое значение помещается вместо старого с помощью функции ak_bckey_rekey(),
+    то есть без повторного выделения памяти под ключ и развернутые раундовые ключи.
+    Одновременно, изменяется ресурс нового ключа: его тип принимает значение - \ref key_using_resource,
+    а счетчик принимает значение, определяемое одной из опций
+
+     - `ackpm_section_magma_block_count`,
+     - `ackpm_section_kuznechik_block_count`.
+
+    @param bkey Контекст ключа алгоритма блочного шифрования, для которого вычисляется
+    новое значение. Контекст должен быть инициализирован и содержать ключевое значение.
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_next_acpkm_key( ak_bckey bkey )
+{
+  ssize_t counter = 0;
+  int error = ak_error_ok;
+  ak_uint8 new_key[32];
+
+ /* выработка нового значения */
+  if(( error = ak_bckey_acpkm_derive_key( bkey, new_key )) != ak_error_ok )
+    return ak_error_message( error, __func__ , "incorrect generation of new key value" );
+  counter = ak_libakrypt_get_option_by_name( bkey->bsize == 8 ?
+                       "acpkm_section_magma_block_count" : "acpkm_section_kuznechik_block_count" );
+
  /* присваиваем ключу значение */
-  if(( error = ak_bckey_set_key( bkey, new_key, bkey->key.key_size )) != ak_error_ok )
+  if(( error = ak_bckey_rekey( bkey, new_key, bkey->key.key_size )) != ak_error_ok )
     ak_error_message( error, __func__ , "can't replace key by new using acpkm" );
    else {
            bkey->key.resource.value.type = key_using_resource;
@@ -105,6 +126,173 @@
            }
 #endif
 
+#ifdef AK_LITTLE_ENDIAN
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Количество секций, ключи которых вырабатываются заранее, в расчете на один поток. */
+ #define ak_acpkm_sections_per_thread    (4)
+/*! \brief Минимальный объем данных (в октетах), шифруемых с использованием нескольких потоков. */
+ #define ak_acpkm_parallel_min_size      (65536)
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Задание для параллельного шифрования группы секций в режиме CTR-ACPKM. */
+ typedef struct acpkm_job {
+  /*! \brief Ключи секций группы. */
+   struct bckey *keys;
+  /*! \brief Значение счетчика в начале первой секции группы. */
+   ak_uint64 ctr[2];
+  /*! \brief Указатель на входные данные группы. */
+   ak_uint8 *in;
+  /*! \brief Указатель на выходные данные группы. */
+   ak_uint8 *out;
+  /*! \brief Объем данных группы в октетах. */
+   size_t size;
+  /*! \brief Длина одной секции в октетах. */
+   size_t section_size;
+ } *ak_acpkm_job;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция зашифровывает одну секцию группы на заранее выработанном ключе.
+    \details Начальное значение счетчика секции вычисляется по ее номеру, поэтому
+    секции группы могут обрабатываться независимо друг от друга.                                 */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_bckey_ctr_acpkm_section( ak_pointer ptr, const size_t idx )
+{
+  ak_acpkm_job job = ( ak_acpkm_job )ptr;
+  ak_bckey bkey = job->keys + idx;
+  size_t j = 0, offset = idx*job->section_size,
+         len = ak_min( job->section_size, job->size - offset ), blocks = len/bkey->bsize;
+  ak_uint64 yaout[2], ctr[2], shift = ( ak_uint64 )( idx*( job->section_size/bkey->bsize )),
+            *inptr = ( ak_uint64 *)( job->in + offset ), *outptr = ( ak_uint64 *)( job->out + offset );
+
+  ctr[0] = job->ctr[0] + shift;
+  ctr[1] = job->ctr[1] + (( bkey->bsize == 16 ) && ( ctr[0] < shift ));
+  switch( bkey->bsize ) {
+    case  8:
+      for( j = 0; j < blocks; j++, inptr++, outptr++ ) {
+         bkey->encrypt( &bkey->key, ctr, yaout );
+         ctr[0] += 1;
+         outptr[0] = yaout[0] ^ inptr[0];
+      }
+      break;
+    case 16:
+      for( j = 0; j < blocks; j++, inptr += 2, outptr += 2 ) {
+         bkey->encrypt( &bkey->key, ctr, yaout );
+         if(( ctr[0] += 1 ) == 0 ) ctr[1]++;
+         outptr[0] = yaout[0] ^ inptr[0];
+         outptr[1] = yaout[1] ^ inptr[1];
+      }
+      break;
+  }
+ /* последний фрагмент, длина которого меньше длины блока, может быть только в последней секции */
+  if(( len -= blocks*bkey->bsize ) > 0 ) {
+    bkey->encrypt( &bkey->key, ctr, yaout );
+    for( j = 0; j < len; j++ ) ((ak_uint8 *) outptr)[j] =
+                               ((ak_uint8 *)yaout)[bkey->bsize-len+j] ^ ((ak_uint8 *) inptr)[j];
+  }
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция присваивает ключу значение, следующее за значением ключа prev.
+    \details Если ключ next еще не создан, то он создается.                                        */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_bckey_acpkm_set_next_key( ak_bckey next, bool_t created, ak_bckey prev )
+{
+  ak_uint8 new_key[32];
+  int error = ak_error_ok;
+
+  if(( error = ak_bckey_acpkm_derive_key( prev, new_key )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect generation of new key value" );
+  if( !created ) {
+    if(( error = (( ak_function_bckey_create *)prev->key.oid->func.first.create )( next ))
+                                                                                 != ak_error_ok ) {
+      ak_error_message( error, __func__, "incorrect creation of section key" );
+      goto labex;
+    }
+  }
+  if(( error = ( created ? ak_bckey_rekey( next, new_key, sizeof( new_key )) :
+                      ak_bckey_set_key( next, new_key, sizeof( new_key )))) != ak_error_ok ) {
+    ak_error_message( error, __func__, "incorrect assigning of section key" );
+    if( !created ) ak_bckey_destroy( next );
+  }
+
+  labex:
+   ak_ptr_wipe( new_key, sizeof( new_key ), &prev->key.generator );
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция шифрует данные в режиме CTR-ACPKM, распределяя секции между потоками.
+    \details Данные обрабатываются группами секций. Для каждой группы в начале последовательно
+    вырабатывается цепочка ключей секций, после чего секции группы зашифровываются параллельно
+    с помощью функции ak_libakrypt_parallel_run().
+
+    @param nkey Исходный ключ (ключ первой секции); значение ключа не изменяется.
+    @param in Указатель на входные данные.
+    @param out Указатель на выходные данные.
+    @param size Размер данных в октетах.
+    @param section_size Длина секции в октетах.
+    @param ctr Начальное значение счетчика.
+    @param threads Количество потоков.
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_bckey_ctr_acpkm_parallel( ak_bckey nkey, ak_uint8 *in, ak_uint8 *out,
+                             const size_t size, const size_t section_size, ak_uint64 *ctr,
+                                                                            const size_t threads )
+{
+  struct acpkm_job job;
+  int error = ak_error_ok;
+  ak_uint64 shift = 0;
+  size_t i = 0, batch = 0, created = 0, count = 0, offset = 0,
+         sections = ( size + section_size - 1 )/section_size;
+
+  batch = ak_min( sections, threads*ak_acpkm_sections_per_thread );
+  if(( job.keys = ak_aligned_malloc( batch*sizeof( struct bckey ))) == NULL )
+    return ak_error_message( ak_error_out_of_memory, __func__,
+                                                     "incorrect memory allocation for section keys" );
+  job.section_size = section_size;
+
+  while( offset < size ) {
+    count = ak_min( batch, ( size - offset + section_size - 1 )/section_size );
+   /* последовательно вырабатываем ключи секций группы: ключ первой секции сообщения
+      совпадает с nkey, ключ первой секции каждой следующей группы вычисляется из ключа
+      последней секции предыдущей (полной) группы */
+    for( i = 0; i < count; i++ ) {
+       if(( i == 0 ) && ( offset == 0 ))
+         error = ak_bckey_create_and_set_bckey( job.keys, nkey );
+        else error = ak_bckey_acpkm_set_next_key( job.keys + i, i < created,
+                                                   job.keys + ( i > 0 ? i - 1 : batch - 1 ));
+       if( error != ak_error_ok ) {
+         ak_error_message( error, __func__, "incorrect generation of section keys" );
+         goto labex;
+       }
+       if( i >= created ) created = i+1;
+    }
+
+   /* шифруем секции группы параллельно */
+    shift = ( ak_uint64 )( offset/nkey->bsize );
+    job.ctr[0] = ctr[0] + shift;
+    job.ctr[1] = ctr[1] + (( nkey->bsize == 16 ) && ( job.ctr[0] < shift ));
+    job.in = in + offset;
+    job.out = out + offset;
+    job.size = ak_min( count*section_size, size - offset );
+    if(( error = ak_libakrypt_parallel_run( ak_bckey_ctr_acpkm_section,
+                                                             &job, count )) != ak_error_ok ) {
+      ak_error_message( error, __func__, "incorrect encryption of sections" );
+      goto labex;
+    }
+    offset += job.size;
+  }
+
+  labex:
+   for( i = 0; i < created; i++ ) ak_bckey_destroy( job.keys + i );
+   free( job.keys );
+ return error;
+}
+#endif
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! В режиме `ACPKM` для шифрования используется операция гаммирования - операция сложения
     открытого (зашифровываемого) текста с гаммой, вырабатываемой шифром, по модулю два.
@@ -147,6 +335,9 @@
   struct bckey nkey;
   int error = ak_error_ok;
   ssize_t j = 0, sections = 0, tail = 0, seclen = 0, maxseclen = 0, mcount = 0;
+#ifdef AK_LITTLE_ENDIAN
+  size_t threads = 0;
+#endif
   ak_uint64 yaout[2], *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out, ctr[2] = { 0, 0 };
 
  /* выполняем проверку размера входных данных */
@@ -201,6 +392,13 @@
        else bkey->key.resource.value.counter--;
      }
 
+#ifdef AK_LITTLE_ENDIAN
+ /* при наличии нескольких потоков большие объемы данных шифруются параллельно */
+  if(( size >= ak_acpkm_parallel_min_size ) && ( size > section_size ) &&
+     (( threads = ak_libakrypt_get_threads_count()) > 1 ))
+    return ak_bckey_ctr_acpkm_parallel( bkey, in, out, size, section_size, ctr, threads );
+#endif
+
  /* теперь размножаем исходный ключ */
   if(( error = ak_bckey_create_and_set_bckey( &nkey, bkey )) != ak_error_ok )
     return ak_error_message( error, __func__, "incorrect key duplication" );
@@ -249,6 +447,591 @@
  return error;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*                     реализация алгоритма выработки имитовставки OMAC-ACPKM                      */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вырабатывает очередной блок ключевой последовательности ACPKM-Master.
+    \details Ключевая последовательность вырабатывается в режиме CTR-ACPKM с синхропосылкой,
+    состоящей из единиц, и длиной секции \f$ T^* \f$, см. раздел 4.3 Р 1323565.1.017—2018.        */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_omac_acpkm_next_master_block( ak_omac_acpkm ictx, ak_uint64 *out )
+{
+  int error = ak_error_ok;
+
+  if( ictx->master_count == ictx->master_section_size ) {
+    if(( error = ak_bckey_next_acpkm_key( &ictx->master )) != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect generation of ACPKM-Master key" );
+    ictx->master_count = 0;
+    ictx->master_changed = ak_true;
+  }
+  ictx->master.encrypt( &ictx->master.key, ictx->ctr, out );
+  ictx->master_count++;
+
+ /* увеличиваем значение счетчика */
+  #ifdef AK_LITTLE_ENDIAN
+   if(( ictx->ctr[0] += 1 ) == 0 ) ictx->ctr[1]++;
+  #else
+   ictx->ctr[0] = bswap_64( ictx->ctr[0] ); ictx->ctr[0] += 1; ictx->ctr[0] = bswap_64( ictx->ctr[0] );
+  #endif
+
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вырабатывает ключ \f$ K^j \f$ и дополнительный ключ \f$ K^j_1 \f$
+    очередной секции сообщения.
+    \details Из ключевой последовательности ACPKM-Master последовательно извлекаются
+    \f$ k + n \f$ бит. Поскольку блоки и ключи хранятся в библиотеке в развернутом виде,
+    блоки, образующие ключ секции, записываются в обратном порядке.                                */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_omac_acpkm_next_section_key( ak_omac_acpkm ictx )
+{
+  size_t i = 0;
+  ak_uint8 key[32];
+  ak_uint64 block[2];
+  int error = ak_error_ok;
+  const size_t bsize = ictx->skey.bsize;
+
+  for( i = 0; i < sizeof( key )/bsize; i++ ) {
+     if(( error = ak_omac_acpkm_next_master_block( ictx, block )) != ak_error_ok ) goto labex;
+     memcpy( key + sizeof( key ) - ( i+1 )*bsize, block, bsize );
+  }
+  if(( error = ak_bckey_rekey( &ictx->skey, key, sizeof( key ))) != ak_error_ok ) {
+    ak_error_message( error, __func__, "incorrect assigning a section key" );
+    goto labex;
+  }
+
+ /* дополнительный ключ храним в маскированном виде */
+  block[1] = 0;
+  if(( error = ak_omac_acpkm_next_master_block( ictx, block )) != ak_error_ok ) goto labex;
+  if(( error = ak_random_ptr( &ictx->skey.key.generator,
+                                          ictx->amask, sizeof( ictx->amask ))) != ak_error_ok ) {
+    ak_error_message( error, __func__, "incorrect generation of additional key mask" );
+    goto labex;
+  }
+  ictx->akey[0] = block[0] ^ ictx->amask[0];
+  ictx->akey[1] = block[1] ^ ictx->amask[1];
+  ictx->section_count = 0;
+
+  labex:
+   memset( key, 0, sizeof( key ));
+   memset( block, 0, sizeof( block ));
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция обрабатывает заданное количество полных блоков сообщения, не являющихся
+    последним блоком, и при необходимости вырабатывает ключи новых секций.                         */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_omac_acpkm_update_blocks( ak_omac_acpkm ictx, const ak_uint8 *in, size_t blocks )
+{
+  size_t i = 0, count = 0;
+  int error = ak_error_ok;
+  ak_uint64 *inptr = (ak_uint64 *)in;
+
+  while( blocks > 0 ) {
+    if( ictx->section_count == ictx->section_size )
+      if(( error = ak_omac_acpkm_next_section_key( ictx )) != ak_error_ok )
+        return ak_error_message( error, __func__, "incorrect generation of section key" );
+
+    count = ak_min( blocks, ( ictx->section_size - ictx->section_count )/ictx->skey.bsize );
+    switch( ictx->skey.bsize ) {
+      case  8:
+        for( i = 0; i < count; i++, inptr++ ) {
+           ictx->yaout[0] ^= inptr[0];
+           ictx->skey.encrypt( &ictx->skey.key, ictx->yaout, ictx->yaout );
+        }
+        break;
+      case 16:
+        for( i = 0; i < count; i++, inptr += 2 ) {
+           ictx->yaout[0] ^= inptr[0];
+           ictx->yaout[1] ^= inptr[1];
+           ictx->skey.encrypt( &ictx->skey.key, ictx->yaout, ictx->yaout );
+        }
+        break;
+    }
+    ictx->section_count += count*ictx->skey.bsize;
+    blocks -= count;
+  }
+
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция восстанавливает исходное значение ключа ACPKM-Master и очищает
+    внутреннее состояние алгоритма.                                                                */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_omac_acpkm_reset( ak_omac_acpkm ictx )
+{
+  int error = ak_error_ok;
+
+  if( ictx->master_changed ) {
+    if(( error = ictx->key.key.unmask( &ictx->key.key )) != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect unmasking of secret key" );
+    error = ak_bckey_rekey( &ictx->master, ictx->key.key.key, ictx->key.key.key_size );
+    ictx->key.key.set_mask( &ictx->key.key );
+    if( error != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect assigning of ACPKM-Master key" );
+    ictx->master_changed = ak_false;
+  }
+
+ /* синхропосылка ACPKM-Master состоит из единиц (n/2 бит) */
+  if( ictx->key.bsize == 8 ) {
+   #ifdef AK_LITTLE_ENDIAN
+    ictx->ctr[0] = 0xffffffff00000000LL;
+   #else
+    ictx->ctr[0] = 0xffffffffLL;
+   #endif
+    ictx->ctr[1] = 0;
+  }
+   else { ictx->ctr[0] = 0; ictx->ctr[1] = 0xffffffffffffffffLL; }
+
+  ictx->master_count = 0;
+  ictx->section_count = ictx->section_size; /* ключ первой секции будет выработан позднее */
+  memset( ictx->yaout, 0, sizeof( ictx->yaout ));
+  memset( ictx->data, 0, sizeof( ictx->data ));
+  ictx->length = 0;
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция создает контекст алгоритма OMAC-ACPKM для заданного блочного шифра. */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_omac_acpkm_create( ak_omac_acpkm ictx, ak_function_bckey_create *create,
+                                                                         const char *option )
+{
+  int error = ak_error_ok;
+
+  if( ictx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                          "using null pointer to omac context" );
+  memset( ictx, 0, sizeof( struct omac_acpkm ));
+  if(( error = create( &ictx->key )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect creation of secret key" );
+  if(( error = create( &ictx->master )) != ak_error_ok ) {
+    ak_error_message( error, __func__, "incorrect creation of ACPKM-Master key" );
+    goto lab1;
+  }
+  if(( error = create( &ictx->skey )) != ak_error_ok ) {
+    ak_error_message( error, __func__, "incorrect creation of section key" );
+    goto lab2;
+  }
+  ictx->section_size = ( size_t )ak_libakrypt_get_option_by_name( option )*ictx->key.bsize;
+  ictx->master_section_size = ( size_t )ak_libakrypt_get_option_by_name( option );
+ return ak_error_ok;
+
+  lab2: ak_bckey_destroy( &ictx->master );
+  lab1: ak_bckey_destroy( &ictx->key );
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Длина секций сообщения и преобразования ACPKM-Master принимает значение, определяемое
+    опцией `acpkm_section_magma_block_count`; изменить длины секций можно с помощью
+    функции ak_omac_acpkm_set_section_size().
+
+    @param ictx Контекст алгоритма выработки имитовставки.
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_omac_acpkm_create_magma( ak_omac_acpkm ictx )
+{
+ return ak_omac_acpkm_create( ictx, ak_bckey_create_magma, "acpkm_section_magma_block_count" );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Длина секций сообщения и преобразования ACPKM-Master принимает значение, определяемое
+    опцией `acpkm_section_kuznechik_block_count`; изменить длины секций можно с помощью
+    функции ak_omac_acpkm_set_section_size().
+
+    @param ictx Контекст алгоритма выработки имитовставки.
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_omac_acpkm_create_kuznechik( ak_omac_acpkm ictx )
+{
+ return ak_omac_acpkm_create( ictx, ak_bckey_create_kuznechik,
+                                                            "acpkm_section_kuznechik_block_count" );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param ictx Контекст алгоритма выработки имитовставки.
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_omac_acpkm_destroy( ak_omac_acpkm ictx )
+{
+  int error = ak_error_ok;
+
+  if( ictx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                          "using null pointer to omac context" );
+  memset( ictx->akey, 0, sizeof( ictx->akey ));
+  memset( ictx->yaout, 0, sizeof( ictx->yaout ));
+  memset( ictx->data, 0, sizeof( ictx->data ));
+  if(( error = ak_bckey_destroy( &ictx->skey )) != ak_error_ok )
+    ak_error_message( error, __func__, "incorrect destroying of section key" );
+  if(( error = ak_bckey_destroy( &ictx->master )) != ak_error_ok )
+    ak_error_message( error, __func__, "incorrect destroying of ACPKM-Master key" );
+  if(( error = ak_bckey_destroy( &ictx->key )) != ak_error_ok )
+    ak_error_message( error, __func__, "incorrect destroying of secret key" );
+
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param ictx Контекст алгоритма выработки имитовставки.
+    @param ptr Указатель на область памяти, содержащую значение ключа.
+    @param size Размер ключа в октетах (32 октета).
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_omac_acpkm_set_key( ak_omac_acpkm ictx, const ak_pointer ptr, const size_t size )
+{
+  int error = ak_error_ok;
+
+  if( ictx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                          "using null pointer to omac context" );
+  if(( error = ak_bckey_set_key( &ictx->key, ptr, size )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect assigning a secret key value" );
+  ictx->master_changed = ak_true;
+
+ return ak_omac_acpkm_reset( ictx );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param ictx Контекст алгоритма выработки имитовставки.
+    @param generator Генератор, используемый для выработки ключа.
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_omac_acpkm_set_key_random( ak_omac_acpkm ictx, ak_random generator )
+{
+  int error = ak_error_ok;
+
+  if( ictx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                          "using null pointer to omac context" );
+  if(( error = ak_bckey_set_key_random( &ictx->key, generator )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect generation of secret key value" );
+  ictx->master_changed = ak_true;
+
+ return ak_omac_acpkm_reset( ictx );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param ictx Контекст алгоритма выработки имитовставки.
+    @param pass Пароль, представленный в виде строки символов.
+    @param pass_size Длина пароля в байтах.
+    @param salt Случайный вектор, представленный в виде строки символов.
+    @param salt_size Длина случайного вектора в байтах.
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_omac_acpkm_set_key_from_password( ak_omac_acpkm ictx, const ak_pointer pass,
+                             const size_t pass_size, const ak_pointer salt, const size_t salt_size )
+{
+  int error = ak_error_ok;
+
+  if( ictx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                          "using null pointer to omac context" );
+  if(( error = ak_bckey_set_key_from_password( &ictx->key,
+                                             pass, pass_size, salt, salt_size )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect generation of secret key value" );
+  ictx->master_changed = ak_true;
+
+ return ak_omac_acpkm_reset( ictx );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция изменяет параметры \f$ N \f$ и \f$ T^* \f$ алгоритма и очищает его внутреннее
+    состояние. Обе величины должны быть кратны длине блока и не должны превосходить значения,
+    определяемого опцией `acpkm_section_magma_block_count` или
+    `acpkm_section_kuznechik_block_count` соответственно.
+
+    @param ictx Контекст алгоритма выработки имитовставки.
+    @param section_size Длина секции сообщения \f$ N \f$ в октетах.
+    @param master_section_size Длина секции \f$ T^* \f$ преобразования ACPKM-Master в октетах.
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_omac_acpkm_set_section_size( ak_omac_acpkm ictx, const size_t section_size,
+                                                                const size_t master_section_size )
+{
+  size_t maxseclen = 0;
+
+  if( ictx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                          "using null pointer to omac context" );
+  if(( !section_size ) || ( !master_section_size ) ||
+     ( section_size%ictx->key.bsize ) || ( master_section_size%ictx->key.bsize ))
+    return ak_error_message( ak_error_wrong_block_cipher_length,
+                               __func__ , "the length of section is not divided by block length" );
+  maxseclen = ( size_t )ak_libakrypt_get_option_by_name( ictx->key.bsize == 8 ?
+                       "acpkm_section_magma_block_count" : "acpkm_section_kuznechik_block_count" );
+  if(( section_size/ictx->key.bsize > maxseclen ) ||
+     ( master_section_size/ictx->key.bsize > maxseclen ))
+    return ak_error_message( ak_error_wrong_length, __func__, "section has very large length" );
+
+  ictx->section_size = section_size;
+  ictx->master_section_size = master_section_size/ictx->key.bsize;
+ return ak_omac_acpkm_clean( ictx );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param ictx Контекст алгоритма выработки имитовставки.
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_omac_acpkm_clean( ak_omac_acpkm ictx )
+{
+  if( ictx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                          "using null pointer to omac context" );
+  if( !( ictx->key.key.flags&ak_key_flag_set_key ))
+    return ak_error_message( ak_error_key_value, __func__,
+                                                     "using omac context with undefined key" );
+ return ak_omac_acpkm_reset( ictx );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! В отличие от функции ak_bckey_cmac_update(), длина обрабатываемых данных может быть
+    произвольной. Последний блок данных всегда сохраняется во внутреннем буффере и
+    обрабатывается при вызове функции ak_omac_acpkm_finalize().
+
+    @param ictx Контекст алгоритма выработки имитовставки.
+    @param in Указатель на обрабатываемые данные.
+    @param size Длина данных в октетах.
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_omac_acpkm_update( ak_omac_acpkm ictx, const ak_pointer in, const size_t size )
+{
+  int error = ak_error_ok;
+  size_t offset = 0, blocks = 0, newsize = size;
+  const ak_uint8 *ptrin = (const ak_uint8 *)in;
+
+  if( ictx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                          "using null pointer to omac context" );
+  if( !size ) return ak_error_ok;
+  if( in == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                               "using null pointer to input data" );
+ /* дополняем буффер */
+  offset = ak_min( ictx->skey.bsize - ictx->length, newsize );
+  memcpy( ictx->data + ictx->length, ptrin, offset );
+  ictx->length += offset;
+  ptrin += offset;
+  if(( newsize -= offset ) == 0 ) return ak_error_ok;
+
+ /* буффер заполнен и не содержит последний блок сообщения */
+  if(( error = ak_omac_acpkm_update_blocks( ictx, ictx->data, 1 )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect updating of internal buffer" );
+
+ /* обрабатываем данные без копирования, оставляя последний блок */
+  if(( blocks = ( newsize - 1 )/ictx->skey.bsize ) > 0 ) {
+    if(( error = ak_omac_acpkm_update_blocks( ictx, ptrin, blocks )) != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect updating of input data" );
+    ptrin += blocks*ictx->skey.bsize;
+    newsize -= blocks*ictx->skey.bsize;
+  }
+  memset( ictx->data, 0, sizeof( ictx->data ));
+  memcpy( ictx->data, ptrin, ictx->length = newsize );
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Последний блок сообщения складывается с дополнительным ключом \f$ K^l_1 \f$ той секции,
+    которой он принадлежит. Если последний блок неполон, то он дополняется по правилу
+    \f$ 10\ldots0 \f$, а в качестве дополнительного ключа используется произведение
+    \f$ K^l_1 \f$ на многочлен \f$ x \f$, как это делается в ГОСТ Р 34.13-2015.
+
+    После вызова функции повторное вычисление имитовставки возможно только после вызова
+    ak_omac_acpkm_clean().
+
+    @param ictx Контекст алгоритма выработки имитовставки.
+    @param in Указатель на последний фрагмент данных.
+    @param size Длина фрагмента в октетах (может быть равна нулю).
+    @param out Область памяти, куда помещается имитовставка.
+    @param out_size Ожидаемый размер имитовставки (не более длины блока).
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_omac_acpkm_finalize( ak_omac_acpkm ictx, const ak_pointer in, const size_t size,
+                                                           ak_pointer out, const size_t out_size )
+{
+  size_t i = 0;
+  int error = ak_error_ok;
+  ak_uint64 keys[2], result[2], *yaout = NULL;
+  ak_int64 oc = ak_libakrypt_get_option_by_name( "openssl_compability" );
+  ak_uint64
+      #ifdef AK_LITTLE_ENDIAN
+        one64[2] = { 0x02, 0x00 };
+      #else
+        one64[2] = { 0x0200000000000000LL, 0x00 };
+      #endif
+
+  if( ictx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                          "using null pointer to omac context" );
+  if( out == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                           "using null pointer to result buffer" );
+  if( !out_size ) return ak_error_message( ak_error_zero_length, __func__,
+                                                            "using zero length of result buffer" );
+  if(( error = ak_omac_acpkm_update( ictx, in, size )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect updating of input data" );
+
+ /* последний блок может начинать новую секцию */
+  if( ictx->section_count == ictx->section_size )
+    if(( error = ak_omac_acpkm_next_section_key( ictx )) != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect generation of section key" );
+
+ /* вычисляем дополнительный ключ */
+  keys[0] = ictx->akey[0] ^ ictx->amask[0];
+  keys[1] = ictx->akey[1] ^ ictx->amask[1];
+  yaout = ictx->yaout;
+  switch( ictx->skey.bsize ) {
+    case  8:
+      if( oc ) keys[0] = bswap_64( keys[0] );
+      if( ictx->length < 8 ) {
+        ak_gf64_mul( keys, keys, one64 );
+        ((ak_uint8 *)keys)[ictx->length] ^= 0x80;
+      }
+      if( oc ) {
+        yaout[0] ^= bswap_64( keys[0] );
+        for( i = 0; i < ictx->length; i++ )
+           ((ak_uint8 *)yaout)[7-i] ^= ictx->data[ictx->length-1-i];
+      }
+       else {
+        yaout[0] ^= keys[0];
+        for( i = 0; i < ictx->length; i++ ) ((ak_uint8 *)yaout)[i] ^= ictx->data[i];
+       }
+      break;
+
+    case 16:
+      if( oc ) {
+        ak_uint64 tmp = bswap_64( keys[0] );
+        keys[0] = bswap_64( keys[1] );
+        keys[1] = tmp;
+      }
+      if( ictx->length < 16 ) {
+        ak_gf128_mul( keys, keys, one64 );
+        ((ak_uint8 *)keys)[ictx->length] ^= 0x80;
+      }
+      if( oc ) {
+        yaout[0] ^= bswap_64( keys[1] );
+        yaout[1] ^= bswap_64( keys[0] );
+        for( i = 0; i < ictx->length; i++ )
+           ((ak_uint8 *)yaout)[15-i] ^= ictx->data[ictx->length-1-i];
+      }
+       else {
+        yaout[0] ^= keys[0];
+        yaout[1] ^= keys[1];
+        for( i = 0; i < ictx->length; i++ ) ((ak_uint8 *)yaout)[i] ^= ictx->data[i];
+       }
+      break;
+  }
+  memset( keys, 0, sizeof( keys ));
+  ictx->skey.encrypt( &ictx->skey.key, yaout, result );
+
+ /* копируем нужную часть результата */
+  if( oc ) memcpy( out, (ak_uint8 *)result, ak_min( out_size, ictx->skey.bsize ));
+   else memcpy( out, (ak_uint8 *)result +
+               ( out_size > ictx->skey.bsize ? 0 : ictx->skey.bsize - out_size ),
+                                                             ak_min( out_size, ictx->skey.bsize ));
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param ictx Контекст алгоритма выработки имитовставки.
+    @param in Указатель на данные, для которых вычисляется имитовставка.
+    @param size Длина данных в октетах.
+    @param out Область памяти, куда помещается имитовставка.
+    @param out_size Ожидаемый размер имитовставки (не более длины блока).
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_omac_acpkm_ptr( ak_omac_acpkm ictx, const ak_pointer in, const size_t size,
+                                                           ak_pointer out, const size_t out_size )
+{
+  int error = ak_error_ok;
+
+  if(( error = ak_omac_acpkm_clean( ictx )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect cleaning of omac context" );
+ return ak_omac_acpkm_finalize( ictx, in, size, out, out_size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция проверяет корректность реализации алгоритма OMAC-ACPKM.
+    \details Значение имитовставки сравнивается с контрольным примером из раздела A.2
+    RFC 8645 (Р 1323565.1.017-2018): длина секции \f$ N \f$ равна двум блокам, длина секции
+    ACPKM-Master \f$ T^* \f$ равна 768 бит для алгоритма Кузнечик и 640 бит для алгоритма Магма.
+    Контрольный пример проверяется в базовом режиме работы библиотеки, независимо от значения
+    опции `openssl_compability`. Также проверяется, что вычисление имитовставки
+    фрагментами произвольной длины приводит к тому же результату.
+
+    \param create Функция создания ключа блочного шифрования.
+    \param algorithm Имя алгоритма блочного шифрования.
+    \param message Сообщение из контрольного примера (блоки развернуты в обратном порядке).
+    \param size Длина сообщения в октетах.
+    \param icode Ожидаемое значение имитовставки (развернуто в обратном порядке).
+    \param master Длина секции ACPKM-Master в октетах.
+    \return Функция возвращает \ref ak_true в случае успешного тестирования.                    */
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t ak_libakrypt_test_omac_acpkm( ak_function_bckey_create *create,
+                         const char *algorithm, const ak_uint8 *message, const size_t size,
+                                                   const ak_uint8 *icode, const size_t master )
+{
+  struct omac_acpkm ictx;
+  size_t i = 0, j = 0, bsize = 0, offset = 0;
+  int error = ak_error_ok, audit = ak_log_get_level(),
+      oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
+  ak_uint8 in[131], out[16], out2[16];
+  ak_uint8 skeyval[32] = {
+    0xef, 0xcd, 0xab, 0x89, 0x67, 0x45, 0x23, 0x01, 0x10, 0x32, 0x54, 0x76, 0x98, 0xba, 0xdc, 0xfe,
+    0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x00, 0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88
+  };
+
+  for( i = 0; i < sizeof( in ); i++ ) in[i] = (ak_uint8)( 7*i+1 );
+
+ /* контрольный пример проверяется в базовом режиме работы библиотеки */
+  ak_libakrypt_set_openssl_compability( ak_false );
+  if(( error = create == ak_bckey_create_magma ? ak_omac_acpkm_create_magma( &ictx ) :
+                                         ak_omac_acpkm_create_kuznechik( &ictx )) != ak_error_ok ) {
+    ak_error_message( error, __func__, "incorrect creation of omac context" ); goto ex1; }
+  bsize = ictx.skey.bsize;
+  if(( error = ak_omac_acpkm_set_key( &ictx, skeyval, sizeof( skeyval ))) != ak_error_ok ) {
+    ak_error_message( error, __func__, "incorrect assigning a key value" ); goto ex2; }
+  if(( error = ak_omac_acpkm_set_section_size( &ictx, 2*bsize, master )) != ak_error_ok ) {
+    ak_error_message( error, __func__, "incorrect setting of section size" ); goto ex2; }
+
+ /* 1. проверяем контрольный пример */
+  if(( error = ak_omac_acpkm_ptr( &ictx, ( ak_pointer )message, size, out, bsize )) != ak_error_ok ) {
+    ak_error_message( error, __func__, "incorrect evaluation of omac-acpkm" ); goto ex2; }
+  if( memcmp( out, icode, bsize ) != 0 ) {
+    ak_error_message_fmt( error = ak_error_not_equal_data, __func__,
+                            "incorrect omac-acpkm value for %s cipher", algorithm ); goto ex2; }
+
+ /* 2. вычисляем имитовставку фрагментами различной длины */
+  if(( error = ak_omac_acpkm_ptr( &ictx, in, sizeof( in ), out, bsize )) != ak_error_ok ) {
+    ak_error_message( error, __func__, "incorrect evaluation of omac-acpkm" ); goto ex2; }
+  for( j = 1; j <= bsize+1; j++ ) {
+     ak_omac_acpkm_clean( &ictx );
+     for( offset = 0; offset + j < sizeof( in ); offset += j )
+        if(( error = ak_omac_acpkm_update( &ictx, in + offset, j )) != ak_error_ok ) goto ex2;
+     if(( error = ak_omac_acpkm_finalize( &ictx, in + offset, sizeof( in ) - offset,
+                                                              out2, bsize )) != ak_error_ok ) goto ex2;
+     if( memcmp( out, out2, bsize ) != 0 ) {
+       ak_error_message_fmt( error = ak_error_not_equal_data, __func__,
+            "incorrect omac-acpkm value for %u byte fragments of data", (unsigned int) j ); goto ex2; }
+  }
+
+  if( audit >= ak_log_maximum ) ak_error_message_fmt( ak_error_ok, __func__ ,
+                                                 "omac-acpkm test for %s is Ok", algorithm );
+  ex2: ak_omac_acpkm_destroy( &ictx );
+  ex1: ak_libakrypt_set_openssl_compability( oc );
+  if( error != ak_error_ok ) {
+    ak_error_message_fmt( ak_error_ok, __func__ , "omac-acpkm test for %s is wrong", algorithm );
+    return ak_false;
+  }
+ return ak_true;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
  bool_t ak_libakrypt_test_acpkm( void )
 {
@@ -298,6 +1081,13 @@
     0xc1, 0x72, 0xca, 0x3f, 0x5b, 0xf1, 0xa2, 0x84
   };
 
+ /* значения имитовставки OMAC-ACPKM из раздела A.2 RFC 8645 для первых пяти блоков
+    открытого текста (по сравнению с текстом рекомендаций значения развернуты) */
+  ak_uint8 omac1[16] = {
+    0x5d, 0x8e, 0x89, 0x00, 0x57, 0x8c, 0xf5, 0x35, 0x7c, 0xa6, 0xbe, 0x45, 0xee, 0xdc, 0xb8, 0xfb
+  };
+  ak_uint8 omac2[8] = { 0x8e, 0xbb, 0x96, 0x54, 0xad, 0x8d, 0x00, 0x34 };
+
  /* 1. Выполняем тест для алгоритма Магма */
   if(( error = ak_bckey_create_magma( &key )) != ak_error_ok ) {
     ak_error_message( error, __func__, "incorrect creation of magma secret key" );
@@ -364,6 +1154,14 @@
     return ak_false;
   }
 
+ /* 3. Выполняем тест для алгоритма выработки имитовставки OMAC-ACPKM */
+  if( ak_libakrypt_test_omac_acpkm( ak_bckey_create_magma, "magma",
+                                                           in2, 40, omac2, 80 ) != ak_true )
+    return ak_false;
+  if( ak_libakrypt_test_omac_acpkm( ak_bckey_create_kuznechik, "kuznechik",
+                                                           in1, 80, omac1, 96 ) != ak_true )
+    return ak_false;
+
  return ak_true;
 }
 
@@ -0,0 +1,428 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  Copyright (c) 2020 by Axel Kenzo, axelkenzo@mail.ru                                            */
+/*                                                                                                 */
+/*  Файл ak_aead.c                                                                                 */
+/*  - содержит реализацию потокового аутентифицированного шифрования данных                        */
+/*    в режимах ctr-cmac и ctr-hmac, а также общих функций для потоковых контекстов                */
+/* ----------------------------------------------------------------------------------------------- */
+ #include <libakrypt-internal.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Длина участка данных, который зашифровывается и аутентифицируется за один шаг.
+    \details Участок целиком размещается в кэш-памяти первого уровня, поэтому при выработке
+    имитовставки данные повторно из оперативной памяти не считываются. */
+ #define ak_aead_stream_piece_size              (8192)
+/*! \brief Флаг того, что синхропосылка режима гаммирования уже использована. */
+ #define ak_aead_stream_counter_bit              (0x4)
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                           общие функции для потоковых контекстов                                */
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция определяет режим шифрования по заданному идентификатору и вызывает одну из функций
+    ak_bckey_xtsmac_stream_clean(), ak_bckey_ctr_cmac_stream_clean() или
+    ak_bckey_ctr_hmac_stream_clean().
+
+    @param ctx Контекст потокового шифрования.
+    @param oid Идентификатор режима аутентифицированного шифрования.
+    @param encryptionKey Ключ шифрования.
+    @param authenticationKey Ключ выработки имитовставки.
+    @param iv Указатель на синхропосылку.
+    @param iv_size Длина синхропосылки в октетах.
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_aead_stream_clean( ak_aead_stream ctx, ak_oid oid, ak_pointer encryptionKey,
+                         ak_pointer authenticationKey, const ak_pointer iv, const size_t iv_size )
+{
+  if( oid == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                             "using null pointer to aead oid" );
+  if(( oid->engine != block_cipher ) || ( oid->mode != aead ))
+    return ak_error_message( ak_error_oid_mode, __func__, "using oid with wrong mode" );
+
+  if( oid->func.direct == ( ak_function_run_object *) ak_bckey_encrypt_xtsmac )
+    return ak_bckey_xtsmac_stream_clean( ctx, encryptionKey, authenticationKey, iv, iv_size );
+  if( oid->func.direct == ( ak_function_run_object *) ak_bckey_encrypt_ctr_cmac )
+    return ak_bckey_ctr_cmac_stream_clean( ctx, encryptionKey, authenticationKey, iv, iv_size );
+  if( oid->func.direct == ( ak_function_run_object *) ak_bckey_encrypt_ctr_hmac )
+    return ak_bckey_ctr_hmac_stream_clean( ctx, encryptionKey, authenticationKey, iv, iv_size );
+
+ return ak_error_message_fmt( ak_error_oid_mode, __func__,
+                                  "stream processing is not supported for %s mode", oid->name[0] );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Ассоциированные данные должны быть переданы в контекст до начала обработки шифруемых данных.
+
+    @param ctx Контекст потокового шифрования.
+    @param adata Указатель на фрагмент ассоциированных данных.
+    @param size Длина фрагмента в октетах.
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_aead_stream_authenticate( ak_aead_stream ctx, const ak_pointer adata, const size_t size )
+{
+  if( ctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                         "using null pointer to stream context" );
+  if( ctx->authenticate == NULL ) return ak_error_message( ak_error_undefined_function, __func__,
+                                                       "using uninitialized stream context" );
+  if( ctx->flags&ak_aead_assosiated_data_bit )
+    return ak_error_message( ak_error_wrong_block_cipher_function, __func__,
+                                        "associated data must be processed before encrypted data" );
+  if(( adata == NULL ) || ( size == 0 )) return ak_error_ok;
+
+ return ctx->authenticate( ctx, adata, size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param ctx Контекст потокового шифрования.
+    @param in Указатель на фрагмент зашифровываемых данных.
+    @param out Указатель на область памяти, куда помещаются зашифрованные данные;
+    указатель может совпадать с указателем `in`.
+    @param size Длина фрагмента в октетах; если длина фрагмента не кратна длине блока,
+    то фрагмент должен быть последним.
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_aead_stream_encrypt( ak_aead_stream ctx, const ak_pointer in, ak_pointer out,
+                                                                                const size_t size )
+{
+  if( ctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                         "using null pointer to stream context" );
+  if( ctx->encrypt == NULL ) return ak_error_message( ak_error_undefined_function, __func__,
+                                                       "using uninitialized stream context" );
+  ctx->flags |= ak_aead_assosiated_data_bit;
+  if(( in == NULL ) || ( size == 0 )) return ak_error_ok;
+
+ return ctx->encrypt( ctx, in, out, size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param ctx Контекст потокового шифрования.
+    @param in Указатель на фрагмент расшифровываемых данных.
+    @param out Указатель на область памяти, куда помещаются расшифрованные данные;
+    указатель может совпадать с указателем `in`.
+    @param size Длина фрагмента в октетах; если длина фрагмента не кратна длине блока,
+    то фрагмент должен быть последним.
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_aead_stream_decrypt( ak_aead_stream ctx, const ak_pointer in, ak_pointer out,
+                                                                                const size_t size )
+{
+  if( ctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                         "using null pointer to stream context" );
+  if( ctx->decrypt == NULL ) return ak_error_message( ak_error_undefined_function, __func__,
+                                                       "using uninitialized stream context" );
+  ctx->flags |= ak_aead_assosiated_data_bit;
+  if(( in == NULL ) || ( size == 0 )) return ak_error_ok;
+
+ return ctx->decrypt( ctx, in, out, size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! После выработки имитовставки контекст очищается; для обработки следующего сообщения
+    контекст должен быть заново инициализирован.
+
+    @param ctx Контекст потокового шифрования.
+    @param icode Указатель на область памяти, куда помещается имитовставка.
+    @param icode_size Ожидаемый размер имитовставки в октетах.
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_aead_stream_finalize( ak_aead_stream ctx, ak_pointer icode, const size_t icode_size )
+{
+  int error = ak_error_ok;
+
+  if( ctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                         "using null pointer to stream context" );
+  if( ctx->finalize == NULL ) return ak_error_message( ak_error_undefined_function, __func__,
+                                                       "using uninitialized stream context" );
+  error = ctx->finalize( ctx, icode, icode_size );
+  memset( ctx, 0, sizeof( struct aead_stream ));
+
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                          потоковая обработка данных в режимах ctr-xxx                           */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция гаммирования очередного участка данных.
+    \details Текущее значение счетчика хранится в потоковом контексте и восстанавливается перед
+    каждым вызовом, поэтому ключ шифрования может использоваться между вызовами функции
+    (в частности, совпадать с ключом выработки имитовставки).                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_aead_stream_ctr( ak_aead_stream ctx, ak_uint8 *in, ak_uint8 *out, size_t size )
+{
+  int error = ak_error_ok;
+  ak_bckey ekey = ( ak_bckey )ctx->encryptionKey;
+
+  if( ctx->flags&ak_aead_stream_counter_bit ) {
+    memcpy( ekey->ivector, ctx->ivector, ekey->bsize );
+    ekey->key.flags &= ~ak_key_flag_not_ctr;
+    error = ak_bckey_ctr( ekey, in, out, size, NULL, 0 );
+  } else {
+     error = ak_bckey_ctr( ekey, in, out, size, ctx->ivector, ctx->ivector_size );
+     ctx->flags |= ak_aead_stream_counter_bit;
+    }
+  memcpy( ctx->ivector, ekey->ivector, ekey->bsize );
+
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Общая часть шифрования в режимах ctr-cmac и ctr-hmac.
+    \details Данные обрабатываются участками длины \ref ak_aead_stream_piece_size: каждый участок
+    открытого текста аутентифицируется и гаммируется сразу после считывания в кэш-память. */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_aead_stream_ctr_mac( ak_aead_stream ctx, const ak_pointer in, ak_pointer out,
+                                                         const size_t size, const bool_t decrypt )
+{
+  size_t len = 0, done = 0;
+  int error = ak_error_ok;
+  ak_uint8 *inptr = ( ak_uint8 *)in, *outptr = ( ak_uint8 *)out;
+
+  if( ctx->flags&ak_aead_encrypted_data_bit )
+    return ak_error_message( ak_error_wrong_block_cipher_function, __func__ ,
+                                               "attemp to update previously closed stream context");
+  if(( ctx->encryptionKey != NULL ) && ( out == NULL ))
+    return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                          "using null pointer to output buffer" );
+  for( done = 0; done < size; done += len ) {
+     len = ak_min( size - done, ak_aead_stream_piece_size );
+     if( !decrypt && ( ctx->authenticationKey != NULL ))
+       if(( error = ctx->authenticate( ctx, inptr + done, len )) != ak_error_ok ) return error;
+     if( ctx->encryptionKey != NULL )
+       if(( error = ak_aead_stream_ctr( ctx, inptr + done, outptr + done, len )) != ak_error_ok )
+         return ak_error_message( error, __func__, "incorrect data encryption" );
+     if( decrypt && ( ctx->authenticationKey != NULL ))
+       if(( error = ctx->authenticate( ctx, ctx->encryptionKey ? outptr + done : inptr + done,
+                                                                   len )) != ak_error_ok ) return error;
+  }
+ /* данные, длина которых не кратна длине блока, завершают сообщение */
+  if(( ctx->encryptionKey != NULL ) && ( size%(( ak_bckey )ctx->encryptionKey )->bsize ))
+    ak_aead_set_bit( ctx->flags, ak_aead_encrypted_data_bit );
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_aead_stream_ctr_encrypt( ak_aead_stream ctx,
+                                          const ak_pointer in, ak_pointer out, const size_t size )
+{
+  return ak_aead_stream_ctr_mac( ctx, in, out, size, ak_false );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_aead_stream_ctr_decrypt( ak_aead_stream ctx,
+                                          const ak_pointer in, ak_pointer out, const size_t size )
+{
+  return ak_aead_stream_ctr_mac( ctx, in, out, size, ak_true );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Проверка ключей и сохранение синхропосылки в потоковом контексте. */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_aead_stream_ctr_clean( ak_aead_stream ctx, ak_pointer encryptionKey,
+                         ak_pointer authenticationKey, const ak_pointer iv, const size_t iv_size )
+{
+  if( ctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                         "using null pointer to stream context" );
+  if(( encryptionKey == NULL ) && ( authenticationKey == NULL ))
+    return ak_error_message( ak_error_null_pointer, __func__ ,
+                                "using null pointers both to encryption and authentication keys" );
+  if( encryptionKey != NULL ) {
+    if( ((ak_bckey)encryptionKey)->key.oid->engine != block_cipher )
+      return ak_error_message( ak_error_oid_engine, __func__ ,
+                                                "using non block cipher key for data encryption" );
+    if(( iv == NULL ) || ( iv_size == 0 ))
+      return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                          "using null pointer to initial vector" );
+  }
+  memset( ctx, 0, sizeof( struct aead_stream ));
+  if( encryptionKey != NULL )
+    memcpy( ctx->ivector, iv, ( ctx->ivector_size = ak_min( iv_size, sizeof( ctx->ivector ))));
+  ctx->encryptionKey = encryptionKey;
+  ctx->authenticationKey = authenticationKey;
+  ctx->encrypt = ak_aead_stream_ctr_encrypt;
+  ctx->decrypt = ak_aead_stream_ctr_decrypt;
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                            потоковая обработка данных в режиме ctr-cmac                         */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Обновление имитовставки для данных, длина которых кратна длине блока.
+    \details Текущее значение сцепления хранится в потоковом контексте, поэтому ключ выработки
+    имитовставки может совпадать с ключом шифрования.                                             */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_aead_stream_cmac_blocks( ak_aead_stream ctx, const ak_uint8 *in, const size_t size )
+{
+  int error = ak_error_ok;
+  ak_bckey akey = ( ak_bckey )ctx->authenticationKey;
+
+  memcpy( akey->ivector, ctx->state, akey->bsize );
+  error = ak_bckey_cmac_update( akey, ( ak_pointer )in, size );
+  memcpy( ctx->state, akey->ivector, akey->bsize );
+
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Обработка данных произвольной длины алгоритмом выработки имитовставки.
+    \details Последний блок данных всегда сохраняется в буффере, поскольку он обрабатывается
+    отдельно при завершении вычислений.                                                            */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_aead_stream_cmac_authenticate( ak_aead_stream ctx,
+                                                     const ak_pointer adata, const size_t size )
+{
+  size_t len = 0, rest = size, bsize = 0;
+  int error = ak_error_ok;
+  const ak_uint8 *inptr = ( const ak_uint8 *)adata;
+
+  if( ctx->authenticationKey == NULL ) return ak_error_ok;
+  bsize = (( ak_bckey )ctx->authenticationKey )->bsize;
+
+  while( rest > 0 ) {
+    /* за буффером следуют данные, следовательно, он не является последним блоком */
+     if( ctx->buflen == bsize ) {
+       if(( error = ak_aead_stream_cmac_blocks( ctx, ctx->buffer, bsize )) != ak_error_ok )
+         return ak_error_message( error, __func__, "incorrect updating of integrity code" );
+       ctx->buflen = 0;
+     }
+    /* обрабатываем все полные блоки, кроме последнего, без копирования */
+     if(( ctx->buflen == 0 ) && ( rest > bsize )) {
+       len = (( rest - 1 )/bsize )*bsize;
+       if(( error = ak_aead_stream_cmac_blocks( ctx, inptr, len )) != ak_error_ok )
+         return ak_error_message( error, __func__, "incorrect updating of integrity code" );
+       inptr += len; rest -= len;
+       continue;
+     }
+     len = ak_min( bsize - ctx->buflen, rest );
+     memcpy( ctx->buffer + ctx->buflen, inptr, len );
+     ctx->buflen += len; inptr += len; rest -= len;
+  }
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_aead_stream_cmac_finalize( ak_aead_stream ctx, ak_pointer out, const size_t out_size )
+{
+  int error = ak_error_ok;
+  ak_bckey akey = ( ak_bckey )ctx->authenticationKey;
+
+  if( akey == NULL ) return ak_error_ok;
+  if( ctx->buflen == 0 ) return ak_error_message( ak_error_zero_length, __func__,
+                                                                 "using a data with zero length" );
+  memcpy( akey->ivector, ctx->state, akey->bsize );
+  error = ak_bckey_cmac_finalize( akey, ctx->buffer, ctx->buflen, out, out_size );
+  memset( akey->ivector, 0, akey->bsize );
+
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция подготавливает контекст к обработке нового сообщения в режиме `ctr-cmac`.
+    Имитовставка вычисляется для последовательного объединения ассоциированных данных и
+    открытого текста; фрагменты ассоциированных данных могут иметь произвольную длину,
+    а длины всех фрагментов шифруемых данных, кроме последнего, должны быть кратны
+    длине блока. В отличие от функции ak_bckey_encrypt_ctr_cmac() ассоциированные и шифруемые
+    данные могут располагаться в памяти произвольным образом.
+
+    Требования к ключам аналогичны требованиям функции ak_bckey_encrypt_ctr_cmac();
+    в частности, один из ключей может принимать значение `NULL`.
+
+    @param ctx Контекст потокового шифрования.
+    @param encryptionKey Ключ шифрования (указатель на struct bckey).
+    @param authenticationKey Ключ выработки имитовставки (указатель на struct bckey).
+    @param iv Указатель на синхропосылку.
+    @param iv_size Длина синхропосылки в октетах.
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_ctr_cmac_stream_clean( ak_aead_stream ctx, ak_pointer encryptionKey,
+                         ak_pointer authenticationKey, const ak_pointer iv, const size_t iv_size )
+{
+  int error = ak_error_ok;
+
+  if(( encryptionKey != NULL ) && ( authenticationKey != NULL )) {
+    if( ((ak_bckey)encryptionKey)->bsize != ((ak_bckey)authenticationKey)->bsize )
+      return ak_error_message( ak_error_wrong_length, __func__,
+                                                           "different block sizes for given keys");
+  }
+  if(( authenticationKey != NULL ) &&
+                              ((ak_bckey)authenticationKey)->key.oid->engine != block_cipher )
+    return ak_error_message( ak_error_oid_engine, __func__ ,
+                                             "using non block cipher key for checking integrity" );
+  if(( error = ak_aead_stream_ctr_clean( ctx, encryptionKey,
+                                             authenticationKey, iv, iv_size )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect initialization of stream context" );
+
+  ctx->authenticate = ak_aead_stream_cmac_authenticate;
+  ctx->finalize = ak_aead_stream_cmac_finalize;
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                            потоковая обработка данных в режиме ctr-hmac                         */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_aead_stream_hmac_authenticate( ak_aead_stream ctx,
+                                                     const ak_pointer adata, const size_t size )
+{
+  int error = ak_error_ok;
+
+  if( ctx->authenticationKey == NULL ) return ak_error_ok;
+  if(( error = ak_hmac_update( ctx->authenticationKey, adata, size )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect updating of integrity code" );
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_aead_stream_hmac_finalize( ak_aead_stream ctx, ak_pointer out, const size_t out_size )
+{
+  if( ctx->authenticationKey == NULL ) return ak_error_ok;
+ return ak_hmac_finalize( ctx->authenticationKey, NULL, 0, out, out_size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция подготавливает контекст к обработке нового сообщения в режиме `ctr-hmac`.
+    Фрагменты ассоциированных данных могут иметь произвольную длину,
+    а длины всех фрагментов шифруемых данных, кроме последнего, должны быть кратны
+    длине блока алгоритма шифрования.
+
+    Требования к ключам аналогичны требованиям функции ak_bckey_encrypt_ctr_hmac().
+
+    @param ctx Контекст потокового шифрования.
+    @param encryptionKey Ключ шифрования (указатель на struct bckey).
+    @param authenticationKey Ключ выработки имитовставки (указатель на struct hmac).
+    @param iv Указатель на синхропосылку.
+    @param iv_size Длина синхропосылки в октетах.
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_ctr_hmac_stream_clean( ak_aead_stream ctx, ak_pointer encryptionKey,
+                         ak_pointer authenticationKey, const ak_pointer iv, const size_t iv_size )
+{
+  int error = ak_error_ok;
+
+  if( authenticationKey != NULL ) {
+    if( ((ak_hmac)authenticationKey)->key.oid->engine != hmac_function )
+      return ak_error_message( ak_error_oid_engine, __func__ ,
+                                                 "using non hmac key for checking data integrity" );
+    if(( error = ak_hmac_clean( authenticationKey )) != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect cleaning of hmac secret key context" );
+  }
+  if(( error = ak_aead_stream_ctr_clean( ctx, encryptionKey,
+                                             authenticationKey, iv, iv_size )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect initialization of stream context" );
+
+  ctx->authenticate = ak_aead_stream_hmac_authenticate;
+  ctx->finalize = ak_aead_stream_hmac_finalize;
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                                                                                      ak_aead.c  */
+/* ----------------------------------------------------------------------------------------------- */
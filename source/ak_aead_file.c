@@ -0,0 +1,597 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  Copyright (c) 2020 by Axel Kenzo, axelkenzo@mail.ru                                            */
+/*                                                                                                 */
+/*  Файл ak_aead_file.c                                                                            */
+/*  - содержит реализацию аутентифицированного шифрования данных, разбитых на фрагменты,           */
+/*    а также функций чтения произвольных фрагментов зашифрованных файлов                          */
+/* ----------------------------------------------------------------------------------------------- */
+ #include <libakrypt-internal.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+/*  Зашифрованные данные состоят из заголовка, последовательности фрагментов и завершающей
+    записи (индекса). Заголовок содержит (все целые числа записываются в little-endian формате):
+
+     - 8 октетов - сигнатура формата "akchunk1",
+     - 4 октета - длина фрагмента открытого текста,
+     - 4 октета - количество итераций алгоритма PBKDF2,
+     - 64 октета - имя режима аутентифицированного шифрования (строка, дополненная нулями),
+     - 16 октетов - соль, используемая для выработки мастер-ключа из пароля,
+     - 16 октетов - синхропосылка (для 64-х битных шифров используются только первые 8 октетов),
+     - 16 октетов - зарезервировано (заполняется нулями).
+
+    Для k-го фрагмента используются ключи шифрования и имитозащиты, вырабатываемые из мастер-ключа
+    путем зашифрования номера фрагмента (аналогично преобразованию ACPKM), синхропосылка,
+    младшие 8 октетов которой складываются по модулю 2 с номером фрагмента, а также
+    ассоциированные данные, состоящие из заголовка и признака последнего фрагмента.
+
+    Завершающая запись содержит сигнатуру "akindex1", длину открытого текста и количество
+    фрагментов, а также имитовставку, вычисляемую для номера фрагмента \f$ 2^{64}-1 \f$.
+    Поскольку все фрагменты, кроме последнего, имеют одинаковую длину, завершающей записи
+    достаточно для вычисления положения любого фрагмента в зашифрованных данных.                   */
+/* ----------------------------------------------------------------------------------------------- */
+ #define ak_aead_chunks_magic            "akchunk1"
+ #define ak_aead_chunks_footer_magic     "akindex1"
+ #define ak_aead_chunks_name_offset            (16)
+ #define ak_aead_chunks_salt_offset            (80)
+ #define ak_aead_chunks_nonce_offset           (96)
+ #define ak_aead_chunks_min_size             (4096)
+ #define ak_aead_chunks_max_size         (16777216)
+ #define ak_aead_chunks_max_iterations      (65536)
+ #define ak_aead_chunks_footer_index  ( ~( ak_uint64 )0 )
+
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_aead_chunks_store( ak_uint8 *out, ak_uint64 value, size_t size )
+{
+  size_t i = 0;
+  for( i = 0; i < size; i++, value >>= 8 ) out[i] = ( ak_uint8 )value;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static ak_uint64 ak_aead_chunks_load( const ak_uint8 *in, size_t size )
+{
+  ak_uint64 value = 0;
+  while( size-- > 0 ) value = ( value << 8 )^in[size];
+ return value;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* проверка того, что алгоритм является режимом mgm или xtsmac */
+ static bool_t ak_aead_chunks_check_oid( ak_oid oid )
+{
+  if(( oid == NULL ) || ( oid->engine != block_cipher ) || ( oid->mode != aead )) return ak_false;
+  if(( oid->func.direct == ( ak_function_run_object *) ak_bckey_encrypt_mgm ) ||
+     ( oid->func.direct == ( ak_function_run_object *) ak_bckey_encrypt_xtsmac )) return ak_true;
+ return ak_false;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* создание ключей фрагментов и общих для всех контекстов параметров */
+ static int ak_aead_chunks_create_keys( ak_aead_chunks ctx )
+{
+  int error = ak_error_ok;
+
+ /* режим xtsmac не позволяет обрабатывать сообщения, длина которых менее 16 октетов */
+  ctx->minimal = ( ctx->oid->func.direct ==
+                                  ( ak_function_run_object *) ak_bckey_encrypt_xtsmac ) ? 16 : 1;
+  ctx->resource = 0;
+  if(( error = ctx->oid->func.first.create( &ctx->ekey )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect creation of encryption key" );
+  if(( error = ctx->oid->func.second.create( &ctx->akey )) != ak_error_ok ) {
+    ak_bckey_destroy( &ctx->ekey );
+    return ak_error_message( error, __func__, "incorrect creation of authentication key" );
+  }
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* выработка мастер-ключа из пароля и значения соли, содержащегося в заголовке */
+ static int ak_aead_chunks_create_master( ak_aead_chunks ctx,
+                                                    const ak_pointer pass, const size_t pass_size )
+{
+  int error = ak_error_ok;
+  ak_uint8 material[32];
+
+  if(( error = ak_hmac_pbkdf2_streebog512( pass, pass_size,
+                                   ctx->header + ak_aead_chunks_salt_offset, 16,
+           ( size_t )ak_aead_chunks_load( ctx->header + 12, 4 ), 32, material )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect generation of master key from password" );
+
+  if(( error = ctx->oid->func.first.create( &ctx->master )) != ak_error_ok ) {
+    memset( material, 0, sizeof( material ));
+    return ak_error_message( error, __func__, "incorrect creation of master key" );
+  }
+  error = ak_bckey_set_key( &ctx->master, material, sizeof( material ));
+  ak_ptr_wipe( material, sizeof( material ), &ctx->master.key.generator );
+  if( error != ak_error_ok ) {
+    ak_bckey_destroy( &ctx->master );
+    return ak_error_message( error, __func__, "incorrect assigning of master key value" );
+  }
+  ctx->bsize = ctx->master.bsize;
+  if(( error = ak_aead_chunks_create_keys( ctx )) != ak_error_ok ) ak_bckey_destroy( &ctx->master );
+
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция формирует заголовок зашифрованных данных, содержащий случайные значения соли и
+    синхропосылки, и вырабатывает из пароля мастер-ключ, используемый для выработки
+    ключей отдельных фрагментов.
+
+    @param ctx Контекст шифрования данных, разбитых на фрагменты.
+    @param oid Идентификатор режима аутентифицированного шифрования (`mgm` или `xtsmac`).
+    @param chunk Длина фрагмента открытого текста; должна быть кратна 16 и лежать в пределах
+    от 4096 до 16777216 октетов; если значение равно нулю, используется
+    \ref ak_aead_chunks_default_size.
+    @param pass Пароль, строка символов в utf8 кодировке.
+    @param pass_size Длина пароля в октетах.
+    @param generator Генератор, используемый для выработки соли и синхропосылки.
+
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_aead_chunks_create( ak_aead_chunks ctx, ak_oid oid, const size_t chunk,
+                                 const ak_pointer pass, const size_t pass_size, ak_random generator )
+{
+  int error = ak_error_ok;
+  size_t size = chunk ? chunk : ak_aead_chunks_default_size;
+
+  if(( ctx == NULL ) || ( pass == NULL ) || ( generator == NULL ))
+    return ak_error_message( ak_error_null_pointer, __func__, "using null pointer" );
+  if( !ak_aead_chunks_check_oid( oid ))
+    return ak_error_message( ak_error_wrong_oid, __func__, "using unsupported aead mode" );
+  if(( size < ak_aead_chunks_min_size ) || ( size > ak_aead_chunks_max_size ) || ( size%16 ))
+    return ak_error_message_fmt( ak_error_wrong_length, __func__,
+                                        "using unsupported chunk length %u", (unsigned int)size );
+  memset( ctx, 0, sizeof( struct aead_chunks ));
+  ctx->oid = oid;
+  ctx->chunk = size;
+
+  memcpy( ctx->header, ak_aead_chunks_magic, 8 );
+  ak_aead_chunks_store( ctx->header + 8, size, 4 );
+  ak_aead_chunks_store( ctx->header + 12,
+                            ( ak_uint64 )ak_libakrypt_get_option_by_name( "pbkdf2_iteration_count" ), 4 );
+  memcpy( ctx->header + ak_aead_chunks_name_offset, oid->name[0], ak_min( strlen( oid->name[0] ), 63 ));
+  if(( error = ak_random_ptr( generator, ctx->header + ak_aead_chunks_salt_offset, 32 )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect generation of random values" );
+
+ return ak_aead_chunks_create_master( ctx, pass, pass_size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param ctx Контекст шифрования данных, разбитых на фрагменты.
+    @param header Указатель на заголовок зашифрованных данных длины \ref ak_aead_chunks_header_size.
+    @param pass Пароль, строка символов в utf8 кодировке.
+    @param pass_size Длина пароля в октетах.
+
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_aead_chunks_create_from_header( ak_aead_chunks ctx, const ak_pointer header,
+                                                    const ak_pointer pass, const size_t pass_size )
+{
+  char name[64];
+
+  if(( ctx == NULL ) || ( header == NULL ) || ( pass == NULL ))
+    return ak_error_message( ak_error_null_pointer, __func__, "using null pointer" );
+  if( memcmp( header, ak_aead_chunks_magic, 8 ))
+    return ak_error_message( ak_error_undefined_value, __func__, "using unsupported data format" );
+
+  memset( ctx, 0, sizeof( struct aead_chunks ));
+  memcpy( ctx->header, header, ak_aead_chunks_header_size );
+  ctx->chunk = ( size_t )ak_aead_chunks_load( ctx->header + 8, 4 );
+  if(( ctx->chunk < ak_aead_chunks_min_size ) || ( ctx->chunk > ak_aead_chunks_max_size ) ||
+     ( ctx->chunk%16 ) || ( ak_aead_chunks_load( ctx->header + 12, 4 ) == 0 ))
+    return ak_error_message( ak_error_wrong_length, __func__, "using wrong header parameters" );
+ /* количество итераций берется из непроверенного заголовка, поэтому ограничиваем его
+    максимальным значением опции `pbkdf2_iteration_count` */
+  if( ak_aead_chunks_load( ctx->header + 12, 4 ) > ak_aead_chunks_max_iterations )
+    return ak_error_message( ak_error_wrong_length, __func__,
+                                                "using unsupported number of pbkdf2 iterations" );
+
+  memset( name, 0, sizeof( name ));
+  memcpy( name, ctx->header + ak_aead_chunks_name_offset, sizeof( name ) - 1 );
+  if( !ak_aead_chunks_check_oid( ctx->oid = ak_oid_find_by_name( name )))
+    return ak_error_message( ak_error_wrong_oid, __func__, "using unsupported aead mode" );
+
+ return ak_aead_chunks_create_master( ctx, pass, pass_size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Копия использует тот же мастер-ключ, что и исходный контекст, но собственные ключи
+    фрагментов, что позволяет обрабатывать различные фрагменты в разных потоках.
+
+    @param ctx Создаваемый контекст.
+    @param src Ранее созданный контекст.
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_aead_chunks_create_copy( ak_aead_chunks ctx, ak_aead_chunks src )
+{
+  int error = ak_error_ok;
+
+  if(( ctx == NULL ) || ( src == NULL ))
+    return ak_error_message( ak_error_null_pointer, __func__, "using null pointer" );
+  memset( ctx, 0, sizeof( struct aead_chunks ));
+  ctx->oid = src->oid;
+  ctx->chunk = src->chunk;
+  ctx->bsize = src->bsize;
+  memcpy( ctx->header, src->header, ak_aead_chunks_header_size );
+
+  if(( error = ak_bckey_create_and_set_bckey( &ctx->master, &src->master )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect copying of master key" );
+  if(( error = ak_aead_chunks_create_keys( ctx )) != ak_error_ok ) ak_bckey_destroy( &ctx->master );
+
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_aead_chunks_destroy( ak_aead_chunks ctx )
+{
+  if( ctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__, "using null pointer" );
+  ak_bckey_destroy( &ctx->master );
+  ak_bckey_destroy( &ctx->ekey );
+  ak_bckey_destroy( &ctx->akey );
+  memset( ctx, 0, sizeof( struct aead_chunks ));
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Все фрагменты, кроме последнего, имеют длину `ctx->chunk`. Длина последнего фрагмента
+    не превосходит `ctx->chunk`; исключением является режим `xtsmac`, в котором остаток
+    длины менее 16 октетов присоединяется к предыдущему фрагменту.
+
+    @param ctx Контекст шифрования данных, разбитых на фрагменты.
+    @param size Длина открытого текста (в октетах).
+    @param last Указатель на переменную, в которую помещается длина последнего фрагмента.
+    @return Функция возвращает количество фрагментов (не менее одного).                            */
+/* ----------------------------------------------------------------------------------------------- */
+ ak_uint64 ak_aead_chunks_get_count( ak_aead_chunks ctx, const ak_uint64 size, size_t *last )
+{
+  ak_uint64 count = size/ctx->chunk, tail = size%ctx->chunk;
+
+  if( count == 0 ) { *last = ( size_t )tail; return 1; }
+  if( tail == 0 ) { *last = ctx->chunk; return count; }
+  if( tail >= ctx->minimal ) { *last = ( size_t )tail; return count+1; }
+  *last = ctx->chunk + ( size_t )tail;
+ return count;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ size_t ak_aead_chunks_get_footer_size( ak_aead_chunks ctx )
+{
+  return ak_aead_chunks_footer_data_size + ctx->bsize;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* выработка ключей и синхропосылки для фрагмента с заданным номером */
+ static int ak_aead_chunks_set_index( ak_aead_chunks ctx, const ak_uint64 index, ak_uint8 *nonce )
+{
+  size_t i = 0;
+  int error = ak_error_ok;
+  ak_uint8 material[64];
+
+ /* вырабатываем 64 октета, зашифровывая номер фрагмента и номер блока */
+  for( i = 0; i < sizeof( material ); i += ctx->bsize ) {
+     if( ctx->bsize == 8 ) ak_aead_chunks_store( material + i, ( index << 3 )^( i >> 3 ), 8 );
+      else {
+        ak_aead_chunks_store( material + i, index, 8 );
+        ak_aead_chunks_store( material + i + 8, i >> 4, 8 );
+      }
+     ctx->master.encrypt( &ctx->master.key, material + i, material + i );
+  }
+ /* новые ключи получают полный ресурс */
+  if((( error = ak_bckey_rekey( &ctx->ekey, material, 32 )) == ak_error_ok ) &&
+     (( error = ak_bckey_rekey( &ctx->akey, material + 32, 32 )) == ak_error_ok )) {
+    if( !ctx->resource ) ctx->resource = ctx->ekey.key.resource.value.counter;
+    ctx->ekey.key.resource.value.counter = ctx->resource;
+    ctx->akey.key.resource.value.counter = ctx->resource;
+  }
+  ak_ptr_wipe( material, sizeof( material ), &ctx->master.key.generator );
+
+  memcpy( nonce, ctx->header + ak_aead_chunks_nonce_offset, ctx->bsize );
+  ak_aead_chunks_store( material, index, 8 );
+  for( i = 0; i < 8; i++ ) nonce[i] ^= material[i];
+
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* зашифрование или расшифрование одного фрагмента */
+ static int ak_aead_chunks_process( ak_aead_chunks ctx, const ak_uint64 index, const bool_t final,
+             const ak_pointer in, ak_pointer out, const size_t size, ak_pointer icode, bool_t decrypt )
+{
+  int error = ak_error_ok;
+  ak_uint8 nonce[16], ad[ak_aead_chunks_header_size +1];
+
+  if(( ctx == NULL ) || ( in == NULL ) || ( out == NULL ))
+    return ak_error_message( ak_error_null_pointer, __func__, "using null pointer" );
+  if( size > ctx->chunk + ctx->minimal - 1 )
+    return ak_error_message( ak_error_wrong_length, __func__, "using very long chunk" );
+  if(( error = ak_aead_chunks_set_index( ctx, index, nonce )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect generation of chunk keys" );
+
+  memcpy( ad, ctx->header, ak_aead_chunks_header_size );
+  ad[ak_aead_chunks_header_size] = ( final != ak_false );
+ return (( ak_function_aead *)( decrypt ? ctx->oid->func.invert : ctx->oid->func.direct ))
+                  ( &ctx->ekey, &ctx->akey, ad, sizeof( ad ), in, out, size,
+                                                           nonce, ctx->bsize, icode, ctx->bsize );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param ctx Контекст шифрования данных, разбитых на фрагменты.
+    @param index Номер фрагмента.
+    @param final Признак последнего фрагмента.
+    @param in Открытый текст фрагмента.
+    @param out Область памяти, в которую помещаются шифртекст и имитовставка;
+    длина области должна быть не менее `size + ctx->bsize` октетов.
+    @param size Длина открытого текста фрагмента.
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_aead_chunks_encrypt( ak_aead_chunks ctx, const ak_uint64 index, const bool_t final,
+                                            const ak_pointer in, ak_pointer out, const size_t size )
+{
+  if( out == NULL ) return ak_error_message( ak_error_null_pointer, __func__, "using null pointer" );
+ return ak_aead_chunks_process( ctx, index, final, in, out, size,
+                                                            ( ak_uint8 *)out + size, ak_false );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! В случае несовпадения имитовставки расшифрованные данные уничтожаются.
+
+    @param ctx Контекст шифрования данных, разбитых на фрагменты.
+    @param index Номер фрагмента.
+    @param final Признак последнего фрагмента.
+    @param in Шифртекст фрагмента, за которым следует имитовставка.
+    @param out Область памяти, в которую помещается открытый текст.
+    @param size Длина открытого текста фрагмента (без учета имитовставки).
+    @return В случае совпадения имитовставки функция возвращает \ref ak_error_ok (ноль).
+    В противном случае возвращается код ошибки.                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_aead_chunks_decrypt( ak_aead_chunks ctx, const ak_uint64 index, const bool_t final,
+                                            const ak_pointer in, ak_pointer out, const size_t size )
+{
+  int error = ak_error_ok;
+
+  if( in == NULL ) return ak_error_message( ak_error_null_pointer, __func__, "using null pointer" );
+  if(( error = ak_aead_chunks_process( ctx, index, final, in, out, size,
+                                         ( ak_uint8 *)in + size, ak_true )) != ak_error_ok ) {
+    if( out != NULL ) memset( out, 0, size );
+    ak_error_message_fmt( error, __func__, "incorrect integrity code of chunk %llu",
+                                                                   ( unsigned long long )index );
+  }
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* выработка имитовставки завершающей записи */
+ static int ak_aead_chunks_footer_icode( ak_aead_chunks ctx, ak_uint8 *footer, ak_uint8 *icode )
+{
+  int error = ak_error_ok;
+  ak_uint8 nonce[16], ad[ak_aead_chunks_header_size + ak_aead_chunks_footer_data_size];
+
+  if(( error = ak_aead_chunks_set_index( ctx, ak_aead_chunks_footer_index, nonce )) != ak_error_ok )
+    return error;
+  memcpy( ad, ctx->header, ak_aead_chunks_header_size );
+  memcpy( ad + ak_aead_chunks_header_size, footer, ak_aead_chunks_footer_data_size );
+ return (( ak_function_aead *)ctx->oid->func.direct )( &ctx->ekey, &ctx->akey, ad, sizeof( ad ),
+                                              nonce, nonce, 0, nonce, ctx->bsize, icode, ctx->bsize );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Завершающая запись помещается после последнего фрагмента и позволяет при чтении
+    зашифрованных данных сразу определить их длину и положение каждого фрагмента, а также
+    обнаружить удаление фрагментов из конца данных.
+
+    @param ctx Контекст шифрования данных, разбитых на фрагменты.
+    @param size Длина открытого текста (в октетах).
+    @param out Область памяти, в которую помещается завершающая запись; длина области должна
+    быть не менее значения, возвращаемого функцией ak_aead_chunks_get_footer_size().
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_aead_chunks_create_footer( ak_aead_chunks ctx, const ak_uint64 size, ak_pointer out )
+{
+  size_t last = 0;
+  ak_uint8 *footer = out;
+
+  if(( ctx == NULL ) || ( out == NULL ))
+    return ak_error_message( ak_error_null_pointer, __func__, "using null pointer" );
+  memset( footer, 0, ak_aead_chunks_footer_data_size );
+  memcpy( footer, ak_aead_chunks_footer_magic, 8 );
+  ak_aead_chunks_store( footer + 8, size, 8 );
+  ak_aead_chunks_store( footer + 16, ak_aead_chunks_get_count( ctx, size, &last ), 8 );
+
+ return ak_aead_chunks_footer_icode( ctx, footer, footer + ak_aead_chunks_footer_data_size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param ctx Контекст шифрования данных, разбитых на фрагменты.
+    @param in Завершающая запись зашифрованных данных.
+    @param size Указатель на переменную, в которую помещается длина открытого текста.
+    @return В случае совпадения имитовставки функция возвращает \ref ak_error_ok (ноль).
+    В противном случае возвращается код ошибки.                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_aead_chunks_check_footer( ak_aead_chunks ctx, const ak_pointer in, ak_uint64 *size )
+{
+  int error = ak_error_ok;
+  size_t last = 0;
+  ak_uint8 icode[16], *footer = in;
+
+  if(( ctx == NULL ) || ( in == NULL ) || ( size == NULL ))
+    return ak_error_message( ak_error_null_pointer, __func__, "using null pointer" );
+  if( memcmp( footer, ak_aead_chunks_footer_magic, 8 ))
+    return ak_error_message( ak_error_undefined_value, __func__, "using unsupported footer format" );
+  if(( error = ak_aead_chunks_footer_icode( ctx, footer, icode )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect evaluation of footer integrity code" );
+  if( !ak_ptr_is_equal_with_log( icode, footer + ak_aead_chunks_footer_data_size, ctx->bsize ))
+    return ak_error_message( ak_error_not_equal_data, __func__,
+                                                          "incorrect integrity code of footer" );
+  *size = ak_aead_chunks_load( footer + 8, 8 );
+  if( ak_aead_chunks_get_count( ctx, *size, &last ) != ak_aead_chunks_load( footer + 16, 8 ))
+    return ak_error_message( ak_error_wrong_length, __func__, "using wrong number of chunks" );
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                           чтение произвольных фрагментов файлов                                 */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_aead_file_read_data( ak_file fp, ak_pointer ptr, size_t size )
+{
+  ssize_t done = 0;
+  ak_uint8 *buf = ptr;
+
+  while( size > 0 ) {
+    if(( done = ak_file_read( fp, buf, size )) <= 0 )
+      return ak_error_message( ak_error_read_data, __func__, "unexpected end of file" );
+    buf += done; size -= ( size_t )done;
+  }
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция считывает заголовок и завершающую запись зашифрованного файла и проверяет
+    имитовставку завершающей записи. После этого любой фрагмент открытого текста может быть
+    получен с помощью функции ak_aead_file_read(), при этом считываются, проверяются и
+    расшифровываются только те фрагменты файла, которые содержат запрашиваемые данные.
+
+    @param file Контекст зашифрованного файла.
+    @param filename Имя файла.
+    @param pass Пароль, строка символов в utf8 кодировке.
+    @param pass_size Длина пароля в октетах.
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_aead_file_open( ak_aead_file file, const char *filename,
+                                                    const ak_pointer pass, const size_t pass_size )
+{
+  int error = ak_error_ok;
+  ak_uint64 total = 0;
+  ak_uint8 header[ak_aead_chunks_header_size], footer[ak_aead_chunks_footer_data_size +16];
+
+  if(( file == NULL ) || ( filename == NULL ))
+    return ak_error_message( ak_error_null_pointer, __func__, "using null pointer" );
+  memset( file, 0, sizeof( struct aead_file ));
+  if(( error = ak_file_open_to_read( &file->fp, filename )) != ak_error_ok )
+    return ak_error_message_fmt( error, __func__, "incorrect opening of file %s", filename );
+
+  if(( error = ak_aead_file_read_data( &file->fp, header, sizeof( header ))) != ak_error_ok )
+    goto labex;
+  if(( error = ak_aead_chunks_create_from_header( &file->ctx, header, pass, pass_size ))
+                                                                              != ak_error_ok ) {
+    ak_error_message( error, __func__, "incorrect reading of file header" );
+    goto labex;
+  }
+
+ /* считываем завершающую запись и проверяем длину файла */
+  total = ak_aead_chunks_header_size + ak_aead_chunks_get_footer_size( &file->ctx );
+  if( file->fp.size < ( ak_int64 )total ) {
+    error = ak_error_message( ak_error_wrong_length, __func__, "using very short file" );
+    goto labex2;
+  }
+  if((( error = ak_file_seek( &file->fp, file->fp.size - ak_aead_chunks_get_footer_size(
+                                                                 &file->ctx ))) != ak_error_ok ) ||
+     (( error = ak_aead_file_read_data( &file->fp, footer,
+                              ak_aead_chunks_get_footer_size( &file->ctx ))) != ak_error_ok ) ||
+     (( error = ak_aead_chunks_check_footer( &file->ctx, footer, &file->size )) != ak_error_ok ))
+    goto labex2;
+
+  file->count = ak_aead_chunks_get_count( &file->ctx, file->size, &file->last );
+  total += ( file->count - 1 )*( file->ctx.chunk + file->ctx.bsize ) + file->last + file->ctx.bsize;
+  if( total != ( ak_uint64 )file->fp.size ) {
+    error = ak_error_message( ak_error_wrong_length, __func__, "unexpected length of file" );
+    goto labex2;
+  }
+
+  if((( file->buffer = malloc( file->ctx.chunk + 16 + file->ctx.bsize )) == NULL ) ||
+     (( file->plain = malloc( file->ctx.chunk + 16 )) == NULL )) {
+    error = ak_error_message( ak_error_out_of_memory, __func__, "incorrect memory allocation" );
+    goto labex2;
+  }
+  file->cached = ak_aead_chunks_footer_index;
+ return ak_error_ok;
+
+  labex2: ak_aead_chunks_destroy( &file->ctx );
+  labex:
+   if( file->buffer != NULL ) free( file->buffer );
+   if( file->plain != NULL ) free( file->plain );
+   ak_file_close( &file->fp );
+   memset( file, 0, sizeof( struct aead_file ));
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Положение фрагмента, содержащего заданное смещение, вычисляется непосредственно, без
+    чтения предшествующих фрагментов. Последний расшифрованный фрагмент сохраняется
+    во внутреннем буффере, поэтому последовательное чтение небольших участков данных
+    не приводит к повторному расшифрованию фрагментов.
+
+    @param file Контекст зашифрованного файла.
+    @param offset Смещение (в октетах) от начала открытого текста.
+    @param out Область памяти, в которую помещаются расшифрованные данные.
+    @param size Количество запрашиваемых октетов.
+    @return Функция возвращает количество расшифрованных октетов, которое может быть меньше
+    запрошенного при достижении конца данных. В случае ошибки (в частности, при несовпадении
+    имитовставки фрагмента) возвращается отрицательный код ошибки.                                 */
+/* ----------------------------------------------------------------------------------------------- */
+ ssize_t ak_aead_file_read( ak_aead_file file, const ak_uint64 offset,
+                                                                ak_pointer out, const size_t size )
+{
+  int error = ak_error_ok;
+  ak_uint64 index = 0, pos = offset;
+  size_t len = 0, start = 0, done = 0, total = 0;
+
+  if(( file == NULL ) || ( out == NULL ))
+    return ak_error_message( ak_error_null_pointer, __func__, "using null pointer" );
+  if( offset >= file->size ) return 0;
+  total = ( size_t )ak_min(( ak_uint64 )size, file->size - offset );
+
+  while( done < total ) {
+    if(( index = pos/file->ctx.chunk ) >= file->count ) index = file->count - 1;
+    len = ( index == file->count - 1 ) ? file->last : file->ctx.chunk;
+    start = ( size_t )( pos - index*file->ctx.chunk );
+
+   /* считываем и расшифровываем фрагмент, если его нет в буффере */
+    if( index != file->cached ) {
+      file->cached = ak_aead_chunks_footer_index;
+      if((( error = ak_file_seek( &file->fp, ( ak_int64 )( ak_aead_chunks_header_size +
+                             index*( file->ctx.chunk + file->ctx.bsize )))) != ak_error_ok ) ||
+         (( error = ak_aead_file_read_data( &file->fp, file->buffer,
+                                                   len + file->ctx.bsize )) != ak_error_ok ) ||
+         (( error = ak_aead_chunks_decrypt( &file->ctx, index, index == file->count - 1,
+                                             file->buffer, file->plain, len )) != ak_error_ok ))
+        return error;
+      file->cached = index;
+    }
+    len = ak_min( len - start, total - done );
+    memcpy(( ak_uint8 *)out + done, file->plain + start, len );
+    done += len;
+    pos += len;
+  }
+
+ return ( ssize_t )done;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_aead_file_close( ak_aead_file file )
+{
+  if( file == NULL ) return ak_error_message( ak_error_null_pointer, __func__, "using null pointer" );
+  if( file->plain != NULL ) {
+    ak_ptr_wipe( file->plain, file->ctx.chunk + 16, &file->ctx.master.key.generator );
+    free( file->plain );
+  }
+  if( file->buffer != NULL ) free( file->buffer );
+  ak_aead_chunks_destroy( &file->ctx );
+  ak_file_close( &file->fp );
+  memset( file, 0, sizeof( struct aead_file ));
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \example test-aead-file.c                                                                      */
+/* ----------------------------------------------------------------------------------------------- */
+/*                                                                                 ak_aead_file.c  */
+/* ----------------------------------------------------------------------------------------------- */
@@ -1565,7 +1565,7 @@ int ak_asn1_get_length_from_der( ak_uint8** pp_data, size_t *p_len )
       ak_tlv_get_utf8_string( asnset_right->current, &ptr_right );
       strncpy( memory, ptr_right, sizeof( memory )-1 );
 
-      ak_tlv_get_utf8_string( asnset_right->current, &ptr_left );
+      ak_tlv_get_utf8_string( asnset_left->current, &ptr_left );
       if( strcmp( memory, ptr_left ) != 0 )
         return ak_error_message( ak_error_not_equal_data, __func__,
                                                   "the given global names has different values" );
@@ -2973,54 +2973,541 @@ Validity ::= SEQUENCE {
 }
 
 /* ----------------------------------------------------------------------------------------------- */
-                                 /* функции для работы с файлами */
+                      /* функции последовательного чтения der-последовательностей */
 /* ----------------------------------------------------------------------------------------------- */
-/*! \param asn указатель на текущий уровень ASN.1 дерева
-    \param filename имя файла, в который записываются данные
+/*! \brief Функция считывает из der-последовательности заданное количество октетов.
+    \details Чтение выполняется только в прямом направлении. Если указатель `out` равен `NULL`,
+    то считанные октеты пропускаются.
+    \param cursor контекст курсора
+    \param out область памяти, в которую помещаются считанные данные (может быть равна `NULL`)
+    \param count количество считываемых октетов
+    \return В случае успеха функция возвращает \ref ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_asn1_cursor_read( ak_asn1_cursor cursor, ak_uint8 *out, size_t count )
+{
+  ssize_t rb = 0;
+  size_t len = 0;
+
+  if( cursor->offset + count > cursor->size ) return ak_error_read_data;
+  if( !cursor->is_file ) {
+    if( out != NULL ) memcpy( out, cursor->ptr + cursor->offset, count );
+    cursor->offset += count;
+    return ak_error_ok;
+  }
+
+  while( count > 0 ) {
+    if( cursor->bufpos == cursor->bufsize ) {
+      if(( rb = ak_file_read( &cursor->fp, cursor->buffer, sizeof( cursor->buffer ))) <= 0 )
+        return ak_error_read_data;
+      cursor->bufsize = ( size_t ) rb;
+      cursor->bufpos = 0;
+    }
+    len = ak_min( count, cursor->bufsize - cursor->bufpos );
+    if( out != NULL ) {
+      memcpy( out, cursor->buffer + cursor->bufpos, len );
+      out += len;
+    }
+    cursor->bufpos += len;
+    cursor->offset += len;
+    count -= len;
+  }
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция перемещает курсор вперед до заданного смещения.                                 */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_asn1_cursor_skip_to( ak_asn1_cursor cursor, const size_t offset )
+{
+  if( offset < cursor->offset ) return ak_error_wrong_index;
+ return ak_asn1_cursor_read( cursor, NULL, offset - cursor->offset );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция проверяет, что данные текущего узла еще не считывались.                         */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_asn1_cursor_check_current( ak_asn1_cursor cursor, const char *function )
+{
+  if( cursor == NULL ) return ak_error_message( ak_error_null_pointer, function,
+                                                              "using null pointer to asn1 cursor" );
+  if( !cursor->has_current ) return ak_error_message( ak_error_wrong_index, function,
+                                                        "using asn1 cursor without current node" );
+  if( cursor->offset != cursor->data_offset ) return ak_error_message( ak_error_wrong_index,
+                                            function, "data of current node is already consumed" );
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \param cursor контекст курсора
+    \param ptr указатель на область памяти, содержащую der-последовательность; область памяти
+    должна оставаться доступной на протяжении всего времени использования курсора
+    \param size длина der-последовательности (в октетах)
     \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха, в случае неудачи
     возвращается код ошибки.                                                                       */
 /* ----------------------------------------------------------------------------------------------- */
- int ak_asn1_export_to_derfile( ak_asn1 asn, const char *filename )
+ int ak_asn1_cursor_create_ptr( ak_asn1_cursor cursor, const ak_pointer ptr, const size_t size )
 {
-   struct file fp;
-   ssize_t wbb = 0;
-   size_t len = 0, wb = 0;
-   ak_uint8 *buffer = NULL;
-   int error = ak_error_ok;
-
-   if(( error = ak_asn1_evaluate_length( asn, &len )) != ak_error_ok )
-     return ak_error_message( error, __func__, "incorrect evaluation total asn1 context length" );
-
-  /* кодируем */
-   if(( buffer = malloc( len )) == NULL )
-     return ak_error_message( ak_error_out_of_memory, __func__,
-                                                  "incorrect memory allocation for der-sequence" );
-   if(( error = ak_asn1_encode( asn, buffer, &len )) != ak_error_ok ) {
-     ak_error_message( error, __func__, "incorrect encoding of asn1 context" );
-     goto lab2;
-   }
+  if( cursor == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                              "using null pointer to asn1 cursor" );
+  if( ptr == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                            "using null pointer to der-sequence" );
+  memset( cursor, 0, sizeof( struct asn1_cursor ));
+  cursor->ptr = ptr;
+  cursor->is_file = ak_false;
+  cursor->end[0] = cursor->size = size;
 
-  /* сохраняем */
-   if(( error = ak_file_create_to_write( &fp, filename )) != ak_error_ok ) {
-     ak_error_message( error, __func__, "incorrect creation a file for secret key" );
-     goto lab2;
-   }
-   do{
-     wbb = ak_file_write( &fp, buffer, len );
-     if( wbb == -1 ) {
-       ak_error_message( error = ak_error_get_value(), __func__ ,
-                                                     "incorrect writing an encoded data to file" );
-       goto lab3;
-     }
-      else wb += (size_t) wbb;
-   } while( wb < len );
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Данные из файла считываются блоками фиксированной длины по мере продвижения курсора,
+    поэтому файл может иметь произвольный размер. Поддерживаются только файлы,
+    содержащие der-последовательности (без кодирования base64).
+
+    \param cursor контекст курсора
+    \param filename имя файла, содержащего der-последовательность
+    \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха, в случае неудачи
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_asn1_cursor_create_file( ak_asn1_cursor cursor, const char *filename )
+{
+  int error = ak_error_ok;
+
+  if( cursor == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                              "using null pointer to asn1 cursor" );
+  if( filename == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                                "using null pointer to filename" );
+  memset( cursor, 0, sizeof( struct asn1_cursor ));
+  if(( error = ak_file_open_to_read( &cursor->fp, filename )) != ak_error_ok )
+    return ak_error_message_fmt( error, __func__, "incorrect opening of %s", filename );
+  if( cursor->fp.size <= 0 ) {
+    ak_file_close( &cursor->fp );
+    return ak_error_message_fmt( ak_error_zero_length, __func__, "file %s is empty", filename );
+  }
+  cursor->is_file = ak_true;
+  cursor->end[0] = cursor->size = ( size_t ) cursor->fp.size;
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \param cursor контекст курсора
+    \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха, в случае неудачи
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_asn1_cursor_destroy( ak_asn1_cursor cursor )
+{
+  if( cursor == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                              "using null pointer to asn1 cursor" );
+  if( cursor->is_file ) ak_file_close( &cursor->fp );
+  memset( cursor, 0, sizeof( struct asn1_cursor ));
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция пропускает не считанные данные текущего узла (если он определен)
+    и считывает тег и длину следующего узла текущего уровня. Данные узла не считываются.
+
+    \param cursor контекст курсора
+    \return Функция возвращает истину, если следующий узел существует и его заголовок
+    корректно декодирован. Если текущий уровень исчерпан, возвращается ложь.
+    В случае возникновения ошибки также возвращается ложь, а код ошибки может быть
+    получен с помощью функции ak_error_get_value().                                                */
+/* ----------------------------------------------------------------------------------------------- */
+ bool_t ak_asn1_cursor_next( ak_asn1_cursor cursor )
+{
+  int error = ak_error_ok;
+  ak_uint8 octet = 0, cnt = 0, i = 0, lbuf[4];
+
+  if( cursor == NULL ) {
+    ak_error_message( ak_error_null_pointer, __func__, "using null pointer to asn1 cursor" );
+    return ak_false;
+  }
+
+ /* пропускаем данные текущего узла */
+  if( cursor->has_current ) {
+    cursor->has_current = ak_false;
+    if(( error = ak_asn1_cursor_skip_to( cursor, cursor->next_offset )) != ak_error_ok ) {
+      ak_error_message( error, __func__, "incorrect skipping of current node" );
+      return ak_false;
+    }
+  }
+  if( cursor->offset >= cursor->end[cursor->depth] ) return ak_false;
+
+ /* считываем тег и длину */
+  if(( error = ak_asn1_cursor_read( cursor, &cursor->tag, 1 )) != ak_error_ok ) goto labex;
+  if(( error = ak_asn1_cursor_read( cursor, &octet, 1 )) != ak_error_ok ) goto labex;
+  if( octet&0x80 ) {
+    if(( cnt = octet&0x7F ) > 4 ) {
+      error = ak_error_invalid_asn1_length;
+      goto labex;
+    }
+    if(( error = ak_asn1_cursor_read( cursor, lbuf, cnt )) != ak_error_ok ) goto labex;
+    for( cursor->len = 0, i = 0; i < cnt; i++ ) cursor->len = ( cursor->len << 8 )|lbuf[i];
+  }
+   else cursor->len = octet;
+
+ /* проверяем, что узел не выходит за границы текущего уровня */
+  cursor->data_offset = cursor->offset;
+  if( cursor->len > cursor->end[cursor->depth] - cursor->data_offset ) {
+    error = ak_error_wrong_length;
+    goto labex;
+  }
+  cursor->next_offset = cursor->data_offset + cursor->len;
+  cursor->has_current = ak_true;
+  return ak_true;
+
+  labex:
+   ak_error_message( error, __func__, "incorrect decoding of tlv element header" );
+ return ak_false;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! После перехода текущий узел не определен; для перехода к первому узлу
+    низлежащего уровня следует вызвать функцию ak_asn1_cursor_next().
+
+    \param cursor контекст курсора
+    \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха, в случае неудачи
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_asn1_cursor_enter( ak_asn1_cursor cursor )
+{
+  int error = ak_error_ok;
+
+  if(( error = ak_asn1_cursor_check_current( cursor, __func__ )) != ak_error_ok ) return error;
+  if( DATA_STRUCTURE( cursor->tag ) != CONSTRUCTED )
+    return ak_error_message( ak_error_invalid_asn1_tag, __func__,
+                                                         "current node is not a constructed one" );
+  if( cursor->depth + 1 >= ak_asn1_cursor_max_depth )
+    return ak_error_message( ak_error_wrong_index, __func__, "asn1 cursor depth is exceeded" );
+
+  cursor->end[++cursor->depth] = cursor->next_offset;
+  cursor->has_current = ak_false;
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \param cursor контекст курсора
+    \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха, в случае неудачи
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_asn1_cursor_leave( ak_asn1_cursor cursor )
+{
+  int error = ak_error_ok;
+
+  if( cursor == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                              "using null pointer to asn1 cursor" );
+  if( cursor->depth == 0 ) return ak_error_message( ak_error_wrong_index, __func__,
+                                                        "asn1 cursor is placed on the top level" );
+  if(( error = ak_asn1_cursor_skip_to( cursor, cursor->end[cursor->depth] )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect skipping of current level" );
+
+  cursor->depth--;
+  cursor->has_current = ak_false;
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \param cursor контекст курсора
+    \param out область памяти, в которую помещаются данные узла
+    \param size длина данных (в октетах)
+
+    \note Перед вызовом функции переменная `size` должна быть инициализирована значением,
+    указывающим максимальный объем выделенной области памяти. Если данное значение окажется меньше
+    необходимого, то будет возбуждена ошибка, а необходимое значение будет помещено в `size`.
+
+    \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха, в случае неудачи
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_asn1_cursor_get_primitive( ak_asn1_cursor cursor, ak_pointer out, size_t *size )
+{
+  int error = ak_error_ok;
+
+  if(( error = ak_asn1_cursor_check_current( cursor, __func__ )) != ak_error_ok ) return error;
+  if( size == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                                "using null pointer to length" );
+  if( DATA_STRUCTURE( cursor->tag ) != PRIMITIVE )
+    return ak_error_message( ak_error_invalid_asn1_tag, __func__,
+                                                           "current node is not a primitive one" );
+  if( *size < cursor->len ) {
+    *size = cursor->len;
+    return ak_error_wrong_length;
+  }
+  if(( out == NULL ) && ( cursor->len > 0 )) return ak_error_message( ak_error_null_pointer,
+                                                      __func__, "using null pointer to buffer" );
+  if(( error = ak_asn1_cursor_read( cursor, out, *size = cursor->len )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect reading of primitive node data" );
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция позволяет построить ASN.1 дерево только для тех фрагментов der-последовательности,
+    которые действительно необходимы. Данные узла копируются в ASN.1 дерево.
+
+    \param cursor контекст курсора
+    \param asn уровень ASN.1 дерева, к которому добавляется декодированный узел
+    \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха, в случае неудачи
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_asn1_cursor_get_asn1( ak_asn1_cursor cursor, ak_asn1 asn )
+{
+  ak_tlv tlv = NULL;
+  ak_asn1 asnew = NULL;
+  ak_uint8 *data = NULL;
+  int error = ak_error_ok;
+
+  if(( error = ak_asn1_cursor_check_current( cursor, __func__ )) != ak_error_ok ) return error;
+  if( asn == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                            "using null pointer to asn1 context" );
+ /* получаем указатель на данные узла */
+  if( cursor->is_file ) {
+    if(( data = malloc( ak_max( cursor->len, 1 ))) == NULL )
+      return ak_error_message( ak_error_out_of_memory, __func__,
+                                                           "incorrect memory allocation for data" );
+    if(( error = ak_asn1_cursor_read( cursor, data, cursor->len )) != ak_error_ok ) {
+      ak_error_message( error, __func__, "incorrect reading of node data" );
+      goto labex;
+    }
+  } else {
+     data = cursor->ptr + cursor->data_offset;
+     cursor->offset = cursor->next_offset;
+    }
+
+ /* декодируем узел */
+  switch( DATA_STRUCTURE( cursor->tag )) {
+    case PRIMITIVE:
+      if(( tlv = ak_tlv_new_primitive( cursor->tag, cursor->len, data, ak_true )) == NULL ) {
+        ak_error_message( error = ak_error_get_value(), __func__,
+                                                             "incorrect creation of tlv context" );
+        goto labex;
+      }
+      if(( error = ak_asn1_add_tlv( asn, tlv )) != ak_error_ok )
+        ak_error_message( error, __func__, "incorrect addition of tlv context into asn1 context" );
+      break;
 
-   lab3: ak_file_close( &fp );
-   lab2: free( buffer );
+    case CONSTRUCTED:
+      if(( error = ak_asn1_decode( asnew = ak_asn1_new(), data,
+                                                       cursor->len, ak_true )) != ak_error_ok ) {
+        ak_asn1_delete( asnew );
+        ak_error_message( error, __func__, "incorrect decoding of asn1 context" );
+        goto labex;
+      }
+      if(( error = ak_asn1_add_asn1( asn, cursor->tag, asnew )) != ak_error_ok ) {
+        ak_asn1_delete( asnew );
+        ak_error_message( error, __func__,
+                                          "incorrect addition of asn1 context into asn1 context" );
+      }
+      break;
+
+    default: ak_error_message( error = ak_error_invalid_asn1_tag, __func__,
+                                                         "unexpected tag's value of tlv element" );
+  }
 
+  labex:
+   if( cursor->is_file && ( data != NULL )) free( data );
  return error;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+                                 /* функции для работы с файлами */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Размер внутреннего буффера, используемого при потоковой записи der-последовательностей. */
+ #define ak_asn1_writer_buffer_size  (4096)
+
+/*! \brief Количество блоков base64 (по четыре символа) в одной строке pem-файла. */
+ #define ak_asn1_writer_pem_blocks   (16)
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Контекст потоковой записи der-последовательности.
+
+    Закодированные данные помещаются либо в область памяти, предоставленную вызывающей стороной,
+    либо во внутренний буффер, содержимое которого по мере заполнения сбрасывается в файл.
+    Для pem формата данные преобразуются в base64 в том же проходе, без построения
+    промежуточной der-последовательности.                                                          */
+/* ----------------------------------------------------------------------------------------------- */
+ typedef struct asn1_writer {
+  /*! \brief область памяти, в которую помещаются данные */
+   ak_uint8 *ptr;
+  /*! \brief размер области памяти */
+   size_t size;
+  /*! \brief количество октетов, помещенных в область памяти */
+   size_t offset;
+  /*! \brief файл, в который сбрасываются данные (`NULL` при записи в память) */
+   ak_file fp;
+  /*! \brief флаг преобразования данных в base64 */
+   bool_t pem;
+  /*! \brief октеты, ожидающие преобразования в base64 */
+   ak_uint8 rest[3];
+  /*! \brief количество октетов, ожидающих преобразования */
+   size_t rlen;
+  /*! \brief количество блоков base64 в текущей строке */
+   size_t column;
+  /*! \brief внутренний буффер для записи в файл */
+   ak_uint8 buffer[ak_asn1_writer_buffer_size];
+ } *ak_asn1_writer;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция сбрасывает содержимое внутреннего буффера в файл. */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_asn1_writer_flush( ak_asn1_writer wr )
+{
+  ssize_t wbb = 0;
+  size_t wb = 0;
+
+  if( wr->fp == NULL ) return ak_error_ok;
+  while( wb < wr->offset ) {
+    if(( wbb = ak_file_write( wr->fp, wr->ptr + wb, wr->offset - wb )) == -1 )
+      return ak_error_message( ak_error_get_value(), __func__ ,
+                                                     "incorrect writing an encoded data to file" );
+    wb += ( size_t )wbb;
+  }
+  wr->offset = 0;
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция помещает данные в область памяти (без преобразования). */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_asn1_writer_put_raw( ak_asn1_writer wr, const ak_uint8 *data, size_t len )
+{
+  int error = ak_error_ok;
+
+  while( len > 0 ) {
+    size_t cnt = ak_min( len, wr->size - wr->offset );
+    if( cnt == 0 ) {
+      if( wr->fp == NULL ) return ak_error_message( ak_error_wrong_length, __func__,
+                                                      "unexpected end of output memory area" );
+      if(( error = ak_asn1_writer_flush( wr )) != ak_error_ok ) return error;
+      continue;
+    }
+    memcpy( wr->ptr + wr->offset, data, cnt );
+    wr->offset += cnt; data += cnt; len -= cnt;
+  }
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция помещает один блок base64 и, при необходимости, символ перевода строки. */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_asn1_writer_put_block( ak_asn1_writer wr, ak_uint8 *in, int len )
+{
+  ak_uint8 out[5];
+  size_t cnt = 4;
+
+  ak_base64_encodeblock( in, out, len );
+  if( ++wr->column == ak_asn1_writer_pem_blocks ) {
+    out[cnt++] = '\n';
+    wr->column = 0;
+  }
+ /* быстрый путь: в области памяти достаточно места */
+  if( wr->size - wr->offset >= cnt ) {
+    memcpy( wr->ptr + wr->offset, out, cnt );
+    wr->offset += cnt;
+    return ak_error_ok;
+  }
+ return ak_asn1_writer_put_raw( wr, out, cnt );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция помещает фрагмент der-последовательности, преобразуя его в base64
+    для pem формата. */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_asn1_writer_put( ak_asn1_writer wr, const ak_uint8 *data, size_t len )
+{
+  int error = ak_error_ok;
+
+  if( !wr->pem ) return ak_asn1_writer_put_raw( wr, data, len );
+
+ /* дополняем ранее сохраненные октеты до полного блока */
+  if( wr->rlen > 0 ) {
+    size_t cnt = ak_min( 3 - wr->rlen, len );
+    memcpy( wr->rest + wr->rlen, data, cnt );
+    data += cnt; len -= cnt;
+    if(( wr->rlen += cnt ) < 3 ) return ak_error_ok;
+    if(( error = ak_asn1_writer_put_block( wr, wr->rest, 3 )) != ak_error_ok ) return error;
+    wr->rlen = 0;
+  }
+ /* кодируем полные блоки непосредственно из входных данных:
+    сначала дополняем текущую строку, потом кодируем строки целиком */
+  while(( wr->column != 0 ) && ( len >= 3 )) {
+    if(( error = ak_asn1_writer_put_block( wr, ( ak_uint8 *)data, 3 )) != ak_error_ok )
+      return error;
+    data += 3; len -= 3;
+  }
+  while( len >= 3*ak_asn1_writer_pem_blocks ) {
+    ak_uint8 line[4*ak_asn1_writer_pem_blocks + 1];
+    size_t cnt = sizeof( line ) - 1;
+
+    ak_base64_encode( data, 3*ak_asn1_writer_pem_blocks, line, &cnt );
+    line[cnt++] = '\n';
+    if(( error = ak_asn1_writer_put_raw( wr, line, cnt )) != ak_error_ok ) return error;
+    data += 3*ak_asn1_writer_pem_blocks; len -= 3*ak_asn1_writer_pem_blocks;
+  }
+  while( len >= 3 ) {
+    if(( error = ak_asn1_writer_put_block( wr, ( ak_uint8 *)data, 3 )) != ak_error_ok )
+      return error;
+    data += 3; len -= 3;
+  }
+  if( len > 0 ) memcpy( wr->rest, data, wr->rlen = len );
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция помещает тег и длину элемента ASN.1 дерева. */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_asn1_writer_put_header( ak_asn1_writer wr, ak_uint8 tag, size_t len )
+{
+  ak_uint8 header[32], *ptr = header;
+
+  ak_asn1_put_tag( &ptr, tag );
+  ak_asn1_put_length( &ptr, ( ak_uint32 )len );
+ return ak_asn1_writer_put( wr, header, ( size_t )( ptr - header ));
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Однопроходная процедура потоковой записи одного ASN.1 уровня.
+    \details Функция использует длины составных элементов, вычисленные ранее функцией
+    ak_asn1_evaluate_length() и сохраненные в узлах дерева.                                        */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_asn1_writer_put_asn1( ak_asn1_writer wr, ak_asn1 asn )
+{
+  int error = ak_error_ok;
+
+  ak_asn1_first( asn );
+  if( asn->current == NULL ) return ak_error_ok;
+
+  do{
+     ak_tlv tlv = asn->current;
+
+     if(( error = ak_asn1_writer_put_header( wr, tlv->tag, tlv->len )) != ak_error_ok )
+       return ak_error_message( error, __func__, "incorrect encoding of tlv element's header" );
+
+     switch( DATA_STRUCTURE( tlv->tag )) {
+       case PRIMITIVE:
+         if(( error = ak_asn1_writer_put( wr, tlv->data.primitive, tlv->len )) != ak_error_ok )
+           return ak_error_message( error, __func__, "incorrect encoding of primitive element" );
+         break;
+
+       case CONSTRUCTED:
+         if(( error = ak_asn1_writer_put_asn1( wr, tlv->data.constructed )) != ak_error_ok )
+           return ak_error_message( error, __func__, "incorrect encoding of constructed element" );
+         break;
+
+       default: return ak_error_message_fmt( ak_error_invalid_asn1_tag, __func__,
+                                                         "unexpected tag's value of tlv element" );
+     }
+  } while( ak_asn1_next( asn ));
+
+ return ak_error_ok;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Константы, используемые для сохранения закодированной информации. */
  const char *crypto_content_titles[] = {
@@ -3034,69 +3521,117 @@ Validity ::= SEQUENCE {
  };
 
 /* ----------------------------------------------------------------------------------------------- */
-/*! \param asn указатель на текущий уровень ASN.1 дерева
-    \param filename имя файла, в который записываются данные
-    \param type тип сохраняемого контента, используется для формирования заголовков pem-файла.
+/*! \brief Функция вычисляет длину pem-представления der-последовательности заданной длины. */
+/* ----------------------------------------------------------------------------------------------- */
+ static size_t ak_asn1_get_pem_length( size_t len, crypto_content_t type )
+{
+  size_t blocks = ( len + 2 )/3;
+
+ return 2*strlen( crypto_content_titles[type] ) + 32 /* заголовок и окончание */
+             + 4*blocks + ( blocks + ak_asn1_writer_pem_blocks - 1 )/ak_asn1_writer_pem_blocks;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция записывает ASN.1 дерево с помощью контекста потоковой записи.
+
+    Длины составных элементов вычисляются за один проход по дереву и сохраняются в его узлах,
+    после чего во втором проходе данные помещаются в область памяти или файл,
+    без выделения памяти под промежуточную der-последовательность.
+
+    \param wr контекст потоковой записи
+    \param asn указатель на текущий уровень ASN.1 дерева
+    \param type тип сохраняемого контента, используется для формирования заголовков pem-формата.
     \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха, в случае неудачи
     возвращается код ошибки.                                                                       */
 /* ----------------------------------------------------------------------------------------------- */
- int ak_asn1_export_to_pemfile( ak_asn1 asn, const char *filename, crypto_content_t type )
+ static int ak_asn1_writer_export( ak_asn1_writer wr, ak_asn1 asn, crypto_content_t type )
 {
-  ak_uint8 out[4];
-  struct file ofile;
+  char title[64];
   int error = ak_error_ok;
-  ak_uint8 *buffer = NULL, *ptr = NULL;
-  size_t len = 0, cnt = 0, idx, blocks, tail;
 
- /* получаем длину */
-  if(( error = ak_asn1_evaluate_length( asn, &len )) != ak_error_ok )
-    return ak_error_message( error, __func__, "incorrect evaluation total asn1 context length" );
+  if( wr->pem ) {
+    wr->pem = ak_false;
+    ak_snprintf( title, sizeof( title ), "-----BEGIN %s-----\n", crypto_content_titles[type] );
+    if(( error = ak_asn1_writer_put_raw( wr, (ak_uint8 *)title, strlen( title ))) != ak_error_ok )
+      return error;
+    wr->pem = ak_true;
+  }
 
- /* кодируем/декодируем */
-  blocks = len/3;
-  if(( tail = len - 3*blocks ) != 0 ) len = 3*(blocks+1); /* увеличиваем объем до кратного трем
-                              после декодирования переменная len снова примет истинное значение */
-  if(( ptr = buffer = malloc( len )) == NULL )
-    return ak_error_message( ak_error_out_of_memory, __func__,
-                                                  "incorrect memory allocation for der-sequence" );
-  memset( buffer, 0, len );
-  if(( error = ak_asn1_encode( asn, buffer, &len )) != ak_error_ok ) {
-    ak_error_message( error, __func__, "incorrect encoding of asn1 context" );
-    goto lab2;
-  }
-
- /* сохраняем закодированый буффер */
-  if(( error = ak_file_create_to_write( &ofile, filename )) != ak_error_ok ) {
-    ak_error_message( error, __func__, "incorrect creation a file for secret key" );
-    goto lab2;
-  }
-
-  ak_file_printf( &ofile, "-----BEGIN %s-----\n", crypto_content_titles[type] );
-
-  for( idx = 0; idx < blocks; idx++ ) {
-     ak_base64_encodeblock( ptr, out, 3);
-     ak_file_printf( &ofile, "%c%c%c%c", out[0], out[1], out[2], out[3] );
-     ptr += 3;
-     if( ++cnt == 16 ) { /* 16х4 = 64 символа в одной строке */
-       ak_file_printf( &ofile, "\n" );
-       cnt = 0;
-     }
+  if(( error = ak_asn1_writer_put_asn1( wr, asn )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect encoding of asn1 context" );
+
+  if( wr->pem ) {
+    if( wr->rlen > 0 ) {
+      if(( error = ak_asn1_writer_put_block( wr, wr->rest, ( int )wr->rlen )) != ak_error_ok )
+        return error;
+    }
+    wr->pem = ak_false;
+    ak_snprintf( title, sizeof( title ), "%s-----END %s-----\n",
+                                          wr->column != 0 ? "\n" : "", crypto_content_titles[type] );
+    if(( error = ak_asn1_writer_put_raw( wr, (ak_uint8 *)title, strlen( title ))) != ak_error_ok )
+      return error;
   }
-  if( tail ) {
-    ak_base64_encodeblock( ptr, out, tail );
-    ak_file_printf( &ofile, "%c%c%c%c", out[0], out[1], out[2], out[3] );
-    ++cnt;
-    ak_file_printf( &ofile, "\n" );
-  } else
-     if(( cnt != 16 ) && ( cnt != 0 )) ak_file_printf( &ofile, "\n" );
 
-  ak_file_printf( &ofile, "-----END %s-----\n", crypto_content_titles[type] );
-  ak_file_close( &ofile );
+ return ak_asn1_writer_flush( wr );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция записывает ASN.1 дерево в файл в заданном формате. */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_asn1_export_to_file_stream( ak_asn1 asn, const char *filename,
+                                                          bool_t pem, crypto_content_t type )
+{
+  size_t len = 0;
+  struct file fp;
+  struct asn1_writer wr;
+  int error = ak_error_ok;
+
+  if(( error = ak_asn1_evaluate_length( asn, &len )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect evaluation total asn1 context length" );
+  if(( error = ak_file_create_to_write( &fp, filename )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect creation a file for asn1 context" );
+
+  wr.ptr = wr.buffer;
+  wr.size = sizeof( wr.buffer );
+  wr.offset = wr.rlen = wr.column = 0;
+  wr.fp = &fp;
+  wr.pem = pem;
+  if(( error = ak_asn1_writer_export( &wr, asn, type )) != ak_error_ok )
+    ak_error_message( error, __func__, "incorrect writing an encoded data to file" );
+  ak_file_close( &fp );
 
-  lab2: free( buffer );
  return error;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Данные записываются в файл по мере кодирования, без выделения памяти
+    под всю der-последовательность.
+
+    \param asn указатель на текущий уровень ASN.1 дерева
+    \param filename имя файла, в который записываются данные
+    \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха, в случае неудачи
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_asn1_export_to_derfile( ak_asn1 asn, const char *filename )
+{
+ return ak_asn1_export_to_file_stream( asn, filename, ak_false, 0 );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Данные кодируются в base64 и записываются в файл в ходе одного прохода по ASN.1 дереву,
+    без построения промежуточной der-последовательности.
+
+    \param asn указатель на текущий уровень ASN.1 дерева
+    \param filename имя файла, в который записываются данные
+    \param type тип сохраняемого контента, используется для формирования заголовков pem-файла.
+    \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха, в случае неудачи
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_asn1_export_to_pemfile( ak_asn1 asn, const char *filename, crypto_content_t type )
+{
+ return ak_asn1_export_to_file_stream( asn, filename, ak_true, type );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \param asn указатель на текущий уровень ASN.1 дерева
     \param filename имя файла, в который записываются данные
@@ -3127,6 +3662,57 @@ Validity ::= SEQUENCE {
  return error;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция помещает ASN.1 дерево в область памяти, предоставленную вызывающей стороной,
+    в виде der-последовательности или в pem формате (с заголовками и разбиением на строки).
+    Преобразование в base64 выполняется в том же проходе, что и кодирование.
+
+    \param asn указатель на текущий уровень ASN.1 дерева
+    \param ptr указатель на область памяти, в которую помещаются данные
+    \param size размер области памяти (в октетах)
+    \param format формат, в котором сохраняются данные
+    \param content тип сохраняемого контента, используется для формирования заголовков pem формата.
+
+    \note Перед вызовом функции переменная `size` должна быть инициализирована значением,
+    указывающим максимальный объем выделенной области памяти. Если данное значение окажется меньше
+    необходимого, то будет возбуждена ошибка, а необходимое значение будет помещено в `size`.
+    После успешного завершения в `size` помещается количество записанных октетов;
+    для pem формата завершающий нулевой символ не записывается.
+
+    \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха, в случае неудачи
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_asn1_export_to_ptr( ak_asn1 asn, ak_pointer ptr, size_t *size,
+                                                export_format_t format, crypto_content_t content )
+{
+  size_t len = 0;
+  struct asn1_writer wr;
+  int error = ak_error_ok;
+
+  if( asn == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                            "using null pointer to asn1 context" );
+  if( size == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                         "using null pointer to size variable" );
+  if(( error = ak_asn1_evaluate_length( asn, &len )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect evaluation total asn1 context length" );
+  if( format == asn1_pem_format ) len = ak_asn1_get_pem_length( len, content );
+  if(( ptr == NULL ) || ( *size < len )) {
+    *size = len;
+    return ak_error_wrong_length;
+  }
+
+  wr.ptr = ptr;
+  wr.size = len;
+  wr.offset = wr.rlen = wr.column = 0;
+  wr.fp = NULL;
+  wr.pem = ( format == asn1_pem_format );
+  if(( error = ak_asn1_writer_export( &wr, asn, content )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect encoding of asn1 context" );
+
+  *size = wr.offset;
+ return ak_error_ok;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция сперва считывает данные из файла `filename` считая, что он содержит чистую
     der-последовательность. После считывания данных производится попытка их декодирования.
@@ -3258,7 +3844,39 @@ Validity ::= SEQUENCE {
 }
 
 /* ----------------------------------------------------------------------------------------------- */
-/*! \param infile имя разделяемого файла
+/*! \brief Функция сохраняет уровень ASN.1 дерева в файл с заданным порядковым номером.         */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_libakrypt_split_asn1_export( ak_asn1 asn, const char *infile, unsigned int cnt,
+                                                export_format_t format, crypto_content_t content )
+{
+  int error = ak_error_ok;
+  char outfile[FILENAME_MAX];
+
+  switch( format ) {
+    case asn1_der_format:
+      ak_snprintf( outfile, sizeof( outfile ), "%s-%04u.der", infile, cnt );
+      if(( error = ak_asn1_export_to_derfile( asn, outfile )) != ak_error_ok )
+        ak_error_message_fmt( error, __func__,
+                               "incorrect export asn1 context to file %s in der format", outfile );
+      break;
+    case asn1_pem_format:
+      ak_snprintf( outfile, sizeof( outfile ), "%s-%04u.pem", infile, cnt );
+      if(( error = ak_asn1_export_to_pemfile( asn, outfile, content )) != ak_error_ok )
+        ak_error_message_fmt( error, __func__,
+                               "incorrect export asn1 context to file %s in pem format", outfile );
+      break;
+  }
+
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Файлы, содержащие der-последовательности, обрабатываются последовательно с помощью курсора,
+    т.е. в памяти одновременно хранится только один узел верхнего уровня. Если файл не удается
+    разобрать как der-последовательность (например, он содержит данные в формате pem),
+    то ASN.1 дерево считывается целиком.
+
+    \param infile имя разделяемого файла
     \param format формат результирующего файла (pem или der)
     \param content тип контента; используется для вывода символьной строки, описывающей в pem
     формате тип контента; для формата der значение роли не играет.
@@ -3272,9 +3890,28 @@ Validity ::= SEQUENCE {
   ak_asn1 asn = NULL;
   unsigned int cnt = 0;
   int error = ak_error_ok;
-  char outfile[FILENAME_MAX];
+  struct asn1_cursor cursor;
 
- /* 1. Считываем дерево из файла */
+ /* 1. Последовательно считываем узлы der-последовательности */
+  if( ak_asn1_cursor_create_file( &cursor, infile ) == ak_error_ok ) {
+    while( ak_asn1_cursor_next( &cursor )) {
+      if(( asn = ak_asn1_new( )) == NULL ) {
+        error = ak_error_message( ak_error_get_value(),
+                                              __func__, "incorrect creation of new asn1 context" );
+        break;
+      }
+      if(( error = ak_asn1_cursor_get_asn1( &cursor, asn )) == ak_error_ok )
+        error = ak_libakrypt_split_asn1_export( asn, infile, cnt, format, content );
+      ak_asn1_delete( asn );
+      if( error != ak_error_ok ) break;
+      ++cnt;
+    }
+    if(( error == ak_error_ok ) && ( cursor.offset != cursor.size )) error = ak_error_read_data;
+    ak_asn1_cursor_destroy( &cursor );
+    if( cnt > 0 ) return error;
+  }
+
+ /* 2. Считываем дерево из файла целиком */
   if(( asn = ak_asn1_new( )) == NULL ) return ak_error_message( ak_error_get_value(),
                                               __func__, "incorrect creation of new asn1 context" );
   if(( error = ak_asn1_import_from_file( asn, infile )) != ak_error_ok ) {
@@ -3283,35 +3920,16 @@ Validity ::= SEQUENCE {
     goto labex;
   }
 
- /* 2. Для каждого узла выполняем одно и тоже действие */
+ /* 3. Для каждого узла выполняем одно и тоже действие */
   ak_asn1_first( asn );
   while( asn->count ) {
     ak_asn1 next = ak_asn1_new();
     ak_tlv tlv = ak_asn1_exclude( asn );
     ak_asn1_add_tlv( next, tlv );
-    if( format == asn1_der_format )
-      ak_snprintf( outfile, sizeof( outfile ), "%s-%04u.der", infile, cnt );
-     else ak_snprintf( outfile, sizeof( outfile ), "%s-%04u.pem", infile, cnt );
-
-    switch( format ) {
-      case asn1_der_format:
-        if(( error = ak_asn1_export_to_derfile( next, outfile )) != ak_error_ok ) {
-          ak_error_message_fmt( error, __func__,
-                               "incorrect export asn1 context to file %s in der format", outfile );
-          goto labex;
-        }
-        break;
-      case asn1_pem_format:
-        if(( error = ak_asn1_export_to_pemfile( next, outfile, content )) != ak_error_ok )
-        {
-          ak_error_message_fmt( error, __func__,
-                               "incorrect export asn1 context to file %s in pem format", outfile );
-          goto labex;
-        }
-        break;
-    }
-    ++cnt;
+    error = ak_libakrypt_split_asn1_export( next, infile, cnt, format, content );
     ak_asn1_delete( next );
+    if( error != ak_error_ok ) goto labex;
+    ++cnt;
   }
 
   labex:
@@ -3322,6 +3940,7 @@ Validity ::= SEQUENCE {
 /* ----------------------------------------------------------------------------------------------- */
 /*! \example test-asn1-build.c                                                                     */
 /*! \example test-asn1-parse.c                                                                     */
+/*! \example test-asn1-cursor.c                                                                    */
 /* ----------------------------------------------------------------------------------------------- */
 /*                                                                                      ak_asn1.c  */
 /* ----------------------------------------------------------------------------------------------- */
@@ -7,12 +7,20 @@
  #include <libakrypt-internal.h>
 
 /* ----------------------------------------------------------------------------------------------- */
+#ifdef AK_HAVE_STDLIB_H
+ #include <stdlib.h>
+#else
+ #error Library cannot be compiled without stdlib.h header
+#endif
 #ifdef AK_HAVE_STRING_H
  #include <string.h>
 #endif
 #ifdef AK_HAVE_TIME_H
  #include <time.h>
 #endif
+#ifdef AK_HAVE_PTHREAD_H
+ #include <pthread.h>
+#endif
 
 /* ----------------------------------------------------------------------------------------------- */
                   /* Функции экспорта открытых ключей в запрос на сертификат */
@@ -244,52 +252,27 @@
 /* ----------------------------------------------------------------------------------------------- */
                  /* Функции импорта открытых ключей из запроса на сертификат */
 /* ----------------------------------------------------------------------------------------------- */
-/*! \brief Функция получает значение открытого ключа из запроса на сертификат,
-    разобранного в ASN.1 дерево, и создает контекст открытого ключа.
-
-    Функция считывает oid алгоритма подписи и проверяет, что он соответствует ГОСТ Р 34.12-2012,
-    потом функция считывает параметры эллиптической кривой и проверяет, что библиотека поддерживает
-    данные параметры. В заключение функция считывает открытый ключ и проверяет,
-    что он принадлежит кривой со считанными ранее параметрами.
+/*! \brief Функция получает значение открытого ключа из структуры `SubjectPublicKeyInfo`,
+    разобранной в ASN.1 дерево, и создает контекст открытого ключа.
 
-    После выполнения всех проверок, функция создает (действие `create`) контекст открытого ключа,
-    а также присваивает (действие `set_key`) ему считанное из asn1 дерева значение.
+    Данная структура содержится как в запросе на сертификат, так и в самом сертификате
+    открытого ключа.
 
     \param vkey контекст создаваемого открытого ключа асимметричного криптографического алгоритма
-    \param asnkey считанное из файла asn1 дерево
+    \param asn уровень asn1 дерева, содержащий параметры алгоритма и значение открытого ключа
     \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха, в случае неудачи
    возвращается код ошибки.                                                                        */
 /* ----------------------------------------------------------------------------------------------- */
- static int ak_verifykey_import_from_asn1_request( ak_verifykey vkey, ak_asn1 asnkey )
+ static int ak_verifykey_import_from_asn1_value( ak_verifykey vkey, ak_asn1 asn )
 {
   size_t size = 0;
   ak_oid oid = NULL;
   struct bit_string bs;
   ak_pointer ptr = NULL;
   int error = ak_error_ok;
-  ak_asn1 asn = asnkey, asnl1; /* копируем адрес */
+  ak_asn1 asnl1 = NULL;
   ak_uint32 val = 0, val64 = 0;
 
- /* проверяем, то первым элементом содержится ноль */
-  ak_asn1_first( asn );
-  if(( DATA_STRUCTURE( asn->current->tag ) != PRIMITIVE ) ||
-     ( TAG_NUMBER( asn->current->tag ) != TINTEGER ))
-    return ak_error_message( ak_error_invalid_asn1_tag, __func__ ,
-                                          "the first element of root asn1 context be an integer" );
-  ak_tlv_get_uint32( asn->current, &val );
-  if( val != 0 ) return ak_error_message( ak_error_invalid_asn1_content, __func__ ,
-                                              "the first element of asn1 context must be a zero" );
- /* второй элемент содержит имя владельца ключа.
-    этот элемент должен быть позднее перенесен в контекст открытого ключа */
-  ak_asn1_next( asn );
-
- /* третий элемент должен быть SEQUENCE с набором oid и значением ключа */
-  ak_asn1_next( asn );
-  if(( DATA_STRUCTURE( asn->current->tag ) != CONSTRUCTED ) ||
-     ( TAG_NUMBER( asn->current->tag ) != TSEQUENCE ))
-    return ak_error_message( ak_error_invalid_asn1_tag, __func__ ,
-             "the third element of root asn1 context must be a sequence with object identifiers" );
-  asn = asn->current->data.constructed;
   ak_asn1_first( asn );
   if(( DATA_STRUCTURE( asn->current->tag ) != CONSTRUCTED ) ||
      ( TAG_NUMBER( asn->current->tag ) != TSEQUENCE ))
@@ -398,6 +381,51 @@
  return error;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция получает значение открытого ключа из запроса на сертификат,
+    разобранного в ASN.1 дерево, и создает контекст открытого ключа.
+
+    Функция считывает oid алгоритма подписи и проверяет, что он соответствует ГОСТ Р 34.12-2012,
+    потом функция считывает параметры эллиптической кривой и проверяет, что библиотека поддерживает
+    данные параметры. В заключение функция считывает открытый ключ и проверяет,
+    что он принадлежит кривой со считанными ранее параметрами.
+
+    После выполнения всех проверок, функция создает (действие `create`) контекст открытого ключа,
+    а также присваивает (действие `set_key`) ему считанное из asn1 дерева значение.
+
+    \param vkey контекст создаваемого открытого ключа асимметричного криптографического алгоритма
+    \param asnkey считанное из файла asn1 дерево
+    \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха, в случае неудачи
+   возвращается код ошибки.                                                                        */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_verifykey_import_from_asn1_request( ak_verifykey vkey, ak_asn1 asnkey )
+{
+  ak_uint32 val = 0;
+  ak_asn1 asn = asnkey; /* копируем адрес */
+
+ /* проверяем, то первым элементом содержится ноль */
+  ak_asn1_first( asn );
+  if(( DATA_STRUCTURE( asn->current->tag ) != PRIMITIVE ) ||
+     ( TAG_NUMBER( asn->current->tag ) != TINTEGER ))
+    return ak_error_message( ak_error_invalid_asn1_tag, __func__ ,
+                                          "the first element of root asn1 context be an integer" );
+  ak_tlv_get_uint32( asn->current, &val );
+  if( val != 0 ) return ak_error_message( ak_error_invalid_asn1_content, __func__ ,
+                                              "the first element of asn1 context must be a zero" );
+ /* второй элемент содержит имя владельца ключа.
+    этот элемент должен быть позднее перенесен в контекст открытого ключа */
+  ak_asn1_next( asn );
+
+ /* третий элемент должен быть SEQUENCE с набором oid и значением ключа */
+  ak_asn1_next( asn );
+  if(( DATA_STRUCTURE( asn->current->tag ) != CONSTRUCTED ) ||
+     ( TAG_NUMBER( asn->current->tag ) != TSEQUENCE ))
+    return ak_error_message( ak_error_invalid_asn1_tag, __func__ ,
+             "the third element of root asn1 context must be a sequence with object identifiers" );
+
+ return ak_verifykey_import_from_asn1_value( vkey, asn->current->data.constructed );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция считывает из заданного файла запрос на получение сертификата. Запрос хранится в виде
     asn1 дерева, определяемого Р 1323565.1.023-2018.
@@ -902,7 +930,1168 @@
 /* ----------------------------------------------------------------------------------------------- */
                      /* Функции импорта открытых ключей из сертификата */
 /* ----------------------------------------------------------------------------------------------- */
+/*! \brief Поля сертификата открытого ключа, используемые при его импорте и проверке. */
+ typedef struct certificate_fields {
+  /*! \brief узел, содержащий структуру tbsCertificate */
+   ak_tlv tbs;
+  /*! \brief расширенное имя эмитента */
+   ak_tlv issuer;
+  /*! \brief расширенное имя владельца ключа */
+   ak_tlv subject;
+  /*! \brief уровень, содержащий структуру SubjectPublicKeyInfo */
+   ak_asn1 spki;
+  /*! \brief временной интервал действия сертификата */
+   struct time_interval time;
+  /*! \brief значение подписи под сертификатом */
+   struct bit_string signature;
+  /*! \brief идентификатор открытого ключа (расширение SubjectKeyIdentifier) */
+   ak_uint8 ski[32];
+  /*! \brief длина идентификатора открытого ключа */
+   size_t ski_len;
+  /*! \brief идентификатор ключа проверки подписи (расширение AuthorityKeyIdentifier) */
+   ak_uint8 aki[32];
+  /*! \brief длина идентификатора ключа проверки подписи */
+   size_t aki_len;
+ } *ak_certificate_fields;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Элемент хранилища доверенных сертификатов. */
+ typedef struct certificate_store_entry {
+  /*! \brief открытый ключ, содержащийся в сертификате */
+   struct verifykey vkey;
+  /*! \brief параметры (расширения) сертификата */
+   struct certificate_opts opts;
+  /*! \brief идентификатор открытого ключа */
+   ak_uint8 ski[32];
+  /*! \brief длина идентификатора открытого ключа */
+   size_t ski_len;
+  /*! \brief хеш-код der-кодировки расширенного имени владельца ключа */
+   ak_uint8 name[32];
+ } *ak_certificate_store_entry;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Хранилище доверенных сертификатов, индексированное по идентификаторам ключей
+    и расширенным именам владельцев. */
+ static struct certificate_store {
+  /*! \brief массив элементов, упорядоченный по идентификаторам ключей */
+   ak_certificate_store_entry *by_key;
+  /*! \brief массив элементов, упорядоченный по хеш-кодам расширенных имен */
+   ak_certificate_store_entry *by_name;
+  /*! \brief количество элементов в хранилище */
+   size_t count;
+  /*! \brief максимальное количество элементов, под которое выделена память */
+   size_t size;
+  /*! \brief флаг того, что хранилище было загружено */
+   bool_t loaded;
+ } certificate_store = { NULL, NULL, 0, 0, ak_false };
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Пустое значение индекса в кеше проверенных сертификатов. */
+ #define ak_certificate_cache_none  ((size_t)-1)
+
+/*! \brief Элемент кеша успешно проверенных сертификатов. */
+ typedef struct certificate_cache_entry {
+  /*! \brief хеш-код (Стрибог256) der-кодировки сертификата */
+   ak_uint8 fingerprint[32];
+  /*! \brief хеш-код открытого ключа, с помощью которого была проверена подпись */
+   ak_uint8 issuer[32];
+  /*! \brief предыдущий элемент в порядке использования */
+   size_t prev;
+  /*! \brief следующий элемент в порядке использования */
+   size_t next;
+  /*! \brief следующий элемент в цепочке хеш-таблицы */
+   size_t chain;
+ } *ak_certificate_cache_entry;
+
+/*! \brief Кеш успешно проверенных сертификатов с вытеснением давно не используемых элементов. */
+ static struct certificate_cache {
+  /*! \brief массив элементов */
+   ak_certificate_cache_entry entries;
+  /*! \brief массив начальных элементов цепочек хеш-таблицы */
+   size_t *buckets;
+  /*! \brief максимальное количество элементов кеша */
+   size_t size;
+  /*! \brief текущее количество элементов кеша */
+   size_t count;
+  /*! \brief маска для вычисления индекса в хеш-таблице */
+   size_t mask;
+  /*! \brief последний использованный элемент */
+   size_t head;
+  /*! \brief элемент, использованный раньше всех прочих */
+   size_t tail;
+ } certificate_cache = { NULL, NULL, 0, 0, 0,
+                                             ak_certificate_cache_none, ak_certificate_cache_none };
+
+/*! \brief Загрузка хранилища доверенных сертификатов (без блокировки хранилища). */
+ static int ak_certificate_store_load_unlocked( const char * );
+
+#ifdef AK_HAVE_PTHREAD_H
+ static pthread_mutex_t certificate_store_mutex = PTHREAD_MUTEX_INITIALIZER;
+ static pthread_mutex_t certificate_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вычисляет хеш-код (Стрибог256) заданной области памяти. */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_ptr_get_fingerprint( const ak_pointer ptr, const size_t size, ak_uint8 *out )
+{
+  struct hash ctx;
+  int error = ak_error_ok;
+
+  if(( error = ak_hash_create_streebog256( &ctx )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect creation of hash function context" );
+  if(( error = ak_hash_ptr( &ctx, ptr, size, out, 32 )) != ak_error_ok )
+    ak_error_message( error, __func__, "incorrect calculation of fingerprint" );
+  ak_hash_destroy( &ctx );
+
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вычисляет хеш-код (Стрибог256) координат открытого ключа.
+    \details В отличие от номера ключа, который может быть взят из непроверенного расширения
+    SubjectKeyIdentifier, хеш-код однозначно определяется значением открытого ключа.
+    \param vkey открытый ключ
+    \param out область памяти, в которую помещается хеш-код (32 октета)
+    \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха, в случае неудачи
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_verifykey_get_fingerprint( ak_verifykey vkey, ak_uint8 *out )
+{
+  ak_uint64 coords[2*ak_mpzn512_size];
+  const size_t size = vkey->wc->size;
+  int error = ak_error_ok;
+
+  memcpy( coords, vkey->qpoint.x, size*sizeof( ak_uint64 ));
+  memcpy( coords +size, vkey->qpoint.y, size*sizeof( ak_uint64 ));
+  error = ak_ptr_get_fingerprint( coords, 2*size*sizeof( ak_uint64 ), out );
+  ak_ptr_wipe( coords, sizeof( coords ), NULL );
+
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вычисляет хеш-код (Стрибог256) der-кодировки заданного узла asn1 дерева.
+    \param tlv узел asn1 дерева
+    \param out область памяти, в которую помещается хеш-код (32 октета)
+    \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха, в случае неудачи
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_tlv_get_fingerprint( ak_tlv tlv, ak_uint8 *out )
+{
+  ak_uint8 buffer[1024], *ptr = buffer;
+  size_t size = sizeof( buffer );
+  int error = ak_error_ok;
+
+  if(( error = ak_tlv_encode( tlv, ptr, &size )) == ak_error_wrong_length ) {
+    if(( ptr = malloc( size )) == NULL )
+      return ak_error_message( ak_error_out_of_memory, __func__,
+                                                     "incorrect memory allocation for encoding" );
+    error = ak_tlv_encode( tlv, ptr, &size );
+  }
+  if( error != ak_error_ok ) {
+    ak_error_message( error, __func__, "incorrect encoding of tlv context" );
+    goto labex;
+  }
+  error = ak_ptr_get_fingerprint( ptr, size, out );
+
+  labex:
+   if( ptr != buffer ) free( ptr );
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция сравнивает элементы хранилища по идентификаторам ключей. */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_certificate_store_compare_keys( const void *left, const void *right )
+{
+  int result = 0;
+  ak_certificate_store_entry l = *( ak_certificate_store_entry * )left,
+                             r = *( ak_certificate_store_entry * )right;
+
+  if(( result = memcmp( l->ski, r->ski, ak_min( l->ski_len, r->ski_len ))) != 0 ) return result;
+ return ( l->ski_len > r->ski_len ) - ( l->ski_len < r->ski_len );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция сравнивает элементы хранилища по хеш-кодам расширенных имен. */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_certificate_store_compare_names( const void *left, const void *right )
+{
+ return memcmp( (*( ak_certificate_store_entry * )left)->name,
+                                           (*( ak_certificate_store_entry * )right)->name, 32 );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Поиск элемента хранилища по идентификатору ключа (без блокировки хранилища). */
+/* ----------------------------------------------------------------------------------------------- */
+ static ak_verifykey ak_certificate_store_find_key( const ak_pointer ski, const size_t size )
+{
+  struct certificate_store_entry key;
+  ak_certificate_store_entry pkey = &key, *result = NULL;
+
+  if(( certificate_store.count == 0 ) || ( size == 0 )) return NULL;
+  memcpy( key.ski, ski, key.ski_len = ak_min( size, sizeof( key.ski )));
+  if(( result = bsearch( &pkey, certificate_store.by_key, certificate_store.count,
+             sizeof( ak_certificate_store_entry ), ak_certificate_store_compare_keys )) == NULL )
+    return NULL;
+ return &(*result)->vkey;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Поиск элемента хранилища по хеш-коду расширенного имени (без блокировки хранилища). */
+/* ----------------------------------------------------------------------------------------------- */
+ static ak_verifykey ak_certificate_store_find_name( const ak_uint8 *name )
+{
+  struct certificate_store_entry key;
+  ak_certificate_store_entry pkey = &key, *result = NULL;
+
+  if( certificate_store.count == 0 ) return NULL;
+  memcpy( key.name, name, sizeof( key.name ));
+  if(( result = bsearch( &pkey, certificate_store.by_name, certificate_store.count,
+            sizeof( ak_certificate_store_entry ), ak_certificate_store_compare_names )) == NULL )
+    return NULL;
+ return &(*result)->vkey;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вычисляет номер цепочки хеш-таблицы кеша по хеш-коду сертификата.
+    \details Хеш-код может быть произвольно выровнен в памяти, поэтому его начальные октеты
+    копируются в переменную, а не считываются через указатель на `size_t`.                         */
+/* ----------------------------------------------------------------------------------------------- */
+ static size_t ak_certificate_cache_bucket( const ak_uint8 *fingerprint )
+{
+  size_t value = 0;
+  memcpy( &value, fingerprint, sizeof( value ));
+ return value&certificate_cache.mask;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция ищет в кеше сертификат, подпись под которым была проверена заданным ключом.
+    \details При успешном поиске элемент становится последним использованным.                     */
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t ak_certificate_cache_find( const ak_uint8 *fingerprint, const ak_uint8 *issuer )
+{
+  size_t idx = 0;
+  bool_t result = ak_false;
+  ak_certificate_cache_entry entry = NULL;
+
+#ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_lock( &certificate_cache_mutex );
+#endif
+  if( certificate_cache.buckets == NULL ) goto labex;
+  idx = certificate_cache.buckets[ ak_certificate_cache_bucket( fingerprint )];
+  while( idx != ak_certificate_cache_none ) {
+    entry = certificate_cache.entries + idx;
+    if( memcmp( entry->fingerprint, fingerprint, 32 ) == 0 ) break;
+    idx = entry->chain;
+  }
+  if(( idx == ak_certificate_cache_none ) || memcmp( entry->issuer, issuer, 32 )) goto labex;
+
+ /* перемещаем элемент в начало списка */
+  if( idx != certificate_cache.head ) {
+    certificate_cache.entries[entry->prev].next = entry->next;
+    if( entry->next != ak_certificate_cache_none )
+      certificate_cache.entries[entry->next].prev = entry->prev;
+     else certificate_cache.tail = entry->prev;
+    entry->prev = ak_certificate_cache_none;
+    entry->next = certificate_cache.head;
+    certificate_cache.entries[certificate_cache.head].prev = idx;
+    certificate_cache.head = idx;
+  }
+  result = ak_true;
+
+  labex:
+#ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_unlock( &certificate_cache_mutex );
+#endif
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция помещает в кеш информацию об успешной проверке подписи под сертификатом.
+    \details Размер кеша определяется опцией `certificate_cache_size`; при нулевом значении
+    опции кеширование не производится. При заполнении кеша из него удаляется элемент,
+    который использовался раньше всех прочих.
+    \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха, в случае неудачи
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_certificate_cache_add( const ak_uint8 *fingerprint, const ak_uint8 *issuer )
+{
+  int error = ak_error_ok;
+  size_t idx = 0, *pidx = NULL, bucket = 0;
+  ak_certificate_cache_entry entry = NULL;
+
+#ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_lock( &certificate_cache_mutex );
+#endif
+ /* при первом вызове выделяем память */
+  if( certificate_cache.buckets == NULL ) {
+    size_t buckets = 1, size = ( size_t ) ak_libakrypt_get_option_by_name( "certificate_cache_size" );
+
+    if(( size == 0 ) || ( size > 65536 )) goto labex;
+    while( buckets < 2*size ) buckets <<= 1;
+    if(( certificate_cache.entries =
+                             malloc( size*sizeof( struct certificate_cache_entry ))) == NULL ) {
+      ak_error_message( error = ak_error_out_of_memory, __func__,
+                                               "incorrect memory allocation for certificate cache" );
+      goto labex;
+    }
+    if(( certificate_cache.buckets = malloc( buckets*sizeof( size_t ))) == NULL ) {
+      free( certificate_cache.entries );
+      certificate_cache.entries = NULL;
+      ak_error_message( error = ak_error_out_of_memory, __func__,
+                                               "incorrect memory allocation for certificate cache" );
+      goto labex;
+    }
+    memset( certificate_cache.buckets, 0xff, buckets*sizeof( size_t ));
+    certificate_cache.size = size;
+    certificate_cache.mask = buckets - 1;
+    certificate_cache.count = 0;
+    certificate_cache.head = certificate_cache.tail = ak_certificate_cache_none;
+  }
+
+ /* выбираем элемент: либо свободный, либо давно не используемый */
+  if( certificate_cache.count < certificate_cache.size ) idx = certificate_cache.count++;
+   else {
+     entry = certificate_cache.entries + ( idx = certificate_cache.tail );
+    /* удаляем элемент из цепочки хеш-таблицы */
+     pidx = certificate_cache.buckets + ak_certificate_cache_bucket( entry->fingerprint );
+     while( *pidx != idx ) pidx = &certificate_cache.entries[*pidx].chain;
+     *pidx = entry->chain;
+    /* удаляем элемент из списка */
+     certificate_cache.tail = entry->prev;
+     if( entry->prev != ak_certificate_cache_none )
+       certificate_cache.entries[entry->prev].next = ak_certificate_cache_none;
+      else certificate_cache.head = ak_certificate_cache_none;
+   }
+
+ /* заполняем элемент и помещаем его в начало списка */
+  entry = certificate_cache.entries + idx;
+  memcpy( entry->fingerprint, fingerprint, 32 );
+  memcpy( entry->issuer, issuer, 32 );
+  bucket = ak_certificate_cache_bucket( fingerprint );
+  entry->chain = certificate_cache.buckets[bucket];
+  certificate_cache.buckets[bucket] = idx;
+  entry->prev = ak_certificate_cache_none;
+  entry->next = certificate_cache.head;
+  if( certificate_cache.head != ak_certificate_cache_none )
+    certificate_cache.entries[certificate_cache.head].prev = idx;
+   else certificate_cache.tail = idx;
+  certificate_cache.head = idx;
+
+  labex:
+#ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_unlock( &certificate_cache_mutex );
+#endif
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \return Функция возвращает \ref ak_error_ok (ноль).                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_certificate_cache_clean( void )
+{
+#ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_lock( &certificate_cache_mutex );
+#endif
+  if( certificate_cache.entries != NULL ) free( certificate_cache.entries );
+  if( certificate_cache.buckets != NULL ) free( certificate_cache.buckets );
+  certificate_cache.entries = NULL;
+  certificate_cache.buckets = NULL;
+  certificate_cache.size = certificate_cache.count = certificate_cache.mask = 0;
+  certificate_cache.head = certificate_cache.tail = ak_certificate_cache_none;
+#ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_unlock( &certificate_cache_mutex );
+#endif
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция считывает значения расширений сертификата открытого ключа.
+
+    Обрабатываются расширения SubjectKeyIdentifier, BasicConstraints, KeyUsage и
+    AuthorityKeyIdentifier; прочие расширения пропускаются.
+
+    \param asn уровень asn1 дерева, содержащий последовательность расширений
+    \param fields структура, в которую помещаются идентификаторы ключей
+    \param opts структура, в которую помещаются значения расширений
+    \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха, в случае неудачи
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_certificate_get_extensions( ak_asn1 asn,
+                                           ak_certificate_fields fields, ak_certificate_opts opts )
+{
+  size_t size = 0;
+  struct bit_string bs;
+  int error = ak_error_ok;
+  ak_pointer oid = NULL, ptr = NULL;
+  ak_asn1 ext = NULL, value = NULL;
+
+  if(( asn == NULL ) || ( asn->count == 0 )) return ak_error_ok;
+  ak_asn1_first( asn );
+  do{
+     if(( DATA_STRUCTURE( asn->current->tag ) != CONSTRUCTED ) ||
+        ( TAG_NUMBER( asn->current->tag ) != TSEQUENCE ))
+       return ak_error_message( ak_error_invalid_asn1_tag, __func__,
+                                                 "certificate extension must be a sequence" );
+     ext = asn->current->data.constructed;
+     ak_asn1_first( ext );
+     if(( error = ak_tlv_get_oid( ext->current, &oid )) != ak_error_ok )
+       return ak_error_message( error, __func__, "incorrect reading of extension identifier" );
+     ak_asn1_last( ext );
+     if(( error = ak_tlv_get_octet_string( ext->current, &ptr, &size )) != ak_error_ok )
+       return ak_error_message( error, __func__, "incorrect reading of extension value" );
+     if(( error = ak_asn1_decode( value = ak_asn1_new(), ptr, size, ak_false )) != ak_error_ok ) {
+       ak_asn1_delete( value );
+       return ak_error_message( error, __func__, "incorrect decoding of extension value" );
+     }
+     ak_asn1_first( value );
+
+    /* 2.5.29.14: SubjectKeyIdentifier ::= OCTET STRING */
+     if( strcmp( oid, "2.5.29.14" ) == 0 ) {
+       if( ak_tlv_get_octet_string( value->current, &ptr, &size ) == ak_error_ok ) {
+         memcpy( fields->ski, ptr, fields->ski_len = ak_min( size, sizeof( fields->ski )));
+       }
+     }
+    /* 2.5.29.19: BasicConstraints ::= SEQUENCE { cA BOOLEAN, pathLenConstraint INTEGER } */
+     if(( strcmp( oid, "2.5.29.19" ) == 0 ) &&
+                                          ( DATA_STRUCTURE( value->current->tag ) == CONSTRUCTED )) {
+       ak_asn1 bc = value->current->data.constructed;
+       opts->ca.is_present = ak_true;
+       opts->ca.value = ak_false;
+       opts->ca.pathlenConstraint = 0;
+       if( bc->count > 0 ) {
+         ak_asn1_first( bc );
+         ak_tlv_get_bool( bc->current, &opts->ca.value );
+         if( ak_asn1_next( bc )) ak_tlv_get_uint32( bc->current, &opts->ca.pathlenConstraint );
+       }
+     }
+    /* 2.5.29.15: KeyUsage ::= BIT STRING */
+     if( strcmp( oid, "2.5.29.15" ) == 0 ) {
+       if( ak_tlv_get_bit_string( value->current, &bs ) == ak_error_ok ) {
+         opts->key_usage.is_present = ak_true;
+         opts->key_usage.bits = 0;
+         if( bs.len > 0 ) opts->key_usage.bits = (( ak_uint32 )bs.value[0] ) << 1;
+         if(( bs.len > 1 ) && ( bs.value[1]&0x80 )) opts->key_usage.bits |= 1;
+       }
+     }
+    /* 2.5.29.35: AuthorityKeyIdentifier ::= SEQUENCE { keyIdentifier [0] OCTET STRING, ... } */
+     if(( strcmp( oid, "2.5.29.35" ) == 0 ) &&
+                                          ( DATA_STRUCTURE( value->current->tag ) == CONSTRUCTED )) {
+       ak_asn1 aki = value->current->data.constructed;
+       opts->authority_key_identifier.is_present = ak_true;
+       if( aki->count > 0 ) {
+         ak_asn1_first( aki );
+         do{
+            if( aki->current->tag == ( CONTEXT_SPECIFIC^0x00 )) {
+              memcpy( fields->aki, aki->current->data.primitive,
+                                      fields->aki_len = ak_min( aki->current->len, sizeof( fields->aki )));
+            }
+            if( TAG_NUMBER( aki->current->tag ) == 0x01 )
+              opts->authority_key_identifier.include_name = ak_true;
+         } while( ak_asn1_next( aki ));
+       }
+     }
+     ak_asn1_delete( value );
+  } while( ak_asn1_next( asn ));
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция разбирает asn1 дерево сертификата открытого ключа.
+
+   Сертификат определяется следующей структурой
+
+   \code
+    Certificate  ::=  SEQUENCE  {
+        tbsCertificate       TBSCertificate,
+        signatureAlgorithm   AlgorithmIdentifier,
+        signatureValue       BIT STRING  }
+   \endcode
+
+   Описание структуры `TBSCertificate` приведено в документации к функции
+   ak_verifykey_export_to_tbs().
+
+    \param root asn1 дерево, содержащее сертификат
+    \param fields структура, в которую помещаются указатели на поля сертификата
+    \param opts структура, в которую помещаются значения расширений сертификата
+    \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха, в случае неудачи
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_certificate_get_fields( ak_asn1 root,
+                                           ak_certificate_fields fields, ak_certificate_opts opts )
+{
+  ak_asn1 asn = NULL;
+  int error = ak_error_ok;
+
+  memset( fields, 0, sizeof( struct certificate_fields ));
+  memset( opts, 0, sizeof( struct certificate_opts ));
+
+ /* проверяем структуру верхнего уровня */
+  ak_asn1_first( root );
+  if(( root->current == NULL ) || ( DATA_STRUCTURE( root->current->tag ) != CONSTRUCTED ) ||
+     ( TAG_NUMBER( root->current->tag ) != TSEQUENCE ))
+    return ak_error_message( ak_error_invalid_asn1_tag, __func__,
+                                                       "incorrect structure of certificate" );
+  if(( asn = root->current->data.constructed )->count != 3 )
+    return ak_error_message( ak_error_invalid_asn1_count, __func__,
+                                         "root asn1 context contains incorrect count of leaves" );
+  ak_asn1_first( asn );
+  fields->tbs = asn->current;
+  if(( DATA_STRUCTURE( fields->tbs->tag ) != CONSTRUCTED ) ||
+     ( TAG_NUMBER( fields->tbs->tag ) != TSEQUENCE ))
+    return ak_error_message( ak_error_invalid_asn1_tag, __func__,
+                                                     "tbsCertificate element must be a sequence" );
+  ak_asn1_last( asn );
+  if(( error = ak_tlv_get_bit_string( asn->current, &fields->signature )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect reading of certificate's signature" );
 
+ /* последовательно перебираем поля tbsCertificate */
+  if(( asn = fields->tbs->data.constructed ) == NULL )
+    return ak_error_message( ak_error_invalid_asn1_content, __func__,
+                                                            "tbsCertificate element is empty" );
+  ak_asn1_first( asn );
+  if( asn->current == NULL )
+    return ak_error_message( ak_error_invalid_asn1_content, __func__,
+                                                            "tbsCertificate element is empty" );
+  if( DATA_CLASS( asn->current->tag ) == CONTEXT_SPECIFIC ) { /* version */
+    if( !ak_asn1_next( asn )) goto lab1;
+  }
+  if( asn->count < 6 ) return ak_error_message( ak_error_invalid_asn1_count, __func__,
+                                      "tbsCertificate element contains incorrect count of leaves" );
+ /* текущим является serialNumber; переходим к signature, issuer, validity, subject и spki */
+  if( !ak_asn1_next( asn ) || !ak_asn1_next( asn ) || ( asn->current == NULL ))
+    goto lab1;
+  fields->issuer = asn->current;
+  if( !ak_asn1_next( asn ) || ( asn->current == NULL )) goto lab1;
+  if(( error = ak_tlv_get_validity( asn->current,
+                               &fields->time.not_before, &fields->time.not_after )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect reading of certificate's validity" );
+  if( !ak_asn1_next( asn ) || ( asn->current == NULL )) goto lab1;
+  fields->subject = asn->current;
+  if( !ak_asn1_next( asn ) || ( asn->current == NULL )) goto lab1;
+  if(( DATA_STRUCTURE( asn->current->tag ) != CONSTRUCTED ) ||
+     ( TAG_NUMBER( asn->current->tag ) != TSEQUENCE ))
+    return ak_error_message( ak_error_invalid_asn1_tag, __func__,
+                                         "subjectPublicKeyInfo element must be a sequence" );
+  fields->spki = asn->current->data.constructed;
+
+ /* расширения сертификата */
+  while( ak_asn1_next( asn )) {
+    if(( DATA_CLASS( asn->current->tag ) == CONTEXT_SPECIFIC ) &&
+       ( TAG_NUMBER( asn->current->tag ) == 0x03 ) &&
+       ( DATA_STRUCTURE( asn->current->tag ) == CONSTRUCTED )) {
+      ak_asn1 ext = asn->current->data.constructed;
+      if( ext == NULL ) goto lab1;
+      ak_asn1_first( ext );
+      if(( ext->current == NULL ) || ( DATA_STRUCTURE( ext->current->tag ) != CONSTRUCTED ))
+        return ak_error_message( ak_error_invalid_asn1_tag, __func__,
+                                                     "incorrect structure of certificate extensions" );
+      if(( error = ak_certificate_get_extensions( ext->current->data.constructed,
+                                                                 fields, opts )) != ak_error_ok )
+        return ak_error_message( error, __func__, "incorrect reading of certificate extensions" );
+    }
+  }
+
+ return ak_error_ok;
+
+  lab1:
+ return ak_error_message( ak_error_invalid_asn1_content, __func__,
+                                                "tbsCertificate element has unexpected structure" );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция проверяет подпись под сертификатом с помощью заданного открытого ключа.
+
+    Если сертификат с тем же хеш-кодом ранее успешно проверялся тем же ключом,
+    то проверка подписи не производится, а используется результат, сохраненный в кеше.
+    Функция не изменяет состояние открытого ключа и может одновременно вызываться
+    из нескольких потоков для одного и того же ключа.
+
+    \param vkey открытый ключ, используемый для проверки подписи
+    \param fields разобранные поля сертификата
+    \param fingerprint хеш-код der-кодировки сертификата
+    \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха, в случае неудачи
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_certificate_verify_signature( ak_verifykey vkey,
+                                         ak_certificate_fields fields, const ak_uint8 *fingerprint )
+{
+  struct hash ctx;
+  ak_uint8 hash[64], buffer[4096], issuer[32], *ptr = buffer;
+  size_t size = sizeof( buffer ), hsize = sizeof( ak_uint64 )*vkey->wc->size;
+  int error = ak_error_ok;
+
+ /* ключом кеша служит хеш-код значения открытого ключа, а не его номер,
+    поскольку номер может быть скопирован из непроверенного сертификата */
+  if(( error = ak_verifykey_get_fingerprint( vkey, issuer )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect hashing of public key" );
+  if( ak_certificate_cache_find( fingerprint, issuer )) return ak_error_ok;
+
+  if(( fields->signature.len != 2*hsize ) || ( hsize > sizeof( hash )))
+    return ak_error_message( ak_error_wrong_length, __func__,
+                                                   "unexpected length of certificate's signature" );
+ /* кодируем tbsCertificate */
+  if(( error = ak_tlv_encode( fields->tbs, ptr, &size )) == ak_error_wrong_length ) {
+    if(( ptr = malloc( size )) == NULL )
+      return ak_error_message( ak_error_out_of_memory, __func__,
+                                                  "incorrect memory allocation for tbsCertificate" );
+    error = ak_tlv_encode( fields->tbs, ptr, &size );
+  }
+  if( error != ak_error_ok ) {
+    ak_error_message( error, __func__, "incorrect encoding of tbsCertificate element" );
+    goto labex;
+  }
+
+ /* вычисляем хеш-код, используя собственный контекст функции хеширования */
+  if(( error = ak_hash_create_oid( &ctx, vkey->ctx.oid )) != ak_error_ok ) {
+    ak_error_message( error, __func__, "incorrect creation of hash function context" );
+    goto labex;
+  }
+  error = ak_hash_ptr( &ctx, ptr, size, hash, hsize );
+  ak_hash_destroy( &ctx );
+  if( error != ak_error_ok ) {
+    ak_error_message( error, __func__, "incorrect hashing of tbsCertificate element" );
+    goto labex;
+  }
+
+  if( ak_verifykey_verify_hash( vkey, hash, hsize, fields->signature.value ) != ak_true ) {
+    ak_error_message( error = ak_error_certificate_signature, __func__,
+                                                    "digital signature of certificate isn't valid" );
+    goto labex;
+  }
+  ak_certificate_cache_add( fingerprint, issuer );
+
+  labex:
+   if( ptr != buffer ) free( ptr );
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Импорт открытого ключа из сертификата, расположенного в памяти.
+
+    Если параметр `entry` отличен от `NULL`, то функция вызывается в ходе загрузки хранилища
+    доверенных сертификатов: поиск ключа эмитента выполняется без блокировки хранилища,
+    а идентификатор ключа и хеш-код имени владельца помещаются в `entry`.                         */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_verifykey_import_from_ptr_as_certificate_internal( ak_verifykey subject_vkey,
+                       ak_verifykey issuer_vkey, const ak_pointer ptr, const size_t size,
+                                     ak_certificate_opts opts, ak_certificate_store_entry entry )
+{
+  ak_asn1 root = NULL;
+  time_t now = time( NULL );
+  int error = ak_error_ok;
+  bool_t self_signed = ak_false, locked = ak_false;
+  ak_verifykey verifier = issuer_vkey;
+  struct certificate_fields fields;
+  ak_uint8 fingerprint[32], subject_name[32], issuer_name[32];
+
+  if( subject_vkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                            "using null pointer to subject's public key context" );
+  if( ptr == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                              "using null pointer to certificate" );
+  if( opts == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                   "using null pointer to certificate options" );
+  memset( subject_vkey, 0, sizeof( struct verifykey ));
+
+ /* 1. Декодируем сертификат и получаем его поля */
+  if(( error = ak_asn1_decode( root = ak_asn1_new(), ptr, size, ak_false )) != ak_error_ok ) {
+    ak_error_message( error, __func__, "incorrect decoding of certificate" );
+    goto labex;
+  }
+  if(( error = ak_certificate_get_fields( root, &fields, opts )) != ak_error_ok ) {
+    ak_error_message( error, __func__, "incorrect structure of certificate" );
+    goto labex;
+  }
+
+ /* 2. Создаем контекст открытого ключа */
+  if(( error = ak_verifykey_import_from_asn1_value( subject_vkey, fields.spki )) != ak_error_ok ) {
+    ak_error_message( error, __func__, "incorrect reading of subject's public key" );
+    goto labex;
+  }
+  subject_vkey->time = fields.time;
+  if(( now < fields.time.not_before ) || ( now > fields.time.not_after )) {
+    ak_error_message( error = ak_error_certificate_validity, __func__,
+                                                    "the validity period of certificate expired" );
+    goto lab1;
+  }
+  if( fields.ski_len == sizeof( subject_vkey->number ))
+    memcpy( subject_vkey->number, fields.ski, fields.ski_len );
+   else
+    if(( error = ak_verifykey_set_number( subject_vkey )) != ak_error_ok ) {
+      ak_error_message( error, __func__, "incorrect creation of public key number" );
+      goto lab1;
+    }
+
+ /* 3. Определяем ключ, с помощью которого должна быть проверена подпись */
+  if((( error = ak_tlv_get_fingerprint( fields.subject, subject_name )) != ak_error_ok ) ||
+     (( error = ak_tlv_get_fingerprint( fields.issuer, issuer_name )) != ak_error_ok )) {
+    ak_error_message( error, __func__, "incorrect hashing of certificate's names" );
+    goto lab1;
+  }
+  if( ak_ptr_is_equal( subject_name, issuer_name, 32 )) {
+    if(( fields.aki_len == 0 ) || (( fields.aki_len == fields.ski_len ) &&
+                                    ak_ptr_is_equal( fields.aki, fields.ski, fields.ski_len )))
+      self_signed = ak_true;
+  }
+
+  if( verifier != NULL ) {
+    if( ak_tlv_compare_global_names( fields.issuer, verifier->name ) != ak_error_ok ) {
+      ak_error_message( error = ak_error_certificate_not_equal_names, __func__,
+                       "issuer's name in certificate differs from the name of given public key" );
+      goto lab1;
+    }
+  } else {
+     if( self_signed ) verifier = subject_vkey;
+      else {
+       /* ищем ключ эмитента в хранилище доверенных сертификатов;
+          найденный ключ принадлежит хранилищу, поэтому хранилище остается заблокированным
+          до завершения проверки подписи */
+        if( entry == NULL ) {
+#ifdef AK_HAVE_PTHREAD_H
+          pthread_mutex_lock( &certificate_store_mutex );
+#endif
+          locked = ak_true;
+          if( !certificate_store.loaded ) {
+            if( ak_certificate_store_load_unlocked( NULL ) != ak_error_ok )
+              ak_error_message( ak_error_get_value(), __func__,
+                                              "incorrect loading of trusted certificates store" );
+          }
+        }
+        if( fields.aki_len > 0 ) verifier = ak_certificate_store_find_key( fields.aki, fields.aki_len );
+        if( verifier == NULL ) verifier = ak_certificate_store_find_name( issuer_name );
+        if( verifier == NULL ) {
+          ak_error_message( error = ak_error_certificate_verify_key, __func__,
+                                         "public key of certificate's issuer is not found" );
+          goto lab1;
+        }
+      }
+    }
+
+ /* 4. Проверяем подпись (или находим результат предыдущей проверки в кеше) */
+  if(( error = ak_ptr_get_fingerprint( ptr, size, fingerprint )) != ak_error_ok ) goto lab1;
+  error = ak_certificate_verify_signature( verifier, &fields, fingerprint );
+#ifdef AK_HAVE_PTHREAD_H
+  if( locked ) pthread_mutex_unlock( &certificate_store_mutex );
+#endif
+  locked = ak_false;
+  if( error != ak_error_ok ) {
+    ak_error_message( error, __func__, "incorrect verification of certificate" );
+    goto lab1;
+  }
+
+ /* 5. Переносим в контекст открытого ключа имя владельца */
+  if(( subject_vkey->name = ak_tlv_duplicate_global_name( fields.subject )) == NULL ) {
+    ak_error_message( error = ak_error_get_value(), __func__,
+                                                  "incorrect duplication of subject's name" );
+    goto lab1;
+  }
+  if( entry != NULL ) {
+    memcpy( entry->ski, subject_vkey->number, entry->ski_len = sizeof( subject_vkey->number ));
+    if( fields.ski_len > 0 ) memcpy( entry->ski, fields.ski, entry->ski_len = fields.ski_len );
+    memcpy( entry->name, subject_name, sizeof( entry->name ));
+  }
+  goto labex;
+
+  lab1:
+#ifdef AK_HAVE_PTHREAD_H
+   if( locked ) pthread_mutex_unlock( &certificate_store_mutex );
+#endif
+   ak_verifykey_destroy( subject_vkey );
+  labex: if( root != NULL ) ak_asn1_delete( root );
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция считывает сертификат из файла в der или pem формате.
+    \details Если размер файла превышает размер буффера `buf`, то память под данные выделяется
+    динамически и должна быть освобождена вызывающей стороной.
+    \return Функция возвращает указатель на считанные данные; в случае ошибки возвращается `NULL`. */
+/* ----------------------------------------------------------------------------------------------- */
+ static ak_uint8 *ak_certificate_load_from_file( ak_uint8 *buf, size_t *size,
+                                                                             const char *filename )
+{
+  size_t bufsize = *size;
+  ak_uint8 *ptr = NULL;
+
+  if(( ptr = ak_ptr_load_from_file( buf, size, filename )) == NULL ) return NULL;
+  if(( *size > 0 ) && ( ptr[0] == ( TSEQUENCE^CONSTRUCTED ))) return ptr;
+
+ /* первый октет не является началом der-последовательности, пробуем pem формат */
+  if( ptr != buf ) free( ptr );
+  *size = bufsize;
+ return ak_ptr_load_from_base64_file( buf, size, filename );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Список имен файлов, найденных в каталоге с доверенными сертификатами. */
+ typedef struct certificate_store_files {
+  /*! \brief массив имен файлов */
+   char **names;
+  /*! \brief количество найденных файлов */
+   size_t count;
+  /*! \brief размер массива имен */
+   size_t size;
+ } *ak_certificate_store_files;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция добавляет имя файла с сертификатом в список. */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_certificate_store_add_file( const char *filename, ak_pointer ptr )
+{
+  size_t len = strlen( filename );
+  ak_certificate_store_files files = ptr;
+
+  if(( len < 4 ) || (( strcmp( filename + len - 4, ".crt" ) != 0 ) &&
+     ( strcmp( filename + len - 4, ".cer" ) != 0 ) && ( strcmp( filename + len - 4, ".pem" ) != 0 )))
+    return ak_error_ok;
+
+  if( files->count == files->size ) {
+    char **names = realloc( files->names, ( files->size += 16 )*sizeof( char * ));
+    if( names == NULL ) return ak_error_message( ak_error_out_of_memory, __func__,
+                                                 "incorrect memory allocation for file names" );
+    files->names = names;
+  }
+  if(( files->names[files->count] = malloc( len + 1 )) == NULL )
+    return ak_error_message( ak_error_out_of_memory, __func__,
+                                                  "incorrect memory allocation for file name" );
+  memcpy( files->names[files->count++], filename, len + 1 );
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция помещает загруженный сертификат в хранилище и обновляет индексы. */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_certificate_store_insert( ak_certificate_store_entry entry )
+{
+  if( certificate_store.count == certificate_store.size ) {
+    size_t size = certificate_store.size + 16;
+    ak_certificate_store_entry *by_key = NULL, *by_name = NULL;
+
+    if(( by_key = malloc( size*sizeof( ak_certificate_store_entry ))) == NULL )
+      return ak_error_message( ak_error_out_of_memory, __func__,
+                                             "incorrect memory allocation for certificate store" );
+    if(( by_name = malloc( size*sizeof( ak_certificate_store_entry ))) == NULL ) {
+      free( by_key );
+      return ak_error_message( ak_error_out_of_memory, __func__,
+                                             "incorrect memory allocation for certificate store" );
+    }
+    if( certificate_store.count > 0 ) {
+      memcpy( by_key, certificate_store.by_key,
+                                       certificate_store.count*sizeof( ak_certificate_store_entry ));
+      memcpy( by_name, certificate_store.by_name,
+                                       certificate_store.count*sizeof( ak_certificate_store_entry ));
+    }
+    if( certificate_store.by_key != NULL ) free( certificate_store.by_key );
+    if( certificate_store.by_name != NULL ) free( certificate_store.by_name );
+    certificate_store.by_key = by_key;
+    certificate_store.by_name = by_name;
+    certificate_store.size = size;
+  }
+
+  certificate_store.by_key[certificate_store.count] = entry;
+  certificate_store.by_name[certificate_store.count] = entry;
+  certificate_store.count++;
+  qsort( certificate_store.by_key, certificate_store.count,
+                         sizeof( ak_certificate_store_entry ), ak_certificate_store_compare_keys );
+  qsort( certificate_store.by_name, certificate_store.count,
+                        sizeof( ak_certificate_store_entry ), ak_certificate_store_compare_names );
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция удаляет все сертификаты из хранилища (без блокировки хранилища). */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_certificate_store_clean_unlocked( void )
+{
+  size_t i = 0;
+
+  for( i = 0; i < certificate_store.count; i++ ) {
+     ak_verifykey_destroy( &certificate_store.by_key[i]->vkey );
+     free( certificate_store.by_key[i] );
+  }
+  if( certificate_store.by_key != NULL ) free( certificate_store.by_key );
+  if( certificate_store.by_name != NULL ) free( certificate_store.by_name );
+  certificate_store.by_key = certificate_store.by_name = NULL;
+  certificate_store.count = certificate_store.size = 0;
+  certificate_store.loaded = ak_false;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Загрузка хранилища доверенных сертификатов (без блокировки хранилища).
+
+    Сертификаты загружаются в несколько проходов: на каждом проходе в хранилище помещаются
+    самоподписанные сертификаты и сертификаты, подпись под которыми может быть проверена
+    ключами, уже находящимися в хранилище. Загрузка завершается, когда очередной проход
+    не добавляет ни одного сертификата. В хранилище помещаются только сертификаты,
+    допускающие подпись других сертификатов.                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_certificate_store_load_unlocked( const char *path )
+{
+  size_t i = 0, size = 0;
+  int error = ak_error_ok;
+  bool_t progress = ak_true;
+  ak_certificate_store_entry entry = NULL;
+  ak_uint8 buffer[4096], *ptr = NULL;
+  struct certificate_store_files files = { NULL, 0, 0 };
+
+  if( path == NULL ) path = LIBAKRYPT_CA_PATH;
+  certificate_store.loaded = ak_true;
+  if( ak_file_or_directory( path ) != DT_DIR ) return ak_error_ok;
+  if(( error = ak_file_find( path, "*", ak_certificate_store_add_file,
+                                                                &files, ak_false )) != ak_error_ok )
+    return ak_error_message_fmt( error, __func__, "incorrect reading of %s directory", path );
+
+  while( progress ) {
+    progress = ak_false;
+    for( i = 0; i < files.count; i++ ) {
+       if( files.names[i] == NULL ) continue;
+       if( entry == NULL ) {
+         if(( entry = malloc( sizeof( struct certificate_store_entry ))) == NULL ) {
+           ak_error_message( error = ak_error_out_of_memory, __func__,
+                                         "incorrect memory allocation for certificate store entry" );
+           goto labex;
+         }
+       }
+       size = sizeof( buffer );
+       if(( ptr = ak_certificate_load_from_file( buffer, &size, files.names[i] )) == NULL ) {
+         free( files.names[i] ); files.names[i] = NULL;
+         continue;
+       }
+       error = ak_verifykey_import_from_ptr_as_certificate_internal( &entry->vkey, NULL,
+                                                               ptr, size, &entry->opts, entry );
+       if( ptr != buffer ) free( ptr );
+
+      /* ключ эмитента может появиться в хранилище на следующем проходе */
+       if( error == ak_error_certificate_verify_key ) continue;
+       if( error == ak_error_ok ) {
+         if(( entry->opts.ca.is_present && entry->opts.ca.value ) ||
+            ( entry->opts.key_usage.is_present && ( entry->opts.key_usage.bits&bit_keyCertSign ))) {
+           if(( error = ak_certificate_store_insert( entry )) != ak_error_ok ) {
+             ak_verifykey_destroy( &entry->vkey );
+             goto labex;
+           }
+           entry = NULL;
+           progress = ak_true;
+         }
+          else ak_verifykey_destroy( &entry->vkey );
+       }
+        else ak_error_message_fmt( error, __func__, "certificate %s is ignored", files.names[i] );
+       free( files.names[i] ); files.names[i] = NULL;
+    }
+  }
+  error = ak_error_ok;
+
+  labex:
+   if( entry != NULL ) free( entry );
+   for( i = 0; i < files.count; i++ ) if( files.names[i] != NULL ) free( files.names[i] );
+   if( files.names != NULL ) free( files.names );
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \param path Каталог, содержащий доверенные сертификаты (файлы с расширениями crt, cer и pem).
+    Если значение равно `NULL`, то используется каталог, заданный при сборке библиотеки
+    (константа `LIBAKRYPT_CA_PATH`).
+
+    Ранее загруженные сертификаты удаляются из хранилища. Если функция не вызывалась явно,
+    то хранилище загружается из каталога по-умолчанию при первом поиске в нем ключа.
+
+    \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха, в случае неудачи
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_certificate_store_load( const char *path )
+{
+  int error = ak_error_ok;
+
+#ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_lock( &certificate_store_mutex );
+#endif
+  ak_certificate_store_clean_unlocked();
+  error = ak_certificate_store_load_unlocked( path );
+#ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_unlock( &certificate_store_mutex );
+#endif
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \return Функция возвращает \ref ak_error_ok (ноль).                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_certificate_store_destroy( void )
+{
+#ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_lock( &certificate_store_mutex );
+#endif
+  ak_certificate_store_clean_unlocked();
+#ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_unlock( &certificate_store_mutex );
+#endif
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \return Функция возвращает количество сертификатов, находящихся в хранилище.                  */
+/* ----------------------------------------------------------------------------------------------- */
+ size_t ak_certificate_store_count( void )
+{
+  size_t count = 0;
+
+#ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_lock( &certificate_store_mutex );
+#endif
+  if( !certificate_store.loaded ) ak_certificate_store_load_unlocked( NULL );
+  count = certificate_store.count;
+#ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_unlock( &certificate_store_mutex );
+#endif
+ return count;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция создает копию открытого ключа, принадлежащего хранилищу.
+    \details Функция вызывается при заблокированном хранилище.                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_certificate_store_copy_key( ak_verifykey vkey, ak_verifykey source )
+{
+  int error = ak_error_ok;
+
+  if( source == NULL ) return ak_error_message( ak_error_certificate_verify_key, __func__,
+                                        "public key is not found in trusted certificates store" );
+  if(( error = ak_verifykey_create( vkey, source->wc )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect creation of public key context" );
+  memcpy( vkey->number, source->number, sizeof( vkey->number ));
+  memcpy( &vkey->qpoint, &source->qpoint, sizeof( struct wpoint ));
+  vkey->oid = source->oid;
+  vkey->time = source->time;
+  vkey->flags = source->flags;
+  if(( source->name != NULL ) &&
+     (( vkey->name = ak_tlv_duplicate_global_name( source->name )) == NULL )) {
+    ak_verifykey_destroy( vkey );
+    return ak_error_message( ak_error_get_value(), __func__,
+                                                      "incorrect duplication of owner's name" );
+  }
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \param vkey Контекст открытого ключа, в который помещается копия найденного ключа;
+    после использования контекст должен быть уничтожен с помощью ak_verifykey_destroy()
+    \param ski Указатель на идентификатор открытого ключа (значение расширения
+    SubjectKeyIdentifier или номер ключа)
+    \param size Длина идентификатора (в октетах)
+    \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха; если ключ не найден,
+    возвращается \ref ak_error_certificate_verify_key.                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_certificate_store_find_by_key_identifier( ak_verifykey vkey,
+                                                         const ak_pointer ski, const size_t size )
+{
+  int error = ak_error_ok;
+
+  if( vkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                       "using null pointer to public key context" );
+  if( ski == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                           "using null pointer to key identifier" );
+#ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_lock( &certificate_store_mutex );
+#endif
+  if( !certificate_store.loaded ) ak_certificate_store_load_unlocked( NULL );
+  error = ak_certificate_store_copy_key( vkey, ak_certificate_store_find_key( ski, size ));
+#ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_unlock( &certificate_store_mutex );
+#endif
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \param vkey Контекст открытого ключа, в который помещается копия найденного ключа;
+    после использования контекст должен быть уничтожен с помощью ak_verifykey_destroy()
+    \param name Расширенное имя владельца ключа
+    \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха; если ключ не найден,
+    возвращается \ref ak_error_certificate_verify_key.                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_certificate_store_find_by_name( ak_verifykey vkey, ak_tlv name )
+{
+  ak_uint8 hash[32];
+  int error = ak_error_ok;
+
+  if( vkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                       "using null pointer to public key context" );
+  if( name == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                              "using null pointer to global name" );
+  if(( error = ak_tlv_get_fingerprint( name, hash )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect hashing of global name" );
+#ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_lock( &certificate_store_mutex );
+#endif
+  if( !certificate_store.loaded ) ak_certificate_store_load_unlocked( NULL );
+  error = ak_certificate_store_copy_key( vkey, ak_certificate_store_find_name( hash ));
+#ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_unlock( &certificate_store_mutex );
+#endif
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \param subject_vkey Контекст открытого ключа, который создается из сертификата
+    \param issuer_vkey Контекст открытого ключа, с помощью которого проверяется подпись под
+    сертификатом. Если значение равно `NULL`, то для самоподписанного сертификата
+    используется ключ, содержащийся в самом сертификате, а для прочих сертификатов ключ
+    разыскивается в хранилище доверенных сертификатов (по значению расширения
+    AuthorityKeyIdentifier, а при его отсутствии -- по расширенному имени эмитента).
+    \param ptr Указатель на область памяти, содержащую der-кодировку сертификата
+    \param size Размер der-кодировки (в октетах)
+    \param opts Структура, в которую помещаются значения расширений сертификата
+    (может принимать значение `NULL`)
+
+    Результат успешной проверки подписи сохраняется в кеше (ключом кеша служат хеш-код
+    сертификата и хеш-код значения ключа проверки), поэтому повторный импорт того же сертификата
+    не требует вычислений в группе точек эллиптической кривой.
+
+    \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха, в случае неудачи
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_verifykey_import_from_ptr_as_certificate( ak_verifykey subject_vkey,
+   ak_verifykey issuer_vkey, const ak_pointer ptr, const size_t size, ak_certificate_opts opts )
+{
+  struct certificate_opts local;
+
+ return ak_verifykey_import_from_ptr_as_certificate_internal( subject_vkey, issuer_vkey,
+                                                    ptr, size, opts == NULL ? &local : opts, NULL );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \param subject_vkey Контекст открытого ключа, который создается из сертификата
+    \param issuer_vkey Контекст открытого ключа, с помощью которого проверяется подпись под
+    сертификатом (может принимать значение `NULL`, см. описание функции
+    ak_verifykey_import_from_ptr_as_certificate() )
+    \param filename Имя файла, содержащего сертификат в der или pem формате
+    \param opts Структура, в которую помещаются значения расширений сертификата
+    (может принимать значение `NULL`)
+    \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха, в случае неудачи
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_verifykey_import_from_certificate( ak_verifykey subject_vkey, ak_verifykey issuer_vkey,
+                                                 const char *filename, ak_certificate_opts opts )
+{
+  ak_uint8 buffer[4096], *ptr = NULL;
+  size_t size = sizeof( buffer );
+  int error = ak_error_ok;
+
+  if( filename == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                                "using null pointer to filename" );
+  if(( ptr = ak_certificate_load_from_file( buffer, &size, filename )) == NULL )
+    return ak_error_message_fmt( ak_error_get_value(), __func__,
+                                                 "incorrect loading of certificate %s", filename );
+  if(( error = ak_verifykey_import_from_ptr_as_certificate( subject_vkey,
+                                                   issuer_vkey, ptr, size, opts )) != ak_error_ok )
+    ak_error_message_fmt( error, __func__, "incorrect import of certificate %s", filename );
+  if( ptr != buffer ) free( ptr );
+
+ return error;
+}
 
 /* ----------------------------------------------------------------------------------------------- */
 /*                                                                                 ak_asn1_cert.c  */
@@ -1110,6 +1110,7 @@
      if( ((ak_bckey)skey)->schedule_keys != NULL ) {
        if(( error = ((ak_bckey)skey)->schedule_keys( skey )) != ak_error_ok )
          ak_error_message( error, __func__, "incorrect execution of key scheduling procedure" );
+        else ak_bckey_cmac_set_subkeys(( ak_bckey )skey );
      }
    }
 
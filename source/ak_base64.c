@@ -9,10 +9,40 @@
 /* ----------------------------------------------------------------------------------------------- */
  #include <libakrypt-base.h>
 
+/* ----------------------------------------------------------------------------------------------- */
+#ifdef AK_HAVE_BUILTIN_MM256_SHUFFLE_EPI8
+ #include <immintrin.h>
+#else
+ #ifdef AK_HAVE_BUILTIN_SHUFFLE_EPI8
+  #include <tmmintrin.h>
+ #endif
+#endif
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Encoding table as described in RFC1113 */
  static const char base64[]="ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
+/*! \brief Таблица обратного преобразования: значение -1 соответствует символам,
+    не входящим в алфавит base64. */
+ static const signed char base64_decode_table[256] = {
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, -1, -1, 63,
+   52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1, -1,
+   -1,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+   15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, -1,
+   -1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+   41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+ };
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \param in  указатель на кодируемые данные,
     \param out указатель на данные, куда помещается результат
@@ -26,6 +56,392 @@
     out[3] = (ak_uint8) (len > 2 ? base64[ (int)(in[2] & 0x3f) ] : '=');
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*                 векторные реализации преобразований (SSSE3 и AVX2)                              */
+/* ----------------------------------------------------------------------------------------------- */
+#ifdef AK_HAVE_BUILTIN_MM256_SHUFFLE_EPI8
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Векторное кодирование: за одну итерацию 24 октета преобразуются в 32 символа.
+    \details Из входной последовательности считываются 28 октетов, поэтому цикл продолжается,
+    пока доступно не менее 28 октетов.
+    \return Функция возвращает количество обработанных октетов (кратное 24).                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static size_t ak_base64_encode_vector( const ak_uint8 *in, size_t len, ak_uint8 *out )
+{
+  size_t done = 0;
+  const __m256i shuffle = _mm256_setr_epi8(
+                              1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                              1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10 );
+  const __m256i lut = _mm256_setr_epi8(
+                  65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0,
+                  65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0 );
+
+  while( len - done >= 28 ) {
+    __m256i v = _mm256_inserti128_si256( _mm256_castsi128_si256(
+                      _mm_loadu_si128(( const __m128i *)( in + done ))),
+                      _mm_loadu_si128(( const __m128i *)( in + done + 12 )), 1 ), t0, t1, idx;
+
+   /* разбиваем каждые три октета на четыре шестибитных значения */
+    v = _mm256_shuffle_epi8( v, shuffle );
+    t0 = _mm256_mulhi_epu16( _mm256_and_si256( v, _mm256_set1_epi32( 0x0fc0fc00 )),
+                                                               _mm256_set1_epi32( 0x04000040 ));
+    t1 = _mm256_mullo_epi16( _mm256_and_si256( v, _mm256_set1_epi32( 0x003f03f0 )),
+                                                               _mm256_set1_epi32( 0x01000010 ));
+    v = _mm256_or_si256( t0, t1 );
+
+   /* переводим шестибитные значения в символы алфавита */
+    idx = _mm256_subs_epu8( v, _mm256_set1_epi8( 51 ));
+    idx = _mm256_sub_epi8( idx, _mm256_cmpgt_epi8( v, _mm256_set1_epi8( 25 )));
+    v = _mm256_add_epi8( v, _mm256_shuffle_epi8( lut, idx ));
+
+    _mm256_storeu_si256(( __m256i *) out, v );
+    out += 32; done += 24;
+  }
+ return done;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Векторное декодирование: за одну итерацию 32 символа преобразуются в 24 октета.
+    \details Обработка прекращается на первом блоке, содержащем символ, не входящий
+    в алфавит base64 (перевод строки, пробел, символ '=' и т.п.); такой блок обрабатывается
+    вызывающей функцией. В выходную последовательность записываются 32 октета, поэтому
+    цикл продолжается, пока в ней доступно не менее 32 октетов.
+    \return Функция возвращает количество обработанных символов (кратное 32).                      */
+/* ----------------------------------------------------------------------------------------------- */
+ static size_t ak_base64_decode_vector( const ak_uint8 *in, size_t len,
+                                                                 ak_uint8 *out, size_t outlen )
+{
+  size_t done = 0;
+  const __m256i lut_lo = _mm256_setr_epi8(
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a,
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a );
+  const __m256i lut_hi = _mm256_setr_epi8(
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10 );
+  const __m256i lut_roll = _mm256_setr_epi8(
+                          0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+                          0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0 );
+  const __m256i mask = _mm256_set1_epi8( 0x2f );
+  const __m256i shuffle = _mm256_setr_epi8(
+                          2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                          2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1 );
+
+  while(( len - done >= 32 ) && ( outlen >= 32 )) {
+    __m256i v = _mm256_loadu_si256(( const __m256i *)( in + done )), hi, lo, roll;
+
+   /* проверяем, что все символы принадлежат алфавиту */
+    hi = _mm256_and_si256( _mm256_srli_epi32( v, 4 ), mask );
+    lo = _mm256_shuffle_epi8( lut_lo, _mm256_and_si256( v, mask ));
+    if( !_mm256_testz_si256( lo, _mm256_shuffle_epi8( lut_hi, hi ))) break;
+
+   /* переводим символы в шестибитные значения */
+    roll = _mm256_shuffle_epi8( lut_roll, _mm256_add_epi8( _mm256_cmpeq_epi8( v, mask ), hi ));
+    v = _mm256_add_epi8( v, roll );
+
+   /* объединяем каждые четыре значения в три октета */
+    v = _mm256_maddubs_epi16( v, _mm256_set1_epi32( 0x01400140 ));
+    v = _mm256_madd_epi16( v, _mm256_set1_epi32( 0x00011000 ));
+    v = _mm256_shuffle_epi8( v, shuffle );
+    v = _mm256_permutevar8x32_epi32( v, _mm256_setr_epi32( 0, 1, 2, 4, 5, 6, -1, -1 ));
+
+    _mm256_storeu_si256(( __m256i *) out, v );
+    out += 24; outlen -= 24; done += 32;
+  }
+ return done;
+}
+
+#else
+ #ifdef AK_HAVE_BUILTIN_SHUFFLE_EPI8
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Векторное кодирование: за одну итерацию 12 октетов преобразуются в 16 символов.
+    \return Функция возвращает количество обработанных октетов (кратное 12).                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static size_t ak_base64_encode_vector( const ak_uint8 *in, size_t len, ak_uint8 *out )
+{
+  size_t done = 0;
+  const __m128i shuffle = _mm_setr_epi8( 1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10 );
+  const __m128i lut = _mm_setr_epi8( 65, 71, -4, -4, -4, -4, -4, -4,
+                                                            -4, -4, -4, -4, -19, -16, 0, 0 );
+  while( len - done >= 16 ) {
+    __m128i v = _mm_loadu_si128(( const __m128i *)( in + done )), t0, t1, idx;
+
+    v = _mm_shuffle_epi8( v, shuffle );
+    t0 = _mm_mulhi_epu16( _mm_and_si128( v, _mm_set1_epi32( 0x0fc0fc00 )),
+                                                                  _mm_set1_epi32( 0x04000040 ));
+    t1 = _mm_mullo_epi16( _mm_and_si128( v, _mm_set1_epi32( 0x003f03f0 )),
+                                                                  _mm_set1_epi32( 0x01000010 ));
+    v = _mm_or_si128( t0, t1 );
+
+    idx = _mm_subs_epu8( v, _mm_set1_epi8( 51 ));
+    idx = _mm_sub_epi8( idx, _mm_cmpgt_epi8( v, _mm_set1_epi8( 25 )));
+    v = _mm_add_epi8( v, _mm_shuffle_epi8( lut, idx ));
+
+    _mm_storeu_si128(( __m128i *) out, v );
+    out += 16; done += 12;
+  }
+ return done;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Векторное декодирование: за одну итерацию 16 символов преобразуются в 12 октетов.
+    \return Функция возвращает количество обработанных символов (кратное 16).                      */
+/* ----------------------------------------------------------------------------------------------- */
+ static size_t ak_base64_decode_vector( const ak_uint8 *in, size_t len,
+                                                                 ak_uint8 *out, size_t outlen )
+{
+  size_t done = 0;
+  const __m128i lut_lo = _mm_setr_epi8( 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                           0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a );
+  const __m128i lut_hi = _mm_setr_epi8( 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                           0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10 );
+  const __m128i lut_roll = _mm_setr_epi8( 0, 16, 19, 4, -65, -65, -71, -71,
+                                                                    0, 0, 0, 0, 0, 0, 0, 0 );
+  const __m128i mask = _mm_set1_epi8( 0x2f );
+  const __m128i shuffle = _mm_setr_epi8( 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1 );
+
+  while(( len - done >= 16 ) && ( outlen >= 16 )) {
+    __m128i v = _mm_loadu_si128(( const __m128i *)( in + done )), hi, lo, roll;
+
+    hi = _mm_and_si128( _mm_srli_epi32( v, 4 ), mask );
+    lo = _mm_shuffle_epi8( lut_lo, _mm_and_si128( v, mask ));
+    if( _mm_movemask_epi8( _mm_cmpeq_epi8( _mm_and_si128( lo, _mm_shuffle_epi8( lut_hi, hi )),
+                                                         _mm_setzero_si128( ))) != 0xffff ) break;
+
+    roll = _mm_shuffle_epi8( lut_roll, _mm_add_epi8( _mm_cmpeq_epi8( v, mask ), hi ));
+    v = _mm_add_epi8( v, roll );
+
+    v = _mm_maddubs_epi16( v, _mm_set1_epi32( 0x01400140 ));
+    v = _mm_madd_epi16( v, _mm_set1_epi32( 0x00011000 ));
+    v = _mm_shuffle_epi8( v, shuffle );
+
+    _mm_storeu_si128(( __m128i *) out, v );
+    out += 12; outlen -= 12; done += 16;
+  }
+ return done;
+}
+
+ #else
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Скалярная реализация: векторные инструкции недоступны. */
+ #define ak_base64_encode_vector( in, len, out ) (0)
+/*! \brief Скалярная реализация: векторные инструкции недоступны. */
+ #define ak_base64_decode_vector( in, len, out, outlen ) (0)
+ #endif
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция кодирует последовательность октетов в формат base64 (без разбиения на строки).
+    При наличии векторных инструкций SSSE3 или AVX2 основная часть данных кодируется
+    векторным алгоритмом, оставшиеся октеты -- скалярным.
+
+    \param in указатель на кодируемые данные
+    \param size количество кодируемых октетов
+    \param out указатель на область памяти, в которую помещаются символы base64
+    \param outsize размер области памяти `out`.
+
+    \note Перед вызовом функции переменная `outsize` должна быть инициализирована значением,
+    указывающим максимальный объем выделенной области памяти. Если данное значение окажется меньше
+    необходимого, то будет возбуждена ошибка, а необходимое значение будет помещено в `outsize`.
+    Завершающий нулевой символ не записывается.
+
+    \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха, в случае неудачи
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_base64_encode( ak_const_pointer in, const size_t size, ak_uint8 *out, size_t *outsize )
+{
+  size_t done = 0, len = 4*(( size + 2 )/3 );
+  const ak_uint8 *inp = in;
+
+  if( outsize == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                         "using null pointer to size variable" );
+  if(( out == NULL ) || ( *outsize < len )) {
+    *outsize = len;
+    return ak_error_wrong_length;
+  }
+  if(( inp == NULL ) && ( size > 0 )) return ak_error_message( ak_error_null_pointer, __func__,
+                                                                 "using null pointer to data" );
+  *outsize = len;
+  done = ak_base64_encode_vector( inp, size, out );
+  out += 4*( done/3 );
+
+  for( ; size - done >= 3; done += 3, out += 4 ) ak_base64_encodeblock(( ak_uint8 *)inp + done, out, 3 );
+  if( size > done ) {
+    ak_uint8 tail[3] = { 0, 0, 0 };
+    memcpy( tail, inp + done, size - done );
+    ak_base64_encodeblock( tail, out, ( int )( size - done ));
+  }
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Контекст потокового декодирования данных в формате base64. */
+ typedef struct base64_decoder {
+  /*! \brief область памяти, в которую помещаются декодированные данные */
+   ak_uint8 *out;
+  /*! \brief количество декодированных октетов */
+   size_t len;
+  /*! \brief размер области памяти */
+   size_t size;
+  /*! \brief накопленные, но еще не записанные шестибитные значения */
+   ak_uint32 acc;
+  /*! \brief количество накопленных значений (от нуля до трех) */
+   int state;
+  /*! \brief флаг того, что был встречен символ '=' */
+   bool_t end;
+ } *ak_base64_decoder;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция декодирует очередной фрагмент данных в формате base64.
+    \details Пробелы, символы табуляции и перевода строки пропускаются, поэтому фрагменты могут
+    разбиваться произвольным образом, в том числе внутри группы из четырех символов.
+    Символы, следующие за символом '=', кроме пробельных и '=', вызывают ошибку.
+    \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха, в случае неудачи
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_base64_decoder_update( ak_base64_decoder dc, const ak_uint8 *in, size_t size )
+{
+  size_t idx = 0;
+
+  while( idx < size ) {
+    ak_uint8 ch;
+    signed char val;
+
+   /* на границе группы пробуем обработать блок векторным алгоритмом */
+    if(( dc->state == 0 ) && ( !dc->end )) {
+      size_t done = ak_base64_decode_vector( in + idx, size - idx,
+                                                          dc->out + dc->len, dc->size - dc->len );
+      idx += done;
+      dc->len += 3*( done >> 2 );
+      if( idx == size ) break;
+    }
+
+    switch( ch = in[idx++] ) {
+      case ' ': case '\t': case '\r': case '\n': continue;
+      case '=':
+        if( !dc->end && ( dc->state < 2 ))
+          return ak_error_message( ak_error_wrong_length, __func__ ,
+                                                     "incorrect last symbol(s) of encoded data" );
+        dc->end = ak_true;
+        continue;
+      default: break;
+    }
+    if( dc->end ) return ak_error_message( ak_error_undefined_value, __func__ ,
+                                                   "unexpected symbol after the end of data" );
+    if(( val = base64_decode_table[ch] ) < 0 )
+      return ak_error_message_fmt( ak_error_undefined_value, __func__ ,
+                                                   "incorrect symbol 0x%02x of encoded data", ch );
+    dc->acc = ( dc->acc << 6 )|( ak_uint32 )val;
+    if( ++dc->state == 4 ) {
+      if( dc->len + 3 > dc->size ) return ak_error_message( ak_error_wrong_index, __func__ ,
+                                                                  "current index is too large" );
+      dc->out[dc->len++] = ( ak_uint8 )( dc->acc >> 16 );
+      dc->out[dc->len++] = ( ak_uint8 )( dc->acc >> 8 );
+      dc->out[dc->len++] = ( ak_uint8 )( dc->acc );
+      dc->acc = 0; dc->state = 0;
+    }
+  }
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция завершает декодирование и записывает последние октеты. */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_base64_decoder_finalize( ak_base64_decoder dc )
+{
+  switch( dc->state ) {
+    case 0: break;
+    case 1: return ak_error_message( ak_error_wrong_length, __func__ ,
+                                                     "incorrect last symbol(s) of encoded data" );
+    case 2:
+      if( dc->len + 1 > dc->size ) return ak_error_message( ak_error_wrong_index, __func__ ,
+                                                                  "current index is too large" );
+      dc->out[dc->len++] = ( ak_uint8 )( dc->acc >> 4 );
+      break;
+    default:
+      if( dc->len + 2 > dc->size ) return ak_error_message( ak_error_wrong_index, __func__ ,
+                                                                  "current index is too large" );
+      dc->out[dc->len++] = ( ak_uint8 )( dc->acc >> 10 );
+      dc->out[dc->len++] = ( ak_uint8 )( dc->acc >> 2 );
+      break;
+  }
+  dc->acc = 0; dc->state = 0;
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция декодирует данные в формате base64. Пробелы, символы табуляции и перевода строки
+    игнорируются, поэтому на вход может подаваться содержимое pem-файла без заголовков.
+
+    \param in указатель на символы base64
+    \param size количество символов
+    \param out указатель на область памяти, в которую помещаются декодированные данные
+    \param outsize размер области памяти `out`.
+
+    \note Перед вызовом функции переменная `outsize` должна быть инициализирована значением,
+    указывающим максимальный объем выделенной области памяти. Если данное значение окажется меньше
+    величины 3*((size+3)/4), то будет возбуждена ошибка, а данная величина будет помещена в `outsize`.
+    После успешного декодирования в `outsize` помещается количество декодированных октетов.
+
+    \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха, в случае неудачи
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_base64_decode( ak_const_pointer in, const size_t size, ak_uint8 *out, size_t *outsize )
+{
+  int error = ak_error_ok;
+  struct base64_decoder dc;
+  size_t len = 3*(( size + 3 )/4 );
+
+  if( outsize == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                         "using null pointer to size variable" );
+  if(( out == NULL ) || ( *outsize < len )) {
+    *outsize = len;
+    return ak_error_wrong_length;
+  }
+  if(( in == NULL ) && ( size > 0 )) return ak_error_message( ak_error_null_pointer, __func__,
+                                                                 "using null pointer to data" );
+  memset( &dc, 0, sizeof( struct base64_decoder ));
+  dc.out = out;
+  dc.size = *outsize;
+  if(( error = ak_base64_decoder_update( &dc, in, size )) != ak_error_ok ) return error;
+  if(( error = ak_base64_decoder_finalize( &dc )) != ak_error_ok ) return error;
+
+  *outsize = dc.len;
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция обрабатывает одну строку файла в формате base64.
+    \details Сохраняется поведение, принятое в библиотеке для pem-файлов: строки нулевой длины,
+    строки, длина которых не кратна четырем, а также строки, содержащие символы '#', ':' или
+    последовательность "-----" (заголовки pem-файла), пропускаются. Каждая строка декодируется
+    независимо; символ '=' завершает обработку строки.                                             */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_base64_decoder_line( ak_base64_decoder dc, const char *line, size_t slen )
+{
+  int error = ak_error_ok;
+  const char *eq = NULL;
+
+ /* обрабатываем конец строки для файлов, созданных в Windows */
+  if(( slen > 0 ) && ( line[slen-1] == 0x0d )) slen--;
+
+ /* проверяем корректность строки с данными */
+  if(( slen == 0 ) || ( slen%4 != 0 )) return ak_error_ok;
+  if( memchr( line, '#', slen ) || memchr( line, ':', slen )) return ak_error_ok;
+  if(( eq = memchr( line, '-', slen )) != NULL ) {
+    size_t i, cnt = 0;
+    for( i = ( size_t )( eq - line ); i < slen; i++ ) {
+       if( line[i] == '-' ) { if( ++cnt == 5 ) return ak_error_ok; } else cnt = 0;
+    }
+  }
+
+ /* символ '=' завершает данные в строке, оставшаяся часть строки игнорируется */
+  if(( eq = memchr( line, '=', slen )) != NULL ) slen = ( size_t )( eq - line ) + 1;
+  if(( error = ak_base64_decoder_update( dc, ( const ak_uint8 *)line, slen )) != ak_error_ok )
+    return error;
+  dc->end = ak_false;
+ return ak_base64_decoder_finalize( dc );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция пытается считать данные из файла в буффер, на который указывает `buf`.
     Данные в файле должны быть сохранены в формате base64. Все строки файлов,
@@ -36,6 +452,9 @@
 
     В оставшихся строках символы, не входящие в base64, вызывают ошибку декодирования.
 
+    Файл считывается блоками, строки декодируются непосредственно из считанного блока
+    (во временный буффер копируются только строки, пересекающие границу блоков).
+
  \note Функция экспортируется.
  \param buf указатель на массив, в который будут считаны данные;
  память может быть выделена заранее, если память не выделена, то указатель должен принимать
@@ -51,12 +470,14 @@
  ak_uint8 *ak_ptr_load_from_base64_file( ak_pointer buf, size_t *size, const char *filename )
 {
   struct file sfp;
-  ak_uint64 idx = 0;
-  size_t ptrlen = 0, len = 0;
+  ssize_t rb = 0;
+  size_t ptrlen = 0, off = 0;
   ak_uint8 *ptr = NULL;
-  char ch, localbuffer[1024];
-  int error = ak_error_ok, off = 0;
+  char block[4096], localbuffer[1024];
+  int error = ak_error_ok;
+  struct base64_decoder dc;
 
+  memset( &dc, 0, sizeof( struct base64_decoder ));
  /* открываемся */
   if(( error = ak_file_open_to_read( &sfp, filename )) != ak_error_ok ) {
     ak_error_message_fmt( error, __func__, "wrong opening the %s", filename );
@@ -75,110 +496,70 @@
   if(( buf == NULL ) || ( ptrlen > *size )) {
     if(( ptr = malloc( ptrlen )) == NULL ) {
       ak_error_message( error = ak_error_out_of_memory, __func__, "incorrect memory allocation" );
-      goto  exlab;
+      goto exlab;
     }
   } else { ptr = buf; }
 
- /* нарезаем входные данные на строки длиной не более чем 1022 символа */
-  memset( ptr, 0, ptrlen );
-  memset( localbuffer, 0, sizeof( localbuffer ));
-  for( idx = 0; idx < (size_t) sfp.size; idx++ ) {
-     if( ak_file_read( &sfp, &ch, 1 ) != 1 ) {
-       ak_error_message_fmt( error = ak_error_read_data, __func__ ,
-                                                               "unexpected end of %s", filename );
-       goto exlab;
-     }
-     if( off > 1022 ) {
-       ak_error_message_fmt( error = ak_error_read_data, __func__ ,
+  dc.out = ptr;
+  dc.size = ptrlen;
+
+ /* считываем файл блоками и нарезаем его на строки длиной не более чем 1022 символа */
+  while(( rb = ak_file_read( &sfp, block, sizeof( block ))) > 0 ) {
+    const char *pos = block, *end = block + rb, *eol = NULL;
+
+    while( pos < end ) {
+      if(( eol = memchr( pos, '\n', ( size_t )( end - pos ))) == NULL ) eol = end;
+      if(( off + ( size_t )( eol - pos )) > 1022 ) {
+        ak_error_message_fmt( error = ak_error_read_data, __func__ ,
                                           "%s has a line with more than 1022 symbols", filename );
-       goto exlab;
-     }
-    if( ch == '\n' ) {
-      int state = 0;
-      char *pos = 0;
-      size_t i = 0, slen = strlen( localbuffer );
-
-     /* обрабатываем конец строки для файлов, созданных в Windows */
-      if((slen > 0) && (localbuffer[slen-1] == 0x0d )) { localbuffer[slen-1] = 0; slen--; }
-
-     /* проверяем корректность строки с данными */
-      if(( slen != 0 ) &&              /* строка не пустая */
-         ( slen%4 ==0 ) &&             /* длина строки кратна четырем */
-         ( strchr( localbuffer, '#' ) == 0 ) &&        /* строка не содержит символ # */
-         ( strchr( localbuffer, ':' ) == 0 ) &&        /* строка не содержит символ : */
-         ( strstr( localbuffer, "-----" ) == NULL )) { /* строка не содержит ----- */
-
-        /* теперь последовательно декодируем одну строку */
-         while(( ch = localbuffer[i++]) != 0 ) {
-           if( ch == ' ' ) continue; /* пробелы пропускаем */
-           if( ch == '=' ) break;    /* достигли конца данных */
-           if(( pos = strchr( base64, ch )) == NULL ) { /* встречен некорректный символ */
-             ak_error_message_fmt( error = ak_error_undefined_value, __func__ ,
-                                                    "%s contains an incorrect symbol", filename );
-             goto exlab;
-           }
-           if( len + 1 >= ptrlen ) { /* достаточно места для хранения данных */
-             ak_error_message( error = ak_error_wrong_index, __func__ ,
-                                                                   "current index is too large" );
-             goto exlab;
-           }
-           switch( state ) {
-             case 0:
-               ptr[len] = (pos - base64) << 2;
-               state = 1;
-             break;
-
-             case 1:
-               ptr[len] |= (pos - base64) >> 4;
-               ptr[len+1] = ((pos - base64) & 0x0f) << 4;
-               len++;
-               state = 2;
-             break;
-
-             case 2:
-               ptr[len] |= (pos - base64) >> 2;
-               ptr[len+1] = ((pos - base64) & 0x03) << 6;
-               len++;
-               state = 3;
-             break;
-
-             case 3:
-               ptr[len] |= (pos - base64);
-               len++;
-               state = 0;
-             break;
-             default: break;
-           }
-         }
-
-        /* обработка конца данных */
-         if( ch == '=' ) {
-           if(( state == 0 ) || ( state == 1 )) {
-             ak_error_message( error = ak_error_wrong_length, __func__ ,
-                                                     "incorrect last symbol(s) of encoded data" );
-             goto exlab;
-           }
-         }
-
-      } /* далее мы очищаем строку независимо от ее содержимого */
-      off = 0;
-      memset( localbuffer, 0, 1024 );
-    } else localbuffer[off++] = ch;
+        goto exlab;
+      }
+      if( eol == end ) { /* строка продолжается в следующем блоке */
+        memcpy( localbuffer + off, pos, ( size_t )( eol - pos ));
+        off += ( size_t )( eol - pos );
+        break;
+      }
+      if( off > 0 ) {
+        memcpy( localbuffer + off, pos, ( size_t )( eol - pos ));
+        error = ak_base64_decoder_line( &dc, localbuffer, off + ( size_t )( eol - pos ));
+        off = 0;
+      }
+       else error = ak_base64_decoder_line( &dc, pos, ( size_t )( eol - pos ));
+      if( error != ak_error_ok ) {
+        ak_error_message_fmt( error, __func__ , "%s contains an incorrect data", filename );
+        goto exlab;
+      }
+      pos = eol + 1;
+    }
+  }
+  if( rb < 0 ) {
+    ak_error_message_fmt( error = ak_error_read_data, __func__ ,
+                                                               "unexpected end of %s", filename );
+    goto exlab;
+  }
+ /* обрабатываем последнюю строку, не завершенную символом перевода строки */
+  if( off > 0 ) {
+    if(( error = ak_base64_decoder_line( &dc, localbuffer, off )) != ak_error_ok ) {
+      ak_error_message_fmt( error, __func__ , "%s contains an incorrect data", filename );
+      goto exlab;
+    }
   }
 
  /* получили нулевой вектор => ошибка */
-  if( len == 0 ) ak_error_message_fmt( error = ak_error_zero_length, __func__,
+  if( dc.len == 0 ) ak_error_message_fmt( error = ak_error_zero_length, __func__,
                                        "%s not contain a correct base64 encoded data", filename );
  exlab:
-  *size = len;
+  *size = dc.len;
   ak_file_close( &sfp );
   if( error != ak_error_ok ) {
-    if( ptr != NULL ) free(ptr);
+    if(( ptr != NULL ) && ( ptr != buf )) free(ptr);
     ptr = NULL;
   }
  return ptr;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \example test-base64.c                                                                        */
 /* ----------------------------------------------------------------------------------------------- */
 /* ak_base64.c                                                                                     */
 /* ----------------------------------------------------------------------------------------------- */
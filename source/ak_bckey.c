@@ -43,6 +43,11 @@
                                                         "using block cipher key with zero length" );
   if( !blocksize ) return ak_error_message( ak_error_zero_length, __func__,
                                                             "using cipher with zero block length" );
+ /* при необходимости выполняем динамический контроль алгоритмов блочного шифрования */
+  if( !ak_libakrypt_control_test_on_first_use( gfn_control_test ) ||
+      !ak_libakrypt_control_test_on_first_use( block_cipher_control_test ))
+    return ak_error_message( ak_error_control_test, __func__,
+                                                 "incorrect dynamic control of block ciphers" );
  /* инициализируем ключевые данные */
   if(( error = ak_skey_create( &bkey->key, keysize )) != ak_error_ok )
     return ak_error_message( error, __func__, "wrong creation of secret key" );
@@ -52,8 +57,12 @@
   bkey->ivector_size =  0;
   bkey->encrypt =       NULL;
   bkey->decrypt =       NULL;
+  bkey->encrypt_blocks = NULL;
+  bkey->decrypt_blocks = NULL;
   bkey->schedule_keys = NULL;
   bkey->delete_keys =   NULL;
+  memset( bkey->cmac_subkeys, 0, sizeof( bkey->cmac_subkeys ));
+  memset( bkey->cmac_mask, 0, sizeof( bkey->cmac_mask ));
 
  return ak_error_ok;
 }
@@ -78,6 +87,9 @@
                                                           &bkey->key.generator )) != ak_error_ok )
     ak_error_message( error, __func__, "incorrect wiping of internal buffer" );
   bkey->ivector_size = 0;
+  if(( error =  ak_ptr_wipe( bkey->cmac_subkeys, sizeof( bkey->cmac_subkeys ),
+                                                          &bkey->key.generator )) != ak_error_ok )
+    ak_error_message( error, __func__, "incorrect wiping of cmac subkeys" );
 
  /* уничтожаем секретный ключ */
   if(( error = ak_skey_destroy( &bkey->key )) != ak_error_ok )
@@ -175,6 +187,7 @@
   if( bkey->schedule_keys != NULL ) {
     if(( error = bkey->schedule_keys( &bkey->key )) != ak_error_ok )
       ak_error_message( error, __func__, "incorrect execution of key scheduling procedure" );
+     else ak_bckey_cmac_set_subkeys( bkey );
   }
  /* устанавливаем ресурс использования секретного ключа */
   switch( bkey->bsize ) {
@@ -194,6 +207,67 @@
  return error;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \details Функция заменяет значение ключа, которому ранее уже было присвоено значение,
+    новым значением, содержащимся в области памяти, на которую указывает `keyptr`.
+    В отличие от функции ak_bckey_set_key(), память под ключ и развернутые раундовые ключи
+    повторно не выделяется: новое значение копируется на место старого, маскируется,
+    для него вычисляется контрольная сумма, после чего развертка ключа выполняется в
+    уже выделенной памяти.
+
+    Функция предназначена для частой смены ключа, например, в режимах семейства ACPKM.
+    Поэтому ресурс ключа функцией не изменяется (его устанавливает вызывающая сторона), а
+    дополнительные ключи алгоритма выработки имитовставки CMAC заранее не вычисляются
+    (при необходимости они вычисляются в ходе выработки имитовставки).
+
+    Если ключу еще не было присвоено значение, то вызывается функция ak_bckey_set_key().
+
+    @param bkey Контекст ключа блочного алгоритма шифрования.
+    @param keyptr Указатель на область памяти, содержащую новое значение ключа.
+    @param size Размер области памяти, содержащей значение ключа; должен совпадать
+    с длиной текущего ключа.
+
+    @return Функция возвращает код ошибки. В случае успеха возвращается \ref ak_error_ok (ноль).   */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_rekey( ak_bckey bkey, const ak_pointer keyptr, const size_t size )
+{
+  size_t idx = 0;
+  int error = ak_error_ok;
+  ak_skey skey = NULL;
+
+ /* проверяем входные данные */
+  if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                      "using null pointer to secret key context" );
+  if( keyptr == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                                "using null pointer to key data" );
+  if( size != bkey->key.key_size ) return ak_error_message( ak_error_wrong_length, __func__,
+                                       "using a constant value for secret key with wrong length" );
+  if((( skey = &bkey->key )->flags&ak_key_flag_set_key ) == 0 )
+    return ak_bckey_set_key( bkey, keyptr, size );
+
+ /* копируем новое значение на место старого (для алгоритма Магма в режиме
+    совместимости с openssl ключ дополнительно переворачивается) */
+  if(( ak_libakrypt_get_option_by_name( "openssl_compability" ) == 1 ) &&
+                                                ( strncmp( skey->oid->name[0], "magma", 5 ) == 0 ))
+    for( idx = 0; idx < 32; idx++ ) skey->key[idx] = ((ak_uint8 *)keyptr)[31-idx];
+   else memcpy( skey->key, keyptr, size );
+  memset( skey->key+size, 0, size );
+
+ /* маскируем ключ и вычисляем контрольную сумму */
+  skey->flags &= ~( ak_key_flag_set_mask | ak_key_flag_cmac_subkeys );
+  if(( error = skey->set_mask( skey )) != ak_error_ok )
+    return ak_error_message( error, __func__ , "wrong secret key masking" );
+  if(( error = skey->set_icode( skey )) != ak_error_ok )
+    return ak_error_message( error, __func__ , "wrong calculation of integrity code" );
+
+ /* развертка ключа выполняется в ранее выделенной памяти */
+  if( bkey->schedule_keys != NULL )
+    if(( error = bkey->schedule_keys( skey )) != ak_error_ok )
+      ak_error_message( error, __func__, "incorrect execution of key scheduling procedure" );
+
+ return error;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция присваивает контексту ключа алгоритма блочного шифрования случайное (псевдослучайное)
     значение, вырабатываемое заданным генератором случайных (псевдослучайных) чисел.
@@ -224,6 +298,7 @@
   if( bkey->schedule_keys != NULL ) error = bkey->schedule_keys( &bkey->key );
   if( error != ak_error_ok )
     ak_error_message( error, __func__, "incorrect execution of key scheduling procedure" );
+   else ak_bckey_cmac_set_subkeys( bkey );
 
  /* устанавливаем ресурс использования секретного ключа */
   switch( bkey->bsize ) {
@@ -281,6 +356,7 @@
   if( bkey->schedule_keys != NULL ) error = bkey->schedule_keys( &bkey->key );
   if( error != ak_error_ok )
     ak_error_message( error, __func__, "incorrect execution of key scheduling procedure" );
+   else ak_bckey_cmac_set_subkeys( bkey );
 
  /* устанавливаем ресурс использования секретного ключа */
   switch( bkey->bsize ) {
@@ -330,9 +406,19 @@
     ak_error_message( error, __func__, "incorrect unmasking block cipher context" );
     goto  labex;
   }
-  if(( error = ak_bckey_set_key( bkey, rkey->key.key, rkey->key.key_size )) != ak_error_ok ) {
-    ak_error_message( error, __func__, "incorrect assigning a new key value" );
+ /* ключ алгоритма Магма в режиме совместимости с openssl хранится в перевернутом виде,
+    поэтому, перед присвоением, переворачиваем его обратно */
+  if(( ak_libakrypt_get_option_by_name( "openssl_compability" ) == 1 ) &&
+                                         ( strncmp( rkey->key.oid->name[0], "magma", 5 ) == 0 )) {
+    size_t i = 0;
+    ak_uint8 revkey[32];
+
+    for( i = 0; i < 32; i++ ) revkey[i] = rkey->key.key[31-i];
+    error = ak_bckey_set_key( bkey, revkey, sizeof( revkey ));
+    ak_ptr_wipe( revkey, sizeof( revkey ), &rkey->key.generator );
   }
+   else error = ak_bckey_set_key( bkey, rkey->key.key, rkey->key.key_size );
+  if( error != ak_error_ok ) ak_error_message( error, __func__, "incorrect assigning a new key value" );
   rkey->key.set_mask( &rkey->key );
 
  return error;
@@ -344,6 +430,280 @@
 
 /* ----------------------------------------------------------------------------------------------- */
 /*                             теперь реализация режимов шифрования                                */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Количество блоков, обрабатываемых за одно обращение к функции преобразования
+    нескольких блоков в режимах со сцеплением. */
+ #define ak_bckey_blocks_batch       (16)
+/*! \brief Минимальный объем данных (в октетах), обрабатываемых с использованием нескольких потоков. */
+ #define ak_bckey_parallel_min_size  (262144)
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Преобразования, выполняемые над последовательностью блоков, все входы блочного шифра
+    для которых известны заранее. */
+ typedef enum {
+  /*! \brief Зашифрование в режиме простой замены. */
+   blocks_encrypt_ecb,
+  /*! \brief Расшифрование в режиме простой замены. */
+   blocks_decrypt_ecb,
+  /*! \brief Расшифрование в режиме простой замены с зацеплением. */
+   blocks_decrypt_cbc,
+  /*! \brief Расшифрование в режиме гаммирования с обратной связью по шифртексту. */
+   blocks_decrypt_cfb,
+  /*! \brief Выработка гаммы (и гаммирование) в режиме гаммирования. */
+   blocks_ctr
+ } blocks_mode_t;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция зашифровывает (расшифровывает) несколько последовательно расположенных блоков.
+    \details Если для алгоритма определена функция преобразования нескольких блоков,
+    то используется она; в противном случае блоки преобразуются по одному.                        */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_bckey_apply_blocks( ak_bckey bkey, const bool_t encrypt,
+                                                ak_uint8 *in, ak_uint8 *out, size_t blocks )
+{
+  ak_function_bckey_blocks *multiple = encrypt ? bkey->encrypt_blocks : bkey->decrypt_blocks;
+  ak_function_bckey *single = encrypt ? bkey->encrypt : bkey->decrypt;
+
+  if( multiple != NULL ) multiple( &bkey->key, in, out, blocks );
+   else
+    for( ; blocks > 0; blocks--, in += bkey->bsize, out += bkey->bsize )
+       single( &bkey->key, in, out );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция расшифровывает последовательность блоков в режимах CBC и CFB.
+    \details Значения сцепления хранятся в кольцевом буффере `ring` из `z` блоков:
+    блоку с номером `k` соответствует ячейка `k mod z`, которая в момент обработки блока
+    содержит предыдущий блок шифртекста с тем же остатком (либо соответствующий блок
+    синхропосылки). Данные обрабатываются группами по ak_bckey_blocks_batch блоков;
+    перед записью результата шифртекст группы сохраняется в кольцевом буффере, поэтому
+    допускается совпадение указателей `in` и `out`.
+
+    @param bkey Контекст ключа алгоритма блочного шифрования.
+    @param cfb Флаг режима CFB (в противном случае используется режим CBC).
+    @param in Указатель на шифртекст.
+    @param out Указатель на область памяти, куда помещается открытый текст.
+    @param start Номер первого обрабатываемого блока.
+    @param blocks Количество обрабатываемых блоков.
+    @param ring Кольцевой буффер значений сцепления (изменяется функцией).
+    @param z Количество блоков в кольцевом буффере.                                               */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_bckey_decrypt_chained_blocks( ak_bckey bkey, const bool_t cfb, ak_uint8 *in,
+                 ak_uint8 *out, size_t start, size_t blocks, ak_uint8 *ring, const size_t z )
+{
+  size_t i = 0, count = 0;
+  const size_t bsize = bkey->bsize;
+  ak_uint64 chain[2*ak_bckey_blocks_batch], result[2*ak_bckey_blocks_batch];
+
+  while( blocks > 0 ) {
+    count = ak_min( blocks, ak_bckey_blocks_batch );
+   /* собираем значения сцепления для блоков группы */
+    for( i = 0; i < count; i++ )
+       memcpy(( ak_uint8 *)chain + i*bsize,
+                          i < z ? ring + (( start+i )%z )*bsize : in + ( i-z )*bsize, bsize );
+   /* сохраняем последние блоки шифртекста группы до того, как они будут перезаписаны */
+    for( i = ( count > z ? count - z : 0 ); i < count; i++ )
+       memcpy( ring + (( start+i )%z )*bsize, in + i*bsize, bsize );
+
+    if( cfb ) {
+      ak_bckey_apply_blocks( bkey, ak_true, ( ak_uint8 *)chain, ( ak_uint8 *)result, count );
+      for( i = 0; i < ( count*bsize ) >> 3; i++ )
+         (( ak_uint64 *)out )[i] = (( ak_uint64 *)in )[i] ^ result[i];
+    } else {
+        ak_bckey_apply_blocks( bkey, ak_false, in, ( ak_uint8 *)result, count );
+        for( i = 0; i < ( count*bsize ) >> 3; i++ )
+           (( ak_uint64 *)out )[i] = result[i] ^ chain[i];
+      }
+    in += count*bsize; out += count*bsize;
+    start += count; blocks -= count;
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вырабатывает гамму в режиме гаммирования для последовательности блоков.
+    \details Значение счетчика для блока с номером `k` вычисляется непосредственно
+    по начальному значению `ivector`, поэтому последовательность блоков может быть разделена на независимо обрабатываемые части.
+    Значения счетчиков зашифровываются группами по ak_bckey_blocks_batch блоков.
+
+    @param bkey Контекст ключа алгоритма блочного шифрования.
+    @param in Указатель на входные данные; если указатель равен `NULL`,
+    то в `out` помещается сама гамма.
+    @param out Указатель на область памяти, куда помещается результат.
+    @param start Номер первого обрабатываемого блока.
+    @param blocks Количество обрабатываемых блоков.
+    @param ivector Начальное значение счетчика.                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_bckey_ctr_blocks( ak_bckey bkey, ak_uint8 *in, ak_uint8 *out,
+                                      size_t start, size_t blocks, const ak_uint8 *ivector )
+{
+  size_t i = 0, count = 0;
+  const size_t bsize = bkey->bsize, qwords = bkey->bsize >> 3;
+  const int oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
+ /* для Магмы счетчик занимает весь блок, для Кузнечика - одну из половин */
+  const size_t w = ( bsize == 16 ) ? ( size_t )oc : 0;
+  ak_uint64 x, y, counters[2*ak_bckey_blocks_batch], gamma[2*ak_bckey_blocks_batch];
+
+ #ifdef AK_LITTLE_ENDIAN
+  x = oc ? bswap_64( ((ak_uint64 *)ivector)[w] ) : ((ak_uint64 *)ivector)[w];
+ #else
+  x = oc ? ((ak_uint64 *)ivector)[w] : bswap_64( ((ak_uint64 *)ivector)[w] );
+ #endif
+
+  while( blocks > 0 ) {
+    count = ak_min( blocks, ak_bckey_blocks_batch );
+    for( i = 0; i < count; i++ ) {
+       memcpy( counters + i*qwords, ivector, bsize );
+       y = x + start + i;
+      #ifdef AK_LITTLE_ENDIAN
+       counters[i*qwords + w] = oc ? bswap_64( y ) : y;
+      #else
+       counters[i*qwords + w] = oc ? y : bswap_64( y );
+      #endif
+    }
+    ak_bckey_apply_blocks( bkey, ak_true, ( ak_uint8 *)counters, ( ak_uint8 *)gamma, count );
+    if( in != NULL ) {
+      for( i = 0; i < count*qwords; i++ )
+         (( ak_uint64 *)out )[i] = (( ak_uint64 *)in )[i] ^ gamma[i];
+      in += count*bsize;
+    }
+     else memcpy( out, gamma, count*bsize );
+    out += count*bsize;
+    start += count; blocks -= count;
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция выполняет заданное преобразование последовательности блоков. */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_bckey_process_blocks( ak_bckey bkey, const blocks_mode_t mode, ak_uint8 *in,
+                 ak_uint8 *out, const size_t start, const size_t blocks, ak_uint8 *ring, const size_t z )
+{
+  switch( mode ) {
+    case blocks_encrypt_ecb: ak_bckey_apply_blocks( bkey, ak_true, in, out, blocks ); break;
+    case blocks_decrypt_ecb: ak_bckey_apply_blocks( bkey, ak_false, in, out, blocks ); break;
+    case blocks_decrypt_cbc:
+      ak_bckey_decrypt_chained_blocks( bkey, ak_false, in, out, start, blocks, ring, z ); break;
+    case blocks_decrypt_cfb:
+      ak_bckey_decrypt_chained_blocks( bkey, ak_true, in, out, start, blocks, ring, z ); break;
+    case blocks_ctr: ak_bckey_ctr_blocks( bkey, in, out, start, blocks, ring ); break;
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Задание для параллельной обработки последовательности блоков. */
+ typedef struct bckey_blocks_job {
+  /*! \brief Ключ, используемый для обработки первой части данных. */
+   ak_bckey bkey;
+  /*! \brief Копии ключа для остальных частей данных. */
+   struct bckey *keys;
+  /*! \brief Выполняемое преобразование. */
+   blocks_mode_t mode;
+  /*! \brief Указатель на входные данные. */
+   ak_uint8 *in;
+  /*! \brief Указатель на выходные данные. */
+   ak_uint8 *out;
+  /*! \brief Общее количество блоков. */
+   size_t blocks;
+  /*! \brief Количество блоков в одной части. */
+   size_t part;
+  /*! \brief Кольцевые буфферы значений сцепления (по одному на каждую часть). */
+   ak_uint8 *rings;
+  /*! \brief Количество блоков в кольцевом буффере. */
+   size_t z;
+ } *ak_bckey_blocks_job;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция обрабатывает одну часть данных; вызывается из ak_libakrypt_parallel_run(). */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_bckey_process_blocks_part( ak_pointer ptr, const size_t idx )
+{
+  ak_bckey_blocks_job job = ( ak_bckey_blocks_job )ptr;
+  ak_bckey bkey = idx ? job->keys + idx - 1 : job->bkey;
+  size_t start = idx*job->part, offset = start*bkey->bsize;
+
+  ak_bckey_process_blocks( bkey, job->mode, job->in ? job->in + offset : NULL,
+                                 job->out + offset, start, ak_min( job->part, job->blocks - start ),
+                                                 job->rings + idx*sizeof( bkey->ivector ), job->z );
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция выполняет заданное преобразование последовательности блоков, распределяя
+    данные между несколькими потоками.
+    \details Данные делятся на части по числу потоков. Первая часть обрабатывается исходным
+    ключом, для остальных частей создаются копии ключа (маскированное преобразование Магмы
+    изменяет состояние генератора ключа, поэтому один контекст не может использоваться
+    одновременно несколькими потоками). Начальные значения сцепления для каждой части
+    вычисляются до начала обработки, так что допускается совпадение указателей `in` и `out`.
+    В режиме гаммирования буффер `ring` содержит начальное значение счетчика, которое
+    передается всем частям без изменения.
+    Если многопоточная обработка не требуется, то данные обрабатываются последовательно.
+
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_bckey_run_blocks( ak_bckey bkey, const blocks_mode_t mode,
+                        ak_uint8 *in, ak_uint8 *out, const size_t blocks, ak_uint8 *ring, size_t z )
+{
+  struct bckey_blocks_job job;
+  int error = ak_error_ok;
+  size_t i = 0, k = 0, start = 0, created = 0, count = 0, threads = 0;
+
+  if(( blocks*bkey->bsize < ak_bckey_parallel_min_size ) ||
+     (( threads = ak_libakrypt_get_threads_count()) < 2 )) {
+    ak_bckey_process_blocks( bkey, mode, in, out, 0, blocks, ring, z );
+    return ak_error_ok;
+  }
+
+  job.bkey = bkey;
+  job.mode = mode;
+  job.in = in;
+  job.out = out;
+  job.blocks = blocks;
+  job.part = ( blocks + threads - 1 )/threads;
+  job.z = z;
+  count = ( blocks + job.part - 1 )/job.part;
+  if(( job.keys = ak_aligned_malloc(( count - 1 )*sizeof( struct bckey ))) == NULL )
+    return ak_error_message( ak_error_out_of_memory, __func__,
+                                                          "incorrect memory allocation for keys" );
+  if(( job.rings = malloc( count*sizeof( bkey->ivector ))) == NULL ) {
+    ak_error_message( error = ak_error_out_of_memory, __func__,
+                                               "incorrect memory allocation for chaining values" );
+    goto labex;
+  }
+  for( created = 0; created < count - 1; created++ )
+     if(( error = ak_bckey_create_and_set_bckey( job.keys + created, bkey )) != ak_error_ok ) {
+       ak_error_message( error, __func__, "incorrect duplication of block cipher key" );
+       goto labex;
+     }
+
+ /* начальные значения сцепления для каждой части */
+  if( z > 0 ) {
+    for( i = 0; i < count; i++ ) {
+       memcpy( job.rings + i*sizeof( bkey->ivector ), ring, z*bkey->bsize );
+       if( mode == blocks_ctr ) continue;
+       start = i*job.part;
+       for( k = ( start > z ? start - z : 0 ); k < start; k++ )
+          memcpy( job.rings + i*sizeof( bkey->ivector ) + ( k%z )*bkey->bsize,
+                                                               in + k*bkey->bsize, bkey->bsize );
+    }
+  }
+
+  if(( error = ak_libakrypt_parallel_run( ak_bckey_process_blocks_part,
+                                                                &job, count )) != ak_error_ok ) {
+    ak_error_message( error, __func__, "incorrect processing of data blocks" );
+    goto labex;
+  }
+ /* значение сцепления после обработки последней части */
+  if( z > 0 ) memcpy( ring, job.rings + ( count - 1 )*sizeof( bkey->ivector ), z*bkey->bsize );
+
+  labex:
+   for( i = 0; i < created; i++ ) ak_bckey_destroy( job.keys + i );
+   free( job.keys );
+   if( job.rings != NULL ) free( job.rings );
+ return error;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! @param bkey Контекст ключа алгоритма блочного шифрования.
     @param in Указатель на область памяти, где хранятся входные (зашифровываемые) данные
@@ -359,7 +719,6 @@
 {
   size_t blocks = 0;
   int error = ak_error_ok;
-  ak_uint64 *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
 
  /* выполняем проверку размера входных данных */
   if( size%bkey->bsize != 0 )
@@ -378,22 +737,12 @@
    else bkey->key.resource.value.counter -= blocks;
 
  /* теперь приступаем к зашифрованию данных */
-  switch( bkey->bsize ) {
-    case  8: /* шифр с длиной блока 64 бита */
-      do {
-        bkey->encrypt( &bkey->key, inptr++, outptr++ );
-      } while( --blocks > 0 );
-    break;
-
-    case 16: /* шифр с длиной блока 128 бит */
-      do {
-        bkey->encrypt( &bkey->key, inptr, outptr );
-        inptr+=2; outptr+=2;
-      } while( --blocks > 0 );
-    break;
-    default: return ak_error_message( ak_error_wrong_block_cipher,
+  if(( bkey->bsize != 8 ) && ( bkey->bsize != 16 ))
+    return ak_error_message( ak_error_wrong_block_cipher,
                                           __func__ , "incorrect block size of block cipher key" );
-  }
+  if(( error = ak_bckey_run_blocks( bkey, blocks_encrypt_ecb,
+                                                 in, out, blocks, NULL, 0 )) != ak_error_ok )
+    return ak_error_message( error, __func__ , "incorrect encryption of data blocks" );
  /* перемаскируем ключ */
   if(( error = bkey->key.set_mask( &bkey->key )) != ak_error_ok )
     ak_error_message( error, __func__ , "wrong remasking of secret key" );
@@ -416,7 +765,6 @@
 {
   size_t blocks = 0;
   int error = ak_error_ok;
-  ak_uint64 *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
 
  /* выполняем проверку размера входных данных */
   if( size%bkey->bsize != 0 )
@@ -435,22 +783,12 @@
    else bkey->key.resource.value.counter -= blocks;
 
  /* теперь приступаем к расшифрованию данных */
-  switch( bkey->bsize ) {
-    case  8: /* шифр с длиной блока 64 бита */
-      do {
-        bkey->decrypt( &bkey->key, inptr++, outptr++ );
-      } while( --blocks > 0 );
-    break;
-
-    case 16: /* шифр с длиной блока 128 бит */
-      do {
-        bkey->decrypt( &bkey->key, inptr, outptr );
-        inptr+=2; outptr+=2;
-      } while( --blocks > 0 );
-    break;
-    default: return ak_error_message( ak_error_wrong_block_cipher,
+  if(( bkey->bsize != 8 ) && ( bkey->bsize != 16 ))
+    return ak_error_message( ak_error_wrong_block_cipher,
                                           __func__ , "incorrect block size of block cipher key" );
-  }
+  if(( error = ak_bckey_run_blocks( bkey, blocks_decrypt_ecb,
+                                                 in, out, blocks, NULL, 0 )) != ak_error_ok )
+    return ak_error_message( error, __func__ , "incorrect decryption of data blocks" );
  /* перемаскируем ключ */
   if(( error = bkey->key.set_mask( &bkey->key )) != ak_error_ok )
     ak_error_message( error, __func__ , "wrong remasking of secret key" );
@@ -459,65 +797,28 @@
 }
 
 /* ----------------------------------------------------------------------------------------------- */
-/*! Поскольку в режиме гаммирования операцией шифрования является сложение открытого текста по
-    модулю два с последовательностью, вырабатываемой блочным шифром из заданной синхропосылки,
-    то для зашифрования и расшифрования информациии используется одна и та же функция.
-
-    Значение синхропосылки `iv` копируется в контекст секретного ключа (область памяти, на которую
-    указывает `iv` не изменяется) и преобразуется в ходе реализации режима гаммирования.
-    Преобразованное значение сохраняется в контексте секретного ключа в буффере `skey.ivector`.
-    Данное значение может быть использовано при повторном вызове функции ak_bckey_ctr().
-    Следующий пример иллюстрирует сказанное.
-
-
-\code
- // bkey - ключ алгоритма "Магма"
- // шифрование буффера с данными одним фрагментом
-  ak_bckey_ctr( bkey, in, out, size, iv, 4 );
-
- // тот же результат может быть получен за три последовательных вызова
-  ak_bckey_ctr( bkey, in, out, 16, iv, 4 );
-  ak_bckey_ctr( bkey, in+16, out+16, 16, NULL, 0 );
-  ak_bckey_ctr( bkey, in+32, out+32, size-32, NULL, 0 );
- //   для того, чтобы использовать внутреннее значение синхропосылки,
- //                мы передаем нулевые значения последних параметров
- //        использовать данную возможность можно только в том случае,
- // когда длина переданных в функцию ранее данных кратна длине блока
-\endcode
-
-
- В приведенном выше фрагменте исходный буффер сначала зашифровывается за один вызов функции,
- а потом фрагментами, длина которых кратна длине блока используемого алгоритма блочного шифрования.
- Результаты зашифрования должны совпадать в обоих случаях. Указанное поведение функции позволяет
- зашифровывать данные в случае, когда они поступают фрагментами, например из сети, или когда хранение
- данных полностью в оперативной памяти нецелесообразно (например, шифрование больших файлов).
-
-    @param bkey Контекст ключа алгоритма блочного шифрования, на котором происходит
-    зашифрование или расшифрование информации.
-    @param in Указатель на область памяти, где хранятся входные (открытые) данные.
-    @param out Указатель на область памяти, куда помещаются зашифрованные данные
-    (этот указатель может совпадать с `in`).
-    @param size Размер зашировываемых данных (в байтах).
-    @param iv Указатель на произвольную область памяти - синхропосылку. Область памяти, на
-    которую указывает `iv` не изменяется.
-    @param iv_size Длина синхропосылки в байтах. Согласно  стандарту ГОСТ Р 34.13-2015 длина
-    синхропосылки должна быть ровно в два раза меньше, чем длина блока, то есть 4 байта для Магмы
-    и 8 байт для Кузнечика. Значение `iv_size`, отличное от указанных, может привести к
-    возникновению ошибки.
-
-    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
-    возвращается \ref ak_error_ok (ноль)                                                           */
+/*! \brief Функция реализует режим гаммирования, а также выработку гаммы без наложения
+    на данные (в этом случае указатель `in` равен `NULL`).
+    \details Основной массив данных, длина которого кратна длине блока, обрабатывается
+    функцией ak_bckey_run_blocks(): для больших объемов данных множество значений счетчика
+    делится на непересекающиеся интервалы, обрабатываемые несколькими потоками на копиях ключа.
+    Ресурс ключа уменьшается до начала обработки сразу на все количество блоков,
+    поэтому потоки ресурс исходного ключа не изменяют.                                            */
 /* ----------------------------------------------------------------------------------------------- */
- int ak_bckey_ctr( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
+ static int ak_bckey_ctr_common( ak_bckey bkey, ak_uint8 *in, ak_uint8 *out, size_t size,
                                                                      ak_pointer iv, size_t iv_size )
 {
   ak_int64 blocks = (ak_int64)( size/bkey->bsize ),
              tail = (ak_int64)( size%bkey->bsize );
-  ak_uint64 x, yaout[2], *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
+  ak_uint64 x, yaout[2];
+  size_t w = 0;
   int error = ak_error_ok, oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
 
   if(( oc < 0 ) || ( oc > 1 )) return ak_error_message( ak_error_wrong_option, __func__,
                                                 "wrong value for \"openssl_compability\" option" );
+  if(( bkey->bsize != 8 ) && ( bkey->bsize != 16 ))
+    return ak_error_message( ak_error_wrong_block_cipher,
+                                          __func__ , "incorrect block size of block cipher key" );
 
  /* проверяем, установлен ли ключ */
   if(( bkey->key.flags&ak_key_flag_set_key ) == 0 ) return ak_error_message( ak_error_key_value,
@@ -561,53 +862,26 @@
     }
 
  /* обработка основного массива данных (кратного длине блока) */
-  switch( bkey->bsize ) {
-    case  8: /* шифр с длиной блока 64 бита (Магма) */
-      while( blocks > 0 ) {
-        #ifndef AK_LITTLE_ENDIAN
-          x = oc ? ((ak_uint64 *)bkey->ivector)[0] : bswap_64( ((ak_uint64 *)bkey->ivector)[0] );
-        #else
-          x = oc ? bswap_64( ((ak_uint64 *)bkey->ivector)[0] ) : ((ak_uint64 *)bkey->ivector)[0];
-        #endif
-          bkey->encrypt( &bkey->key, bkey->ivector, yaout );
-          *outptr = *inptr ^ yaout[0];
-          outptr++; inptr++;
-
-        #ifndef AK_LITTLE_ENDIAN
-          ((ak_uint64 *)bkey->ivector)[0] = oc ? ++x : bswap_64( ++x );
-        #else
-          ((ak_uint64 *)bkey->ivector)[0] = oc ? bswap_64( ++x ) : ++x;
-        #endif
-        --blocks;
-      }
-    break;
-
-    case 16: /* шифр с длиной блока 128 бит (Кузнечик) */
-     #ifndef AK_LITTLE_ENDIAN
-      x = bswap_64( ((ak_uint64 *)bkey->ivector)[oc] );
-     #else
-      x = ((ak_uint64 *)bkey->ivector)[oc];
-     #endif
-
-      while( blocks > 0 ) {
-          bkey->encrypt( &bkey->key, bkey->ivector, yaout );
-          *outptr = *inptr ^ yaout[0]; outptr++; inptr++;
-          *outptr = *inptr ^ yaout[1]; outptr++; inptr++;
-
-       /* за элементарное сложение с единицей приходится платить одним разворотом */
-        #ifdef AK_LITTLE_ENDIAN
-         ((ak_uint64 *)bkey->ivector)[oc] = oc ? bswap_64(++x) : ++x;
-        #else
-          ((ak_uint64 *)bkey->ivector)[oc] = oc ? ++x : bswap_64( ++x );
-        #endif                    /* здесь мы не учитываем знак переноса
-                                     потому что объем данных на одном ключе не должен
-                                     превышать 2^64 блоков (контролируется через ресурс ключа) */
-        --blocks;
-      }
-    break;
-
-    default: return ak_error_message( ak_error_wrong_block_cipher,
-                                          __func__ , "incorrect block size of block cipher key" );
+  if( blocks > 0 ) {
+    if(( error = ak_bckey_run_blocks( bkey, blocks_ctr, in, out,
+                                         ( size_t )blocks, bkey->ivector, 1 )) != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect processing of data blocks" );
+
+   /* вычисляем значение счетчика, следующее за последним обработанным блоком */
+    w = ( bkey->bsize == 16 ) ? ( size_t )oc : 0;
+   #ifdef AK_LITTLE_ENDIAN
+    x = oc ? bswap_64( ((ak_uint64 *)bkey->ivector)[w] ) : ((ak_uint64 *)bkey->ivector)[w];
+    x += ( ak_uint64 )blocks;
+    ((ak_uint64 *)bkey->ivector)[w] = oc ? bswap_64( x ) : x;
+   #else
+    x = oc ? ((ak_uint64 *)bkey->ivector)[w] : bswap_64( ((ak_uint64 *)bkey->ivector)[w] );
+    x += ( ak_uint64 )blocks;
+    ((ak_uint64 *)bkey->ivector)[w] = oc ? x : bswap_64( x );
+   #endif                   /* здесь мы не учитываем знак переноса
+                               потому что объем данных на одном ключе не должен
+                               превышать 2^64 блоков (контролируется через ресурс ключа) */
+    if( in != NULL ) in += blocks*bkey->bsize;
+    out += blocks*bkey->bsize;
   }
 
  /* обрабатываем хвост сообщения */
@@ -621,10 +895,9 @@
            для блочного шифра Кузнечик результат совпадает
 
            поиск того, почему Магма реализована по другому - задача за гранью добра и зла */
-         ( (ak_uint8*)outptr )[i] = ( (ak_uint8*)inptr )[i]^( (ak_uint8 *)yaout)[i];
+         out[i] = ( in ? in[i] : 0 )^( (ak_uint8 *)yaout)[i];
 
-       } else ( (ak_uint8*)outptr )[i] =
-           ( (ak_uint8*)inptr )[i]^( (ak_uint8 *)yaout)[bkey->bsize - (size_t)(tail-i)];
+       } else out[i] = ( in ? in[i] : 0 )^( (ak_uint8 *)yaout)[bkey->bsize - (size_t)(tail-i)];
 
    /* запрещаем дальнейшее использование функции на данном значении синхропосылки,
                                            поскольку обрабатываемые данные не кратны длине блока. */
@@ -639,6 +912,90 @@
  return error;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Поскольку в режиме гаммирования операцией шифрования является сложение открытого текста по
+    модулю два с последовательностью, вырабатываемой блочным шифром из заданной синхропосылки,
+    то для зашифрования и расшифрования информациии используется одна и та же функция.
+
+    Значение синхропосылки `iv` копируется в контекст секретного ключа (область памяти, на которую
+    указывает `iv` не изменяется) и преобразуется в ходе реализации режима гаммирования.
+    Преобразованное значение сохраняется в контексте секретного ключа в буффере `skey.ivector`.
+    Данное значение может быть использовано при повторном вызове функции ak_bckey_ctr().
+    Следующий пример иллюстрирует сказанное.
+
+
+\code
+ // bkey - ключ алгоритма "Магма"
+ // шифрование буффера с данными одним фрагментом
+  ak_bckey_ctr( bkey, in, out, size, iv, 4 );
+
+ // тот же результат может быть получен за три последовательных вызова
+  ak_bckey_ctr( bkey, in, out, 16, iv, 4 );
+  ak_bckey_ctr( bkey, in+16, out+16, 16, NULL, 0 );
+  ak_bckey_ctr( bkey, in+32, out+32, size-32, NULL, 0 );
+ //   для того, чтобы использовать внутреннее значение синхропосылки,
+ //                мы передаем нулевые значения последних параметров
+ //        использовать данную возможность можно только в том случае,
+ // когда длина переданных в функцию ранее данных кратна длине блока
+\endcode
+
+
+ В приведенном выше фрагменте исходный буффер сначала зашифровывается за один вызов функции,
+ а потом фрагментами, длина которых кратна длине блока используемого алгоритма блочного шифрования.
+ Результаты зашифрования должны совпадать в обоих случаях. Указанное поведение функции позволяет
+ зашифровывать данные в случае, когда они поступают фрагментами, например из сети, или когда хранение
+ данных полностью в оперативной памяти нецелесообразно (например, шифрование больших файлов).
+
+    @param bkey Контекст ключа алгоритма блочного шифрования, на котором происходит
+    зашифрование или расшифрование информации.
+    @param in Указатель на область памяти, где хранятся входные (открытые) данные.
+    @param out Указатель на область памяти, куда помещаются зашифрованные данные
+    (этот указатель может совпадать с `in`).
+    @param size Размер зашировываемых данных (в байтах).
+    @param iv Указатель на произвольную область памяти - синхропосылку. Область памяти, на
+    которую указывает `iv` не изменяется.
+    @param iv_size Длина синхропосылки в байтах. Согласно  стандарту ГОСТ Р 34.13-2015 длина
+    синхропосылки должна быть ровно в два раза меньше, чем длина блока, то есть 4 байта для Магмы
+    и 8 байт для Кузнечика. Значение `iv_size`, отличное от указанных, может привести к
+    возникновению ошибки.
+
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_ctr( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
+                                                                     ak_pointer iv, size_t iv_size )
+{
+  if( in == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                                "using null pointer to input data" );
+ return ak_bckey_ctr_common( bkey, in, out, size, iv, iv_size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вырабатывает `size` октетов гаммы, которая в режиме гаммирования накладывается на
+    данные функцией ak_bckey_ctr() при тех же значениях ключа и синхропосылки. Выработанная заранее
+    гамма может быть позднее сложена с данными по модулю два, что позволяет исключить вычисление
+    блочного шифра из критичных по времени участков обработки (например, при шифровании сетевых
+    пакетов). Значение счетчика сохраняется в контексте ключа так же, как и при вызове
+    ak_bckey_ctr(), поэтому вызовы двух функций могут чередоваться.
+
+    @param bkey Контекст ключа алгоритма блочного шифрования.
+    @param out Указатель на область памяти, куда помещается гамма.
+    @param size Количество вырабатываемых октетов гаммы.
+    @param iv Указатель на синхропосылку; если указатель равен `NULL`, то используется
+    значение счетчика, сохраненное в контексте ключа.
+    @param iv_size Длина синхропосылки в байтах.
+
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_ctr_keystream( ak_bckey bkey, ak_pointer out, size_t size,
+                                                                     ak_pointer iv, size_t iv_size )
+{
+  if( out == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                          "using null pointer to output buffer" );
+ return ak_bckey_ctr_common( bkey, NULL, out, size, iv, iv_size );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
  int ak_bckey_encrypt_cbc( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
                                                                     ak_pointer iv, size_t iv_size )
@@ -718,8 +1075,6 @@
                                                                     ak_pointer iv, size_t iv_size )
  {
   ak_int64 blocks = 0;
-  ak_uint64 yaout[2], z = iv_size / bkey->bsize;
-  ak_uint64 *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out, *ivector = (ak_uint64 *)bkey->ivector;
   int error = ak_error_ok, oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
 
   if(( oc < 0 ) || ( oc > 1 )) return ak_error_message( ak_error_wrong_option, __func__,
@@ -749,38 +1104,15 @@
                                                              "incorrect length of initial value" );
    memcpy(bkey->ivector, iv, iv_size);
 
- /* теперь приступаем к расшифрованию данных */
-  switch( bkey->bsize ) {
-    case  8: /* шифр с длиной блока 64 бита */
-      while( blocks > 0 ) {
-          bkey->decrypt( &bkey->key, inptr, yaout );
-          if( z == 0 ) {
-              ivector = (ak_uint64 *)in;
-          }
-          *outptr = yaout[0] ^ *ivector; outptr++; ivector++;
-          inptr++;
-          --blocks;
-          --z;
-      }
-    break;
-
-    case 16: /* шифр с длиной блока 128 бит */
-      while( blocks > 0 ) {
-          bkey->decrypt( &bkey->key, inptr, yaout );
-          if( z == 0 ) {
-              ivector = (ak_uint64 *)in;
-          }
-          *outptr = yaout[0] ^ *ivector; outptr++; ivector++;
-          *outptr = yaout[1] ^ *ivector; outptr++; ivector++;
-          inptr+=2;
-          --blocks;
-          --z;
-      }
-
-    break;
-    default: return ak_error_message( ak_error_wrong_block_cipher,
+ /* теперь приступаем к расшифрованию данных:
+    все входы блочного шифра известны заранее, поэтому блоки расшифровываются группами */
+  if(( bkey->bsize != 8 ) && ( bkey->bsize != 16 ))
+    return ak_error_message( ak_error_wrong_block_cipher,
                                           __func__ , "incorrect block size of block cipher key" );
-  }
+  if(( error = ak_bckey_run_blocks( bkey, blocks_decrypt_cbc, in, out, ( size_t )blocks,
+                                   bkey->ivector, iv_size / bkey->bsize )) != ak_error_ok )
+    return ak_error_message( error, __func__ , "incorrect decryption of data blocks" );
+
  /* перемаскируем ключ */
   if(( error = bkey->key.set_mask( &bkey->key )) != ak_error_ok )
     ak_error_message( error, __func__ , "wrong remasking of secret key" );
@@ -917,6 +1249,7 @@
      if( bkey->key.flags&ak_key_flag_not_ctr )
        return ak_error_message( ak_error_wrong_block_cipher_function, __func__ ,
                                             "function call with undefined value of initial vector" );
+     z = bkey->ivector_size / bkey->bsize;
    } else {
 
      /* проверяем длину синхропосылки (если меньше длины блока, то плохо)
@@ -925,7 +1258,7 @@
         return ak_error_message( ak_error_wrong_iv_length, __func__,
                                                                "incorrect length of initial value" );
      /* помещаем во внутренний буффер значение синхропосылки */
-      memcpy(bkey->ivector, iv, iv_size);
+      memcpy(bkey->ivector, iv, bkey->ivector_size = iv_size );
 
      /* поднимаем значение флага: синхропосылка установлена */
       bkey->key.flags = ( bkey->key.flags&( ~ak_key_flag_not_ctr ))^ak_key_flag_not_ctr;
@@ -964,7 +1297,7 @@
 
   /* обрабатываем хвост сообщения */
    if( tail ) {
-     vecptr = (bkey->ivector + bkey->bsize * (i % (int)(iv_size / bkey->bsize)));
+     vecptr = (bkey->ivector + bkey->bsize * (i % z));
      bkey->encrypt( &bkey->key, vecptr, yaout );
      for( i = 0; i < (unsigned long)tail; i++ )
         ( (ak_uint8*)outptr)[i] = ( (ak_uint8*)inptr )[i]^( (ak_uint8 *)yaout)[i];
@@ -987,9 +1320,10 @@
    ak_int64 blocks = (ak_int64)( size/bkey->bsize ),
               tail = (ak_int64)( size%bkey->bsize );
    ak_uint8 *vecptr = NULL;
-   ak_uint64 yaout[2], *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
+   ak_uint64 yaout[2];
    int error = ak_error_ok, oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
    unsigned long i = 0, z = iv_size / bkey->bsize; // во сколько раз синхрпосылка длиннее блока
+   ak_uint8 *inptr = (ak_uint8 *)in + blocks*bkey->bsize, *outptr = (ak_uint8 *)out + blocks*bkey->bsize;
 
    if(( oc < 0 ) || ( oc > 1 )) return ak_error_message( ak_error_wrong_option, __func__,
                                                  "wrong value for \"openssl_compability\" option" );
@@ -1011,6 +1345,9 @@
      if( bkey->key.flags&ak_key_flag_not_ctr )
        return ak_error_message( ak_error_wrong_block_cipher_function, __func__ ,
                                             "function call with undefined value of initial vector" );
+     if(( z = bkey->ivector_size / bkey->bsize ) == 0 )
+       return ak_error_message( ak_error_wrong_iv_length, __func__,
+                                                         "incorrect length of internal initial value" );
    } else {
 
      /* проверяем длину синхропосылки (если меньше длины блока, то плохо)
@@ -1019,49 +1356,28 @@
         return ak_error_message( ak_error_wrong_iv_length, __func__,
                                                                "incorrect length of initial value" );
      /* помещаем во внутренний буффер значение синхропосылки */
-      memcpy(bkey->ivector, iv, iv_size);
+      memcpy(bkey->ivector, iv, bkey->ivector_size = iv_size );
 
      /* поднимаем значение флага: синхропосылка установлена */
       bkey->key.flags = ( bkey->key.flags&( ~ak_key_flag_not_ctr ))^ak_key_flag_not_ctr;
      }
 
-  /* обработка основного массива данных (кратного длине блока) */
-   switch( bkey->bsize ) {
-     case  8: /* шифр с длиной блока 64 бита */
-       while( blocks > 0 ) {
-           vecptr = (bkey->ivector + i*bkey->bsize);
-           bkey->encrypt( &bkey->key, vecptr, yaout );
-           *outptr = *inptr ^ yaout[0];
-           ((ak_uint64 *)vecptr)[0] = *inptr;
-           outptr++; inptr++;
-           if (++i == z) i = 0;
-           --blocks;
-       }
-     break;
-
-     case 16: /* шифр с длиной блока 128 бит */
-       while( blocks > 0 ) {
-           vecptr = (bkey->ivector + i*bkey->bsize );
-           bkey->encrypt( &bkey->key, vecptr, yaout );
-           *outptr = *inptr ^ yaout[0];
-           ((ak_uint64 *)vecptr)[0] = *inptr; ++outptr; ++inptr;
-           *outptr = *inptr ^ yaout[1];
-           ((ak_uint64 *)vecptr)[1] = *inptr; ++outptr; ++inptr;
-           if (++i == z) i = 0;
-           --blocks;
-       }
-     break;
-
-     default: return ak_error_message( ak_error_wrong_block_cipher,
+  /* обработка основного массива данных (кратного длине блока):
+     все входы блочного шифра известны заранее, поэтому блоки обрабатываются группами */
+   if(( bkey->bsize != 8 ) && ( bkey->bsize != 16 ))
+     return ak_error_message( ak_error_wrong_block_cipher,
                                            __func__ , "incorrect block size of block cipher key" );
-   }
+   if(( error = ak_bckey_run_blocks( bkey, blocks_decrypt_cfb, in, out,
+                                     ( size_t )blocks, bkey->ivector, z )) != ak_error_ok )
+     return ak_error_message( error, __func__ , "incorrect decryption of data blocks" );
+   i = ( unsigned long )blocks % z;
 
   /* обрабатываем хвост сообщения */
    if( tail ) {
-     vecptr = (bkey->ivector + bkey->bsize * (i % (int)(iv_size / bkey->bsize)));
+     vecptr = (bkey->ivector + bkey->bsize * i );
      bkey->encrypt( &bkey->key, vecptr, yaout );
      for( i = 0; i < (unsigned long)tail; i++ )
-        ( (ak_uint8*)outptr)[i] = ( (ak_uint8*)inptr )[i]^( (ak_uint8 *)yaout)[i];
+        outptr[i] = inptr[i]^( (ak_uint8 *)yaout)[i];
 
      /* запрещаем дальнейшее использование функции на данном значении синхропосылки,
                                                поскольку обрабатываемые данные не кратны длине блока. */
@@ -1079,7 +1395,8 @@
     режима гаммирования данных, согласно ГОСТ Р 34.12-2015. В начале
     вычисляется имитовставка от объединения ассоцииированных данных и
     данных, подлежащих зашифрования. При этом предполагается, что ассоциированные данные
-    расположены вначале. После этого, данные зашифровываются.
+    расположены вначале. Данные зашифровываются и аутентифицируются за один проход
+    (см. функцию ak_bckey_ctr_hmac_stream_clean()).
 
     Режим `ctr-hmac` \b должен использовать для шифрования и выработки имитовставки два
     различных ключа -- ключ алгоритма шифрования и ключ алгоритма hmac.
@@ -1128,36 +1445,20 @@
                                                          ak_pointer icode, const size_t icode_size )
 {
   int error = ak_error_ok;
-
- /* проверки ключей */
-  if(( encryptionKey == NULL ) && ( authenticationKey == NULL ))
-    return ak_error_message( ak_error_null_pointer, __func__ ,
-                               "using null pointers both to encryption and authentication keys" );
-
- /* тестируем типы ключей */
-  if(( encryptionKey != NULL ) && ((ak_bckey)encryptionKey)->key.oid->engine != block_cipher )
-    return ak_error_message( ak_error_null_pointer, __func__ ,
-                                                "using non block cipher key for data encryption" );
-  if(( authenticationKey != NULL ) &&
-                                  ((ak_hmac)authenticationKey)->key.oid->engine != hmac_function )
-    return ak_error_message( ak_error_null_pointer, __func__ ,
-                                                 "using non hmac key for checkin data integrity" );
- /* вычисляем имитовставку */
-  if( authenticationKey != NULL ) {
-    if(( error = ak_hmac_clean( authenticationKey )) != ak_error_ok )
-      return ak_error_message( error, __func__, "incorrect cleaning of hmac secret key context" );
-    if(( error = ak_hmac_update( authenticationKey, adata, adata_size )) != ak_error_ok )
-      return ak_error_message( error, __func__, "incorrect updating of associated data" );
-    if(( error = ak_hmac_finalize( authenticationKey, in, size, icode, icode_size )) != ak_error_ok )
-      return ak_error_message( error, __func__, "incorrect finalizing of integrity code" );
-  }
- /* зашифровываем даные */
-  if( encryptionKey != NULL ) {
-    if(( error = ak_bckey_ctr( encryptionKey, in, out, size, iv, iv_size )) != ak_error_ok )
-     return ak_error_message( error, __func__, "incorrect data encryption" );
+  struct aead_stream ctx;
+
+  if(( error = ak_bckey_ctr_hmac_stream_clean( &ctx,
+                                encryptionKey, authenticationKey, iv, iv_size )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect initialization of stream context" );
+
+ /* данные зашифровываются и аутентифицируются за один проход */
+  if((( error = ak_aead_stream_authenticate( &ctx, adata, adata_size )) != ak_error_ok ) ||
+     (( error = ak_aead_stream_encrypt( &ctx, in, out, size )) != ak_error_ok ) ||
+     (( error = ak_aead_stream_finalize( &ctx, icode, icode_size )) != ak_error_ok )) {
+    memset( &ctx, 0, sizeof( struct aead_stream ));
+    return ak_error_message( error, __func__, "incorrect data encryption" );
   }
-
- return error;
+ return ak_error_ok;
 }
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -1194,46 +1495,32 @@
                                      const size_t size, const ak_pointer iv, const size_t iv_size,
                                                          ak_pointer icode, const size_t icode_size )
 {
+  ak_uint8 icode2[128];
   int error = ak_error_ok;
+  struct aead_stream ctx;
 
- /* проверки ключей */
-  if(( encryptionKey == NULL ) && ( authenticationKey == NULL ))
-    return ak_error_message( ak_error_null_pointer, __func__ ,
-                               "using null pointers both to encryption and authentication keys" );
-
- /* тестируем типы ключей */
-  if(( encryptionKey != NULL ) && ((ak_bckey)encryptionKey)->key.oid->engine != block_cipher )
-    return ak_error_message( ak_error_null_pointer, __func__ ,
-                                                "using non block cipher key for data encryption" );
   if(( authenticationKey != NULL ) &&
-                                  ((ak_hmac)authenticationKey)->key.oid->engine != hmac_function )
-    return ak_error_message( ak_error_null_pointer, __func__ ,
-                                                 "using non hmac key for checkin data integrity" );
- /* расшифровываем даные */
-  if( encryptionKey != NULL ) {
-    if(( error = ak_bckey_ctr( encryptionKey, in, out, size, iv, iv_size )) != ak_error_ok )
-     return ak_error_message( error, __func__, "incorrect data decryption" );
-  }
- /* вычисляем имитовставку */
-  if( authenticationKey != NULL ) {
-    ak_uint8 icode2[128];
-    memset( icode2, 0, sizeof( icode2 ));
-
-    if( ak_hmac_get_tag_size( authenticationKey ) > sizeof( icode2 ))
-      return ak_error_message( ak_error_wrong_length, __func__,
+     ( ak_hmac_get_tag_size( authenticationKey ) > sizeof( icode2 )))
+    return ak_error_message( ak_error_wrong_length, __func__,
                                                        "using hmac key with very huge tag size" );
-    if(( error = ak_hmac_clean( authenticationKey )) != ak_error_ok )
-      return ak_error_message( error, __func__, "incorrect cleaning of hmac secret key context" );
-    if(( error = ak_hmac_update( authenticationKey, adata, adata_size )) != ak_error_ok )
-      return ak_error_message( error, __func__, "incorrect updating of associated data" );
-    if(( error = ak_hmac_finalize( authenticationKey, out, size, icode2, icode_size )) != ak_error_ok )
-      return ak_error_message( error, __func__, "incorrect finalizing of integrity code" );
-    if( ak_ptr_is_equal( icode, icode2, icode_size )) error = ak_error_ok;
-       else error = ak_error_not_equal_data;
+  if(( error = ak_bckey_ctr_hmac_stream_clean( &ctx,
+                                encryptionKey, authenticationKey, iv, iv_size )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect initialization of stream context" );
+
+ /* данные расшифровываются и аутентифицируются за один проход */
+  memset( icode2, 0, sizeof( icode2 ));
+  if((( error = ak_aead_stream_authenticate( &ctx, adata, adata_size )) != ak_error_ok ) ||
+     (( error = ak_aead_stream_decrypt( &ctx, in, out, size )) != ak_error_ok ) ||
+     (( error = ak_aead_stream_finalize( &ctx, icode2, icode_size )) != ak_error_ok )) {
+    memset( &ctx, 0, sizeof( struct aead_stream ));
+    return ak_error_message( error, __func__, "incorrect data decryption" );
   }
+  if( authenticationKey == NULL ) return ak_error_ok;
+  if( ak_ptr_is_equal( icode, icode2, icode_size )) return ak_error_ok;
 
- return error;
+ return ak_error_not_equal_data;
 }
+
 /* ----------------------------------------------------------------------------------------------- */
 /*                                                                                     ak_bckey.c  */
 /* ----------------------------------------------------------------------------------------------- */
@@ -57,6 +57,8 @@
   \f\[ Kab = f_a\left( \texttt{Streebog}_n(IDb) \right). \f\]
 
   Создание ключа абонента \f$ Ka \f$ может быть выполнено с помощью функции ak_blomkey_create_abonent_key().
+  Для одновременной выработки ключей большого числа абонентов (за один проход по мастер-ключу)
+  предназначена функция ak_blomkey_create_abonent_keys().
 
   Создание ключа парной связи \f$ Kab \f$ - с помощью функции ak_blomkey_create_pairwise_key().
 
@@ -68,6 +70,76 @@
 
   Отметим, что неприводимые многочлены, используемые для реализации элементарных операций
   в конечном поле \f$ GF(2^n)\f$, определены в файле ak_gf2n.c                                  @} */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Количество строк (и столбцов) в одном блоке матрицы при копировании элементов
+    в нижний треугольник мастер-ключа. */
+ #define ak_blomkey_tile_size                  (16)
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Флаг, добавляемый к типу ключа в заголовке контейнера мастер-ключа,
+    строки которого зашифрованы и имеют независимые имитовставки. */
+ #define ak_blomkey_container_flag            (0x80)
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Задание на вычисление контрольной суммы мастер-ключа. */
+ typedef struct blomkey_icode_job {
+  /*! \brief мастер-ключ */
+   ak_blomkey bkey;
+  /*! \brief хэш-коды строк матрицы (по 32 октета на строку) */
+   ak_uint8 *values;
+ } *ak_blomkey_icode_job;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вычисляет хэш-код строки мастер-ключа с номером `row`;
+    вызывается из ak_libakrypt_parallel_run(). */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_blomkey_icode_row( ak_pointer ptr, const size_t row )
+{
+  struct hash ctx;
+  int error = ak_error_ok;
+  ak_blomkey_icode_job job = ( ak_blomkey_icode_job )ptr;
+  const size_t len = job->bkey->size*job->bkey->count;
+
+  if(( error = ak_hash_create_oid( &ctx, job->bkey->ctx.oid )) != ak_error_ok ) return error;
+  error = ak_hash_ptr( &ctx, job->bkey->data + row*len, len, job->values + row*32, 32 );
+  ak_hash_destroy( &ctx );
+
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вычисляет контрольную сумму ключевых данных.
+    \details Для ключа абонента контрольная сумма совпадает с хэш-кодом ключевых данных.
+    Для мастер-ключа сначала вычисляются хэш-коды всех строк матрицы (строки распределяются
+    между потоками), после чего контрольная сумма вычисляется как хэш-код от последовательности
+    хэш-кодов строк. Таким образом, время вычисления контрольной суммы мастер-ключа уменьшается
+    пропорционально количеству потоков.
+
+    \param bkey указатель на контекст мастер-ключа или ключа абонента
+    \param icode область памяти (32 октета), в которую помещается контрольная сумма
+    \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха,
+    в противном случае возвращается код ошибки.                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_blomkey_evaluate_icode( ak_blomkey bkey, ak_uint8 *icode )
+{
+  struct blomkey_icode_job job;
+  int error = ak_error_ok;
+
+  if( bkey->type != blom_matrix_key )
+    return ak_hash_ptr( &bkey->ctx, bkey->data, bkey->size*bkey->count, icode, 32 );
+
+  if(( job.values = malloc( bkey->size*32 )) == NULL )
+    return ak_error_message( ak_error_out_of_memory, __func__, "incorrect memory allocation" );
+  job.bkey = bkey;
+  if(( error = ak_libakrypt_parallel_run( ak_blomkey_icode_row,
+                                                            &job, bkey->size )) == ak_error_ok )
+    error = ak_hash_ptr( &bkey->ctx, job.values, bkey->size*32, icode, 32 );
+   else ak_error_message( error, __func__, "incorrect evaluation of rows integrity codes" );
+  free( job.values );
+
+ return error;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
  static bool_t ak_blomkey_check_icode( ak_blomkey bkey )
 {
@@ -84,9 +156,7 @@
 
  /* вычисляем контрольную сумму и сравниваем */
   memset( value, 0, sizeof( value ));
-  ak_hash_ptr( &bkey->ctx, bkey->data,
-                    bkey->type == blom_matrix_key ? (bkey->size)*(bkey->size)*bkey->count :
-                                                             (bkey->size)*bkey->count, value, 32 );
+  if( ak_blomkey_evaluate_icode( bkey, value ) != ak_error_ok ) return ak_false;
   if( ak_ptr_is_equal( value, bkey->icode, 32 ) == ak_false ) {
     ak_error_message( ak_error_not_equal_data, __func__, "integrity code is wrong" );
     return ak_false;
@@ -94,12 +164,41 @@
  return ak_true;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция копирует элементы верхнего треугольника мастер-ключа в нижний для строк
+    из блока с номером `idx`; вызывается из ak_libakrypt_parallel_run().
+    \details Копирование выполняется блоками размера \ref ak_blomkey_tile_size x
+    \ref ak_blomkey_tile_size элементов, так что считываемые и записываемые элементы
+    блока одновременно находятся в кэш-памяти.                                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_blomkey_mirror_tiles( ak_pointer ptr, const size_t idx )
+{
+  ak_blomkey bkey = ( ak_blomkey )ptr;
+  const size_t size = bkey->size, count = bkey->count;
+  const size_t first = idx*ak_blomkey_tile_size,
+               last = ak_min( first + ak_blomkey_tile_size, size );
+  size_t row = 0, column = 0, start = 0;
+
+  for( start = 0; start < last; start += ak_blomkey_tile_size ) {
+     const size_t end = ak_min( start + ak_blomkey_tile_size, last );
+     for( row = first; row < last; row++ )
+        for( column = start; column < ak_min( end, row ); column++ )
+           memcpy( bkey->data + ( row*size + column )*count,
+                                                  bkey->data + ( column*size + row )*count, count );
+  }
+ return ak_error_ok;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! В ходе своего выполнения функция вырабатывает симметричную матрицу,
     состоящую из (`size`)x(`size`) элементов конечного поля \f$ GF(2^n)\f$, где `n` это количество
     бит (задается параметром `count`). Например, для поля \f$ GF(2^{256})\f$ величина `count` должна
     принимать значение 32.
 
+    Элементы, расположенные на главной диагонали и над ней, вырабатываются заданным генератором
+    (в порядке следования строк), после чего копируются в нижний треугольник матрицы.
+    Копирование и вычисление контрольной суммы выполняются в несколько потоков.
+
     \param bkey указатель на контекст мастер-ключа
     \param size размер матрицы
     \param count количество октетов, определяющих размер конечного поля;
@@ -111,9 +210,9 @@
  int ak_blomkey_create_matrix( ak_blomkey bkey, const ak_uint32 size,
                                                       const ak_uint32 count, ak_random generator )
 {
+  ak_uint32 row = 0;
   int error = ak_error_ok;
-  ak_uint32 column = 0, row = 0;
-  size_t memsize = size*size*count;
+  size_t memsize = ( size_t )size*size*count;
 
   if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                       "using null pointer to secret key context" );
@@ -123,21 +222,11 @@
   if(( count != ak_galois256_size ) && ( count != ak_galois512_size ))
    return ak_error_message( ak_error_undefined_value, __func__,
                                        "this function accepts only 256 or 512 bit galois fields" );
+  memset( bkey, 0, sizeof( struct blomkey ));
   bkey->type = blom_matrix_key;
   bkey->count = count;
   bkey->size = size;
-  if(( bkey->data = malloc( memsize + 16 )) == NULL ) /* 16 это размер имитовставки */
-    return ak_error_message( ak_error_out_of_memory, __func__, "incorrect memory allocation" );
 
-  memset( bkey->data, 0, memsize + 16 );
-  for( column = 0; column < size; column++ ) {
-    /* копируем созданное ранее */
-     for( row = 0; row < column; row++ ) memcpy( bkey->data + column*count*size+row*count,
-                                     ak_blomkey_get_element_by_index( bkey, row, column ), count );
-    /* создаем новое */
-     ak_random_ptr( generator, bkey->data+column*count*(size+1),( size - column )*count );
-  }
-  
   switch( bkey->count ) {
     case ak_galois256_size: error = ak_hash_create_streebog256( &bkey->ctx );
                             break;
@@ -146,12 +235,211 @@
     default: ak_error_message( error = ak_error_undefined_value, __func__,
                                        "this function accepts only 256 or 512 bit galois fields" );
   }
-  if( error != ak_error_ok ) {
-    ak_blomkey_destroy( bkey );
+  if( error != ak_error_ok )
     return ak_error_message( error, __func__, "incorrect creation of hash function context" );
+
+  if(( bkey->data = malloc( memsize + 16 )) == NULL ) { /* 16 это размер имитовставки */
+    ak_blomkey_destroy( bkey );
+    return ak_error_message( ak_error_out_of_memory, __func__, "incorrect memory allocation" );
   }
-  if(( error = ak_hash_ptr( &bkey->ctx, bkey->data, memsize,
-                                    bkey->icode, 32 )) != ak_error_ok ) ak_blomkey_destroy( bkey );
+  memset( bkey->data, 0, memsize + 16 );
+
+ /* вырабатываем элементы верхнего треугольника (в каждой строке они расположены последовательно) */
+  for( row = 0; row < size; row++ )
+     if(( error = ak_random_ptr( generator, bkey->data + ( size_t )row*count*( size + 1 ),
+                                                    ( size - row )*count )) != ak_error_ok ) {
+       ak_error_message( error, __func__, "incorrect generation of secret matrix" );
+       goto labex;
+     }
+
+ /* копируем их в нижний треугольник */
+  if(( error = ak_libakrypt_parallel_run( ak_blomkey_mirror_tiles, bkey,
+                  ( size + ak_blomkey_tile_size - 1 )/ak_blomkey_tile_size )) != ak_error_ok ) {
+    ak_error_message( error, __func__, "incorrect creation of symmetric matrix" );
+    goto labex;
+  }
+  error = ak_blomkey_evaluate_icode( bkey, bkey->icode );
+
+  labex:
+   if( error != ak_error_ok ) ak_blomkey_destroy( bkey );
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Задание на выработку ключей нескольких абонентов. */
+ typedef struct blomkey_abonents_job {
+  /*! \brief мастер-ключ */
+   ak_blomkey matrix;
+  /*! \brief массив вырабатываемых ключей абонентов */
+   ak_blomkey keys;
+  /*! \brief количество вырабатываемых ключей */
+   size_t count;
+  /*! \brief значения хэш-функции от идентификаторов абонентов (по 64 октета на абонента) */
+   ak_uint8 *values;
+  /*! \brief степени значений хэш-функции, соответствующие текущей строке мастер-ключа
+      (используются при выработке ключей из контейнера) */
+   ak_uint8 *powers;
+  /*! \brief элементы текущей строки мастер-ключа, расположенные не левее главной диагонали */
+   ak_uint8 *line;
+  /*! \brief номер текущей строки мастер-ключа */
+   size_t row;
+ } *ak_blomkey_abonents_job;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вычисляет элементы с номером `row` для всех ключей абонентов;
+    вызывается из ak_libakrypt_parallel_run().
+    \details Каждый элемент строки мастер-ключа считывается из памяти один раз, после чего
+    используется для выполнения очередного шага схемы Горнера сразу для всех абонентов.        */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_blomkey_abonents_row( ak_pointer ptr, const size_t row )
+{
+  size_t k = 0;
+  ak_int32 column = 0;
+  ak_blomkey_abonents_job job = ( ak_blomkey_abonents_job )ptr;
+  const ak_uint32 count = job->matrix->count, size = job->matrix->size;
+  ak_uint8 *line = job->matrix->data + row*size*count;
+  ak_uint32 i = 0;
+
+  for( k = 0; k < job->count; k++ ) memset( job->keys[k].data + row*count, 0, count );
+  for( column = size - 1; column >= 0; column-- ) { /* схема Горнера для вычисления значений */
+     ak_uint64 *key = ( ak_uint64 * )( line + column*count );
+     for( k = 0; k < job->count; k++ ) {
+        ak_uint64 *sum = ( ak_uint64 * )( job->keys[k].data + row*count );
+        if( count == ak_galois256_size ) ak_gf256_mul( sum, sum, job->values + k*64 );
+         else ak_gf512_mul( sum, sum, job->values + k*64 );
+        for( i = 0; i < ( count >> 3 ); i++ ) sum[i] ^= key[i];
+     }
+  }
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция учитывает элементы `job->line` строки мастер-ключа с номером `job->row`,
+    расположенные на главной диагонали и правее нее, в ключе абонента с номером `idx`;
+    вызывается из ak_libakrypt_parallel_run().
+    \details Обозначим \f$ h \f$ хэш-код идентификатора абонента, \f$ r \f$ - номер строки.
+    В силу симметричности мастер-ключа, элемент \f$ a_{r,c},\: c > r \f$ входит в значения
+    \f$ b_r \f$ и \f$ b_c \f$ ключа абонента с коэффициентами \f$ h^c \f$ и \f$ h^r \f$
+    соответственно. Поэтому к элементу \f$ b_r \f$ прибавляется величина
+    \f$ h^r \sum_{c \ge r} a_{r,c}h^{c-r} \f$ (вычисляемая по схеме Горнера), а к каждому
+    элементу \f$ b_c,\: c > r \f$ - величина \f$ a_{r,c} h^r \f$. После обработки всех строк
+    ключ абонента совпадает с ключом, вырабатываемым функцией ak_blomkey_create_abonent_key(). */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_blomkey_abonents_segment( ak_pointer ptr, const size_t idx )
+{
+  ak_uint32 i = 0;
+  ak_int64 column = 0;
+  ak_uint64 sum[8], value[8];
+  ak_blomkey_abonents_job job = ( ak_blomkey_abonents_job )ptr;
+  const ak_uint32 count = job->keys[idx].count, size = job->keys[idx].size;
+  const size_t row = job->row;
+  ak_uint8 *h = job->values + idx*64, *power = job->powers + idx*64;
+  ak_uint64 *key = ( ak_uint64 * )( job->keys[idx].data + row*count ), *element = NULL;
+
+  memset( sum, 0, sizeof( sum ));
+  for( column = size - 1; column >= ( ak_int64 )row; column-- ) {
+     element = ( ak_uint64 * )( job->line + ( column - row )*count );
+     if( count == ak_galois256_size ) ak_gf256_mul( sum, sum, h );
+      else ak_gf512_mul( sum, sum, h );
+     for( i = 0; i < ( count >> 3 ); i++ ) sum[i] ^= element[i];
+  }
+  if( row > 0 ) {
+    if( count == ak_galois256_size ) ak_gf256_mul( sum, sum, power );
+     else ak_gf512_mul( sum, sum, power );
+  }
+  for( i = 0; i < ( count >> 3 ); i++ ) key[i] ^= sum[i];
+
+ /* элементы, расположенные ниже главной диагонали */
+  for( column = row + 1; column < size; column++ ) {
+     element = ( ak_uint64 * )( job->line + ( column - row )*count );
+     key = ( ak_uint64 * )( job->keys[idx].data + column*count );
+     if( row > 0 ) {
+       if( count == ak_galois256_size ) ak_gf256_mul( value, element, power );
+        else ak_gf512_mul( value, element, power );
+       for( i = 0; i < ( count >> 3 ); i++ ) key[i] ^= value[i];
+     }
+      else for( i = 0; i < ( count >> 3 ); i++ ) key[i] ^= element[i];
+  }
+
+ /* вычисляем следующую степень */
+  if( row > 0 ) {
+    if( count == ak_galois256_size ) ak_gf256_mul( power, power, h );
+     else ak_gf512_mul( power, power, h );
+  }
+   else memcpy( power, h, count );
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция создает контексты ключей абонентов и вычисляет хэш-коды их идентификаторов.
+    \details В случае ошибки созданные контексты уничтожаются.                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_blomkey_abonents_create( ak_blomkey_abonents_job job, ak_oid oid,
+             const ak_uint32 size, const ak_uint32 count, ak_pointer *ids, const size_t *idsizes )
+{
+  size_t k = 0, created = 0, memsize = size*count;
+  int error = ak_error_ok;
+
+  if( !job->count ) return ak_error_message( ak_error_zero_length, __func__,
+                                                         "using zero count of abonent's keys" );
+  if(( ids == NULL ) || ( idsizes == NULL )) return ak_error_message( ak_error_null_pointer,
+                                            __func__, "using null pointer to abonent's identifiers" );
+  for( k = 0; k < job->count; k++ )
+     if(( ids[k] == NULL ) || ( !idsizes[k] ))
+       return ak_error_message_fmt( ak_error_undefined_value, __func__,
+                                  "using undefined abonent's identifier (%u)", (unsigned int) k );
+
+  if(( job->values = malloc( job->count*64 )) == NULL )
+    return ak_error_message( ak_error_out_of_memory, __func__, "incorrect memory allocation" );
+  memset( job->values, 0, job->count*64 );
+
+  for( created = 0; created < job->count; ) {
+     ak_blomkey bkey = job->keys + created++;
+
+     memset( bkey, 0, sizeof( struct blomkey ));
+     bkey->count = count;
+     bkey->size = size;
+     bkey->type = blom_abonent_key;
+     if(( error = ak_hash_create_oid( &bkey->ctx, oid )) != ak_error_ok ) {
+       ak_error_message( error, __func__, "incorrect creation of hash function context" );
+       break;
+     }
+     if(( error = ak_hash_ptr( &bkey->ctx, ids[created-1], idsizes[created-1],
+                                job->values + ( created-1 )*64, bkey->count )) != ak_error_ok ) {
+       ak_error_message( error, __func__, "incorrect evauation of initial hash value" );
+       break;
+     }
+     if(( bkey->data = malloc( memsize + 16 )) == NULL ) {
+       ak_error_message( error = ak_error_out_of_memory, __func__, "incorrect memory allocation" );
+       break;
+     }
+     memset( bkey->data, 0, memsize + 16 );
+  }
+
+  if( error != ak_error_ok ) {
+    for( k = 0; k < created; k++ ) ak_blomkey_destroy( job->keys + k );
+    free( job->values );
+    job->values = NULL;
+  }
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция завершает выработку ключей абонентов, вычисляя их контрольные суммы.
+    \details В случае ошибки (в том числе, переданной в параметре `error`)
+    все ключи абонентов уничтожаются.                                                              */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_blomkey_abonents_finalize( ak_blomkey_abonents_job job, int error )
+{
+  size_t k = 0;
+
+  for( k = 0; ( k < job->count ) && ( error == ak_error_ok ); k++ )
+     error = ak_blomkey_evaluate_icode( job->keys + k, job->keys[k].icode );
+  if( error != ak_error_ok )
+    for( k = 0; k < job->count; k++ ) ak_blomkey_destroy( job->keys + k );
+  if( job->values != NULL ) free( job->values );
+  if( job->powers != NULL ) free( job->powers );
+
  return error;
 }
 
@@ -168,54 +456,58 @@
  int ak_blomkey_create_abonent_key( ak_blomkey bkey, ak_blomkey matrix,
                                                                ak_pointer id, const size_t idsize )
 {
-  ak_uint8 value[64];
-  size_t memsize = 0;
-  ak_int32 column = 0;
-  ak_uint32 i, row = 0;
+  if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                           "using null pointer to abonent's key" );
+ return ak_blomkey_create_abonent_keys( bkey, matrix, 1, &id, &idsize );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вырабатывает ключи для `count` абонентов за один проход по мастер-ключу.
+    Каждая строка мастер-ключа считывается из памяти один раз, при этом одновременно
+    обновляются значения многочленов для всех заданных абонентов. Строки мастер-ключа
+    распределяются между потоками с помощью функции ak_libakrypt_parallel_run().
+    Контрольная сумма мастер-ключа также проверяется однократно.
+
+    Результат совпадает с результатом последовательных вызовов функции
+    ak_blomkey_create_abonent_key() для каждого из идентификаторов.
+
+    \param keys указатель на массив из `count` контекстов создаваемых ключей абонентов
+    \param matrix указатель на контекст мастер-ключа
+    \param count количество абонентов
+    \param ids массив указателей на идентификаторы абонентов
+    \param idsizes массив длин идентификаторов (в октетах)
+    \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха,
+    в противном случае возвращается код ошибки; при этом ни один ключ не создается.                */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_blomkey_create_abonent_keys( ak_blomkey keys, ak_blomkey matrix, const size_t count,
+                                                      ak_pointer *ids, const size_t *idsizes )
+{
+  struct blomkey_abonents_job job;
   int error = ak_error_ok;
 
-  if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+  if( keys == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                            "using null pointer to abonent's key" );
   if( matrix == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                          "using null pointer to blom master key" );
   if( matrix->type != blom_matrix_key ) return ak_error_message( ak_error_wrong_key_type,
                                                    __func__, "incorrect type of blom secret key" );
-  if(( id == NULL ) || ( !idsize )) return ak_error_message( ak_error_undefined_value, __func__,
-                                                          "using undefined abonent's identifier" );
   if( !ak_blomkey_check_icode( matrix ))
     return ak_error_message( ak_error_get_value(), __func__, "using wrong blom master key" );
 
-  memset( bkey, 0, sizeof( struct blomkey ));
-  bkey->count = matrix->count;
-  bkey->size = matrix->size;
-  bkey->type = blom_abonent_key;
+  memset( &job, 0, sizeof( struct blomkey_abonents_job ));
+  job.matrix = matrix;
+  job.keys = keys;
+  job.count = count;
+  if(( error = ak_blomkey_abonents_create( &job, matrix->ctx.oid,
+                                     matrix->size, matrix->count, ids, idsizes )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect creation of abonent's keys" );
 
- /* создаем контекст хеш-функции */
-  if(( error = ak_hash_create_oid( &bkey->ctx, matrix->ctx.oid )) != ak_error_ok )
-    return ak_error_message( error, __func__, "incorrect creation of hash function context" );
- /* формируем хэш от идентификатора */
-  if(( error = ak_hash_ptr( &bkey->ctx, id, idsize, value, bkey->count )) != ak_error_ok )
-    return ak_error_message( error, __func__, "incorrect evauation of initial hash value" );
-
- /* формируем ключевые данные */
-  if(( bkey->data = malloc( ( memsize = bkey->size*matrix->count ) + 16 )) == NULL )
-    return ak_error_message( ak_error_out_of_memory, __func__, "incorrect memory allocation" );
+ /* формируем ключевые данные: строки мастер-ключа распределяются между потоками */
+  if(( error = ak_libakrypt_parallel_run( ak_blomkey_abonents_row,
+                                                         &job, matrix->size )) != ak_error_ok )
+    ak_error_message( error, __func__, "incorrect evaluation of abonent's keys" );
 
-  memset( bkey->data, 0, memsize + 16 );
-  for( row = 0; row < bkey->size; row++ ) { /* схема Горнера для вычисления значений многочлена */
-     ak_uint8 *sum = bkey->data + row*bkey->count;
-     memset( sum, 0, bkey->count );
-     for( column = bkey->size - 1; column >= 0; column-- ) {
-        ak_uint8 *key = ak_blomkey_get_element_by_index( matrix, row, column );
-        if( bkey->count == ak_galois256_size ) ak_gf256_mul( sum, sum, value );
-         else ak_gf512_mul( sum, sum, value );
-        for( i = 0; i < ( bkey->count >> 3 ); i++ ) ((ak_uint64 *)sum)[i] ^= ((ak_uint64 *)key)[i];
-     }
-  }
-
-  if(( error = ak_hash_ptr( &bkey->ctx, bkey->data, memsize,
-                                    bkey->icode, 32 )) != ak_error_ok ) ak_blomkey_destroy( bkey );
- return error;
+ return ak_blomkey_abonents_finalize( &job, error );
 }
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -239,7 +531,6 @@
 {
   ak_uint8 sum[64];
   ak_pointer key = NULL;
-  struct random generator;
   int error = ak_error_ok;
 
  /* проверяем, что заданый oid корректно определяет секретный ключ */
@@ -274,14 +565,30 @@
     key = NULL;
   }
 
-  if( ak_random_create_lcg( &generator ) == ak_error_ok ) {
-    ak_ptr_wipe( sum, 64, &generator );
-    ak_random_destroy( &generator );
-  }
+  if( key != NULL ) ak_ptr_wipe( sum, sizeof( sum ), &((ak_skey)key)->generator );
+    else memset( sum, 0, sizeof( sum ));
 
  return key;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вычисляет значение многочлена, определяемого ключом абонента, в точке `value`
+    (по схеме Горнера) и помещает результат в область памяти `key`. */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_blomkey_evaluate_pairwise( ak_blomkey bkey, ak_uint8 *value, ak_pointer key )
+{
+  ak_uint32 i = 0;
+  ak_int32 row = 0;
+
+  memset( key, 0, bkey->count );
+  for( row = bkey->size - 1; row >= 0; row-- ) {
+     ak_uint8 *element = bkey->data + row*bkey->count;
+     if( bkey->count == ak_galois256_size ) ak_gf256_mul( key, key, value );
+       else ak_gf512_mul( key, key, value );
+     for( i = 0; i < ( bkey->count >> 3 ); i++ ) ((ak_uint64 *)key)[i] ^= ((ak_uint64 *)element)[i];
+  }
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция вырабатывает общий для двух абонентов секретный вектор и
     помещает его в заданную область памяти.
@@ -298,8 +605,6 @@
  int ak_blomkey_create_pairwise_key_as_ptr( ak_blomkey bkey,
                                ak_pointer id, const size_t idsize, ak_pointer key, size_t keysize )
 {
-  ak_uint32 i = 0;
-  ak_int32 row = 0;
   ak_uint8 value[64];
   int error = ak_error_ok;
 
@@ -319,18 +624,284 @@
  /* формируем хэш от идентификатора */
   if(( error = ak_hash_ptr( &bkey->ctx, id, idsize, value, bkey->count )) != ak_error_ok )
     return ak_error_message( error, __func__, "incorrect evauation of initial hash value" );
+  ak_blomkey_evaluate_pairwise( bkey, value, key );
 
-  memset( key, 0, bkey->count );
-  for( row = bkey->size - 1; row >= 0; row-- ) {
-     ak_uint8 *element = ak_blomkey_get_element_by_index( bkey, row, 0 );
-     if( bkey->count == ak_galois256_size ) ak_gf256_mul( key, key, value );
-       else ak_gf512_mul( key, key, value );
-     for( i = 0; i < ( bkey->count >> 3 ); i++ ) ((ak_uint64 *)key)[i] ^= ((ak_uint64 *)element)[i];
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Количество ключей парной связи, обрабатываемых одним потоком за один проход
+    по ключу абонента. */
+ #define ak_blomkey_pairwise_block_size         (64)
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Задание на выработку нескольких ключей парной связи. */
+ typedef struct blomkey_pairwise_job {
+  /*! \brief ключ абонента */
+   ak_blomkey bkey;
+  /*! \brief количество вырабатываемых ключей */
+   size_t count;
+  /*! \brief значения хэш-функции от идентификаторов абонентов (по 64 октета на абонента) */
+   ak_uint8 *values;
+  /*! \brief область памяти для вырабатываемых ключей */
+   ak_uint8 *keys;
+ } *ak_blomkey_pairwise_job;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вырабатывает ключи парной связи для блока идентификаторов с номером `idx`;
+    вызывается из ak_libakrypt_parallel_run().
+    \details Каждый элемент ключа абонента считывается из памяти один раз и используется
+    для выполнения очередного шага схемы Горнера сразу для всех ключей блока.                     */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_blomkey_pairwise_block( ak_pointer ptr, const size_t idx )
+{
+  ak_uint32 i = 0;
+  ak_int32 row = 0;
+  ak_blomkey_pairwise_job job = ( ak_blomkey_pairwise_job )ptr;
+  const ak_uint32 count = job->bkey->count;
+  const size_t first = idx*ak_blomkey_pairwise_block_size,
+               last = ak_min( first + ak_blomkey_pairwise_block_size, job->count );
+  size_t k = 0;
+
+  memset( job->keys + first*count, 0, ( last - first )*count );
+  for( row = job->bkey->size - 1; row >= 0; row-- ) {
+     ak_uint64 *element = ( ak_uint64 * )( job->bkey->data + row*count );
+     for( k = first; k < last; k++ ) {
+        ak_uint64 *key = ( ak_uint64 * )( job->keys + k*count );
+        if( count == ak_galois256_size ) ak_gf256_mul( key, key, job->values + k*64 );
+         else ak_gf512_mul( key, key, job->values + k*64 );
+        for( i = 0; i < ( count >> 3 ); i++ ) key[i] ^= element[i];
+     }
   }
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вырабатывает ключи парной связи с `count` абонентами за один проход по ключу абонента;
+    блоки идентификаторов распределяются между потоками с помощью функции
+    ak_libakrypt_parallel_run(). Контрольная сумма ключа абонента проверяется однократно.
+    Ключ парной связи с абонентом `ids[i]` помещается в память по адресу `keys + i*bkey->count` и
+    совпадает с ключом, вырабатываемым функцией ak_blomkey_create_pairwise_key_as_ptr().
 
+    \param bkey указатель на контекст ключа абонента
+    \param count количество абонентов
+    \param ids массив указателей на идентификаторы абонентов
+    \param idsizes массив длин идентификаторов (в октетах)
+    \param keys указатель на область памяти, в которую помещаются ключи парной связи
+    \param keysize размер доступной области памяти (в октетах); данное значение должно быть
+     не менее, чем `count*bkey->count`
+    \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха,
+    в противном случае возвращается код ошибки.                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_blomkey_create_pairwise_keys_as_ptr( ak_blomkey bkey, const size_t count,
+               ak_pointer *ids, const size_t *idsizes, ak_pointer keys, const size_t keysize )
+{
+  size_t k = 0;
+  int error = ak_error_ok;
+  struct blomkey_pairwise_job job;
+
+  if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                           "using null pointer to abonent's key" );
+  if( bkey->type != blom_abonent_key ) return ak_error_message( ak_error_wrong_key_type,
+                                                   __func__, "incorrect type of blom secret key" );
+  if( !count ) return ak_error_message( ak_error_zero_length, __func__,
+                                                            "using zero count of pairwise keys" );
+  if(( ids == NULL ) || ( idsizes == NULL )) return ak_error_message( ak_error_null_pointer,
+                                            __func__, "using null pointer to abonent's identifiers" );
+  if( keys == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                            "using null pointer to pairwise keys" );
+  if( keysize < count*bkey->count ) return ak_error_message( ak_error_wrong_length, __func__,
+                                          "insufficient memory size for storing a pairwise keys" );
+  if( !ak_blomkey_check_icode( bkey ))
+    return ak_error_message( ak_error_get_value(), __func__, "using wrong blom master key" );
+
+  if(( job.values = malloc( count*64 )) == NULL )
+    return ak_error_message( ak_error_out_of_memory, __func__, "incorrect memory allocation" );
+  job.bkey = bkey;
+  job.count = count;
+  job.keys = keys;
+
+ /* формируем хэш от идентификаторов */
+  for( k = 0; k < count; k++ ) {
+     if(( ids[k] == NULL ) || ( !idsizes[k] )) {
+       ak_error_message_fmt( error = ak_error_undefined_value, __func__,
+                                  "using undefined abonent's identifier (%u)", (unsigned int) k );
+       goto labex;
+     }
+     if(( error = ak_hash_ptr( &bkey->ctx, ids[k], idsizes[k],
+                                               job.values + k*64, bkey->count )) != ak_error_ok ) {
+       ak_error_message( error, __func__, "incorrect evauation of initial hash value" );
+       goto labex;
+     }
+  }
+  if(( error = ak_libakrypt_parallel_run( ak_blomkey_pairwise_block, &job,
+                ( count + ak_blomkey_pairwise_block_size - 1 )/ak_blomkey_pairwise_block_size ))
+                                                                                != ak_error_ok )
+    ak_error_message( error, __func__, "incorrect evaluation of pairwise keys" );
+
+  labex:
+   free( job.values );
  return error;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*                              Кэш ключей парной связи                                            */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Количество элементов в одном множестве кэша ключей парной связи. */
+ #define ak_blomkey_cache_ways                   (4)
+
+/*! \brief Элемент кэша ключей парной связи. */
+ typedef struct blomkey_cache_entry {
+  /*! \brief хэш-код идентификатора абонента */
+   ak_uint8 value[64];
+  /*! \brief ключ парной связи, замаскированный значением `mask` */
+   ak_uint8 key[64];
+  /*! \brief маска, выработанная при помещении ключа в элемент кэша */
+   ak_uint8 mask[64];
+  /*! \brief время последнего обращения к элементу (ноль для свободного элемента) */
+   ak_uint64 stamp;
+ } *ak_blomkey_cache_entry;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Кэш хранит не более `size` ключей парной связи, выработанных из заданного ключа абонента.
+    Ключи хранятся в памяти в замаскированном виде: к каждому ключу прибавляется собственная
+    случайная маска, вырабатываемая генератором \ref ak_random_create_drbg() при помещении
+    ключа в кэш. Кэш является множественно-ассоциативным:
+    элементы разбиты на множества из \ref ak_blomkey_cache_ways элементов, номер множества
+    определяется хэш-кодом идентификатора абонента; при заполнении множества из него удаляется
+    элемент, к которому дольше всего не было обращений.
+
+    Контекст ключа абонента должен существовать в течение всего времени жизни кэша.
+    Кэш не предназначен для одновременного использования несколькими потоками.
+
+    \param cache указатель на контекст кэша
+    \param bkey указатель на контекст ключа абонента
+    \param size максимальное количество хранимых ключей парной связи
+    \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха,
+    в противном случае возвращается код ошибки.                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_blomkey_cache_create( ak_blomkey_cache cache, ak_blomkey bkey, const size_t size )
+{
+  int error = ak_error_ok;
+
+  if( cache == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                               "using null pointer to key cache" );
+  if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                           "using null pointer to abonent's key" );
+  if( bkey->type != blom_abonent_key ) return ak_error_message( ak_error_wrong_key_type,
+                                                   __func__, "incorrect type of blom secret key" );
+  if( !size ) return ak_error_message( ak_error_zero_length, __func__,
+                                                                 "using zero size of key cache" );
+  if( !ak_blomkey_check_icode( bkey ))
+    return ak_error_message( ak_error_get_value(), __func__, "using wrong blom master key" );
+
+  memset( cache, 0, sizeof( struct blomkey_cache ));
+  cache->bkey = bkey;
+  cache->sets = ( size + ak_blomkey_cache_ways - 1 )/ak_blomkey_cache_ways;
+  if(( cache->entries = malloc( cache->sets*ak_blomkey_cache_ways*
+                                         sizeof( struct blomkey_cache_entry ))) == NULL )
+    return ak_error_message( ak_error_out_of_memory, __func__, "incorrect memory allocation" );
+  memset( cache->entries, 0,
+                      cache->sets*ak_blomkey_cache_ways*sizeof( struct blomkey_cache_entry ));
+
+  if(( error = ak_random_create_drbg( &cache->generator )) != ak_error_ok ) {
+    free( cache->entries );
+    memset( cache, 0, sizeof( struct blomkey_cache ));
+    return ak_error_message( error, __func__, "incorrect creation of random generator" );
+  }
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Если ключ парной связи с абонентом `id` содержится в кэше, то он возвращается без вычислений
+    (вычисляется только хэш-код идентификатора). В противном случае ключ вырабатывается
+    (так же как функцией ak_blomkey_create_pairwise_key_as_ptr(), но без повторной проверки
+    контрольной суммы ключа абонента) и помещается в кэш.
+
+    \param cache указатель на контекст кэша
+    \param id указатель на идентификатор абонента, с которым вырабатывается ключ парной связи
+    \param idsize длина идентификатора (в октетах)
+    \param key указатель на область памяти, в которую помещается ключ парной связи
+    \param keysize размер доступной области памяти (в октетах); данное значение должно быть
+     не менее, чем размер ключа парной связи (см. поле `bkey->count`)
+    \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха,
+    в противном случае возвращается код ошибки.                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_blomkey_cache_get_pairwise_key( ak_blomkey_cache cache,
+                         ak_pointer id, const size_t idsize, ak_pointer key, const size_t keysize )
+{
+  size_t i = 0, j = 0, set = 0;
+  ak_uint8 value[64];
+  int error = ak_error_ok;
+  ak_blomkey_cache_entry entry = NULL, victim = NULL;
+
+  if( cache == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                               "using null pointer to key cache" );
+  if( cache->entries == NULL ) return ak_error_message( ak_error_undefined_value, __func__,
+                                                              "using uninitialized key cache" );
+  if(( id == NULL ) || ( !idsize )) return ak_error_message( ak_error_undefined_value, __func__,
+                                                          "using undefined abonent's identifier" );
+  if( key == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                            "using null pointer to pairwise key" );
+  if( keysize < cache->bkey->count ) return ak_error_message( ak_error_wrong_length, __func__,
+                                           "insufficient memory size for storing a pairwise key" );
+
+  memset( value, 0, sizeof( value ));
+  if(( error = ak_hash_ptr( &cache->bkey->ctx, id, idsize,
+                                                  value, cache->bkey->count )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect evauation of initial hash value" );
+
+ /* поиск во множестве, определяемом хэш-кодом идентификатора */
+  set = ( size_t )( value[0] | ( value[1] << 8 ) | ( value[2] << 16 )
+                                                     | (( ak_uint32 )value[3] << 24 ))%cache->sets;
+  entry = ( ak_blomkey_cache_entry )cache->entries + set*ak_blomkey_cache_ways;
+  cache->clock++;
+  for( i = 0; i < ak_blomkey_cache_ways; i++ ) {
+     if( entry[i].stamp && ak_ptr_is_equal( entry[i].value, value, cache->bkey->count )) {
+       entry[i].stamp = cache->clock;
+       for( j = 0; j < cache->bkey->count; j++ )
+          (( ak_uint8 *)key)[j] = entry[i].key[j] ^ entry[i].mask[j];
+       return ak_error_ok;
+     }
+     if(( victim == NULL ) || ( entry[i].stamp < victim->stamp )) victim = entry + i;
+  }
+
+ /* вырабатываем ключ и помещаем его на место давно не используемого элемента */
+  ak_blomkey_evaluate_pairwise( cache->bkey, value, key );
+  if(( error = ak_random_ptr( &cache->generator,
+                                      victim->mask, cache->bkey->count )) != ak_error_ok ) {
+    victim->stamp = 0;
+    return ak_error_message( error, __func__, "incorrect generation of key mask" );
+  }
+  memcpy( victim->value, value, sizeof( value ));
+  for( i = 0; i < cache->bkey->count; i++ )
+     victim->key[i] = (( ak_uint8 *)key)[i] ^ victim->mask[i];
+  victim->stamp = cache->clock;
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \param cache указатель на контекст кэша
+    \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха,
+    в противном случае возвращается код ошибки.                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_blomkey_cache_destroy( ak_blomkey_cache cache )
+{
+  if( cache == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                               "using null pointer to key cache" );
+  if( cache->entries != NULL ) {
+    ak_ptr_wipe( cache->entries, cache->sets*ak_blomkey_cache_ways*
+                                         sizeof( struct blomkey_cache_entry ), &cache->generator );
+    free( cache->entries );
+    ak_random_destroy( &cache->generator );
+  }
+  memset( cache, 0, sizeof( struct blomkey_cache ));
+
+ return ak_error_ok;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \param bkey указатель на контекст мастер-ключа или ключа абонента
     \param row номер строки
@@ -383,16 +954,385 @@
  return ak_error_ok;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*                  Контейнеры мастер-ключей с независимой имитозащитой строк                      */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вычисляет смещение (от начала контейнера) зашифрованного фрагмента строки
+    мастер-ключа с номером `row`; при `row` равном `size` возвращается размер контейнера. */
+/* ----------------------------------------------------------------------------------------------- */
+ static size_t ak_blomkey_container_offset( const size_t size, const size_t count,
+                                                                                 const size_t row )
+{
+ return 16 + ( row*size - ( row*( row - 1 ))/2 )*count + 16*row;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция формирует заголовок строки мастер-ключа с номером `row`: номер строки
+    складывается с последними четырьмя октетами синхропосылки из заголовка контейнера.
+    Первые восемь октетов заголовка строки используются в качестве синхропосылки
+    для режима гаммирования, весь заголовок - в качестве первого блока имитовставки.           */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_blomkey_container_row_header( const ak_uint8 *header,
+                                                                const size_t row, ak_uint8 *out )
+{
+  memcpy( out, header, 16 );
+  out[4] ^= ( row >> 24 )&0xFF;
+  out[5] ^= ( row >> 16 )&0xFF;
+  out[6] ^= ( row >>  8 )&0xFF;
+  out[7] ^= row&0xFF;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вычисляет имитовставку от заголовка строки и зашифрованных данных строки. */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_blomkey_container_row_icode( ak_bckey ikey, ak_uint8 *rheader,
+                                            const ak_uint8 *data, const size_t len, ak_uint8 *out )
+{
+  ikey->key.resource.value.counter = len/16 + 2;
+  ak_bckey_cmac_clean( ikey );
+  ak_bckey_cmac_update( ikey, rheader, 16 );
+  if( len > 16 ) ak_bckey_cmac_update( ikey, ( ak_pointer )data, len - 16 );
+ return ak_bckey_cmac_finalize( ikey, ( ak_pointer )( data + len - 16 ), 16, out, 16 );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция сохраняет мастер-ключ в контейнер: каждая строка верхнетреугольной части
+    матрицы зашифровывается и снабжается собственной имитовставкой. */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_blomkey_container_write( ak_blomkey bkey, ak_file fs,
+                                                   ak_bckey ekey, ak_bckey ikey, ak_uint8 *header )
+{
+  size_t row = 0, len = 0;
+  int error = ak_error_ok;
+  ak_uint8 rheader[16], *buffer = NULL;
+
+  if(( buffer = malloc( bkey->size*bkey->count + 16 )) == NULL )
+    return ak_error_message( ak_error_out_of_memory, __func__, "incorrect memory allocation" );
+
+  for( row = 0; row < bkey->size; row++ ) {
+     len = ( bkey->size - row )*bkey->count;
+     ak_blomkey_container_row_header( header, row, rheader );
+     ekey->key.resource.value.counter = len/16 + 1;
+     if(( error = ak_bckey_ctr( ekey, bkey->data + row*bkey->count*( bkey->size + 1 ),
+                                                   buffer, len, rheader, 8 )) != ak_error_ok ) {
+       ak_error_message( error, __func__, "incorrect encryption of secret matrix" );
+       break;
+     }
+     if(( error = ak_blomkey_container_row_icode( ikey, rheader,
+                                                  buffer, len, buffer + len )) != ak_error_ok ) {
+       ak_error_message( error, __func__, "incorrect evaluation of integrity code" );
+       break;
+     }
+     if( ak_file_write( fs, buffer, len + 16 ) != ( ssize_t )( len + 16 )) {
+       ak_error_message( error = ak_error_write_data, __func__,
+                                                              "incorrect writing encrypted data" );
+       break;
+     }
+  }
+  ak_ptr_wipe( buffer, bkey->size*bkey->count + 16, &ekey->key.generator );
+  free( buffer );
+
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция проверяет имитовставку строки мастер-ключа, размещенной в контейнере. */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_blomkey_container_check_row( ak_blomkey_container ctx,
+                                                               const size_t row, ak_uint8 *rheader )
+{
+  ak_uint8 icode[16];
+  int error = ak_error_ok;
+  const size_t len = ( ctx->size - row )*ctx->count;
+  const ak_uint8 *data = ctx->data + ak_blomkey_container_offset( ctx->size, ctx->count, row );
+
+  ak_blomkey_container_row_header( ctx->header, row, rheader );
+  if(( error = ak_blomkey_container_row_icode( &ctx->ikey,
+                                                  rheader, data, len, icode )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect evaluation of integrity code" );
+  if( !ak_ptr_is_equal( icode, ( ak_pointer )( data + len ), 16 ))
+    return ak_error_message_fmt( ak_error_not_equal_data, __func__,
+                                          "wrong integrity code of row %u", ( unsigned int )row );
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция отображает в память контейнер, созданный функцией
+    ak_blomkey_export_to_file_with_password() для мастер-ключа, и вырабатывает из пароля ключи
+    шифрования и имитозащиты. Ключевые данные при этом не расшифровываются; проверяется только
+    имитовставка первой строки матрицы, что позволяет обнаружить неверный пароль.
+    Строки мастер-ключа расшифровываются по мере необходимости функцией
+    ak_blomkey_container_read_row(), так что объем используемой оперативной памяти
+    не зависит от размера мастер-ключа.
+
+    \param ctx указатель на контекст контейнера
+    \param password пароль, из которого вырабатываются ключи шифрования и имитозащиты
+    \param pass_size длина пароля (в октетах)
+    \param filename имя файла с контейнером
+    \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха. Если файл содержит
+    ключ абонента или мастер-ключ, сохраненный в формате предыдущих версий библиотеки,
+    возвращается \ref ak_error_wrong_key_type; в этом случае ключ может быть считан функцией
+    ak_blomkey_import_from_file_with_password(). В остальных случаях возвращается код ошибки.     */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_blomkey_container_open( ak_blomkey_container ctx, const char *password,
+                                                const size_t pass_size, const char *filename )
+{
+  size_t iter = 0;
+  ak_uint8 rheader[16];
+  int error = ak_error_ok;
+
+  if( ctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                         "using null pointer to container context" );
+  if( filename == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                               "using null pointer to file name" );
+  memset( ctx, 0, sizeof( struct blomkey_container ));
+  if(( ctx->data = ak_file_mmap( &ctx->fs, filename, readonly, 0 )) == NULL )
+    return ak_error_message_fmt( ak_error_get_value(), __func__,
+                                                   "incorrect mapping a file \"%s\"", filename );
+  if( ctx->fs.size < 16 ) {
+    ak_error_message( error = ak_error_read_data, __func__, "incorrect reading a file header" );
+    goto labex;
+  }
+  memcpy( ctx->header, ctx->data, 16 );
+  if( ctx->header[10] != ( blom_matrix_key | ak_blomkey_container_flag )) {
+    error = ak_error_wrong_key_type;
+    goto labex;
+  }
+  ctx->size = ( (ak_uint32)ctx->header[12] << 24 ) + ( (ak_uint32)ctx->header[13] << 16 ) +
+                                         ( (ak_uint32)ctx->header[14] << 8 ) + ctx->header[15];
+  ctx->count = ctx->header[11];
+  if(( ctx->size == 0 ) || ( ctx->size > 4096 )) {
+    ak_error_message( error = ak_error_wrong_length, __func__,
+                                                         "using wrong size for blom matrix" );
+    goto labex;
+  }
+  if(( ctx->count != ak_galois256_size ) && ( ctx->count != ak_galois512_size )) {
+    ak_error_message( error = ak_error_undefined_value, __func__,
+                                       "this function accepts only 256 or 512 bit galois fields" );
+    goto labex;
+  }
+  if(( size_t )ctx->fs.size != ak_blomkey_container_offset( ctx->size, ctx->count, ctx->size )) {
+    ak_error_message( error = ak_error_wrong_length, __func__, "unexpected length of container" );
+    goto labex;
+  }
+
+ /* вычисляем ключи и проверяем пароль */
+  iter = ( ctx->header[8] << 8 ) + ctx->header[9];
+  if(( error = ak_bckey_create_key_pair_from_password( &ctx->ekey, &ctx->ikey,
+                          ak_oid_find_by_name( "kuznechik" ), password, pass_size,
+                                                     ctx->header, 16, iter )) != ak_error_ok ) {
+    ak_error_message( error, __func__, "incorrect creation of key pair" );
+    goto labex;
+  }
+  if(( error = ak_blomkey_container_check_row( ctx, 0, rheader )) != ak_error_ok ) {
+    ak_error_message( error, __func__, "incorrect value of control sum, may be wrong password ... " );
+    ak_bckey_destroy( &ctx->ekey );
+    ak_bckey_destroy( &ctx->ikey );
+    goto labex;
+  }
+ return ak_error_ok;
+
+  labex:
+   ak_file_unmap( &ctx->fs, ctx->data );
+   memset( ctx, 0, sizeof( struct blomkey_container ));
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция проверяет имитовставку строки мастер-ключа с номером `row` и расшифровывает элементы
+    \f$ a_{row,row}, a_{row,row+1}, \ldots, a_{row,size-1} \f$ (остальные элементы строки
+    в силу симметричности матрицы содержатся в предыдущих строках).
+
+    \param ctx указатель на контекст открытого контейнера
+    \param row номер строки
+    \param out область памяти, в которую помещаются расшифрованные элементы
+    \param size размер области памяти (в октетах); должен быть не менее `(ctx->size - row)*ctx->count`
+    \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха,
+    в противном случае возвращается код ошибки.                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_blomkey_container_read_row( ak_blomkey_container ctx, const ak_uint32 row,
+                                                               ak_pointer out, const size_t size )
+{
+  size_t len = 0;
+  ak_uint8 rheader[16];
+  int error = ak_error_ok;
+
+  if(( ctx == NULL ) || ( out == NULL )) return ak_error_message( ak_error_null_pointer,
+                                                                   __func__, "using null pointer" );
+  if( ctx->data == NULL ) return ak_error_message( ak_error_undefined_value, __func__,
+                                                                 "using unopened container" );
+  if( row >= ctx->size ) return ak_error_message( ak_error_wrong_index, __func__,
+                                                                    "parameter is very large" );
+  if( size < ( len = ( ctx->size - row )*ctx->count ))
+    return ak_error_message( ak_error_wrong_length, __func__,
+                                                     "insufficient memory size for storing a row" );
+  if(( error = ak_blomkey_container_check_row( ctx, row, rheader )) != ak_error_ok )
+    return ak_error_message( error, __func__, "using damaged row of blom master key" );
+
+  ctx->ekey.key.resource.value.counter = len/16 + 1;
+ return ak_bckey_ctr( &ctx->ekey,
+        ctx->data + ak_blomkey_container_offset( ctx->size, ctx->count, row ), out, len, rheader, 8 );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вырабатывает ключи для `count` абонентов, последовательно расшифровывая строки
+    мастер-ключа, хранящегося в контейнере. В оперативной памяти одновременно находится
+    только одна строка мастер-ключа; вычисления для разных абонентов распределяются между потоками.
+
+    Результат совпадает с результатом функции ak_blomkey_create_abonent_keys(), вызванной для
+    мастер-ключа, считанного из контейнера функцией ak_blomkey_import_from_file_with_password().
+
+    \param ctx указатель на контекст открытого контейнера
+    \param keys указатель на массив из `count` контекстов создаваемых ключей абонентов
+    \param count количество абонентов
+    \param ids массив указателей на идентификаторы абонентов
+    \param idsizes массив длин идентификаторов (в октетах)
+    \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха,
+    в противном случае возвращается код ошибки; при этом ни один ключ не создается.                */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_blomkey_container_create_abonent_keys( ak_blomkey_container ctx, ak_blomkey keys,
+                                  const size_t count, ak_pointer *ids, const size_t *idsizes )
+{
+  struct blomkey_abonents_job job;
+  int error = ak_error_ok;
+  size_t memsize = 0;
+
+  if( ctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                         "using null pointer to container context" );
+  if( keys == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                           "using null pointer to abonent's key" );
+  if( ctx->data == NULL ) return ak_error_message( ak_error_undefined_value, __func__,
+                                                                 "using unopened container" );
+  memset( &job, 0, sizeof( struct blomkey_abonents_job ));
+  job.keys = keys;
+  job.count = count;
+  if(( error = ak_blomkey_abonents_create( &job, ak_oid_find_by_name(
+                                  ctx->count == ak_galois256_size ? "streebog256" : "streebog512" ),
+                                           ctx->size, ctx->count, ids, idsizes )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect creation of abonent's keys" );
+
+  memsize = ctx->size*ctx->count;
+  if((( job.powers = malloc( count*64 )) == NULL ) ||
+     (( job.line = malloc( memsize )) == NULL )) {
+    ak_error_message( error = ak_error_out_of_memory, __func__, "incorrect memory allocation" );
+    goto labex;
+  }
+  for( job.row = 0; job.row < ctx->size; job.row++ ) {
+     if(( error = ak_blomkey_container_read_row( ctx, job.row, job.line,
+                                                                    memsize )) != ak_error_ok ) {
+       ak_error_message( error, __func__, "incorrect reading of blom master key" );
+       break;
+     }
+     if(( error = ak_libakrypt_parallel_run( ak_blomkey_abonents_segment,
+                                                                &job, count )) != ak_error_ok ) {
+       ak_error_message( error, __func__, "incorrect evaluation of abonent's keys" );
+       break;
+     }
+  }
+
+  labex:
+   if( job.line != NULL ) {
+     ak_ptr_wipe( job.line, memsize, &ctx->ekey.key.generator );
+     free( job.line );
+   }
+ return ak_blomkey_abonents_finalize( &job, error );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция считывает мастер-ключ из контейнера: строки верхнетреугольной части матрицы
+    расшифровываются непосредственно в память ключа, после чего копируются в нижний треугольник. */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_blomkey_import_from_container( ak_blomkey bkey,
+                              const char *password, const size_t pass_size, const char *filename )
+{
+  ak_uint32 row = 0;
+  size_t memsize = 0;
+  int error = ak_error_ok;
+  struct blomkey_container ctx;
+
+  if(( error = ak_blomkey_container_open( &ctx, password, pass_size, filename )) != ak_error_ok )
+    return ak_error_message_fmt( error, __func__, "incorrect opening a file \"%s\"", filename );
+
+  memset( bkey, 0, sizeof( struct blomkey ));
+  bkey->type = blom_matrix_key;
+  bkey->count = ctx.count;
+  bkey->size = ctx.size;
+  memsize = ( size_t )bkey->size*bkey->size*bkey->count;
+  if(( error = ak_hash_create_oid( &bkey->ctx, ak_oid_find_by_name( bkey->count ==
+                             ak_galois256_size ? "streebog256" : "streebog512" ))) != ak_error_ok ) {
+    ak_error_message( error, __func__, "incorrect creation of hash function context" );
+    goto labex;
+  }
+  if(( bkey->data = malloc( memsize + 16 )) == NULL ) { /* 16 это размер имитовставки */
+    ak_error_message( error = ak_error_out_of_memory, __func__, "incorrect memory allocation" );
+    goto labex;
+  }
+  memset( bkey->data, 0, memsize + 16 );
+
+  for( row = 0; row < bkey->size; row++ )
+     if(( error = ak_blomkey_container_read_row( &ctx, row,
+                         bkey->data + ( size_t )row*bkey->count*( bkey->size + 1 ),
+                                          ( bkey->size - row )*bkey->count )) != ak_error_ok ) {
+       ak_error_message( error, __func__, "incorrect reading of secret matrix" );
+       goto labex;
+     }
+  if(( error = ak_libakrypt_parallel_run( ak_blomkey_mirror_tiles, bkey,
+             ( bkey->size + ak_blomkey_tile_size - 1 )/ak_blomkey_tile_size )) != ak_error_ok ) {
+    ak_error_message( error, __func__, "incorrect creation of symmetric matrix" );
+    goto labex;
+  }
+  if(( error = ak_blomkey_evaluate_icode( bkey, bkey->icode )) != ak_error_ok )
+    ak_error_message( error,  __func__ , "incorrect calculation of control sum" );
+
+  labex:
+   if( error != ak_error_ok ) ak_blomkey_destroy( bkey );
+   ak_blomkey_container_close( &ctx );
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \param ctx указатель на контекст контейнера
+    \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха,
+    в противном случае возвращается код ошибки.                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_blomkey_container_close( ak_blomkey_container ctx )
+{
+  if( ctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                         "using null pointer to container context" );
+  if( ctx->data != NULL ) {
+    ak_bckey_destroy( &ctx->ekey );
+    ak_bckey_destroy( &ctx->ikey );
+    ak_file_unmap( &ctx->fs, ctx->data );
+  }
+  memset( ctx, 0, sizeof( struct blomkey_container ));
+
+ return ak_error_ok;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Для сохранения ключа используется преобразование KExp15, регламентируемое
     рекомендациями по стадартизации Р 1323565.1.017-2018.
 
-    Формат хранения данных определяется следующим образом.
+    Формат хранения ключа абонента определяется следующим образом.
 
    \code
       IV || CTR( eKey, Key || CMAC( iKey, IV || Key ))
    \endcode
 
+    Для мастер-ключа сохраняются только элементы, расположенные на главной диагонали и над ней;
+    каждая строка \f$ R_i \f$ этой части матрицы зашифровывается независимо и снабжается
+    собственной имитовставкой:
+
+   \code
+      IV || C_0 || T_0 || C_1 || T_1 || ... || C_{size-1} || T_{size-1},
+      C_i = CTR( eKey, R_i ), T_i = CMAC( iKey, IV_i || C_i ),
+   \endcode
+
+    где \f$ IV_i \f$ получается из IV сложением номера строки с октетами 4-7 вектора IV,
+    а первые 8 октетов \f$ IV_i \f$ используются как синхропосылка режима гаммирования.
+    Такой формат позволяет проверять и расшифровывать строки мастер-ключа независимо друг от друга,
+    см. функцию ak_blomkey_container_open().
+
     Ключи шифрования `eKey` и имитозащиты `iKey` вырабатываются из пароля
     с помощью преобразования pbkdf2, см. функцию ak_bckey_create_key_pair_from_password().
 
@@ -400,7 +1340,8 @@
 
     - первые 8 октетов - значение синхропосылки для режима гаммирования,
     - два октета - значение числа итераций в алгоритме pbkdf2,
-    - один октет - тип ключа (bkey->type),
+    - один октет - тип ключа (bkey->type); для мастер-ключа к типу добавляется флаг
+      \ref ak_blomkey_container_flag,
     - один октет - размер элемента поля (bkey->count),
     - четыре октета - размерность матрицы (bkey->size).
 
@@ -428,7 +1369,7 @@
   struct random generator;
   size_t memsize, iter = ak_libakrypt_get_option_by_name( "pbkdf2_iteration_count" );
   struct bckey ekey, ikey;
-  size_t i, j, blocks, lblocks, ltail;
+  size_t i, blocks, lblocks, ltail;
   ak_uint8 iv[16], buffer[1024], *ptr = NULL;
 
   if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
@@ -446,6 +1387,7 @@
   iv[8]  = (iter >> 8)&0xFF;
   iv[9]  = iter&0xFF; /* помещаем число итераций в big-endian формате */
   iv[10] = (ak_uint8) bkey->type;    /* сохраняем тип ключа */
+  if( bkey->type == blom_matrix_key ) iv[10] |= ak_blomkey_container_flag;
   iv[11] = bkey->count; /* количество октетов в одном элементе */
   iv[12] = ( bkey->size >> 24)&0xFF; /* сохраняем значение size */
   iv[13] = ( bkey->size >> 16)&0xFF;
@@ -466,12 +1408,14 @@
        ak_oid_find_by_name( "kuznechik" ), password, pass_size, iv, 16, iter )) != ak_error_ok )
     return ak_error_message( error, __func__, "incorrect creation of key pair" );
 
- /* вычисляем контрольную сумму, которая будет сохранена в файл */
-  ikey.key.resource.value.counter = blocks + 1;
-  ak_bckey_cmac_clean( &ikey );
-  ak_bckey_cmac_update( &ikey, iv, 16 );
-  if( blocks > 1 ) ak_bckey_cmac_update( &ikey, bkey->data, memsize - 16 );
-  ak_bckey_cmac_finalize( &ikey, bkey->data + memsize - 16, 16, bkey->data + memsize, 16 );
+ /* для ключа абонента вычисляем контрольную сумму, которая будет сохранена в файл */
+  if( bkey->type == blom_abonent_key ) {
+    ikey.key.resource.value.counter = blocks + 1;
+    ak_bckey_cmac_clean( &ikey );
+    ak_bckey_cmac_update( &ikey, iv, 16 );
+    if( blocks > 1 ) ak_bckey_cmac_update( &ikey, bkey->data, memsize - 16 );
+    ak_bckey_cmac_finalize( &ikey, bkey->data + memsize - 16, 16, bkey->data + memsize, 16 );
+  }
 
  /* создаем имя файла и сохраняем данные */
   if(( error = ak_skey_generate_file_name_from_buffer( iv, 8,
@@ -493,34 +1437,9 @@
  /* сохраняем данные в оптимальном виде */
   ekey.key.resource.value.counter = blocks + 1;
   switch( bkey->type ) {
-   case blom_matrix_key:                   /* сохраняем только существенные данные, т.е. */
-    /* фактически, мы сохраняем верхнетреугольную матрицу, отбрасывая симметричную часть */
-     for( i = 0; i < bkey->size; i++ ) {
-        memsize = ( bkey->size - i )*bkey->count;
-        if( i == ( bkey->size - 1 )) memsize += 16; /* добавляем контрольную сумму */
-
-        ltail = ( memsize )%sizeof( buffer );
-        lblocks = ( memsize - ltail )/sizeof( buffer );
-        ptr = bkey->data + i*bkey->count*(bkey->size + 1);
-
-        for( j = 0; j < lblocks; j++ ) {
-           ak_bckey_ctr( &ekey, ptr, buffer, sizeof( buffer ), j == 0 ? iv : NULL, 8 );
-           ptr += sizeof( buffer );
-           if( ak_file_write( &fs, buffer, sizeof( buffer )) < 0 ) {
-             ak_error_message( error = ak_error_write_data, __func__,
-                                                              "incorrect writing encrypted data" );
-             goto labex2;
-           }
-        }
-        if( ltail ) {
-          ak_bckey_ctr( &ekey, ptr, buffer, ltail, NULL, 0 );
-          if( ak_file_write( &fs, buffer, ltail ) < 0 ) {
-            ak_error_message( error = ak_error_write_data, __func__,
-                                                              "incorrect writing encrypted tail" );
-            goto labex2;
-          }
-        }
-     }
+   case blom_matrix_key: /* сохраняем верхнетреугольную часть матрицы построчно */
+     if(( error = ak_blomkey_container_write( bkey, &fs, &ekey, &ikey, iv )) != ak_error_ok )
+       ak_error_message( error, __func__, "incorrect writing of secret matrix" );
      break;
 
    case blom_abonent_key: /* в этом случае сохраняем все данные, без выбросов */
@@ -594,6 +1513,11 @@
     ak_error_message( error = ak_error_read_data, __func__, "incorrect reading a file header" );
     goto labex;
   }
+ /* мастер-ключ с независимо зашифрованными строками считываем из контейнера */
+  if( iv[10] == ( blom_matrix_key | ak_blomkey_container_flag )) {
+    ak_file_close( &fs );
+    return ak_blomkey_import_from_container( bkey, password, pass_size, filename );
+  }
 
   memset( bkey, 0, sizeof( struct blomkey ));
   bkey->size = iv[12];
@@ -739,7 +1663,7 @@
     ak_error_message( error, __func__, "incorrect creation of hash function context" );
     goto labex1;
   }
-  if(( error = ak_hash_ptr( &bkey->ctx, bkey->data, memsize, bkey->icode, 32 )) != ak_error_ok ) {
+  if(( error = ak_blomkey_evaluate_icode( bkey, bkey->icode )) != ak_error_ok ) {
     ak_error_message( error,  __func__ , "incorrect calculation of control sum" );
     ak_hash_destroy( &bkey->ctx );
   }
@@ -6,6 +6,153 @@
 /* ----------------------------------------------------------------------------------------------- */
  #include <libakrypt.h>
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вычисляет дополнительные ключи K1 и K2 алгоритма выработки имитовставки.
+    \details Ключи вычисляются путем зашифрования нулевого блока и последующего умножения
+    результата на многочлен \f$ x \f$ (ключ K1) и \f$ x^2 \f$ (ключ K2) в поле
+    \f$ \mathbb F_{2^{64}}\f$ или \f$ \mathbb F_{2^{128}}\f$, в зависимости от длины блока.
+
+    \param bkey Контекст ключа алгоритма блочного шифрования.
+    \param oc Флаг режима совместимости с openssl.
+    \param keys Массив, куда помещаются значения ключей (первые два слова - K1, следующие - K2).  */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_bckey_cmac_compute_subkeys( ak_bckey bkey, const ak_int64 oc, ak_uint64 *keys )
+{
+  ak_uint64
+      #ifdef AK_LITTLE_ENDIAN
+        one64[2] = { 0x02, 0x00 };
+      #else
+        one64[2] = { 0x0200000000000000LL, 0x00 };
+      #endif
+
+  memset( keys, 0, 4*sizeof( ak_uint64 ));
+  bkey->encrypt( &bkey->key, keys, keys );
+  switch( bkey->bsize ) {
+    case  8:
+      if( oc ) keys[0] = bswap_64( keys[0] );
+      ak_gf64_mul( keys, keys, one64 );
+      ak_gf64_mul( keys+2, keys, one64 );
+      break;
+
+    case 16:
+      if( oc ) {
+        ak_uint64 tmp = bswap_64( keys[0] );
+        keys[0] = bswap_64( keys[1] );
+        keys[1] = tmp;
+      }
+      ak_gf128_mul( keys, keys, one64 );
+      ak_gf128_mul( keys+2, keys, one64 );
+      break;
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вычисляет дополнительные ключи K1 и K2 алгоритма выработки имитовставки
+    и сохраняет их в контексте ключа в маскированном виде. Функция вызывается после каждой
+    развертки раундовых ключей, поэтому при вычислении имитовставки зашифрование нулевого
+    блока и умножения в конечном поле не выполняются.
+
+    \param bkey Контекст ключа алгоритма блочного шифрования; значение ключа должно быть
+    определено, а развертка раундовых ключей выполнена.
+    \return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_cmac_set_subkeys( ak_bckey bkey )
+{
+  size_t i = 0;
+  ak_uint64 keys[4];
+  int error = ak_error_ok;
+
+  if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                        "using null pointer to block cipher key" );
+  bkey->key.flags &= ~ak_key_flag_cmac_subkeys;
+  if(( bkey->encrypt == NULL ) || (( bkey->bsize != 8 ) && ( bkey->bsize != 16 )))
+    return ak_error_ok; /* ключи не вычисляются, используется медленный вариант */
+
+  ak_bckey_cmac_compute_subkeys( bkey,
+                           ak_libakrypt_get_option_by_name( "openssl_compability" ), keys );
+  if(( error = ak_random_ptr( &bkey->key.generator,
+                                     bkey->cmac_mask, sizeof( bkey->cmac_mask ))) != ak_error_ok ) {
+    ak_error_message( error, __func__, "incorrect generation of subkeys mask" );
+    memset( keys, 0, sizeof( keys ));
+    return error;
+  }
+  for( i = 0; i < 4; i++ ) bkey->cmac_subkeys[i] = keys[i] ^ bkey->cmac_mask[i];
+  memset( keys, 0, sizeof( keys ));
+  bkey->key.flags |= ak_key_flag_cmac_subkeys;
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция зашифровывает последний блок сообщения.
+    \details Функция объединяет текущее значение сцепления `yaout` с последним
+    (возможно, неполным) блоком сообщения и дополнительным ключом, после чего зашифровывает
+    результат. Если дополнительные ключи были вычислены заранее, то используются они.
+
+    \param bkey Контекст ключа алгоритма блочного шифрования.
+    \param oc Флаг режима совместимости с openssl.
+    \param yaout Текущее значение сцепления (изменяется функцией).
+    \param inptr Указатель на последний блок сообщения.
+    \param tail Длина последнего блока (от 1 до длины блока).
+    \param out Массив, куда помещается результат зашифрования.                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_bckey_cmac_last_block( ak_bckey bkey, const ak_int64 oc, ak_uint64 *yaout,
+                                    const ak_uint8 *inptr, const size_t tail, ak_uint64 *out )
+{
+  size_t i = 0;
+  ak_uint64 keys[4], *akey = keys;
+
+ /* получаем дополнительный ключ */
+  if( bkey->key.flags&ak_key_flag_cmac_subkeys ) {
+    for( i = 0; i < 4; i++ ) keys[i] = bkey->cmac_subkeys[i] ^ bkey->cmac_mask[i];
+  }
+   else ak_bckey_cmac_compute_subkeys( bkey, oc, keys );
+  if( tail < bkey->bsize ) {
+    akey = keys+2;
+    ((ak_uint8 *)akey)[tail] ^= 0x80;
+  }
+
+  switch( bkey->bsize ) {
+    case  8:
+      if( oc ) {
+        yaout[0] ^= bswap_64( akey[0] );
+        for( i = 0; i < tail; i++ ) ((ak_uint8 *)yaout)[7-i] ^= inptr[tail-1-i];
+      }
+       else {
+        yaout[0] ^= akey[0];
+        for( i = 0; i < tail; i++ ) ((ak_uint8 *)yaout)[i] ^= inptr[i];
+       }
+      break;
+
+    case 16:
+      if( oc ) {
+        yaout[0] ^= bswap_64( akey[1] );
+        yaout[1] ^= bswap_64( akey[0] );
+        for( i = 0; i < tail; i++ ) ((ak_uint8 *)yaout)[15-i] ^= inptr[tail-1-i];
+      }
+       else {
+        yaout[0] ^= akey[0];
+        yaout[1] ^= akey[1];
+        for( i = 0; i < tail; i++ ) ((ak_uint8 *)yaout)[i] ^= inptr[i];
+       }
+      break;
+  }
+  memset( keys, 0, sizeof( keys ));
+  bkey->encrypt( &bkey->key, yaout, out );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция копирует нужную часть вычисленной имитовставки. */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_bckey_cmac_copy_result( ak_bckey bkey, const ak_int64 oc, ak_uint64 *akey,
+                                                           ak_pointer out, const size_t out_size )
+{
+  if( oc ) memcpy( out, (ak_uint8 *)akey, ak_min( out_size, bkey->bsize ));
+   else memcpy( out, (ak_uint8 *)akey+( out_size > bkey->bsize ? 0 : bkey->bsize-out_size ),
+                                                                  ak_min( out_size, bkey->bsize ));
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция вычисляет имитовставку от заданной области памяти фиксированного размера.
    Используется алгоритм, который также называют OMAC1
@@ -27,11 +174,6 @@
                                           const size_t size, ak_pointer out, const size_t out_size )
 {
   ak_int64 i = 0, oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" ),
-        #ifdef AK_LITTLE_ENDIAN
-           one64[2] = { 0x02, 0x00 },
-        #else
-           one64[2] = { 0x0200000000000000LL, 0x00 },
-        #endif
            blocks = (ak_int64)size/bkey->bsize,
            tail = (ak_int64)size%bkey->bsize;
  ak_uint64 yaout[2], akey[2], *inptr = (ak_uint64 *)in;
@@ -54,7 +196,6 @@
                                                               "low resource of block cipher key" );
    else bkey->key.resource.value.counter -= ( blocks + ( tail > 0 )); /* уменьшаем ресурс ключа */
 
-  memset( akey, 0, sizeof( akey ));
   memset( yaout, 0, sizeof( yaout ));
   if( !tail ) { tail = bkey->bsize; blocks--; } /* последний блок всегда существует */
 
@@ -66,27 +207,6 @@
                yaout[0] ^= inptr[0];
                bkey->encrypt( &bkey->key, yaout, yaout );
             }
-
-          /* теперь ключи для завершения алгоритма */
-            bkey->encrypt( &bkey->key, akey, akey );
-            if( oc ) akey[0] = bswap_64( akey[0] );
-            ak_gf64_mul( akey, akey, one64 );
-
-            if( tail < (ak_int64) bkey->bsize ) {
-              ak_gf64_mul( akey, akey, one64 );
-              ((ak_uint8 *)akey)[tail] ^= 0x80;
-            }
-
-          /* теперь шифруем последний блок */
-            if( oc ) {
-               yaout[0] ^= bswap_64( akey[0] );
-               for( i = 0; i < tail; i++ ) ((ak_uint8 *)yaout)[7-i] ^= ((ak_uint8 *)inptr)[tail-1-i];
-            }
-              else {
-               yaout[0] ^= akey[0];
-               for( i = 0; i < tail; i++ ) ((ak_uint8 *)yaout)[i] ^= ((ak_uint8 *)inptr)[i];
-              }
-            bkey->encrypt( &bkey->key, yaout, akey );
           break;
 
    case 16 :
@@ -96,39 +216,100 @@
                yaout[1] ^= inptr[1];
                bkey->encrypt( &bkey->key, yaout, yaout );
             }
+          break;
+  }
 
-          /* вырабатываем ключи для завершения алгортма */
-            bkey->encrypt( &bkey->key, akey, akey );
-            if( oc ) {
-              ak_uint64 tmp = bswap_64( akey[0] );
-              akey[0] = bswap_64( akey[1] );
-              akey[1] = tmp;
-            }
-            ak_gf128_mul( akey, akey, one64 );
-            if( tail < (ak_int64) bkey->bsize ) {
-              ak_gf128_mul( akey, akey, one64 );
-              ((ak_uint8 *)akey)[tail] ^= 0x80;
-            }
+ /* теперь шифруем последний блок и копируем нужную часть результирующего массива */
+  ak_bckey_cmac_last_block( bkey, oc, yaout, (ak_uint8 *)inptr, (size_t)tail, akey );
+  ak_bckey_cmac_copy_result( bkey, oc, akey, out, out_size );
 
-          /* теперь шифруем последний блок*/
-            if( oc ) {
-               yaout[0] ^= bswap_64( akey[1] );
-               yaout[1] ^= bswap_64( akey[0] );
-               for( i = 0; i < tail; i++ ) ((ak_uint8 *)yaout)[15-i] ^= ((ak_uint8 *)inptr)[tail-1-i];
-            }
-             else {
-              yaout[0] ^= akey[0];
-              yaout[1] ^= akey[1];
-              for( i = 0; i < tail; i++ ) ((ak_uint8 *)yaout)[i] ^= ((ak_uint8 *)inptr)[i];
-             }
-            bkey->encrypt( &bkey->key, yaout, akey );
-          break;
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вычисляет имитовставки для нескольких независимых сообщений на одном ключе.
+    Вычисления для различных сообщений выполняются с чередованием: на каждом шаге
+    зашифровывается очередной блок каждого из сообщений (не более
+    \ref ak_bckey_cmac_batch_lanes сообщений одновременно), что позволяет избежать простоев,
+    связанных с зависимостью каждого шага от результата предыдущего зашифрования.
+
+    Результат вычислений совпадает с результатом последовательного вызова функции
+    ak_bckey_cmac() для каждого из сообщений.
+
+   @param bkey Ключ алгоритма блочного шифрования, используемый для выработки имитовставки.
+   @param count Количество сообщений.
+   @param in Массив указателей на сообщения.
+   @param size Массив длин сообщений (в октетах); длины должны быть отличны от нуля.
+   @param out Массив указателей на области памяти, куда помещаются имитовставки.
+   @param out_size Ожидаемый размер каждой имитовставки.
+
+   @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+   возвращается \ref ak_error_ok (ноль)                                                            */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_cmac_batch( ak_bckey bkey, const size_t count, ak_pointer *in,
+                                   const size_t *size, ak_pointer *out, const size_t out_size )
+{
+  size_t i = 0, j = 0, lanes = 0, active = 0, total = 0;
+  ak_int64 oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
+  ak_uint64 yaout[ak_bckey_cmac_batch_lanes][2], akey[2];
+  size_t blocks[ak_bckey_cmac_batch_lanes], tail[ak_bckey_cmac_batch_lanes];
+  ak_uint8 *inptr[ak_bckey_cmac_batch_lanes];
+
+  if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                        "using null pointer to block cipher key" );
+  if( !count ) return ak_error_ok;
+  if(( in == NULL ) || ( size == NULL ) || ( out == NULL ))
+    return ak_error_message( ak_error_null_pointer, __func__, "using null pointer to arrays" );
+  if( !out_size ) return ak_error_message( ak_error_zero_length, __func__,
+                                                            "using zero length of result buffer" );
+  for( i = 0; i < count; i++ ) {
+     if(( in[i] == NULL ) || ( out[i] == NULL ))
+       return ak_error_message_fmt( ak_error_null_pointer, __func__,
+                                          "using null pointer for %u-th message", (unsigned int)i );
+     if( !size[i] ) return ak_error_message_fmt( ak_error_zero_length, __func__,
+                                          "using %u-th message with zero length", (unsigned int)i );
+     total += ( size[i] + bkey->bsize - 1 )/bkey->bsize;
+  }
+ /* проверяем целостность ключа */
+  if( bkey->key.check_icode( &bkey->key ) != ak_true )
+    return ak_error_message( ak_error_wrong_key_icode, __func__,
+                                                  "incorrect integrity code of secret key value" );
+ /* уменьшаем значение ресурса ключа */
+  if( bkey->key.resource.value.counter < (ssize_t) total )
+    return ak_error_message( ak_error_low_key_resource, __func__ ,
+                                                              "low resource of block cipher key" );
+   else bkey->key.resource.value.counter -= (ssize_t) total;
+
+ /* основной цикл: обрабатываем сообщения группами */
+  for( j = 0; j < count; j += lanes ) {
+     lanes = ak_min( count - j, ak_bckey_cmac_batch_lanes );
+     for( i = 0; i < lanes; i++ ) {
+        yaout[i][0] = yaout[i][1] = 0;
+        inptr[i] = in[j+i];
+        blocks[i] = size[j+i]/bkey->bsize;
+        if(( tail[i] = size[j+i]%bkey->bsize ) == 0 ) { tail[i] = bkey->bsize; blocks[i]--; }
+     }
+
+    /* чередуем цепочки зацепления, пока есть хотя бы одна с необработанными блоками */
+     do {
+       active = 0;
+       for( i = 0; i < lanes; i++ ) {
+          if( !blocks[i] ) continue;
+          yaout[i][0] ^= (( ak_uint64 *)inptr[i])[0];
+          if( bkey->bsize == 16 ) yaout[i][1] ^= (( ak_uint64 *)inptr[i])[1];
+          bkey->encrypt( &bkey->key, yaout[i], yaout[i] );
+          inptr[i] += bkey->bsize;
+          if( --blocks[i] ) active++;
+       }
+     } while( active );
+
+    /* завершаем вычисления */
+     for( i = 0; i < lanes; i++ ) {
+        ak_bckey_cmac_last_block( bkey, oc, yaout[i], inptr[i], tail[i], akey );
+        ak_bckey_cmac_copy_result( bkey, oc, akey, out[j+i], out_size );
+     }
   }
 
- /* копируем нужную часть результирующего массива и завершаем работу */
- if( oc ) memcpy( out, (ak_uint8 *)akey, ak_min( out_size, bkey->bsize ));
-  else memcpy( out, (ak_uint8 *)akey+( out_size > bkey->bsize ? 0 : bkey->bsize-out_size ),
-                                                                  ak_min( out_size, bkey->bsize ));
  return ak_error_ok;
 }
 
@@ -267,13 +448,8 @@
  int ak_bckey_cmac_finalize( ak_bckey bkey, const ak_pointer in, const size_t size,
                                                            ak_pointer out, const size_t out_size )
 {
-  ak_int64 oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" ),
-        #ifdef AK_LITTLE_ENDIAN
-           one64[2] = { 0x02, 0x00 };
-        #else
-           one64[2] = { 0x0200000000000000LL, 0x00 };
-        #endif
-  ak_uint64 i, *yaout, akey[2], *inptr = (ak_uint64 *)in;
+  ak_uint64 akey[2];
+  ak_int64 oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
 
   if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                         "using null pointer to block cipher key" );
@@ -288,69 +464,11 @@
  /* уменьшаем значение ресурса ключа */
   bkey->key.resource.value.counter--; /* уменьшаем ресурс ключа */
 
-  memset( akey, 0, sizeof( akey ));
-  yaout = ( ak_uint64 * )bkey->ivector;
-
- /* основной цикл */
-  switch( bkey->bsize ) {
-   case  8 :
-          /* теперь ключи для завершения алгоритма */
-            bkey->encrypt( &bkey->key, akey, akey );
-            if( oc ) akey[0] = bswap_64( akey[0] );
-            ak_gf64_mul( akey, akey, one64 );
-
-            if( size < bkey->bsize ) {
-              ak_gf64_mul( akey, akey, one64 );
-              ((ak_uint8 *)akey)[size] ^= 0x80;
-            }
-
-          /* теперь шифруем последний блок */
-            if( oc ) {
-               yaout[0] ^= bswap_64( akey[0] );
-               for( i = 0; i < size; i++ ) ((ak_uint8 *)yaout)[7-i] ^= ((ak_uint8 *)inptr)[size-1-i];
-            }
-              else {
-               yaout[0] ^= akey[0];
-               for( i = 0; i < size; i++ ) ((ak_uint8 *)yaout)[i] ^= ((ak_uint8 *)inptr)[i];
-              }
-            bkey->encrypt( &bkey->key, yaout, akey );
-          break;
-
-   case 16 :
-          /* вырабатываем ключи для завершения алгортма */
-            bkey->encrypt( &bkey->key, akey, akey );
-            if( oc ) {
-              ak_uint64 tmp = bswap_64( akey[0] );
-              akey[0] = bswap_64( akey[1] );
-              akey[1] = tmp;
-            }
-            ak_gf128_mul( akey, akey, one64 );
-            if( size < bkey->bsize ) {
-              ak_gf128_mul( akey, akey, one64 );
-              ((ak_uint8 *)akey)[size] ^= 0x80;
-            }
-
-          /* теперь шифруем последний блок*/
-            if( oc ) {
-               yaout[0] ^= bswap_64( akey[1] );
-               yaout[1] ^= bswap_64( akey[0] );
-               for( i = 0; i < size; i++ ) ((ak_uint8 *)yaout)[15-i] ^= ((ak_uint8 *)inptr)[size-1-i];
-            }
-             else {
-              yaout[0] ^= akey[0];
-              yaout[1] ^= akey[1];
-              for( i = 0; i < size; i++ ) ((ak_uint8 *)yaout)[i] ^= ((ak_uint8 *)inptr)[i];
-             }
-            bkey->encrypt( &bkey->key, yaout, akey );
-          break;
-  }
+ /* шифруем последний блок и копируем нужную часть результирующего массива */
+  ak_bckey_cmac_last_block( bkey, oc, ( ak_uint64 * )bkey->ivector, in, size, akey );
+  ak_bckey_cmac_copy_result( bkey, oc, akey, out, out_size );
 
- /* копируем нужную часть результирующего массива и завершаем работу */
- if( oc ) memcpy( out, (ak_uint8 *)akey, ak_min( out_size, bkey->bsize ));
-  else memcpy( out, (ak_uint8 *)akey+( out_size > bkey->bsize ? 0 : bkey->bsize-out_size ),
-                                                                  ak_min( out_size, bkey->bsize ));
  return ak_error_ok;
-
 }
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -379,9 +497,10 @@
 
     Ситуация, при которой оба указателя на ключ принимают значение `NULL` воспринимается как ошибка.
 
-    \note В настоящий момент использована наиболее простая реализация алгоритма,
-    предполагающая что ассоциированные данные и шифруемые данные находятся в памяти последовательно.
-    Если это допущение невыполнено, то результат работы функции может быть непредсказуемым.
+    Функция реализована с помощью контекста потокового шифрования (см. функцию
+    ak_bckey_ctr_cmac_stream_clean()), поэтому данные зашифровываются и аутентифицируются
+    за один проход, а ассоциированные и шифруемые данные могут располагаться в памяти
+    произвольным образом.
 
     @param encryptionKey ключ шифрования (указатель на struct bckey), должен быть инициализирован
            перед вызовом функции; может принимать значение `NULL`;
@@ -411,39 +530,18 @@
                                      const size_t size, const ak_pointer iv, const size_t iv_size,
                                                          ak_pointer icode, const size_t icode_size )
 {
-  size_t sizeptr = 0;
-  ak_pointer ptr = NULL;
   int error = ak_error_ok;
+  struct aead_stream ctx;
 
- /* проверки ключей */
-  if(( encryptionKey == NULL ) && ( authenticationKey == NULL ))
-    return ak_error_message( ak_error_null_pointer, __func__ ,
-                                "using null pointers both to encryption and authentication keys" );
-  if(( encryptionKey != NULL ) && ( authenticationKey ) != NULL ) {
-    if( ((ak_bckey)encryptionKey)->bsize != ((ak_bckey)authenticationKey)->bsize )
-      return ak_error_message( ak_error_wrong_length, __func__,
-                                                           "different block sizes for given keys");
-  }
-  if(( adata != NULL ) && ( adata_size != 0 )) {
-    /* проверяем, что данные расположены в памяти последовательно */
-     if( ((ak_uint8*)adata)+adata_size != (ak_uint8 *)in )
-       return ak_error_message( ak_error_linked_data, __func__,
-                                          "this function can't be applied to non sequenced data" );
-     ptr = adata;
-     sizeptr = adata_size + size;
-  } else {
-      ptr = iv;
-      sizeptr = size;
-    }
+  if(( error = ak_bckey_ctr_cmac_stream_clean( &ctx,
+                                encryptionKey, authenticationKey, iv, iv_size )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect initialization of stream context" );
 
-  if( authenticationKey != NULL ) {
-    if(( error =
-             ak_bckey_cmac( authenticationKey, ptr, sizeptr, icode, icode_size )) != ak_error_ok )
-     return ak_error_message( error, __func__, "incorrect data encryption" );
-  }
-  if( encryptionKey != NULL ) {
-    if(( error = ak_bckey_ctr( encryptionKey, in, out, size, iv, iv_size )) != ak_error_ok )
-     return ak_error_message( error, __func__, "incorrect data encryption" );
+  if((( error = ak_aead_stream_authenticate( &ctx, adata, adata_size )) != ak_error_ok ) ||
+     (( error = ak_aead_stream_encrypt( &ctx, in, out, size )) != ak_error_ok ) ||
+     (( error = ak_aead_stream_finalize( &ctx, icode, icode_size )) != ak_error_ok )) {
+    memset( &ctx, 0, sizeof( struct aead_stream ));
+    return ak_error_message( error, __func__, "incorrect data encryption" );
   }
  return ak_error_ok;
 }
@@ -482,50 +580,61 @@
                                      const size_t size, const ak_pointer iv, const size_t iv_size,
                                                          ak_pointer icode, const size_t icode_size )
 {
-  size_t sizeptr = 0;
-  ak_pointer ptr = NULL;
+  ak_uint8 icode2[32];
   int error = ak_error_ok;
+  struct aead_stream ctx;
 
- /* проверки ключей */
-  if(( encryptionKey == NULL ) && ( authenticationKey == NULL ))
-    return ak_error_message( ak_error_null_pointer, __func__ ,
-                                "using null pointers both to encryption and authentication keys" );
-  if(( encryptionKey != NULL ) && ( authenticationKey ) != NULL ) {
-    if( ((ak_bckey)encryptionKey)->bsize != ((ak_bckey)authenticationKey)->bsize )
-      return ak_error_message( ak_error_wrong_length, __func__,
-                                                           "different block sizes for given keys");
+  if(( authenticationKey != NULL ) && ( ((ak_bckey)authenticationKey)->bsize > icode_size ))
+    return ak_error_message( ak_error_wrong_length, __func__,
+                                                "using block cipher with very huge block length" );
+  if(( error = ak_bckey_ctr_cmac_stream_clean( &ctx,
+                                encryptionKey, authenticationKey, iv, iv_size )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect initialization of stream context" );
+
+  memset( icode2, 0, sizeof( icode2 ));
+  if((( error = ak_aead_stream_authenticate( &ctx, adata, adata_size )) != ak_error_ok ) ||
+     (( error = ak_aead_stream_decrypt( &ctx, in, out, size )) != ak_error_ok ) ||
+     (( error = ak_aead_stream_finalize( &ctx, icode2, icode_size )) != ak_error_ok )) {
+    memset( &ctx, 0, sizeof( struct aead_stream ));
+    return ak_error_message( error, __func__, "incorrect data decryption" );
   }
-  if(( adata != NULL ) && ( adata_size != 0 )) {
-    /* проверяем, что данные расположены в памяти последовательно */
-     if( ((ak_uint8*)adata)+adata_size != (ak_uint8 *)in )
-       return ak_error_message( ak_error_linked_data, __func__,
-                                          "this function can't be applied to non sequenced data" );
-     ptr = adata;
-     sizeptr = adata_size + size;
-  } else {
-      ptr = iv;
-      sizeptr = size;
-    }
+  if( authenticationKey == NULL ) return ak_error_ok;
+  if( ak_ptr_is_equal( icode, icode2, icode_size )) return ak_error_ok;
 
-  if( encryptionKey != NULL ) {
-    if(( error = ak_bckey_ctr( encryptionKey, in, out, size, iv, iv_size )) != ak_error_ok )
-     return ak_error_message( error, __func__, "incorrect data decryption" );
-  }
-  if( authenticationKey != NULL ) {
-    ak_uint8 icode2[32];
-    memset( icode2, 0, sizeof( icode2 ));
+ return ak_error_not_equal_data;
+}
 
-    if( ((ak_bckey)authenticationKey)->bsize > icode_size )
-      return ak_error_message( ak_error_wrong_length, __func__,
-                                                "using block cipher with very huge block length" );
-    if(( error =
-             ak_bckey_cmac( authenticationKey, ptr, sizeptr, icode2, icode_size )) != ak_error_ok )
-      return ak_error_message( error, __func__,
-                                             "incorrect calculation of data authentication code" );
-     if( ak_ptr_is_equal( icode, icode2, icode_size )) error = ak_error_ok;
-       else error = ak_error_not_equal_data;
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция сравнивает результаты вычисления имитовставки с заранее вычисленными
+    дополнительными ключами, без них, а также результат пакетной обработки сообщений.          */
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t ak_libakrypt_test_cmac_batch( ak_bckey key, ak_uint8 *data, const size_t size )
+{
+  size_t i = 0;
+  ak_pointer in[11], out[11];
+  size_t sizes[11];
+  ak_uint8 values[11][16], out1[16];
+
+  for( i = 0; i < 11; i++ ) {
+     in[i] = data + i;
+     sizes[i] = 1 + ( 7*i )%( size - i );
+     out[i] = values[i];
+  }
+  if( ak_bckey_cmac_batch( key, 11, in, sizes, out, key->bsize ) != ak_error_ok ) return ak_false;
+
+  for( i = 0; i < 11; i++ ) {
+    /* вычисляем имитовставку без использования заранее вычисленных ключей */
+     key->key.flags &= ~ak_key_flag_cmac_subkeys;
+     ak_bckey_cmac( key, in[i], sizes[i], out1, key->bsize );
+     key->key.flags |= ak_key_flag_cmac_subkeys;
+     if( ak_ptr_is_equal_with_log( out1, values[i], key->bsize ) != ak_true ) {
+       ak_error_message_fmt( ak_error_not_equal_data, __func__,
+                 "different values of batch authentication codes (message length: %u)",
+                                                                       (unsigned int) sizes[i] );
+       return ak_false;
+     }
   }
- return error;
+ return ak_true;
 }
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -572,6 +681,7 @@
     }
     blocks--;
   }
+  if( ak_libakrypt_test_cmac_batch( &key, data, sizeof( data )) != ak_true ) result = ak_false;
 
   labm: ak_bckey_destroy( &key );
   if( result != ak_true ) {
@@ -609,6 +719,8 @@
     }
     blocks--;
   }
+  if( ak_libakrypt_test_cmac_batch( &key, data, sizeof( data )) != ak_true ) result = ak_false;
+
   labk: ak_bckey_destroy( &key );
   if( result != ak_true ) {
     ak_error_message( ak_error_ok, __func__,
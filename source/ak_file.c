@@ -268,6 +268,8 @@
 
  /* заполняем данные */
   file->size = ( ak_int64 )st.st_size;
+  file->addr = NULL;
+  file->mapsize = 0;
  #ifdef AK_HAVE_WINDOWS_H
   if(( file->hFile = CreateFile( filename,   /* name of the write */
                      GENERIC_READ,           /* open for reading */
@@ -308,6 +310,8 @@
     return ak_error_message( ak_error_null_pointer, __func__, "using null pointer" );
 
   file->size = 0;
+  file->addr = NULL;
+  file->mapsize = 0;
  #ifdef AK_HAVE_WINDOWS_H
   if(( file->hFile = CreateFile( filename,   /* name of the write */
                      GENERIC_WRITE,          /* open for writing */
@@ -364,6 +368,38 @@
  #endif
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция устанавливает текущую позицию чтения/записи файла, отсчитываемую от его начала.
+    Функция позволяет реализовать произвольный доступ к содержимому больших файлов
+    без их полного считывания.
+
+    @param file Дескриптор ранее открытого файла.
+    @param offset Смещение (в октетах) от начала файла; значение должно быть неотрицательным.
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль), в противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_file_seek( ak_file file, ak_int64 offset )
+{
+ #ifdef AK_HAVE_WINDOWS_H
+  LARGE_INTEGER distance;
+ #endif
+
+  if( file == NULL ) return ak_error_message( ak_error_null_pointer, __func__, "using null pointer" );
+  if( offset < 0 ) return ak_error_message( ak_error_wrong_length, __func__,
+                                                                   "using negative file offset" );
+ #ifdef AK_HAVE_WINDOWS_H
+  distance.QuadPart = offset;
+  if( SetFilePointerEx( file->hFile, distance, NULL, FILE_BEGIN ) == FALSE )
+    return ak_error_message( ak_error_access_file, __func__, "unable to set file position" );
+ #else
+  if( lseek( file->fd, ( off_t )offset, SEEK_SET ) == ( off_t )-1 )
+    return ak_error_message_fmt( ak_error_access_file, __func__,
+                                          "unable to set file position [%s]", strerror( errno ));
+ #endif
+
+ return ak_error_ok;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
  ssize_t ak_file_write( ak_file file, ak_const_pointer buffer, size_t size )
 {
@@ -413,19 +449,108 @@
 
 /* ----------------------------------------------------------------------------------------------- */
                    /* Отображение файлов в память (обертка вокруг mmap) */
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция отображает в память содержимое файла, начиная с заданного смещения и до конца файла.
+    Если указатель `filename` отличен от `NULL`, то файл предварительно открывается
+    (в режиме, определяемом параметром `state`); в противном случае используется
+    ранее открытый файл. Изменения содержимого памяти, отображенной в режиме `readonly`,
+    в файл не записываются.
+
+    Отображенная память должна быть освобождена вызовом функции ak_file_unmap(),
+    которая также закрывает файл.
+
+    @param file Дескриптор файла.
+    @param filename Имя открываемого файла или `NULL`.
+    @param state Режим доступа к отображаемой памяти.
+    @param offset Смещение (в октетах) от начала файла; значение должно быть меньше размера файла.
+    @return В случае успеха функция возвращает указатель на область памяти, содержащую
+    данные файла, начиная с заданного смещения. В случае ошибки возвращается `NULL`,
+    код ошибки может быть получен с помощью вызова функции ak_error_get_value().                   */
 /* ----------------------------------------------------------------------------------------------- */
  ak_pointer ak_file_mmap( ak_file file, const char *filename,
                                                      const filestate_t state, const size_t offset )
 {
- /* в ситуациях, когда mmap не определена, сразу выходим */
-#ifndef AK_HAVE_WINDOWS_H
- #ifndef AK_HAVE_SYSMMAN_H
-   return ak_error_undefined_function;
- #endif
-#endif
+#if defined( AK_HAVE_SYSMMAN_H ) && !defined( AK_HAVE_WINDOWS_H )
+  struct stat st;
+  size_t page = 0, start = 0;
+  int error = ak_error_ok;
+
+  if( file == NULL ) {
+    ak_error_message( ak_error_null_pointer, __func__, "using null pointer to file context" );
+    return NULL;
+  }
+  if( filename != NULL ) {
+    if( state == readonly ) error = ak_file_open_to_read( file, filename );
+     else {
+       if(( file->fd = open( filename, O_RDWR )) < 0 ) error = ak_error_open_file;
+        else {
+          if( fstat( file->fd, &st )) {
+            close( file->fd );
+            error = ak_error_access_file;
+          }
+           else {
+             file->size = ( ak_int64 )st.st_size;
+             file->blksize = ( ak_int64 )st.st_blksize;
+           }
+        }
+     }
+    if( error != ak_error_ok ) {
+      ak_error_message_fmt( error, __func__, "wrong opening a file %s", filename );
+      return NULL;
+    }
+  }
+  if(( file->size <= 0 ) || ( offset >= ( size_t )file->size )) {
+    ak_error_message( ak_error_wrong_length, __func__, "using offset outside of the file" );
+    goto labex;
+  }
+
+ /* смещение отображаемой области должно быть кратно размеру страницы */
+  if(( page = ( size_t )sysconf( _SC_PAGESIZE )) == 0 ) page = 4096;
+  start = offset - offset%page;
+  file->mapsize = ( size_t )file->size - start;
+  file->addr = mmap( NULL, file->mapsize, state == readonly ? PROT_READ : PROT_READ | PROT_WRITE,
+                           state == readonly ? MAP_PRIVATE : MAP_SHARED, file->fd, ( off_t )start );
+  if( file->addr == MAP_FAILED ) {
+    ak_error_message_fmt( ak_error_access_file, __func__,
+                                                  "wrong mapping a file [%s]", strerror( errno ));
+    file->addr = NULL;
+    file->mapsize = 0;
+    goto labex;
+  }
+ return ( ak_uint8 *)file->addr + ( offset - start );
 
- ak_error_message( ak_error_undefined_function, __func__, "this function is'nt well developed" );
+ labex:
+  if( filename != NULL ) ak_file_close( file );
  return NULL;
+
+#else
+  ( void )file; ( void )filename; ( void )state; ( void )offset;
+  ak_error_message( ak_error_undefined_function, __func__,
+                                               "memory mapping is not supported on this platform" );
+ return NULL;
+#endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param file Дескриптор файла, отображенного в память функцией ak_file_mmap().
+    @param ptr Указатель, возвращенный функцией ak_file_mmap().
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль), в противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_file_unmap( ak_file file, ak_pointer ptr )
+{
+  if(( file == NULL ) || ( ptr == NULL )) return ak_error_message( ak_error_null_pointer,
+                                                                   __func__, "using null pointer" );
+#if defined( AK_HAVE_SYSMMAN_H ) && !defined( AK_HAVE_WINDOWS_H )
+  if( file->addr != NULL ) {
+    if( munmap( file->addr, file->mapsize ) != 0 )
+      ak_error_message_fmt( ak_error_access_file, __func__,
+                                                "wrong unmapping a file [%s]", strerror( errno ));
+    file->addr = NULL;
+    file->mapsize = 0;
+  }
+#endif
+ return ak_file_close( file );
 }
 
 /* ----------------------------------------------------------------------------------------------- */
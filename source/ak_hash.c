@@ -1332,6 +1332,9 @@
   int error = ak_error_ok;
   if( hctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                             "using null pointer to hash context" );
+  if( !ak_libakrypt_control_test_on_first_use( hash_control_test ))
+    return ak_error_message( ak_error_control_test, __func__,
+                                                "incorrect dynamic control of hash functions" );
   hctx->data.sctx.hsize = 32;
   if(( hctx->oid = ak_oid_find_by_name( "streebog256" )) == NULL )
     return ak_error_message( ak_error_wrong_oid, __func__,
@@ -1357,6 +1360,9 @@
   int error = ak_error_ok;
   if( hctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                             "using null pointer to hash context" );
+  if( !ak_libakrypt_control_test_on_first_use( hash_control_test ))
+    return ak_error_message( ak_error_control_test, __func__,
+                                                "incorrect dynamic control of hash functions" );
   hctx->data.sctx.hsize = 64;
   if(( hctx->oid = ak_oid_find_by_name( "streebog512" )) == NULL )
     return ak_error_message( ak_error_wrong_oid, __func__,
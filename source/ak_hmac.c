@@ -187,6 +187,10 @@
  /* проверяем, что OID от алгоритма, а не от параметров */
   if( oid->mode != algorithm )
     return ak_error_message( ak_error_oid_mode, __func__ , "using oid with wrong mode" );
+ /* при необходимости выполняем динамический контроль алгоритмов выработки имитовставки */
+  if( !ak_libakrypt_control_test_on_first_use( mac_control_test ))
+    return ak_error_message( ak_error_control_test, __func__,
+                                                  "incorrect dynamic control of mac functions" );
 
  /* получаем oid бесключевой функции хеширования */
   if(( hashoid = ak_oid_find_by_name( oid->name[0]+5 )) == NULL )
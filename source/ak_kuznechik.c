@@ -116,6 +116,13 @@
 /* ---------------------------------------------------------------------------------------------- */
  static struct kuznechik_params kuznechik_parameters;
 
+/*! \brief Произведения элементов поля на коэффициенты линейного регистра сдвига;
+    используются для ускорения линейного преобразования при развертке ключа. */
+ static ak_uint8 kuznechik_reg_products[16][256];
+
+/*! \brief Константы, используемые в процедуре развертки ключа. */
+ static ak_uint64 kuznechik_constants[32][2];
+
 /* ---------------------------------------------------------------------------------------------- */
 /*! \brief Функция умножает два элемента конечного поля \f$\mathbb F_{2^8}\f$, определенного
      согласно ГОСТ Р 34.12-2015.                                                                  */
@@ -131,19 +138,6 @@
  return z;
 }
 
-/* ----------------------------------------------------------------------------------------------- */
-/*! \brief Функция умножает вектор w на матрицу D, результат помещается в вектор x.                */
-/* ----------------------------------------------------------------------------------------------- */
- static void ak_kuznechik_matrix_mul_vector( linear_matrix D, ak_uint8 *w, ak_uint8* x )
-{
-  int i = 0, j = 0;
-  for( i = 0; i < 16; i++ ) {
-    ak_uint8 z = ak_bckey_context_kuznechik_mul_gf256( D[i][0], w[0] );
-    for( j = 1; j < 16; j++ ) z ^= ak_bckey_context_kuznechik_mul_gf256( D[i][j], w[j] );
-    x[i] = z;
-  }
-}
-
 /* ---------------------------------------------------------------------------------------------- */
 /*! \brief Функция возводит квадратную матрицу в квадрат. */
 /* ---------------------------------------------------------------------------------------------- */
@@ -175,12 +169,43 @@
      ak_uint8 z = w[0];
      for( i = 1; i < 16; i++ ) {
         w[i-1] = w[i];
-        z ^= ak_bckey_context_kuznechik_mul_gf256( w[i], kuznechik_parameters.reg[i] );
+        z ^= kuznechik_reg_products[i][w[i]];
      }
      w[15] = z;
   }
 }
 
+/* ---------------------------------------------------------------------------------------------- */
+/*! \brief Функция вычисляет значение L( S( w )) или, если задан флаг `inverse`, значение
+    L^{-1}( w ) с помощью развернутых таблиц алгоритма шифрования.
+
+    Вектор w задается в каноническом (используемом при развертке ключа) представлении.
+    Поскольку в режиме совместимости с openssl таблицы хранят перевернутые векторы, результат
+    в этом случае переворачивается обратно.                                                       */
+/* ---------------------------------------------------------------------------------------------- */
+ static inline void ak_kuznechik_table_steps( ak_uint64 *w, const bool_t inverse,
+                                                                              const ak_int64 oc )
+{
+  int i = 0;
+  ak_uint64 x0 = 0, x1 = 0;
+  ak_uint8 *b = (ak_uint8 *)w;
+
+  if( inverse ) {
+   /* поскольку dec[i][j] = Linv_i * pinv[j], то Linv( w ) = \sum dec[i][pi[w_i]] */
+    for( i = 0; i < 16; i++ ) {
+       const ak_uint64 *v = kuznechik_parameters.dec[i][kuznechik_parameters.pi[b[i]]];
+       x0 ^= v[0]; x1 ^= v[1];
+    }
+  } else {
+      for( i = 0; i < 16; i++ ) {
+         const ak_uint64 *v = kuznechik_parameters.enc[i][b[i]];
+         x0 ^= v[0]; x1 ^= v[1];
+      }
+    }
+  if( oc ) { w[0] = bswap_64( x1 ); w[1] = bswap_64( x0 ); }
+    else { w[0] = x0; w[1] = x1; }
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Для заданного линейного регистра сдвига, задаваемого набором коэффициентов `reg`,
     функция вычисляет 16-ю степень сопровождающей матрицы.
@@ -261,12 +286,28 @@
 /* ----------------------------------------------------------------------------------------------- */
  int ak_bckey_kuznechik_init_gost_tables( void )
 {
-  int audit = ak_log_get_level(),
+  int i = 0, j = 0, audit = ak_log_get_level(),
       error = ak_bckey_kuznechik_init_tables( gost_lvec, gost_pi, &kuznechik_parameters );
 
   if( error != ak_error_ok )
     return ak_error_message( error, __func__,
                                            "generation of GOST R 34.12-2015 parameters is wrong" );
+
+ /* вырабатываем таблицы, используемые при развертке ключа:
+    сначала произведения на коэффициенты линейного регистра, потом константы C_i = L( i ) */
+  for( i = 0; i < 16; i++ )
+     for( j = 0; j < 256; j++ )
+        kuznechik_reg_products[i][j] =
+               ak_bckey_context_kuznechik_mul_gf256( (ak_uint8) j, kuznechik_parameters.reg[i] );
+  for( i = 0; i < 32; i++ ) {
+    #ifdef AK_LITTLE_ENDIAN
+     kuznechik_constants[i][0] = (ak_uint64)( i+1 );
+    #else
+     kuznechik_constants[i][0] = bswap_64( (ak_uint64)( i+1 ));
+    #endif
+     kuznechik_constants[i][1] = 0;
+     ak_kuznechik_linear_steps(( ak_uint8 *)kuznechik_constants[i] );
+  }
   if( audit >= ak_log_maximum ) return ak_error_message( ak_error_ok, __func__ ,
                                               "generation of GOST R 34.12-2015 parameters is Ok" );
  return ak_error_ok;
@@ -295,7 +336,7 @@
       ak_error_message( error, __func__, "incorrect wiping an internal data" );
       memset( skey->data, 0, sizeof( ak_kuznechik_expanded_keys ));
     }
-    free( skey->data );
+    ak_skey_pool_free( skey->data );
     skey->data = NULL;
   }
  return error;
@@ -311,8 +352,8 @@
  static int ak_kuznechik_schedule_keys( ak_skey skey )
 {
   ak_uint8 reverse[64];
-  int i = 0, j = 0, l = 0, kdx = 2;
-  ak_uint64 a0[2], a1[2], c[2], t[2], idx = 0;
+  int i = 0, j = 0, kdx = 2;
+  ak_uint64 a0[2], a1[2], t[2], idx = 0;
   ak_int64 oc = ak_libakrypt_get_option_by_name( "openssl_compability" );
   ak_uint64 *ekey = NULL, *mkey = NULL, *dkey = NULL, *xkey = NULL, *rkey = NULL, *lkey = NULL;
 
@@ -324,12 +365,11 @@
  /* проверяем целостность ключа */
   if( skey->check_icode( skey ) != ak_true ) return ak_error_message( ak_error_wrong_key_icode,
                                                 __func__ , "using key with wrong integrity code" );
- /* удаляем былое */
-  if( skey->data != NULL ) ak_kuznechik_delete_keys( skey );
-
- /* далее, по-возможности, выделяем выравненную память */
-  if(( skey->data = ak_aligned_malloc( sizeof( ak_kuznechik_expanded_keys ))) == NULL )
-    return ak_error_message( ak_error_out_of_memory, __func__ ,
+ /* память выделяется только при первой развертке; при смене значения ключа
+    (например, в режимах ACPKM) раундовые ключи и маски перезаписываются на месте */
+  if( skey->data == NULL )
+    if(( skey->data = ak_skey_alloc_data( skey, sizeof( ak_kuznechik_expanded_keys ))) == NULL )
+      return ak_error_message( ak_error_out_of_memory, __func__ ,
                                                              "wrong allocation of internal data" );
  /* получаем указатели на области памяти */
   ekey = ( ak_uint64 *)skey->data;                  /* 10 прямых раундовых ключей */
@@ -359,23 +399,16 @@
   dkey[0] = a1[0]^xkey[0]; dkey[1] = a1[1]^xkey[1];
 
   ekey[2] = a0[0]^mkey[2]; ekey[3] = a0[1]^mkey[3];
-  ak_kuznechik_matrix_mul_vector( kuznechik_parameters.Linv,
-                                            (ak_uint8 *)a0, (ak_uint8 *)( dkey+2 ));
+  dkey[2] = a0[0]; dkey[3] = a0[1];
+  ak_kuznechik_table_steps( dkey+2, ak_true, oc );
   dkey[2] ^= xkey[2]; dkey[3] ^= xkey[3];
 
   for( j = 0; j < 4; j++ ) {
      for( i = 0; i < 8; i++ ) {
-      #ifdef AK_LITTLE_ENDIAN
-        c[0] = ++idx; /* вычисляем константу алгоритма согласно ГОСТ Р 34.12-2015 */
-      #else
-        c[0] = bswap_64( ++idx );
-      #endif
-        c[1] = 0;
-        ak_kuznechik_linear_steps(( ak_uint8 *)c );
-
-        t[0] = a1[0] ^ c[0]; t[1] = a1[1] ^ c[1];
-        for( l = 0; l < 16; l++ ) ((ak_uint8 *)t)[l] = kuznechik_parameters.pi[ ((ak_uint8 *)t)[l]];
-        ak_kuznechik_linear_steps(( ak_uint8 *)t );
+       /* константа алгоритма согласно ГОСТ Р 34.12-2015 вычислена заранее */
+        t[0] = a1[0] ^ kuznechik_constants[idx][0]; t[1] = a1[1] ^ kuznechik_constants[idx][1];
+        idx++;
+        ak_kuznechik_table_steps( t, ak_false, oc );
 
         t[0] ^= a0[0]; t[1] ^= a0[1];
         a0[0] = a1[0]; a0[1] = a1[1];
@@ -383,14 +416,14 @@
      }
      kdx += 2;
      ekey[kdx] = a1[0]^mkey[kdx]; ekey[kdx+1] = a1[1]^mkey[kdx+1];
-     ak_kuznechik_matrix_mul_vector( kuznechik_parameters.Linv,
-                                         ( ak_uint8 *)a1, (ak_uint8 *)( dkey+kdx ));
+     dkey[kdx] = a1[0]; dkey[kdx+1] = a1[1];
+     ak_kuznechik_table_steps( dkey+kdx, ak_true, oc );
      dkey[kdx] ^= xkey[kdx]; dkey[kdx+1] ^= xkey[kdx+1];
 
      kdx += 2;
      ekey[kdx] = a0[0]^mkey[kdx]; ekey[kdx+1] = a0[1]^mkey[kdx+1];
-     ak_kuznechik_matrix_mul_vector( kuznechik_parameters.Linv,
-                                         ( ak_uint8 *)a0, (ak_uint8 *)( dkey+kdx ));
+     dkey[kdx] = a0[0]; dkey[kdx+1] = a0[1];
+     ak_kuznechik_table_steps( dkey+kdx, ak_true, oc );
      dkey[kdx] ^= xkey[kdx]; dkey[kdx+1] ^= xkey[kdx+1];
   }
 
@@ -670,6 +703,118 @@
   (( ak_uint64 *) out)[1] = x[1] ^ xkey[1];
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Количество блоков, обрабатываемых одновременно функциями зашифрования/расшифрования
+    нескольких блоков. */
+ #define ak_kuznechik_blocks_batch (4)
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция зашифровывает ak_kuznechik_blocks_batch последовательно расположенных блоков.
+    \details Раунды для всех блоков группы выполняются одновременно, что позволяет процессору
+    совмещать обращения к таблицам для независимых блоков.
+    Флаг `oc` определяет порядок следования октетов (режим совместимости с openssl).              */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_kuznechik_encrypt_batch( ak_skey skey,
+                                       const ak_uint64 *in, ak_uint64 *out, const bool_t oc )
+{
+  int i = 0, j = 0, k = 0;
+  ak_uint64 *ekey = ( ak_uint64 *)skey->data;
+  ak_uint64 *mkey = ( ak_uint64 *)skey->data + 40;
+  ak_uint64 t[ak_kuznechik_blocks_batch], s[ak_kuznechik_blocks_batch],
+                                                                   x[ak_kuznechik_blocks_batch][2];
+
+  for( k = 0; k < ak_kuznechik_blocks_batch; k++ ) { x[k][0] = in[2*k]; x[k][1] = in[2*k+1]; }
+  for( i = 0; i < 18; i += 2 ) {
+     for( k = 0; k < ak_kuznechik_blocks_batch; k++ ) {
+        ak_uint8 *b = ( ak_uint8 *)x[k];
+        x[k][0] ^= ekey[i]; x[k][0] ^= mkey[i];
+        x[k][1] ^= ekey[i+1]; x[k][1] ^= mkey[i+1];
+
+        t[k] = s[k] = 0;
+        for( j = 0; j < 16; j++ ) {
+           const ak_uint64 *v = kuznechik_parameters.enc[j][b[oc ? 15-j : j]];
+           t[k] ^= v[0]; s[k] ^= v[1];
+        }
+     }
+     for( k = 0; k < ak_kuznechik_blocks_batch; k++ ) { x[k][0] = t[k]; x[k][1] = s[k]; }
+  }
+  for( k = 0; k < ak_kuznechik_blocks_batch; k++ ) {
+     x[k][0] ^= ekey[18]; x[k][1] ^= ekey[19];
+     out[2*k] = x[k][0] ^ mkey[18];
+     out[2*k+1] = x[k][1] ^ mkey[19];
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция расшифровывает ak_kuznechik_blocks_batch последовательно расположенных блоков. */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_kuznechik_decrypt_batch( ak_skey skey,
+                                       const ak_uint64 *in, ak_uint64 *out, const bool_t oc )
+{
+  int i = 0, j = 0, k = 0;
+  ak_uint64 *dkey = ( ak_uint64 *)skey->data + 20;
+  ak_uint64 *xkey = ( ak_uint64 *)skey->data + 60;
+  ak_uint64 t[ak_kuznechik_blocks_batch], s[ak_kuznechik_blocks_batch],
+                                                                   x[ak_kuznechik_blocks_batch][2];
+
+  for( k = 0; k < ak_kuznechik_blocks_batch; k++ ) {
+     ak_uint8 *b = ( ak_uint8 *)x[k];
+     x[k][0] = in[2*k]; x[k][1] = in[2*k+1];
+     for( j = 0; j < 16; j++ ) b[j] = kuznechik_parameters.pi[b[j]];
+  }
+  for( i = 19; i > 1; i -= 2 ) {
+     for( k = 0; k < ak_kuznechik_blocks_batch; k++ ) {
+        ak_uint8 *b = ( ak_uint8 *)x[k];
+        t[k] = s[k] = 0;
+        for( j = 0; j < 16; j++ ) {
+           const ak_uint64 *v = kuznechik_parameters.dec[j][b[oc ? 15-j : j]];
+           t[k] ^= v[0]; s[k] ^= v[1];
+        }
+     }
+     for( k = 0; k < ak_kuznechik_blocks_batch; k++ ) {
+        x[k][0] = t[k]; x[k][1] = s[k];
+        x[k][1] ^= dkey[i]; x[k][1] ^= xkey[i];
+        x[k][0] ^= dkey[i-1]; x[k][0] ^= xkey[i-1];
+     }
+  }
+  for( k = 0; k < ak_kuznechik_blocks_batch; k++ ) {
+     ak_uint8 *b = ( ak_uint8 *)x[k];
+     for( j = 0; j < 16; j++ ) b[j] = kuznechik_parameters.pinv[b[j]];
+     x[k][0] ^= dkey[0]; x[k][1] ^= dkey[1];
+     out[2*k] = x[k][0] ^ xkey[0];
+     out[2*k+1] = x[k][1] ^ xkey[1];
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Макрос определяет функцию преобразования нескольких последовательно
+    расположенных блоков: полные группы блоков обрабатываются одновременно,
+    оставшиеся блоки - функцией преобразования одного блока.                                      */
+/* ----------------------------------------------------------------------------------------------- */
+ #define ak_kuznechik_define_blocks_function( name, batch, single, oc ) \
+ static void name( ak_skey skey, ak_pointer in, ak_pointer out, size_t blocks ) \
+{ \
+  ak_uint64 *inptr = ( ak_uint64 *)in, *outptr = ( ak_uint64 *)out; \
+ \
+  for( ; blocks >= ak_kuznechik_blocks_batch; blocks -= ak_kuznechik_blocks_batch ) { \
+     batch( skey, inptr, outptr, oc ); \
+     inptr += 2*ak_kuznechik_blocks_batch; outptr += 2*ak_kuznechik_blocks_batch; \
+  } \
+  for( ; blocks > 0; blocks-- ) { \
+     single( skey, inptr, outptr ); \
+     inptr += 2; outptr += 2; \
+  } \
+}
+
+ ak_kuznechik_define_blocks_function( ak_kuznechik_encrypt_blocks,
+                                ak_kuznechik_encrypt_batch, ak_kuznechik_encrypt_with_mask, ak_false )
+ ak_kuznechik_define_blocks_function( ak_kuznechik_decrypt_blocks,
+                                ak_kuznechik_decrypt_batch, ak_kuznechik_decrypt_with_mask, ak_false )
+ ak_kuznechik_define_blocks_function( ak_kuznechik_encrypt_blocks_oc,
+                              ak_kuznechik_encrypt_batch, ak_kuznechik_encrypt_with_mask_oc, ak_true )
+ ak_kuznechik_define_blocks_function( ak_kuznechik_decrypt_blocks_oc,
+                              ak_kuznechik_decrypt_batch, ak_kuznechik_decrypt_with_mask_oc, ak_true )
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! После инициализации устанавливаются обработчики (функции класса). Однако само значение
     ключу не присваивается - поле `bkey->key` остается неопределенным.
@@ -706,10 +851,14 @@
   if( oc ) {
     bkey->encrypt = ak_kuznechik_encrypt_with_mask_oc;
     bkey->decrypt = ak_kuznechik_decrypt_with_mask_oc;
+    bkey->encrypt_blocks = ak_kuznechik_encrypt_blocks_oc;
+    bkey->decrypt_blocks = ak_kuznechik_decrypt_blocks_oc;
   }
    else {
     bkey->encrypt = ak_kuznechik_encrypt_with_mask;
     bkey->decrypt = ak_kuznechik_decrypt_with_mask;
+    bkey->encrypt_blocks = ak_kuznechik_encrypt_blocks;
+    bkey->decrypt_blocks = ak_kuznechik_decrypt_blocks;
   }
  return error;
 }
@@ -4,6 +4,10 @@
 /*  Файл ak_libakrypt.с                                                                            */
 /*  - содержит реализацию функций инициализации и тестирования библиотеки.                         */
 /* ----------------------------------------------------------------------------------------------- */
+/* функция dl_iterate_phdr() объявляется только при определенном макросе _GNU_SOURCE */
+#ifndef _GNU_SOURCE
+ #define _GNU_SOURCE
+#endif
 #ifdef AK_HAVE_PTHREAD_H
  #include <pthread.h>
 #endif
@@ -16,6 +20,9 @@
 
 /* ----------------------------------------------------------------------------------------------- */
  #include <libakrypt-internal.h>
+#ifdef AK_HAVE_LINK_H
+ #include <link.h>
+#endif
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Функция проверяет корректность определения базовых типов данных
@@ -82,6 +89,13 @@
   #ifdef AK_HAVE_BUILTIN_MULQ_GCC
    ak_error_message( ak_error_ok, __func__ , "library applies assembler code for mulq command" );
   #endif
+  #ifdef AK_HAVE_BUILTIN_MM256_SHUFFLE_EPI8
+   ak_error_message( ak_error_ok, __func__ , "library applies avx2 instructions for base64 codec" );
+  #else
+   #ifdef AK_HAVE_BUILTIN_SHUFFLE_EPI8
+   ak_error_message( ak_error_ok, __func__ , "library applies ssse3 instructions for base64 codec" );
+   #endif
+  #endif
   #ifdef AK_HAVE_PTHREAD_H
    ak_error_message( ak_error_ok, __func__ , "library runs with pthreads support" );
   #endif
@@ -240,49 +254,383 @@
  return ak_true;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Состояние группы тестов динамического контроля. */
+ typedef enum {
+  /*! \brief Тестирование не проводилось. */
+   control_test_not_run,
+  /*! \brief Тестирование выполняется. */
+   control_test_running,
+  /*! \brief Тестирование завершено успешно. */
+   control_test_passed,
+  /*! \brief Тестирование завершено с ошибкой. */
+   control_test_failed
+ } control_test_state_t;
+
+/*! \brief Группы тестов динамического контроля, их состояния и время выполнения. */
+ static struct control_test {
+  /*! \brief Человекочитаемое имя группы тестов. */
+   const char *name;
+  /*! \brief Сообщение, выводимое в случае ошибки тестирования. */
+   const char *message;
+  /*! \brief Функция тестирования. */
+   bool_t ( *function )( void );
+  /*! \brief Текущее состояние группы тестов. */
+   volatile control_test_state_t state;
+  /*! \brief Время выполнения тестов (в секундах). */
+   double time;
+#ifdef AK_HAVE_PTHREAD_H
+  /*! \brief Поток, выполняющий тестирование (имеет смысл в состоянии control_test_running). */
+   pthread_t owner;
+#endif
+ } control_tests[control_tests_count] = {
+  { "gfn", "incorrect testing of multiplication in Galois fields",
+                                  ak_libakrypt_test_gfn_multiplication, control_test_not_run, 0 },
+  { "hash", "incorrect testing of hash functions",
+                                      ak_libakrypt_test_hash_functions, control_test_not_run, 0 },
+  { "block-ciphers", "error while testing block ciphers",
+                                        ak_libakrypt_test_block_ciphers, control_test_not_run, 0 },
+  { "mac", "incorrect testing of mac algorithms",
+                                       ak_libakrypt_test_mac_functions, control_test_not_run, 0 },
+  { "asymmetric", "error while testing digital signature mechanisms",
+                                ak_libakrypt_test_asymmetric_functions, control_test_not_run, 0 }
+ };
+
+#ifdef AK_HAVE_PTHREAD_H
+/*! \brief Мьютекс, защищающий состояния групп тестов. */
+ static pthread_mutex_t control_test_mutex = PTHREAD_MUTEX_INITIALIZER;
+/*! \brief Условная переменная, сигнализирующая о завершении выполнения группы тестов. */
+ static pthread_cond_t control_test_cond = PTHREAD_COND_INITIALIZER;
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция возвращает значение монотонного времени (в секундах).
+    \details Функция clock() возвращает процессорное время всего процесса, которое при
+    выполнении тестов в нескольких потоках не соответствует реальному времени тестирования.     */
+/* ----------------------------------------------------------------------------------------------- */
+ static double ak_libakrypt_monotonic_time( void )
+{
+#if defined(CLOCK_MONOTONIC)
+  struct timespec ts;
+  if( clock_gettime( CLOCK_MONOTONIC, &ts ) == 0 )
+    return ( double )ts.tv_sec + ( double )ts.tv_nsec*1e-9;
+#endif
+ return ( double )clock()/( double )CLOCKS_PER_SEC;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция выполняет заданную группу тестов и фиксирует время ее выполнения.
+
+    Если группа тестов уже выполняется тем же потоком (например, тестирование алгоритма
+    выработки имитовставки создает ключи блочного шифрования, что приводит к повторному
+    вызову функции), то функция сразу возвращает истину. Другие потоки ожидают завершения
+    тестирования и получают его результат. Тестирование производится без блокировки мьютекса,
+    поскольку тесты могут использовать потоки библиотеки; при этом функции тестирования
+    не должны создавать контексты алгоритмов своей группы в потоках пула.
+
+    \param group Группа тестов.
+    \param force Флаг принудительного повторного выполнения тестов.
+    \return Функция возвращает \ref ak_true в случае успешного тестирования.                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t ak_libakrypt_run_control_test( const control_test_group_t group, const bool_t force )
+{
+  double timea = 0;
+  bool_t result = ak_false, run = ak_false;
+  struct control_test *ct = control_tests + group;
+
+ #ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_lock( &control_test_mutex );
+  while(( ct->state == control_test_running ) && !pthread_equal( ct->owner, pthread_self( )))
+    pthread_cond_wait( &control_test_cond, &control_test_mutex );
+ #endif
+ /* состояние control_test_running здесь возможно только при рекурсивном вызове */
+  if(( ct->state == control_test_running ) ||
+                                 (( ct->state == control_test_passed ) && !force )) result = ak_true;
+   else
+    if(( ct->state != control_test_failed ) || force ) {
+      ct->state = control_test_running;
+     #ifdef AK_HAVE_PTHREAD_H
+      ct->owner = pthread_self();
+     #endif
+      run = ak_true;
+    }
+ #ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_unlock( &control_test_mutex );
+ #endif
+  if( result ) return ak_true;
+  if( !run ) return ak_false; /* тестирование ранее завершилось с ошибкой */
+
+  timea = ak_libakrypt_monotonic_time();
+  result = ct->function();
+ #ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_lock( &control_test_mutex );
+ #endif
+  ct->time = ak_libakrypt_monotonic_time() - timea;
+  ct->state = result ? control_test_passed : control_test_failed;
+ #ifdef AK_HAVE_PTHREAD_H
+  pthread_cond_broadcast( &control_test_cond );
+  pthread_mutex_unlock( &control_test_mutex );
+ #endif
+
+  if( !result ) ak_error_message( ak_error_get_value(), __func__ , ct->message );
+   else
+    if( ak_log_get_level() >= ak_log_maximum )
+      ak_error_message_fmt( ak_error_ok, __func__ ,
+                                   "testing of %s is Ok (%f sec)", ct->name, ct->time );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вызывается производящими функциями контекстов криптографических механизмов.
+    Если значение опции `dynamic_control_test` равно 1, то при первом вызове функции для
+    заданной группы выполняются тесты этой группы; результат запоминается и последующие
+    вызовы функции не приводят к повторному тестированию. При других значениях опции функция
+    проверяет только то, что ранее выполненное тестирование не завершилось ошибкой.
+
+    \param group Группа тестов, соответствующая используемому механизму.
+    \return Функция возвращает \ref ak_true, если механизм может быть использован.                */
+/* ----------------------------------------------------------------------------------------------- */
+ bool_t ak_libakrypt_control_test_on_first_use( const control_test_group_t group )
+{
+  if(( ak_uint32 )group >= control_tests_count ) return ak_false;
+  if( control_tests[group].state == control_test_passed ) return ak_true;
+  if( ak_libakrypt_get_option_by_name( "dynamic_control_test" ) != 1 )
+    return ( control_tests[group].state != control_test_failed );
+ return ak_libakrypt_run_control_test( group, ak_false );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \param group Группа тестов.
+    \return Функция возвращает константную строку с именем группы тестов.                         */
+/* ----------------------------------------------------------------------------------------------- */
+ const char *ak_libakrypt_get_control_test_name( const control_test_group_t group )
+{
+  if(( ak_uint32 )group >= control_tests_count ) {
+    ak_error_message( ak_error_wrong_index, __func__ , "using unexpected group of tests" );
+    return ak_null_string;
+  }
+ return control_tests[group].name;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \param group Группа тестов.
+    \param time Указатель, по которому помещается время выполнения тестов группы (в секундах).
+    Для результата, взятого из сохраненного ранее файла, время равно нулю. Может быть равен NULL.
+    \return Функция возвращает \ref ak_error_ok, если тесты группы выполнены успешно,
+    \ref ak_error_not_ready, если тестирование не проводилось, и \ref ak_error_control_test,
+    если тестирование завершилось с ошибкой.                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_libakrypt_get_control_test_result( const control_test_group_t group, double *time )
+{
+  if(( ak_uint32 )group >= control_tests_count )
+    return ak_error_message( ak_error_wrong_index, __func__ , "using unexpected group of tests" );
+  if( time != NULL ) *time = control_tests[group].time;
+  switch( control_tests[group].state ) {
+    case control_test_passed: return ak_error_ok;
+    case control_test_failed: return ak_error_control_test;
+    default: return ak_error_not_ready;
+  }
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция проверяет корректность работы всех криптографических механизмов библиотеки
     с использованием как значений, содержащихся в нормативных документах и стандартах,
-    так и с использованием случайных значений, вырабатываемых в ходе тестирования.                 */
+    так и с использованием случайных значений, вырабатываемых в ходе тестирования.
+    Время выполнения каждой группы тестов может быть получено с помощью функции
+    ak_libakrypt_get_control_test_result().                                                        */
 /* ----------------------------------------------------------------------------------------------- */
  bool_t ak_libakrypt_dynamic_control_test( void )
 {
+  size_t idx = 0;
   int audit = ak_log_get_level();
   if( audit >= ak_log_maximum ) ak_error_message( ak_error_ok, __func__ , "testing started" );
 
- /* тестируем арифметические операции в конечных полях */
-  if( ak_libakrypt_test_gfn_multiplication() != ak_true ) {
-    ak_error_message( ak_error_get_value(), __func__ ,
-                                          "incorrect testing of multiplication in Galois fields" );
-    return ak_false;
+  for( idx = 0; idx < control_tests_count; idx++ ) {
+     if( !ak_libakrypt_run_control_test(( control_test_group_t ) idx, ak_true )) {
+       ak_error_message( ak_error_get_value(), __func__ , "incorrect dynamic control test" );
+       return ak_false;
+     }
   }
 
- /* проверяем корректность реализации алгоритмов бесключевого хеширования */
-  if( ak_libakrypt_test_hash_functions( ) != ak_true ) {
-    ak_error_message( ak_error_get_value(), __func__ , "incorrect testing of hash functions" );
-    return ak_false;
+  if( audit >= ak_log_maximum ) ak_error_message( ak_error_ok, __func__ , "testing is Ok" );
+ return ak_true;
+}
+
+#ifdef AK_HAVE_LINK_H
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Идентификатор сборки образа, содержащего код библиотеки. */
+ typedef struct build_id {
+  /*! \brief адрес, принадлежащий образу библиотеки */
+   ak_uint8 *addr;
+  /*! \brief идентификатор сборки (значение NT_GNU_BUILD_ID или хеш-код исполняемого кода) */
+   ak_uint8 id[32];
+  /*! \brief длина идентификатора (в октетах) */
+   size_t size;
+ } *ak_build_id;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция ищет в образе, содержащем заданный адрес, идентификатор сборки.
+
+    Если компоновщик поместил в образ заметку NT_GNU_BUILD_ID, то ее значение используется
+    в качестве идентификатора. В противном случае вычисляется хеш-код (Стрибог256)
+    исполняемых сегментов образа.
+
+    \return Функция возвращает 1, если образ найден, и 0 в противном случае
+    (в этом случае перебор образов продолжается).                                                */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_libakrypt_build_id_callback( struct dl_phdr_info *info, size_t size, void *data )
+{
+  int i = 0;
+  struct hash ctx;
+  bool_t found = ak_false;
+  ak_build_id bid = ( ak_build_id ) data;
+
+  (void)size;
+  for( i = 0; i < info->dlpi_phnum; i++ ) {
+     const ak_uint8 *start = ( const ak_uint8 *)( info->dlpi_addr + info->dlpi_phdr[i].p_vaddr );
+     if(( info->dlpi_phdr[i].p_type == PT_LOAD ) && ( bid->addr >= start ) &&
+        ( bid->addr < start + info->dlpi_phdr[i].p_memsz )) found = ak_true;
+  }
+  if( !found ) return 0;
+
+ /* ищем заметку NT_GNU_BUILD_ID */
+  for( i = 0; i < info->dlpi_phnum; i++ ) {
+     const ak_uint8 *ptr = ( const ak_uint8 *)( info->dlpi_addr + info->dlpi_phdr[i].p_vaddr ),
+                                              *end = ptr + info->dlpi_phdr[i].p_memsz;
+     if( info->dlpi_phdr[i].p_type != PT_NOTE ) continue;
+     while( ptr + sizeof( ElfW(Nhdr)) <= end ) {
+       const ElfW(Nhdr) *note = ( const ElfW(Nhdr) *) ptr;
+       const ak_uint8 *name = ptr + sizeof( ElfW(Nhdr)),
+                      *desc = name + (( note->n_namesz + 3 )&~3 );
+       if(( desc + note->n_descsz > end ) || ( desc < name )) break;
+       if(( note->n_type == NT_GNU_BUILD_ID ) && ( note->n_namesz == 4 ) &&
+          ( memcmp( name, "GNU", 4 ) == 0 ) && ( note->n_descsz > 0 )) {
+         memcpy( bid->id, desc, bid->size = ak_min( note->n_descsz, sizeof( bid->id )));
+         return 1;
+       }
+       ptr = desc + (( note->n_descsz + 3 )&~3 );
+     }
   }
 
- /* тестируем работу алгоритмов блочного шифрования */
-  if( ak_libakrypt_test_block_ciphers() != ak_true ) {
-    ak_error_message( ak_error_get_value(), __func__ , "error while testing block ciphers" );
-    return ak_false;
+ /* вычисляем хеш-код исполняемых сегментов */
+  if( ak_hash_create_streebog256( &ctx ) != ak_error_ok ) return 1;
+  ak_hash_clean( &ctx );
+  for( i = 0; i < info->dlpi_phnum; i++ )
+     if(( info->dlpi_phdr[i].p_type == PT_LOAD ) && ( info->dlpi_phdr[i].p_flags&PF_X ))
+       ak_hash_update( &ctx, ( ak_pointer )( info->dlpi_addr + info->dlpi_phdr[i].p_vaddr ),
+                                                                   info->dlpi_phdr[i].p_memsz );
+  if( ak_hash_finalize( &ctx, NULL, 0, bid->id, sizeof( bid->id )) == ak_error_ok )
+    bid->size = sizeof( bid->id );
+  ak_hash_destroy( &ctx );
+
+ return 1;
+}
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция формирует строку, однозначно определяющую версию и сборку библиотеки,
+    возможности процессора и текущий сеанс работы операционной системы.
+
+    В качестве идентификатора сборки используется идентификатор образа, содержащего
+    код библиотеки (см. ak_libakrypt_build_id_callback()); если он не может быть получен,
+    используется момент компиляции данного файла.
+
+    \param key Массив, куда помещается строка.
+    \param size Размер массива.
+    \return В случае успеха возвращается \ref ak_error_ok. Если идентификатор сеанса работы
+    операционной системы не может быть получен, возвращается код ошибки.                           */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_libakrypt_control_test_key( char *key, const size_t size )
+{
+  struct file fp;
+  ak_uint32 features = 0;
+  char boot[40], build[80], *bootname = "/proc/sys/kernel/random/boot_id";
+#ifdef AK_HAVE_LINK_H
+  struct build_id bid;
+#endif
+
+  memset( boot, 0, sizeof( boot ));
+  if( ak_file_or_directory( bootname ) != DT_REG ) return ak_error_open_file;
+  if( ak_file_open_to_read( &fp, bootname ) != ak_error_ok ) return ak_error_open_file;
+  if( ak_file_read( &fp, boot, 36 ) != 36 ) {
+    ak_file_close( &fp );
+    return ak_error_read_data;
   }
+  ak_file_close( &fp );
+
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ))
+  __builtin_cpu_init();
+  if( __builtin_cpu_supports( "sse2" )) features |= 0x01;
+  if( __builtin_cpu_supports( "avx" )) features |= 0x02;
+  if( __builtin_cpu_supports( "avx2" )) features |= 0x04;
+  if( __builtin_cpu_supports( "pclmul" )) features |= 0x08;
+  if( __builtin_cpu_supports( "aes" )) features |= 0x10;
+  if( __builtin_cpu_supports( "bmi2" )) features |= 0x20;
+#endif
 
- /* проверяем корректность реализации алгоритмов итерационного сжатия */
-   if( ak_libakrypt_test_mac_functions( ) != ak_true ) {
-     ak_error_message( ak_error_get_value(), __func__ , "incorrect testing of mac algorithms" );
-     return ak_false;
-   }
+  ak_snprintf( build, sizeof( build ), "%s %s", __DATE__, __TIME__ );
+#ifdef AK_HAVE_LINK_H
+  memset( &bid, 0, sizeof( struct build_id ));
+  bid.addr = ( ak_uint8 *) control_tests;
+  if(( dl_iterate_phdr( ak_libakrypt_build_id_callback, &bid ) == 1 ) && ( bid.size > 0 ))
+    ak_snprintf( build, sizeof( build ), "%s", ak_ptr_to_hexstr( bid.id, bid.size, ak_false ));
+#endif
+  ak_snprintf( key, size, "libakrypt %s build %s cpu %08x boot %s\n",
+                                                 ak_libakrypt_version(), build, features, boot );
+ return ak_error_ok;
+}
 
- /* тестируем работу алгоритмов выработки и проверки электронной подписи */
-  if( ak_libakrypt_test_asymmetric_functions() != ak_true ) {
-    ak_error_message( ak_error_get_value(), __func__ ,
-                                        "error while testing digital signature mechanisms" );
-    return ak_false;
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция выполняет полное тестирование библиотеки не более одного раза за сеанс
+    работы операционной системы.
+
+    Результат успешного тестирования сохраняется в файле `control-test.cache` домашнего каталога
+    библиотеки вместе со строкой, содержащей версию и идентификатор сборки библиотеки, возможности
+    процессора и идентификатор сеанса работы операционной системы. При совпадении строки
+    тестирование не выполняется. Если идентификатор сеанса не может быть получен,
+    тестирование выполняется при каждом вызове функции.
+
+    \return Функция возвращает \ref ak_true в случае успешного тестирования.                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t ak_libakrypt_dynamic_control_test_cached( void )
+{
+  size_t idx = 0;
+  struct file fp;
+  char key[256], buffer[256], filename[FILENAME_MAX];
+
+  memset( key, 0, sizeof( key ));
+  memset( buffer, 0, sizeof( buffer ));
+  if(( ak_libakrypt_control_test_key( key, sizeof( key )) != ak_error_ok ) ||
+     ( ak_libakrypt_create_home_filename( filename, sizeof( filename ),
+                                                 "control-test.cache", 0 ) != ak_error_ok )) {
+    ak_error_set_value( ak_error_ok );
+    return ak_libakrypt_dynamic_control_test();
   }
 
-  if( audit >= ak_log_maximum ) ak_error_message( ak_error_ok, __func__ , "testing is Ok" );
+ /* проверяем сохраненный результат */
+  if( ak_file_or_directory( filename ) == DT_REG ) {
+    if( ak_file_open_to_read( &fp, filename ) == ak_error_ok ) {
+      ak_file_read( &fp, buffer, sizeof( buffer ) - 1 );
+      ak_file_close( &fp );
+    }
+    if( strcmp( key, buffer ) == 0 ) {
+      for( idx = 0; idx < control_tests_count; idx++ ) {
+         control_tests[idx].time = 0;
+         control_tests[idx].state = control_test_passed;
+      }
+      if( ak_log_get_level() >= ak_log_maximum )
+        ak_error_message( ak_error_ok, __func__ , "using cached result of dynamic control test" );
+      return ak_true;
+    }
+  }
+
+ /* выполняем тестирование и сохраняем результат */
+  if( !ak_libakrypt_dynamic_control_test()) return ak_false;
+  if( ak_file_create_to_write( &fp, filename ) == ak_error_ok ) {
+    ak_file_write( &fp, key, strlen( key ));
+    ak_file_close( &fp );
+  } else ak_error_set_value( ak_error_ok ); /* невозможность сохранения не является ошибкой */
+
  return ak_true;
 }
 
@@ -378,15 +726,27 @@
 
  /* процедура полного тестирования всех криптографических алгоритмов
     занимает крайне много времени, особенно на встраиваемых платформах,
-    поэтому ее запуск должен производиться в соответствии с неким (внешним) регламентом ....
-
-    if( !ak_libakrypt_dynamic_control_test( )) {
-      ak_error_message( error, __func__, "incorrect dynamic control test" );
-      return ak_false;
-    }
-
-    поскольку функция динамического контроля экспортируется,
-    то она может быть запущена пользователем самостоятельно. */
+    поэтому ее запуск определяется опцией dynamic_control_test: при значении 0 тестирование
+    не производится (функция динамического контроля экспортируется и может быть запущена
+    пользователем самостоятельно), при значении 1 тестируется каждая группа механизмов
+    при первом использовании, при значении 2 полное тестирование производится один раз
+    за сеанс работы операционной системы, при значении 3 - при каждом запуске. */
+  switch( ak_libakrypt_get_option_by_name( "dynamic_control_test" )) {
+    case 2:
+      if( !ak_libakrypt_dynamic_control_test_cached( )) {
+        ak_error_message( ak_error_get_value(), __func__, "incorrect dynamic control test" );
+        return ak_false;
+      }
+      break;
+    case 3:
+      if( !ak_libakrypt_dynamic_control_test( )) {
+        ak_error_message( ak_error_get_value(), __func__, "incorrect dynamic control test" );
+        return ak_false;
+      }
+      break;
+    default:
+      break;
+  }
 
  if( ak_log_get_level() != ak_log_none )
    ak_error_message( ak_error_ok, __func__ , "creation of libakrypt is Ok" );
@@ -401,6 +761,14 @@
   if( error != ak_error_ok )
     ak_error_message( error, __func__ , "before destroing library holds an error" );
 
+ /* удаляем хранилище доверенных сертификатов, кеш проверенных сертификатов,
+    останавливаем потоки, удаляем генератор основного потока и освобождаем пул памяти */
+  ak_certificate_store_destroy();
+  ak_certificate_cache_clean();
+  ak_libakrypt_parallel_destroy();
+  ak_random_drbg_thread_destroy();
+  ak_skey_pool_destroy();
+
 #ifdef AK_HAVE_WINDOWS_H
   #ifdef LIBAKRYPT_NETWORK
     if( WSACleanup() != 0 )
@@ -343,20 +343,19 @@
 /*! \brief Функция зашифрования одного блока информации алгоритмом ГОСТ 34.12-2015 (Магма).
 
     @param skey Контекст секретного ключа.
+    @param mv Случайное значение, определяющее траекторию вычислений.
     @param in Блок входной информации (открытый текст).
     @param out Блок выходной информации (шифртекст).                                               */
 /* ----------------------------------------------------------------------------------------------- */
- static void ak_magma_encrypt_with_random_walk( ak_skey skey, ak_pointer in, ak_pointer out )
+ static inline void ak_magma_encrypt_walk( ak_skey skey, const ak_uint32 mv,
+                                                                  ak_pointer in, ak_pointer out )
 {
   ak_uint8 m[34];
-  ak_uint32 i, mv = 0;
+  ak_uint32 i;
   ak_uint32 (*kp)[8] = ((struct magma_encrypted_keys *)skey->data)->inkey;
   ak_uint32 (*mp)[8] = ((struct magma_encrypted_keys *)skey->data)->inmask;
   register ak_uint32 n3, n4, p = 0;
 
- /* вырабатываем случайную траекторию */
-  skey->generator.random( &skey->generator, &mv, sizeof( ak_uint32 ));
-
  /* формируем вектор раундовых поворотов */
   m[0] = m[33] = 0;
   for( i = 0; i < 32; i++ ) m[i+1] = (ak_uint8)(( mv >> i) & 0x01 );
@@ -418,20 +417,19 @@
     алгоритмом ГОСТ 34.12-2015 (Магма).
 
     @param skey Контекст секретного ключа.
+    @param mv Случайное значение, определяющее траекторию вычислений.
     @param in Блок входной информации (шифртекст).
     @param out Блок выходной информации (открытый текст).                                          */
 /* ----------------------------------------------------------------------------------------------- */
- static void ak_magma_decrypt_with_random_walk( ak_skey skey, ak_pointer in, ak_pointer out )
+ static inline void ak_magma_decrypt_walk( ak_skey skey, const ak_uint32 mv,
+                                                                  ak_pointer in, ak_pointer out )
 {
   ak_uint8 m[34];
-  ak_uint32 i, mv = 0;
+  ak_uint32 i;
   ak_uint32 (*kp)[8] = ((struct magma_encrypted_keys *)skey->data)->inkey;
   ak_uint32 (*mp)[8] = ((struct magma_encrypted_keys *)skey->data)->inmask;
   register ak_uint32 n3, n4, p = 0;
 
- /* вырабатываем случайную траекторию */
-  skey->generator.random( &skey->generator, &mv, sizeof( ak_uint32 ));
-
  /* формируем вектор раундовых поворотов */
   m[0] = m[33] = 0;
   for( i = 0; i < 32; i++ ) m[i+1] = (ak_uint8)((mv >> i) & 0x01 );
@@ -493,20 +491,19 @@
     Функция реализует режим совместимости с псевдопреобразованием, реализуемым библиотекой openssl.
 
     @param skey Контекст секретного ключа.
+    @param mv Случайное значение, определяющее траекторию вычислений.
     @param in Блок входной информации (открытый текст).
     @param out Блок выходной информации (шифртекст).                                               */
 /* ----------------------------------------------------------------------------------------------- */
- static void ak_magma_encrypt_with_random_walk_oc( ak_skey skey, ak_pointer in, ak_pointer out )
+ static inline void ak_magma_encrypt_walk_oc( ak_skey skey, const ak_uint32 mv,
+                                                                  ak_pointer in, ak_pointer out )
 {
   ak_uint8 m[34];
-  ak_uint32 i, mv = 0;
+  ak_uint32 i;
   ak_uint32 (*kp)[8] = ((struct magma_encrypted_keys *)skey->data)->inkey;
   ak_uint32 (*mp)[8] = ((struct magma_encrypted_keys *)skey->data)->inmask;
   register ak_uint32 n3, n4, p = 0;
 
- /* вырабатываем случайную траекторию */
-  skey->generator.random( &skey->generator, &mv, sizeof( ak_uint32 ));
-
  /* формируем вектор раундовых поворотов */
   m[0] = m[1] = m[32] = m[33] = 0;
   for( i = 1; i < 31; i++ ) m[i+1] = (ak_uint8)(( mv >> i) & 0x01 );
@@ -569,20 +566,19 @@
     Функция реализует режим совместимости с псевдопреобразованием, реализуемым библиотекой openssl.
 
     @param skey Контекст секретного ключа.
+    @param mv Случайное значение, определяющее траекторию вычислений.
     @param in Блок входной информации (шифртекст).
     @param out Блок выходной информации (открытый текст).                                          */
 /* ----------------------------------------------------------------------------------------------- */
- static void ak_magma_decrypt_with_random_walk_oc( ak_skey skey, ak_pointer in, ak_pointer out )
+ static inline void ak_magma_decrypt_walk_oc( ak_skey skey, const ak_uint32 mv,
+                                                                  ak_pointer in, ak_pointer out )
 {
   ak_uint8 m[34];
-  ak_uint32 i, mv = 0;
+  ak_uint32 i;
   ak_uint32 (*kp)[8] = ((struct magma_encrypted_keys *)skey->data)->inkey;
   ak_uint32 (*mp)[8] = ((struct magma_encrypted_keys *)skey->data)->inmask;
   register ak_uint32 n3, n4, p = 0;
 
- /* вырабатываем случайную траекторию */
-  skey->generator.random( &skey->generator, &mv, sizeof( ak_uint32 ));
-
  /* формируем вектор раундовых поворотов */
   m[0] = m[1] = m[32] = m[33] = 0;
   for( i = 1; i < 31; i++ ) m[i+1] = (ak_uint8)((mv >> i) & 0x01 );
@@ -639,6 +635,48 @@
 #endif
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Количество блоков, для которых случайные траектории вычисляются за одно обращение
+    к генератору. */
+ #define ak_magma_blocks_batch (16)
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Макрос определяет функцию преобразования одного блока информации, вырабатывающую
+    случайную траекторию вычислений, и функцию преобразования нескольких последовательно
+    расположенных блоков, в которой траектории для группы блоков вырабатываются
+    за одно обращение к генератору.                                                                */
+/* ----------------------------------------------------------------------------------------------- */
+ #define ak_magma_define_functions( single, multiple, walk ) \
+ static void single( ak_skey skey, ak_pointer in, ak_pointer out ) \
+{ \
+  ak_uint32 mv = 0; \
+  skey->generator.random( &skey->generator, &mv, sizeof( ak_uint32 )); \
+  walk( skey, mv, in, out ); \
+} \
+ \
+ static void multiple( ak_skey skey, ak_pointer in, ak_pointer out, size_t blocks ) \
+{ \
+  size_t i = 0, count = 0; \
+  ak_uint32 mv[ak_magma_blocks_batch]; \
+  ak_uint64 *inptr = ( ak_uint64 *)in, *outptr = ( ak_uint64 *)out; \
+ \
+  while( blocks > 0 ) { \
+    count = ak_min( blocks, ak_magma_blocks_batch ); \
+    skey->generator.random( &skey->generator, mv, count*sizeof( ak_uint32 )); \
+    for( i = 0; i < count; i++ ) walk( skey, mv[i], inptr++, outptr++ ); \
+    blocks -= count; \
+  } \
+}
+
+ ak_magma_define_functions( ak_magma_encrypt_with_random_walk,
+                                           ak_magma_encrypt_blocks, ak_magma_encrypt_walk )
+ ak_magma_define_functions( ak_magma_decrypt_with_random_walk,
+                                           ak_magma_decrypt_blocks, ak_magma_decrypt_walk )
+ ak_magma_define_functions( ak_magma_encrypt_with_random_walk_oc,
+                                     ak_magma_encrypt_blocks_oc, ak_magma_encrypt_walk_oc )
+ ak_magma_define_functions( ak_magma_decrypt_with_random_walk_oc,
+                                     ak_magma_decrypt_blocks_oc, ak_magma_decrypt_walk_oc )
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Функция уничтожения развернутых ключей для маскированной магмы
 
@@ -657,7 +695,7 @@
  /* если ключ был создан, но ему не было присвоено значение, здесь возникнет ошибка */
   if( skey->data != NULL ) {
     ak_ptr_wipe( skey->data, sizeof( struct magma_encrypted_keys ), &skey->generator );
-    free( skey->data );
+    ak_skey_pool_free( skey->data );
     skey->data = NULL;
   }
  return ak_error_ok;
@@ -681,16 +719,17 @@
  /* проверяем целостность ключа */
   if( skey->check_icode( skey ) != ak_true ) return ak_error_message( ak_error_wrong_key_icode,
                                                 __func__ , "using key with wrong integrity code" );
- /* удаляем былое */
-  if( skey->data != NULL ) ak_magma_delete_keys( skey );
-
-  if(( data = ak_aligned_malloc( sizeof( struct magma_encrypted_keys ))) == NULL )
-    return ak_error_message( ak_error_out_of_memory, __func__, "incorrect memory allocation" );
-
- /* выставляем флаги того, что память выделена */
-  memset( data, 0, sizeof( struct magma_encrypted_keys ));
-  skey->data = ( ak_pointer )data;
-  skey->flags |= ak_key_flag_data_not_free;
+ /* память выделяется только при первой развертке; при смене значения ключа
+    развернутые ключи и маски перезаписываются на месте */
+  if(( data = skey->data ) == NULL ) {
+    if(( data = ak_skey_alloc_data( skey, sizeof( struct magma_encrypted_keys ))) == NULL )
+      return ak_error_message( ak_error_out_of_memory, __func__, "incorrect memory allocation" );
+
+   /* выставляем флаги того, что память выделена */
+    memset( data, 0, sizeof( struct magma_encrypted_keys ));
+    skey->data = ( ak_pointer )data;
+    skey->flags |= ak_key_flag_data_not_free;
+  }
 
  /* размещаем данные */
   if(( error = ak_random_ptr( &skey->generator, data->inmask, sizeof( data->inmask ))) != ak_error_ok )
@@ -946,10 +985,14 @@
   if( oc ) {
     bkey->encrypt = ak_magma_encrypt_with_random_walk_oc;
     bkey->decrypt = ak_magma_decrypt_with_random_walk_oc;
+    bkey->encrypt_blocks = ak_magma_encrypt_blocks_oc;
+    bkey->decrypt_blocks = ak_magma_decrypt_blocks_oc;
   }
    else {
     bkey->encrypt = ak_magma_encrypt_with_random_walk;
     bkey->decrypt = ak_magma_decrypt_with_random_walk;
+    bkey->encrypt_blocks = ak_magma_encrypt_blocks;
+    bkey->decrypt_blocks = ak_magma_decrypt_blocks;
   }
   return error;
 }
@@ -112,6 +112,14 @@
 /*! Константные значения имен идентификаторов */
  static const char *asn1_lcg_n[] =         { "lcg", NULL };
  static const char *asn1_lcg_i[] =         { "1.2.643.2.52.1.1.1", NULL };
+ static const char *asn1_xorshift128_n[] = { "xorshift128+", "xorshift128plus", NULL };
+ static const char *asn1_xorshift128_i[] = { "1.2.643.2.52.1.1.5", NULL };
+ static const char *asn1_mt19937_n[] =     { "mt19937-64", "mt19937", NULL };
+ static const char *asn1_mt19937_i[] =     { "1.2.643.2.52.1.1.6", NULL };
+ static const char *asn1_drbg_n[] =        { "drbg-kuznechik", NULL };
+ static const char *asn1_drbg_i[] =        { "1.2.643.2.52.1.1.7", NULL };
+ static const char *asn1_drbg_thread_n[] = { "drbg-kuznechik-thread", NULL };
+ static const char *asn1_drbg_thread_i[] = { "1.2.643.2.52.1.1.8", NULL };
 #if defined(__unix__) || defined(__APPLE__)
  static const char *asn1_dev_random_n[] =  { "dev-random", "/dev/random", NULL };
  static const char *asn1_dev_random_i[] =  { "1.2.643.2.52.1.1.2", NULL };
@@ -218,6 +226,15 @@
  static const char *asn1_cmac_rc6_i[] =
                                            { "1.2.643.2.52.1.7.1.9", NULL };
 
+ static const char *asn1_omac_acpkm_magma_n[] =
+                                           { "omac-acpkm-magma", NULL };
+ static const char *asn1_omac_acpkm_magma_i[] =
+                                           { "1.2.643.2.52.1.7.2.1", NULL };
+ static const char *asn1_omac_acpkm_kuznechik_n[] =
+                                           { "omac-acpkm-kuznechik", "omac-acpkm-kuznyechik", NULL };
+ static const char *asn1_omac_acpkm_kuznechik_i[] =
+                                           { "1.2.643.2.52.1.7.2.2", NULL };
+
  static const char *asn1_mgm_magma_n[] =   { "mgm-magma",
                                              "id-tc26-cipher-gostr3412-2015-magma-mgm", NULL };
  static const char *asn1_mgm_magma_i[] =   { "1.2.643.7.1.1.5.1.3", NULL };
@@ -485,6 +502,20 @@
                            ( ak_function_set_key_random_object *)ak_hmac_set_key_random, \
                        ( ak_function_set_key_from_password_object *)ak_hmac_set_key_from_password }
 
+ #define ak_object_omac_acpkm_magma { sizeof( struct omac_acpkm ), \
+                           ( ak_function_create_object *) ak_omac_acpkm_create_magma, \
+                           ( ak_function_destroy_object *) ak_omac_acpkm_destroy, \
+                           ( ak_function_set_key_object *)ak_omac_acpkm_set_key, \
+                           ( ak_function_set_key_random_object *)ak_omac_acpkm_set_key_random, \
+                  ( ak_function_set_key_from_password_object *)ak_omac_acpkm_set_key_from_password }
+
+ #define ak_object_omac_acpkm_kuznechik { sizeof( struct omac_acpkm ), \
+                           ( ak_function_create_object *) ak_omac_acpkm_create_kuznechik, \
+                           ( ak_function_destroy_object *) ak_omac_acpkm_destroy, \
+                           ( ak_function_set_key_object *)ak_omac_acpkm_set_key, \
+                           ( ak_function_set_key_random_object *)ak_omac_acpkm_set_key_random, \
+                  ( ak_function_set_key_from_password_object *)ak_omac_acpkm_set_key_from_password }
+
  #define ak_object_signkey256 { sizeof( struct signkey ), \
                           ( ak_function_create_object *) ak_signkey_create_streebog256, \
                           ( ak_function_destroy_object *) ak_signkey_destroy, \
@@ -516,6 +547,22 @@ static struct oid libakrypt_oids[] =
   {{ sizeof( struct random ), (ak_function_create_object *)ak_random_create_lcg,
                               (ak_function_destroy_object *)ak_random_destroy, NULL, NULL, NULL },
                                                                 ak_object_undefined, NULL, NULL }},
+ { random_generator, algorithm, asn1_xorshift128_i, asn1_xorshift128_n, NULL,
+  {{ sizeof( struct random ), (ak_function_create_object *)ak_random_create_xorshift128,
+                              (ak_function_destroy_object *)ak_random_destroy, NULL, NULL, NULL },
+                                                                ak_object_undefined, NULL, NULL }},
+ { random_generator, algorithm, asn1_mt19937_i, asn1_mt19937_n, NULL,
+  {{ sizeof( struct random ), (ak_function_create_object *)ak_random_create_mt19937,
+                              (ak_function_destroy_object *)ak_random_destroy, NULL, NULL, NULL },
+                                                                ak_object_undefined, NULL, NULL }},
+ { random_generator, algorithm, asn1_drbg_i, asn1_drbg_n, NULL,
+  {{ sizeof( struct random ), (ak_function_create_object *)ak_random_create_drbg,
+                              (ak_function_destroy_object *)ak_random_destroy, NULL, NULL, NULL },
+                                                                ak_object_undefined, NULL, NULL }},
+ { random_generator, algorithm, asn1_drbg_thread_i, asn1_drbg_thread_n, NULL,
+  {{ sizeof( struct random ), (ak_function_create_object *)ak_random_create_drbg_thread,
+                              (ak_function_destroy_object *)ak_random_destroy, NULL, NULL, NULL },
+                                                                ak_object_undefined, NULL, NULL }},
 #if defined(__unix__) || defined(__APPLE__)
  { random_generator, algorithm, asn1_dev_random_i, asn1_dev_random_n, NULL,
   {{ sizeof( struct random ), (ak_function_create_object *)ak_random_create_random,
@@ -654,6 +701,14 @@ static struct oid libakrypt_oids[] =
    { ak_object_bckey_rc6, ak_object_undefined,
      ( ak_function_run_object *) ak_bckey_cmac, NULL }},
 
+ { mac_function, algorithm, asn1_omac_acpkm_magma_i, asn1_omac_acpkm_magma_n, NULL,
+                            { ak_object_omac_acpkm_magma,
+                         ak_object_undefined, (ak_function_run_object *) ak_omac_acpkm_ptr, NULL }},
+
+ { mac_function, algorithm, asn1_omac_acpkm_kuznechik_i, asn1_omac_acpkm_kuznechik_n, NULL,
+                            { ak_object_omac_acpkm_kuznechik,
+                         ak_object_undefined, (ak_function_run_object *) ak_omac_acpkm_ptr, NULL }},
+
 /* расширенные режимы блочного шифрования */
  { block_cipher, aead, asn1_mgm_magma_i, asn1_mgm_magma_n, NULL,
   { ak_object_bckey_magma, ak_object_bckey_magma,
@@ -905,7 +960,7 @@ static struct oid libakrypt_oids[] =
     return NULL;
   }
 
-  if(( ctx = malloc( oid->func.first.size )) != NULL ) {
+  if(( ctx = ak_aligned_malloc( oid->func.first.size )) != NULL ) {
     if(( error = ((ak_function_create_object*)oid->func.first.create )( ctx )) != ak_error_ok ) {
       ak_error_message_fmt( error, __func__, "creation of the %s object failed",
                                                       ak_libakrypt_get_engine_name( oid->engine ));
@@ -945,7 +1000,7 @@ static struct oid libakrypt_oids[] =
     return NULL;
   }
 
-  if(( ctx = malloc( oid->func.second.size )) != NULL ) {
+  if(( ctx = ak_aligned_malloc( oid->func.second.size )) != NULL ) {
     if(( error = ((ak_function_create_object*)oid->func.second.create )( ctx )) != ak_error_ok ) {
       ak_error_message_fmt( error, __func__, "creation of the %s object failed",
                                                       ak_libakrypt_get_engine_name( oid->engine ));
@@ -4,7 +4,7 @@
 /*  Файл ak_options.с                                                                              */
 /*  - содержит реализацию функций для работы с опциями библиотеки                                  */
 /* ----------------------------------------------------------------------------------------------- */
- #include <libakrypt.h>
+ #include <libakrypt-internal.h>
 
 /* ----------------------------------------------------------------------------------------------- */
 #ifdef AK_HAVE_ERRNO_H
@@ -52,6 +52,19 @@
      { "openssl_compability", 0, 0, 1 },
   /* флаг использования цвета при выводе сообщений библиотеки */
      { "use_color_output", 1, 0, 1 },
+  /* количество сертификатов, результат проверки подписи под которыми сохраняется в кеше */
+     { "certificate_cache_size", 256, 0, 65536 },
+  /* максимальное количество блоков памяти каждого размера, хранимых в пуле для ключевой информации */
+     { "skey_pool_size", 64, 0, 65536 },
+  /* количество потоков, используемых для параллельных вычислений (ноль - по числу процессоров) */
+     { "threads_count", 0, 0, 256 },
+  /* при ненулевом значении очищаемая память заполняется случайными данными, иначе - обнуляется */
+     { "wipe_with_random", 0, 0, 1 },
+  /* при ненулевом значении память для секретных ключей выделяется из защищенной кучи */
+     { "skey_secure_memory", 0, 0, 1 },
+  /* режим динамического контроля: 0 - не выполняется, 1 - при первом использовании механизма,
+     2 - один раз за сеанс работы операционной системы, 3 - при каждой инициализации библиотеки */
+     { "dynamic_control_test", 0, 0, 3 },
      { NULL, 0, 0, 0 } /* завершающая константа, должна всегда принимать нулевые значения */
  };
 
@@ -130,6 +143,8 @@
   for( i = 0; i < ak_libakrypt_options_count(); i++ ) {
      if( strncmp( name, options[i].name, strlen( options[i].name )) == 0 ) {
        options[i].value = value;
+       if( strcmp( options[i].name, "wipe_with_random" ) == 0 )
+         ak_ptr_wipe_set_with_random( value > 0 );
        result = ak_error_ok;
      }
   }
@@ -4,7 +4,7 @@
 /*  Файл ak_random.с                                                                               */
 /*  - содержит реализацию генераторов псевдо-случайных чисел                                       */
 /* ----------------------------------------------------------------------------------------------- */
- #include <libakrypt.h>
+ #include <libakrypt-internal.h>
 
 /* ----------------------------------------------------------------------------------------------- */
 #ifdef AK_HAVE_TIME_H
@@ -16,6 +16,9 @@
 #ifdef AK_HAVE_FCNTL_H
  #include <fcntl.h>
 #endif
+#ifdef AK_HAVE_PTHREAD_H
+ #include <pthread.h>
+#endif
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Инициализация генератора псевдо-случайных чисел.
@@ -283,6 +286,353 @@
  return error;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*                     вспомогательная функция инициализации генераторов                           */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вырабатывает последовательность 64-х битных слов, используемую для
+    инициализации генераторов с большим внутренним состоянием.
+    \details Заданный массив октетов сворачивается в одно 64-х битное значение, которое
+    затем используется в качестве начального состояния генератора splitmix64.                      */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_random_splitmix64( const ak_uint8 *ptr, const ssize_t size,
+                                                          ak_uint64 *out, const size_t count )
+{
+  size_t i = 0;
+  ssize_t idx = 0;
+  ak_uint64 z, x = 0xcbf29ce484222325ULL;
+
+  for( idx = 0; idx < size; idx++ ) x = ( x ^ ptr[idx] )*0x100000001b3ULL;
+  for( i = 0; i < count; i++ ) {
+     z = ( x += 0x9e3779b97f4a7c15ULL );
+     z = ( z ^ ( z >> 30 ))*0xbf58476d1ce4e5b9ULL;
+     z = ( z ^ ( z >> 27 ))*0x94d049bb133111ebULL;
+     out[i] = z ^ ( z >> 31 );
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                               реализация класса xorshift128+                                    */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Один шаг генератора: каждая из четырех независимых последовательностей
+    вырабатывает 64-х битное значение; результат (32 октета) помещается в массив `out`.
+    \details Операции над последовательностями не зависят друг от друга, что позволяет
+    компилятору использовать векторные инструкции.                                                 */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_random_xorshift128_step( ak_random rnd, ak_uint64 *out )
+{
+  int i = 0;
+  ak_uint64 *s0 = rnd->data.xorshift.s0, *s1 = rnd->data.xorshift.s1;
+
+  for( i = 0; i < 4; i++ ) {
+     ak_uint64 x = s0[i];
+     const ak_uint64 y = s1[i];
+
+     s0[i] = y;
+     x ^= x << 23;
+     s1[i] = x ^ y ^ ( x >> 17 ) ^ ( y >> 26 );
+     out[i] = s1[i] + y;
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_random_xorshift128_next( ak_random rnd )
+{
+  ak_uint64 out[4];
+
+  if( rnd == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                      "use a null pointer to a random generator" );
+  ak_random_xorshift128_step( rnd, out );
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_random_xorshift128_randomize_ptr( ak_random rnd,
+                                                         const ak_pointer ptr, const ssize_t size )
+{
+  int i = 0;
+  ak_uint64 state[8];
+
+  if( rnd == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                      "use a null pointer to a random generator" );
+  if( ptr == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                          "use a null pointer to initial vector" );
+  if( size <= 0 ) return ak_error_message( ak_error_wrong_length, __func__ ,
+                                                          "use initial vector with wrong length" );
+  ak_random_splitmix64( ptr, size, state, 8 );
+  for( i = 0; i < 4; i++ ) {
+     rnd->data.xorshift.s0[i] = state[i];
+    /* нулевое состояние недопустимо */
+     rnd->data.xorshift.s1[i] = state[4+i] | 1;
+  }
+  memset( state, 0, sizeof( state ));
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_random_xorshift128_random( ak_random rnd, const ak_pointer ptr, const ssize_t size )
+{
+  ak_uint64 out[4];
+  ak_uint8 *value = ptr;
+  ssize_t idx = 0, tail = 0;
+
+  if( rnd == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                      "use a null pointer to a random generator" );
+  if( ptr == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                                    "use a null pointer to data" );
+  if( size <= 0 ) return ak_error_message( ak_error_wrong_length, __func__ ,
+                                                           "use a data vector with wrong length" );
+  tail = size&0x1f;
+  for( idx = 0; idx < size - tail; idx += 32 ) {
+     ak_random_xorshift128_step( rnd, out );
+     memcpy( value + idx, out, 32 );
+  }
+  if( tail ) {
+    ak_random_xorshift128_step( rnd, out );
+    memcpy( value + idx, out, ( size_t )tail );
+  }
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Генератор объединяет четыре независимых генератора xorshift128+, предложенных С. Винья
+    (S. Vigna, Further scramblings of Marsaglia's xorshift generators, 2017), с параметрами
+    \f$ a = 23, b = 17, c = 26 \f$. Внутреннее состояние каждого генератора
+    \f$ (x, y) \f$ изменяется по правилу
+    \f$ x' = y, \; y' = t \oplus y \oplus (t \gg 17) \oplus (y \gg 26), \f$
+    где \f$ t = x \oplus (x \ll 23) \f$; выходом является значение \f$ y' + y \pmod{2^{64}}\f$.
+
+    За один шаг вырабатываются 32 октета (по восемь октетов каждым генератором); операции над
+    генераторами выполняются параллельно с использованием векторных инструкций процессора.
+    При запросе последовательности, длина которой не кратна 32 октетам, неиспользованные
+    октеты последнего шага отбрасываются.
+
+    Генератор не является криптографически стойким и предназначен для выработки масок
+    секретных ключей, а также тестовых данных.
+
+    @param generator Контекст создаваемого генератора.
+    \return В случае успеха, функция возвращает \ref ak_error_ok. В противном случае
+            возвращается код ошибки.                                                               */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_random_create_xorshift128( ak_random generator )
+{
+  int error = ak_error_ok;
+  ak_uint64 qword = ak_random_value(); /* вырабатываем случайное число */
+
+  if(( error = ak_random_create( generator )) != ak_error_ok )
+    return ak_error_message( error, __func__ , "wrong initialization of random generator" );
+
+  generator->oid = ak_oid_find_by_name("xorshift128+");
+  generator->next = ak_random_xorshift128_next;
+  generator->randomize_ptr = ak_random_xorshift128_randomize_ptr;
+  generator->random = ak_random_xorshift128_random;
+
+ /* для корректной работы присваиваем какое-то случайное начальное значение */
+  ak_random_xorshift128_randomize_ptr( generator, &qword, sizeof( ak_uint64 ));
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                                реализация класса mt19937-64                                     */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Размер внутреннего состояния генератора mt19937-64 (в 64-х битных словах). */
+ #define ak_mt19937_nn                        (312)
+/*! \brief Смещение, используемое при обновлении внутреннего состояния генератора. */
+ #define ak_mt19937_mm                        (156)
+
+/*! \brief Внутреннее состояние генератора mt19937-64. */
+ typedef struct mt19937 {
+  /*! \brief массив внутренних состояний */
+   ak_uint64 mt[ak_mt19937_nn];
+  /*! \brief индекс следующего используемого элемента массива */
+   size_t mti;
+ } *ak_mt19937;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Обновление всего массива внутренних состояний генератора. */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_random_mt19937_twist( ak_mt19937 ctx )
+{
+  size_t i = 0;
+  ak_uint64 x;
+  static const ak_uint64 mag01[2] = { 0ULL, 0xb5026f5aa96619e9ULL };
+
+  for( i = 0; i < ak_mt19937_nn - ak_mt19937_mm; i++ ) {
+     x = ( ctx->mt[i]&0xffffffff80000000ULL )|( ctx->mt[i+1]&0x7fffffffULL );
+     ctx->mt[i] = ctx->mt[i+ak_mt19937_mm] ^ ( x >> 1 ) ^ mag01[x&1];
+  }
+  for( ; i < ak_mt19937_nn - 1; i++ ) {
+     x = ( ctx->mt[i]&0xffffffff80000000ULL )|( ctx->mt[i+1]&0x7fffffffULL );
+     ctx->mt[i] = ctx->mt[i+ak_mt19937_mm-ak_mt19937_nn] ^ ( x >> 1 ) ^ mag01[x&1];
+  }
+  x = ( ctx->mt[ak_mt19937_nn-1]&0xffffffff80000000ULL )|( ctx->mt[0]&0x7fffffffULL );
+  ctx->mt[ak_mt19937_nn-1] = ctx->mt[ak_mt19937_mm-1] ^ ( x >> 1 ) ^ mag01[x&1];
+  ctx->mti = 0;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Выработка очередного 64-х битного значения. */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline ak_uint64 ak_random_mt19937_value( ak_mt19937 ctx )
+{
+  ak_uint64 x;
+
+  if( ctx->mti >= ak_mt19937_nn ) ak_random_mt19937_twist( ctx );
+  x = ctx->mt[ctx->mti++];
+  x ^= ( x >> 29 )&0x5555555555555555ULL;
+  x ^= ( x << 17 )&0x71d67fffeda60000ULL;
+  x ^= ( x << 37 )&0xfff7eee000000000ULL;
+ return x ^ ( x >> 43 );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_random_mt19937_next( ak_random rnd )
+{
+  if( rnd == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                      "use a null pointer to a random generator" );
+  ak_random_mt19937_value( rnd->data.ctx );
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Инициализация внутреннего состояния генератора 64-х битным значением
+    (функция init_genrand64 эталонной реализации). */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_random_mt19937_init( ak_mt19937 ctx, const ak_uint64 seed )
+{
+  size_t i = 0;
+
+  ctx->mt[0] = seed;
+  for( i = 1; i < ak_mt19937_nn; i++ )
+     ctx->mt[i] = 6364136223846793005ULL*( ctx->mt[i-1] ^ ( ctx->mt[i-1] >> 62 )) + i;
+  ctx->mti = ak_mt19937_nn;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Инициализация внутреннего состояния генератора массивом октетов.
+    \details Массив разбивается на 64-х битные слова (в порядке little endian; неполное
+    последнее слово дополняется нулями), которые обрабатываются так же, как функцией
+    init_by_array64 эталонной реализации.                                                         */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_random_mt19937_randomize_ptr( ak_random rnd, const ak_pointer ptr, const ssize_t size )
+{
+  ak_uint64 key;
+  ak_mt19937 ctx = NULL;
+  const ak_uint8 *value = ptr;
+  size_t i = 1, j = 0, k = 0, m = 0, len = 0;
+
+  if( rnd == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                      "use a null pointer to a random generator" );
+  if( ptr == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                          "use a null pointer to initial vector" );
+  if( size <= 0 ) return ak_error_message( ak_error_wrong_length, __func__ ,
+                                                          "use initial vector with wrong length" );
+  ctx = rnd->data.ctx;
+  len = (( size_t )size + 7 ) >> 3;
+  ak_random_mt19937_init( ctx, 19650218ULL );
+
+  for( k = ak_max( ak_mt19937_nn, len ); k; k-- ) {
+    /* формируем очередное слово ключа */
+     for( m = 0, key = 0; ( m < 8 ) && ( 8*j + m < ( size_t )size ); m++ )
+        key ^= (( ak_uint64 )value[8*j + m] ) << ( 8*m );
+     ctx->mt[i] = ( ctx->mt[i] ^ (( ctx->mt[i-1] ^ ( ctx->mt[i-1] >> 62 ))*3935559000370003845ULL ))
+                                                                                       + key + j;
+     i++; j++;
+     if( i >= ak_mt19937_nn ) { ctx->mt[0] = ctx->mt[ak_mt19937_nn-1]; i = 1; }
+     if( j >= len ) j = 0;
+  }
+  for( k = ak_mt19937_nn - 1; k; k-- ) {
+     ctx->mt[i] = ( ctx->mt[i] ^ (( ctx->mt[i-1] ^ ( ctx->mt[i-1] >> 62 ))*2862933555777941757ULL ))
+                                                                                            - i;
+     i++;
+     if( i >= ak_mt19937_nn ) { ctx->mt[0] = ctx->mt[ak_mt19937_nn-1]; i = 1; }
+  }
+  ctx->mt[0] = 1ULL << 63; /* ненулевой начальный массив */
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_random_mt19937_random( ak_random rnd, const ak_pointer ptr, const ssize_t size )
+{
+  ak_uint64 x;
+  ak_mt19937 ctx = NULL;
+  ak_uint8 *value = ptr;
+  ssize_t idx = 0, tail = 0;
+
+  if( rnd == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                      "use a null pointer to a random generator" );
+  if( ptr == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                                    "use a null pointer to data" );
+  if( size <= 0 ) return ak_error_message( ak_error_wrong_length, __func__ ,
+                                                           "use a data vector with wrong length" );
+  ctx = rnd->data.ctx;
+  tail = size&0x7;
+  for( idx = 0; idx < size - tail; idx += 8 ) {
+     x = ak_random_mt19937_value( ctx );
+     memcpy( value + idx, &x, 8 );
+  }
+  if( tail ) {
+    x = ak_random_mt19937_value( ctx );
+    memcpy( value + idx, &x, ( size_t )tail );
+  }
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_random_mt19937_free( ak_random rnd )
+{
+  if( rnd == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                     "use a null pointer to a random generator" );
+  if( rnd->data.ctx != NULL ) {
+    memset( rnd->data.ctx, 0, sizeof( struct mt19937 ));
+    free( rnd->data.ctx );
+    rnd->data.ctx = NULL;
+  }
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Генератор реализует 64-х битную версию алгоритма "Вихрь Мерсенна"
+    (M. Matsumoto, T. Nishimura, 1998), вырабатывающую последовательность с периодом
+    \f$ 2^{19937} - 1 \f$. Внутреннее состояние генератора (312 64-х битных слов) обновляется
+    целиком после выработки каждых 2496 октетов, что позволяет вырабатывать последовательности
+    большой длины без обращений к функциям библиотеки для каждого слова.
+
+    Выход генератора совпадает с выходом эталонной реализации (функции genrand64_int64),
+    64-х битные слова записываются в память в порядке little endian. При запросе
+    последовательности, длина которой не кратна восьми октетам, неиспользованные октеты
+    последнего слова отбрасываются.
+
+    Генератор не является криптографически стойким.
+
+    @param generator Контекст создаваемого генератора.
+    \return В случае успеха, функция возвращает \ref ak_error_ok. В противном случае
+            возвращается код ошибки.                                                               */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_random_create_mt19937( ak_random generator )
+{
+  int error = ak_error_ok;
+
+  if(( error = ak_random_create( generator )) != ak_error_ok )
+    return ak_error_message( error, __func__ , "wrong initialization of random generator" );
+  if(( generator->data.ctx = malloc( sizeof( struct mt19937 ))) == NULL )
+    return ak_error_message( ak_error_out_of_memory, __func__ ,
+                                                   "incorrect memory allocation for mt19937" );
+  generator->oid = ak_oid_find_by_name("mt19937-64");
+  generator->next = ak_random_mt19937_next;
+  generator->randomize_ptr = ak_random_mt19937_randomize_ptr;
+  generator->random = ak_random_mt19937_random;
+  generator->free = ak_random_mt19937_free;
+
+ /* для корректной работы присваиваем какое-то случайное начальное значение */
+  ak_random_mt19937_init( generator->data.ctx, ak_random_value( ));
+ return error;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*                                 реализация класса rng_file                                      */
 /* ----------------------------------------------------------------------------------------------- */
@@ -397,6 +747,442 @@
 #endif
 
 
+/* ----------------------------------------------------------------------------------------------- */
+/*                               реализация класса drbg-kuznechik                                  */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Размер буфера, из которого выдаются псевдо-случайные значения (в октетах). */
+ #define ak_drbg_buffer_size                 (4096)
+/*! \brief Размер ключевого материала, вырабатываемого для следующего обновления буфера:
+    32 октета ключа и 16 октетов, первые восемь из которых используются как синхропосылка. */
+ #define ak_drbg_seed_size                     (48)
+/*! \brief Количество обновлений буфера, после которого к ключевому материалу добавляется
+    энтропия, полученная от операционной системы. */
+ #define ak_drbg_reseed_interval              (256)
+/*! \brief Объем энтропии, считываемой из источника за одно обращение (в октетах). */
+ #define ak_drbg_entropy_size                (1536)
+
+/*! \brief Внутреннее состояние генератора drbg-kuznechik. */
+ typedef struct drbg {
+  /*! \brief ключ блочного шифра, используемый для выработки гаммы */
+   struct bckey key;
+  /*! \brief источник энтропии */
+   struct random source;
+  /*! \brief буфер выработанных значений, дополненный ключевым материалом */
+   ak_uint8 buffer[ak_drbg_buffer_size + ak_drbg_seed_size];
+  /*! \brief ключевой материал для следующего обновления буфера */
+   ak_uint8 seed[ak_drbg_seed_size];
+  /*! \brief запас энтропии */
+   ak_uint8 entropy[ak_drbg_entropy_size];
+  /*! \brief индекс первого невыданного октета буфера */
+   size_t offset;
+  /*! \brief индекс первого неиспользованного октета запаса энтропии */
+   size_t eoffset;
+  /*! \brief количество обновлений буфера, выполненных после последнего добавления энтропии */
+   size_t refills;
+  /*! \brief метка процесса, в котором было выработано текущее состояние генератора */
+   ak_uint64 mark;
+ } *ak_drbg;
+
+#ifdef AK_HAVE_PTHREAD_H
+/*! \brief Счетчик вызовов fork(), увеличиваемый в дочернем процессе. */
+ static volatile ak_uint64 drbg_fork_generation = 0;
+/*! \brief Флаг однократной регистрации обработчика fork(). */
+ static pthread_once_t drbg_atfork_once = PTHREAD_ONCE_INIT;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Обработчик, вызываемый в дочернем процессе после fork(). */
+ static void ak_random_drbg_atfork_child( void )
+{
+  drbg_fork_generation++;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_random_drbg_atfork_register( void )
+{
+  pthread_atfork( NULL, NULL, ak_random_drbg_atfork_child );
+}
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция возвращает метку текущего процесса: значение изменяется в дочернем процессе,
+    созданном вызовом fork(), что позволяет обнаружить копирование состояния генератора. */
+/* ----------------------------------------------------------------------------------------------- */
+ static ak_uint64 ak_random_drbg_process_mark( void )
+{
+#ifdef AK_HAVE_PTHREAD_H
+ return drbg_fork_generation;
+#else
+ #ifndef _WIN32
+  return ( ak_uint64 ) getpid();
+ #else
+  return ( ak_uint64 ) _getpid();
+ #endif
+#endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция добавляет энтропию к ключевому материалу генератора. */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_random_drbg_reseed( ak_drbg ctx )
+{
+  size_t i = 0;
+  int error = ak_error_ok;
+
+  if( ctx->eoffset + ak_drbg_seed_size > ak_drbg_entropy_size ) {
+    if(( error = ak_random_ptr( &ctx->source, ctx->entropy, ak_drbg_entropy_size )) != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect reading of entropy" );
+    ctx->eoffset = 0;
+  }
+  for( i = 0; i < ak_drbg_seed_size; i++ ) ctx->seed[i] ^= ctx->entropy[ctx->eoffset + i];
+  memset( ctx->entropy + ctx->eoffset, 0, ak_drbg_seed_size );
+  ctx->eoffset += ak_drbg_seed_size;
+  ctx->refills = 0;
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вырабатывает новое содержимое буфера.
+    \details Ключ блочного шифра заменяется значением, выработанным при предыдущем обновлении
+    буфера; после выработки гаммы последние \ref ak_drbg_seed_size октетов буфера
+    используются как ключевой материал для следующего обновления и удаляются из буфера.
+    Таким образом, по текущему состоянию генератора не могут быть восстановлены
+    ранее выданные значения.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_random_drbg_refill( ak_drbg ctx )
+{
+  int error = ak_error_ok;
+
+  if( ctx->refills >= ak_drbg_reseed_interval ) {
+    if(( error = ak_random_drbg_reseed( ctx )) != ak_error_ok ) return error;
+  }
+  if(( error = ak_bckey_rekey( &ctx->key, ctx->seed, 32 )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect updating of secret key" );
+  ctx->key.key.resource.value.type = key_using_resource;
+  ctx->key.key.resource.value.counter = ( ak_drbg_buffer_size + ak_drbg_seed_size )/16;
+  if(( error = ak_bckey_ctr_keystream( &ctx->key, ctx->buffer,
+                          sizeof( ctx->buffer ), ctx->seed + 32, 8 )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect generation of keystream" );
+
+  memcpy( ctx->seed, ctx->buffer + ak_drbg_buffer_size, ak_drbg_seed_size );
+  memset( ctx->buffer + ak_drbg_buffer_size, 0, ak_drbg_seed_size );
+  ctx->offset = 0;
+  ctx->refills++;
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция проверяет, что состояние генератора не было скопировано в дочерний процесс.
+    \details В противном случае буфер и запас энтропии, совпадающие с родительским процессом,
+    удаляются, а ключевой материал обновляется энтропией, полученной от операционной системы. */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_random_drbg_check_process( ak_drbg ctx )
+{
+  ak_uint64 mark = ak_random_drbg_process_mark();
+
+  if( ctx->mark == mark ) return ak_error_ok;
+  memset( ctx->buffer, 0, sizeof( ctx->buffer ));
+  memset( ctx->entropy, 0, sizeof( ctx->entropy ));
+  ctx->eoffset = ak_drbg_entropy_size;
+  ctx->refills = ak_drbg_reseed_interval;
+  ctx->mark = mark;
+
+ return ak_random_drbg_refill( ctx );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_random_drbg_random( ak_random rnd, const ak_pointer ptr, const ssize_t size )
+{
+  size_t len = 0, done = 0;
+  ak_uint8 *value = ptr;
+  ak_drbg ctx = NULL;
+  int error = ak_error_ok;
+
+  if( rnd == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                      "use a null pointer to a random generator" );
+  if( ptr == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                                    "use a null pointer to data" );
+  if( size <= 0 ) return ak_error_message( ak_error_wrong_length, __func__ ,
+                                                           "use a data vector with wrong length" );
+  ctx = rnd->data.ctx;
+  if(( error = ak_random_drbg_check_process( ctx )) != ak_error_ok ) return error;
+  while( done < ( size_t )size ) {
+    if( ctx->offset == ak_drbg_buffer_size ) {
+      if(( error = ak_random_drbg_refill( ctx )) != ak_error_ok ) return error;
+    }
+    len = ak_min(( size_t )size - done, ak_drbg_buffer_size - ctx->offset );
+    memcpy( value + done, ctx->buffer + ctx->offset, len );
+   /* выданные значения удаляются из буфера */
+    memset( ctx->buffer + ctx->offset, 0, len );
+    ctx->offset += len;
+    done += len;
+  }
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция добавляет заданные данные к ключевому материалу генератора и
+    обновляет буфер. */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_random_drbg_randomize_ptr( ak_random rnd, const ak_pointer ptr, const ssize_t size )
+{
+  ssize_t idx = 0;
+  ak_drbg ctx = NULL;
+  const ak_uint8 *value = ptr;
+
+  if( rnd == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                      "use a null pointer to a random generator" );
+  if( ptr == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                          "use a null pointer to initial vector" );
+  if( size <= 0 ) return ak_error_message( ak_error_wrong_length, __func__ ,
+                                                          "use initial vector with wrong length" );
+  ctx = rnd->data.ctx;
+  if( ak_random_drbg_check_process( ctx ) != ak_error_ok )
+    return ak_error_message( ak_error_get_value(), __func__ , "incorrect reseeding after fork" );
+  for( idx = 0; idx < size; idx++ ) ctx->seed[idx%ak_drbg_seed_size] ^= value[idx];
+  memset( ctx->buffer, 0, ak_drbg_buffer_size );
+
+ return ak_random_drbg_refill( ctx );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_random_drbg_free( ak_random rnd )
+{
+  ak_drbg ctx = NULL;
+
+  if( rnd == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                     "use a null pointer to a random generator" );
+  if(( ctx = rnd->data.ctx ) != NULL ) {
+    ak_bckey_destroy( &ctx->key );
+    ak_random_destroy( &ctx->source );
+    memset( ctx, 0, sizeof( struct drbg ));
+    free( ctx );
+    rnd->data.ctx = NULL;
+  }
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Генератор вырабатывает псевдо-случайную последовательность с помощью блочного шифра
+    "Кузнечик" в режиме гаммирования, следуя схеме генераторов на основе блочных шифров из
+    рекомендаций по стандартизации Р 1323565.1.006-2017: после выработки каждого блока
+    из 4096 октетов ключ шифрования и синхропосылка заменяются значениями, выработанными
+    на предыдущем ключе (см. функцию ak_random_drbg_refill()).
+
+    Запросы на выработку данных обслуживаются из внутреннего буфера, поэтому запросы малой длины
+    (например, при выработке масок секретных ключей) не приводят к обращениям к
+    операционной системе. Энтропия, получаемая от операционной системы (из /dev/urandom или
+    с помощью функции CryptGenRandom()), считывается блоками по 1536 октетов и добавляется к
+    ключевому материалу при создании генератора и после каждых 256 обновлений буфера
+    (т.е. после выработки одного мегабайта данных).
+
+    Контекст генератора не может одновременно использоваться несколькими потоками;
+    для многопоточных приложений предназначен генератор, создаваемый функцией
+    ak_random_create_drbg_thread().
+
+    @param generator Контекст создаваемого генератора.
+    \return В случае успеха, функция возвращает \ref ak_error_ok. В противном случае
+            возвращается код ошибки.                                                               */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_random_create_drbg( ak_random generator )
+{
+  ak_drbg ctx = NULL;
+  int error = ak_error_ok;
+
+  if(( error = ak_random_create( generator )) != ak_error_ok )
+    return ak_error_message( error, __func__ , "wrong initialization of random generator" );
+  /* структура содержит ключ блочного шифра и должна быть выровнена */
+  if(( ctx = ak_aligned_malloc( sizeof( struct drbg ))) == NULL )
+    return ak_error_message( ak_error_out_of_memory, __func__ ,
+                                                      "incorrect memory allocation for drbg" );
+  memset( ctx, 0, sizeof( struct drbg ));
+ #ifdef AK_HAVE_PTHREAD_H
+  pthread_once( &drbg_atfork_once, ak_random_drbg_atfork_register );
+ #endif
+  ctx->mark = ak_random_drbg_process_mark();
+  generator->data.ctx = ctx;
+  generator->free = ak_random_drbg_free;
+
+ /* источник энтропии */
+ #if defined(__unix__) || defined(__APPLE__)
+  error = ak_random_create_urandom( &ctx->source );
+ #else
+  #ifdef _WIN32
+   error = ak_random_create_winrtl( &ctx->source );
+  #else
+   error = ak_random_create_lcg( &ctx->source );
+  #endif
+ #endif
+  if( error != ak_error_ok ) {
+    ak_error_message( error, __func__ , "incorrect creation of entropy source" );
+    goto labex;
+  }
+  if(( error = ak_bckey_create_kuznechik( &ctx->key )) != ak_error_ok ) {
+    ak_error_message( error, __func__ , "incorrect creation of secret key" );
+    goto labex;
+  }
+
+ /* первое обновление буфера выполняется с добавлением энтропии */
+  ctx->eoffset = ak_drbg_entropy_size;
+  ctx->refills = ak_drbg_reseed_interval;
+  if(( error = ak_random_drbg_refill( ctx )) != ak_error_ok ) {
+    ak_error_message( error, __func__ , "incorrect initialization of drbg buffer" );
+    goto labex;
+  }
+
+  generator->oid = ak_oid_find_by_name("drbg-kuznechik");
+  generator->next = NULL;
+  generator->randomize_ptr = ak_random_drbg_randomize_ptr;
+  generator->random = ak_random_drbg_random;
+
+ return ak_error_ok;
+
+  labex:
+   ak_random_destroy( generator );
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                      генератор, использующий экземпляр drbg потока                              */
+/* ----------------------------------------------------------------------------------------------- */
+#ifdef AK_HAVE_PTHREAD_H
+/*! \brief Ключ, по которому каждый поток хранит собственный экземпляр генератора. */
+ static pthread_key_t drbg_thread_key;
+/*! \brief Флаг однократного создания ключа drbg_thread_key. */
+ static pthread_once_t drbg_thread_once = PTHREAD_ONCE_INIT;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция удаляет экземпляр генератора при завершении потока. */
+ static void ak_random_drbg_thread_free( void *ptr )
+{
+  if( ptr != NULL ) ak_random_delete( ptr );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_random_drbg_thread_key_create( void )
+{
+  pthread_key_create( &drbg_thread_key, ak_random_drbg_thread_free );
+}
+#else
+/*! \brief Экземпляр генератора, используемый при отсутствии поддержки потоков. */
+ static ak_random drbg_thread_instance = NULL;
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция возвращает экземпляр генератора drbg-kuznechik, принадлежащий текущему потоку;
+    при первом обращении экземпляр создается.                                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ static ak_random ak_random_drbg_thread_instance( void )
+{
+  ak_random rnd = NULL;
+  int error = ak_error_ok;
+
+ #ifdef AK_HAVE_PTHREAD_H
+  pthread_once( &drbg_thread_once, ak_random_drbg_thread_key_create );
+  if(( rnd = pthread_getspecific( drbg_thread_key )) != NULL ) return rnd;
+ #else
+  if(( rnd = drbg_thread_instance ) != NULL ) return rnd;
+ #endif
+
+  if(( rnd = malloc( sizeof( struct random ))) == NULL ) {
+    ak_error_message( ak_error_out_of_memory, __func__ , "incorrect memory allocation" );
+    return NULL;
+  }
+  if(( error = ak_random_create_drbg( rnd )) != ak_error_ok ) {
+    ak_error_message( error, __func__ , "incorrect creation of thread's drbg" );
+    free( rnd );
+    return NULL;
+  }
+ #ifdef AK_HAVE_PTHREAD_H
+  pthread_setspecific( drbg_thread_key, rnd );
+ #else
+  drbg_thread_instance = rnd;
+ #endif
+
+ return rnd;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_random_drbg_thread_random( ak_random rnd, const ak_pointer ptr, const ssize_t size )
+{
+  ak_random instance = ak_random_drbg_thread_instance();
+
+  if( rnd == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                      "use a null pointer to a random generator" );
+  if( instance == NULL ) return ak_error_message( ak_error_get_value(), __func__ ,
+                                                         "using undefined drbg of current thread" );
+ return ak_random_drbg_random( instance, ptr, size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_random_drbg_thread_randomize_ptr( ak_random rnd,
+                                                         const ak_pointer ptr, const ssize_t size )
+{
+  ak_random instance = ak_random_drbg_thread_instance();
+
+  if( rnd == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                      "use a null pointer to a random generator" );
+  if( instance == NULL ) return ak_error_message( ak_error_get_value(), __func__ ,
+                                                         "using undefined drbg of current thread" );
+ return ak_random_drbg_randomize_ptr( instance, ptr, size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Контекст генератора не содержит собственного внутреннего состояния: каждый запрос
+    обслуживается экземпляром генератора drbg-kuznechik (см. ak_random_create_drbg()),
+    принадлежащим вызывающему потоку. Экземпляр создается при первом запросе, выполненном
+    потоком, и удаляется при завершении потока. Поэтому один контекст может одновременно
+    использоваться несколькими потоками без блокировок, а запросы не приводят к
+    обращениям к операционной системе (кроме периодического добавления энтропии).
+
+    @param generator Контекст создаваемого генератора.
+    \return В случае успеха, функция возвращает \ref ak_error_ok. В противном случае
+            возвращается код ошибки.                                                               */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_random_create_drbg_thread( ak_random generator )
+{
+  int error = ak_error_ok;
+
+  if(( error = ak_random_create( generator )) != ak_error_ok )
+    return ak_error_message( error, __func__ , "wrong initialization of random generator" );
+  if( ak_random_drbg_thread_instance() == NULL )
+    return ak_error_message( ak_error_get_value(), __func__ ,
+                                                         "using undefined drbg of current thread" );
+  generator->oid = ak_oid_find_by_name("drbg-kuznechik-thread");
+  generator->next = NULL;
+  generator->randomize_ptr = ak_random_drbg_thread_randomize_ptr;
+  generator->random = ak_random_drbg_thread_random;
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция удаляет экземпляр генератора drbg-kuznechik, принадлежащий текущему потоку
+    (если он был создан). Вызывается при завершении работы с библиотекой, поскольку для
+    основного потока программы функция очистки, связанная с ключом потока, не вызывается.
+
+    \return Функция возвращает \ref ak_error_ok (ноль).                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_random_drbg_thread_destroy( void )
+{
+ #ifdef AK_HAVE_PTHREAD_H
+  ak_random rnd = NULL;
+
+  pthread_once( &drbg_thread_once, ak_random_drbg_thread_key_create );
+  if(( rnd = pthread_getspecific( drbg_thread_key )) != NULL ) {
+    pthread_setspecific( drbg_thread_key, NULL );
+    ak_random_delete( rnd );
+  }
+ #else
+  if( drbg_thread_instance != NULL ) drbg_thread_instance = ak_random_delete( drbg_thread_instance );
+ #endif
+
+ return ak_error_ok;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*                                 реализация класса rng_winrtl                                    */
 /* ----------------------------------------------------------------------------------------------- */
@@ -473,36 +1259,86 @@
 #endif
 
 /* ----------------------------------------------------------------------------------------------- */
-/*! Функция заполняет заданную область памяти случайными данными, выработанными заданным
-    генератором псевдослучайных чисел. Генератор должен быть предварительно корректно
-    инициализирован с помощью функции вида `ak_random_create_...()`.
+/*! \brief Значение опции `wipe_with_random`, используемое функцией ak_ptr_wipe();
+    обновляется при каждом изменении значения опции. */
+ static volatile bool_t ak_ptr_wipe_with_random = ak_false;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вызывается из ak_libakrypt_set_option() при изменении значения
+    опции `wipe_with_random` (в том числе при чтении файла с настройками библиотеки).
+
+    @param flag Новое значение опции.                                                              */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_ptr_wipe_set_with_random( const bool_t flag )
+{
+  ak_ptr_wipe_with_random = flag;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+#if !defined(__GNUC__) && !defined(__clang__)
+/*! \brief Указатель на функцию memset(), значение которого не может быть вычислено
+    компилятором; используется для того, чтобы вызов не был удален при оптимизации. */
+ static void *( *volatile ak_ptr_wipe_memset )( void *, int, size_t ) = memset;
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Барьер, запрещающий компилятору удалять запись в область памяти `ptr`,
+    даже если эта область памяти далее не используется (аналог explicit_bzero()). */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_ptr_wipe_barrier( ak_pointer ptr )
+{
+#if defined(__GNUC__) || defined(__clang__)
+  __asm__ __volatile__( "" : : "r"( ptr ) : "memory" );
+#else
+  (void)ptr;
+#endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция уничтожает содержимое заданной области памяти. Способ уничтожения определяется
+    опцией библиотеки `wipe_with_random`:
+
+     - при нулевом значении опции (значение по-умолчанию) область памяти обнуляется;
+     - при ненулевом значении опции область памяти заполняется случайными данными,
+       выработанными заданным генератором псевдослучайных чисел. Генератор должен быть
+       предварительно корректно инициализирован с помощью функции вида `ak_random_create_...()`.
+
+    В обоих случаях после записи выполняется барьер, запрещающий компилятору удалять
+    запись в память, которая далее не используется, поэтому стоимость очистки определяется
+    скоростью записи в память (и, при использовании генератора, скоростью его работы).
+    Если генератор не задан, то область памяти обнуляется.
 
     @param ptr Область данных, которая заполняется случайным мусором.
     @param size Размер заполняемой области в байтах.
-    @param generator Генератор псевдо-случайных чисел, используемый для генерации случайного мусора.
-    @param readflag Булева переменная, отвечающая за обязательное чтение сгенерированных данных.
-    В большинстве случаев должна принимать истинное значение.
+    @param rnd Генератор псевдо-случайных чисел, используемый для генерации случайного мусора.
     @return Функция возвращает \ref ak_error_ok (ноль) в случае успешного уничтожения данных.
     В противном случае возвращается код ошибки.                                                    */
 /* ----------------------------------------------------------------------------------------------- */
  int ak_ptr_wipe( ak_pointer ptr, size_t size, ak_random rnd )
 {
-  size_t idx = 0;
-  if( rnd == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
-                                                "using null pointer to random generator context" );
-  if( rnd->random == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
-                                                  "using uninitialized random generator context" );
+  int error = ak_error_ok;
+
   if( size > (((size_t)-1) >> 1 )) return ak_error_message( ak_error_wrong_length, __func__,
                                                                    "using very large size value" );
   if(( ptr == NULL ) || ( size == 0 )) return ak_error_ok;
 
-  if( rnd->random( rnd, ptr, (ssize_t) size ) != ak_error_ok ) {
+  if(( rnd != NULL ) && ( rnd->random != NULL ) && ak_ptr_wipe_with_random ) {
+    if(( error = rnd->random( rnd, ptr, (ssize_t) size )) != ak_error_ok )
+      ak_error_message( error = ak_error_write_data, __func__, "incorrect memory wiping" );
+  } else error = ak_error_undefined_value;
+
+ /* если случайные данные не использовались, то просто обнуляем память */
+  if( error != ak_error_ok ) {
+   #if defined(__GNUC__) || defined(__clang__)
     memset( ptr, 0, size );
-    return ak_error_message( ak_error_write_data, __func__, "incorrect memory wiping" );
+   #else
+    ak_ptr_wipe_memset( ptr, 0, size );
+   #endif
+    if( error == ak_error_undefined_value ) error = ak_error_ok;
   }
- /* запись в память при чтении => необходим вызов функции чтения данных из ptr */
-  for( idx = 0; idx < size; idx++ ) ((ak_uint8 *)ptr)[idx] += ((ak_uint8 *)ptr)[size - 1 - idx];
- return ak_error_ok;
+  ak_ptr_wipe_barrier( ptr );
+
+ return error;
 }
 
 /* ----------------------------------------------------------------------------------------------- */
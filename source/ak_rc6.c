@@ -21,11 +21,14 @@ static const ak_uint32 ak_rc6_lg_w = 5;
 /*                                Вспомогательные функции                                          */
 /* ----------------------------------------------------------------------------------------------- */
 static ak_uint32 ak_rc6_left_bit_cicl_shift(ak_uint32 val, ak_uint32 bit_count){
-    return (val << bit_count) | (val >> (32 - bit_count));
+    /* величина сдвига определяется младшими lg_w битами */
+    bit_count &= 0x1f;
+    return (val << bit_count) | (val >> ((32 - bit_count) & 0x1f));
 }
 /* ----------------------------------------------------------------------------------------------- */
 static ak_uint32 ak_rc6_right_bit_cicl_shift(ak_uint32 val, ak_uint32 bit_count){
-    return (val >> bit_count) | (val << (32 - bit_count));
+    bit_count &= 0x1f;
+    return (val >> bit_count) | (val << ((32 - bit_count) & 0x1f));
 }
 /* ----------------------------------------------------------------------------------------------- */
 /* ----------------------------------------------------------------------------------------------- */
@@ -51,7 +54,7 @@ static int ak_rc6_delete_keys( ak_skey skey )
             ak_error_message( error, __func__, "incorrect wiping an internal data" );
             memset( skey->data, 0, sizeof( ak_rc6_expanded_keys ));
         }
-        free( skey->data );
+        ak_skey_pool_free( skey->data );
         skey->data = NULL;
     }
     return error;
@@ -78,7 +81,7 @@ static int ak_rc6_schedule_keys( ak_skey skey )
     if( skey->data != NULL ) ak_rc6_delete_keys( skey );
 
     /* далее, по-возможности, выделяем выравненную память */
-    if(( skey->data = ak_aligned_malloc( sizeof( ak_rc6_expanded_keys ))) == NULL )
+    if(( skey->data = ak_skey_alloc_data( skey, sizeof( ak_rc6_expanded_keys ))) == NULL )
         return ak_error_message( ak_error_out_of_memory, __func__ ,
                                  "wrong allocation of internal data" );
 
@@ -159,6 +162,92 @@ static void ak_rc6_decrypt( ak_skey skey, ak_pointer in, ak_pointer out )
     ((ak_uint32 *)out)[3] = D;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Количество блоков, обрабатываемых одновременно. */
+#define ak_rc6_blocks_batch (4)
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция реализует алгоритм зашифрования нескольких последовательно расположенных
+    блоков информации шифром RC6; раунды для групп из ak_rc6_blocks_batch блоков
+    выполняются одновременно.                                                                      */
+/* ----------------------------------------------------------------------------------------------- */
+static void ak_rc6_encrypt_blocks( ak_skey skey, ak_pointer in, ak_pointer out, size_t blocks )
+{
+    int i = 0, k = 0;
+    ak_uint32 *keys = (ak_uint32*)skey->data;
+    ak_uint32 *inptr = (ak_uint32 *)in, *outptr = (ak_uint32 *)out;
+    ak_uint32 A[ak_rc6_blocks_batch], B[ak_rc6_blocks_batch],
+              C[ak_rc6_blocks_batch], D[ak_rc6_blocks_batch], t, u, tmp;
+
+    for( ; blocks >= ak_rc6_blocks_batch; blocks -= ak_rc6_blocks_batch ) {
+        for( k = 0; k < ak_rc6_blocks_batch; k++ ) {
+            A[k] = inptr[4*k]; B[k] = inptr[4*k+1] + keys[0];
+            C[k] = inptr[4*k+2]; D[k] = inptr[4*k+3] + keys[1];
+        }
+        for( i = 1; i <= ak_rc6_rounds; ++i ) {
+            for( k = 0; k < ak_rc6_blocks_batch; k++ ) {
+                t = ak_rc6_left_bit_cicl_shift((B[k] * (2 * B[k] + 1)), ak_rc6_lg_w);
+                u = ak_rc6_left_bit_cicl_shift((D[k] * (2 * D[k] + 1)), ak_rc6_lg_w);
+                tmp = ak_rc6_left_bit_cicl_shift(A[k] ^ t, u) + keys[2 * i];
+                A[k] = B[k];
+                B[k] = ak_rc6_left_bit_cicl_shift(C[k] ^ u, t) + keys[2 * i + 1];
+                C[k] = D[k]; D[k] = tmp;
+            }
+        }
+        for( k = 0; k < ak_rc6_blocks_batch; k++ ) {
+            outptr[4*k] = A[k] + keys[2 * ak_rc6_rounds + 2];
+            outptr[4*k+1] = B[k];
+            outptr[4*k+2] = C[k] + keys[2 * ak_rc6_rounds + 3];
+            outptr[4*k+3] = D[k];
+        }
+        inptr += 4*ak_rc6_blocks_batch; outptr += 4*ak_rc6_blocks_batch;
+    }
+    for( ; blocks > 0; blocks-- ) {
+        ak_rc6_encrypt( skey, inptr, outptr );
+        inptr += 4; outptr += 4;
+    }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция реализует алгоритм расшифрования нескольких последовательно расположенных
+    блоков информации шифром RC6.                                                                  */
+/* ----------------------------------------------------------------------------------------------- */
+static void ak_rc6_decrypt_blocks( ak_skey skey, ak_pointer in, ak_pointer out, size_t blocks )
+{
+    int i = 0, k = 0;
+    ak_uint32 *keys = (ak_uint32*)skey->data;
+    ak_uint32 *inptr = (ak_uint32 *)in, *outptr = (ak_uint32 *)out;
+    ak_uint32 A[ak_rc6_blocks_batch], B[ak_rc6_blocks_batch],
+              C[ak_rc6_blocks_batch], D[ak_rc6_blocks_batch], t, u, tmp;
+
+    for( ; blocks >= ak_rc6_blocks_batch; blocks -= ak_rc6_blocks_batch ) {
+        for( k = 0; k < ak_rc6_blocks_batch; k++ ) {
+            A[k] = inptr[4*k] - keys[2 * ak_rc6_rounds + 2]; B[k] = inptr[4*k+1];
+            C[k] = inptr[4*k+2] - keys[2 * ak_rc6_rounds + 3]; D[k] = inptr[4*k+3];
+        }
+        for( i = ak_rc6_rounds; i >= 1; --i ) {
+            for( k = 0; k < ak_rc6_blocks_batch; k++ ) {
+                tmp = D[k]; D[k] = C[k]; C[k] = B[k]; B[k] = A[k]; A[k] = tmp;
+                u = ak_rc6_left_bit_cicl_shift(D[k] * (2 * D[k] + 1), ak_rc6_lg_w);
+                t = ak_rc6_left_bit_cicl_shift(B[k] * (2 * B[k] + 1), ak_rc6_lg_w);
+                C[k] = ak_rc6_right_bit_cicl_shift(C[k] - keys[2 * i + 1], t) ^ u;
+                A[k] = ak_rc6_right_bit_cicl_shift(A[k] - keys[2 * i], u) ^ t;
+            }
+        }
+        for( k = 0; k < ak_rc6_blocks_batch; k++ ) {
+            outptr[4*k] = A[k];
+            outptr[4*k+1] = B[k] - keys[0];
+            outptr[4*k+2] = C[k];
+            outptr[4*k+3] = D[k] - keys[1];
+        }
+        inptr += 4*ak_rc6_blocks_batch; outptr += 4*ak_rc6_blocks_batch;
+    }
+    for( ; blocks > 0; blocks-- ) {
+        ak_rc6_decrypt( skey, inptr, outptr );
+        inptr += 4; outptr += 4;
+    }
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 
 /*! После инициализации устанавливаются обработчики (функции класса). Однако само значение
@@ -197,10 +286,14 @@ int ak_bckey_create_rc6( ak_bckey bkey )
     if( oc ) {
         bkey->encrypt = ak_rc6_encrypt;
         bkey->decrypt = ak_rc6_decrypt;
+        bkey->encrypt_blocks = ak_rc6_encrypt_blocks;
+        bkey->decrypt_blocks = ak_rc6_decrypt_blocks;
     }
     else {
         bkey->encrypt = ak_rc6_encrypt;
         bkey->decrypt = ak_rc6_decrypt;
+        bkey->encrypt_blocks = ak_rc6_encrypt_blocks;
+        bkey->decrypt_blocks = ak_rc6_decrypt_blocks;
     }
     return error;
 }
@@ -245,6 +245,9 @@
 
    if( sk == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
                                     "using null pointer to digital signature secret key context" );
+   if( !ak_libakrypt_control_test_on_first_use( asymmetric_control_test ))
+     return ak_error_message( ak_error_control_test, __func__,
+                                         "incorrect dynamic control of digital signatures" );
   /* первичная инициализация */
    memset( sk, 0, sizeof( struct signkey ));
 
@@ -807,6 +810,9 @@
   if( ak_oid_find_by_data( wc ) == NULL )
     return ak_error_message( ak_error_null_pointer, __func__ ,
                                           "using unsearchable pointer to elliptic curve context" );
+  if( !ak_libakrypt_control_test_on_first_use( asymmetric_control_test ))
+    return ak_error_message( ak_error_control_test, __func__,
+                                         "incorrect dynamic control of digital signatures" );
  /* очищаем контекст,
     в частности, здесь обнуляется номер открытого ключа */
   memset( pctx, 0, sizeof( struct verifykey ));
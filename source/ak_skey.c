@@ -28,16 +28,129 @@
 #ifdef AK_HAVE_PTHREAD_H
  #include <pthread.h>
 #endif
+#ifdef AK_HAVE_UNISTD_H
+ #include <unistd.h>
+#endif
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Переменная определяет порядковый номер ключа в рамках одной сессии.
     Использование этой переменной помогает избежать одновременной генерации ключей при
     многопоточной реализации. */
- static ak_uint32 session_unique_number = 0;
+ static ak_uint64 session_unique_number = 0;
+/*! \brief Базовое значение, из которого вырабатываются уникальные номера в рамках одной сессии. */
+ static ak_uint8 session_unique_base[32];
+/*! \brief Флаг того, что базовое значение уникальных номеров выработано. */
+ static bool_t session_unique_base_ready = ak_false;
 #ifdef AK_HAVE_PTHREAD_H
  static pthread_mutex_t session_unique_number_mutex = PTHREAD_MUTEX_INITIALIZER;
+/*! \brief Флаг однократной регистрации обработчика fork(). */
+ static pthread_once_t session_unique_atfork_once = PTHREAD_ONCE_INIT;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Обработчик, вызываемый в дочернем процессе после fork().
+    \details Дочерний процесс наследует базовое значение и счетчик родительского процесса,
+    поэтому без повторной выработки базового значения оба процесса создавали бы ключи
+    с одинаковыми номерами. Базовое значение зависит от номера процесса и будет выработано
+    заново при следующем вызове ak_libakrypt_generate_unique_number().                            */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_libakrypt_unique_number_atfork_child( void )
+{
+  pthread_mutex_init( &session_unique_number_mutex, NULL );
+  session_unique_base_ready = ak_false;
+  session_unique_number = 0;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_libakrypt_unique_number_atfork_register( void )
+{
+  pthread_atfork( NULL, NULL, ak_libakrypt_unique_number_atfork_child );
+}
+#else
+ #ifdef AK_HAVE_UNISTD_H
+/*! \brief Номер процесса, в котором было выработано базовое значение. */
+  static pid_t session_unique_pid = 0;
+ #endif
 #endif
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Пул выровненных блоков памяти для хранения ключевой информации.
+
+    Блоки памяти разбиты на классы, размер блока класса с номером `i` равен `64*2^i` октетов.
+    Освобожденные блоки (после их очистки) не возвращаются операционной системе, а сохраняются
+    в односвязных списках и выдаются повторно при последующих запросах. Максимальное количество
+    хранимых блоков каждого класса определяется опцией `skey_pool_size`.                           */
+/* ----------------------------------------------------------------------------------------------- */
+ #define ak_skey_pool_classes_count       (7)
+ #define ak_skey_pool_class_none     (0xffffffff)
+
+/*! \brief Заголовок блока памяти, размещаемый непосредственно перед выдаваемой областью. */
+ typedef union skey_pool_header {
+  struct {
+   /*! \brief Следующий свободный блок того же класса. */
+    union skey_pool_header *next;
+   /*! \brief Номер класса, к которому относится блок. */
+    ak_uint32 index;
+   /*! \brief Размер отдельного отображения памяти (только для больших блоков защищенной кучи). */
+    size_t size;
+  } value;
+  /*! \brief Выравнивание заголовка. */
+   ak_uint8 padding[32];
+ } *ak_skey_pool_header;
+
+ static struct skey_pool {
+  /*! \brief Списки свободных блоков. */
+   ak_skey_pool_header head[ak_skey_pool_classes_count];
+  /*! \brief Количество блоков в каждом из списков. */
+   size_t count[ak_skey_pool_classes_count];
+ } skey_pool = {{ NULL }, { 0 }};
+#ifdef AK_HAVE_PTHREAD_H
+ static pthread_mutex_t skey_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Защищенная куча для хранения ключевой информации.
+
+    Память выделяется крупными областями (аренами), которые закрепляются в оперативной памяти
+    вызовом mlock(), исключаются из дампов памяти (MADV_DONTDUMP) и окружаются страницами,
+    доступ к которым запрещен. Из арены блоки нарезаются последовательно, используя те же классы,
+    что и пул \ref skey_pool; освобожденные блоки хранятся в собственных списках и никогда
+    не возвращаются операционной системе до завершения работы с библиотекой.
+    Блоки, размер которых превышает размер максимального класса, размещаются в отдельных
+    защищенных отображениях памяти.                                                                */
+/* ----------------------------------------------------------------------------------------------- */
+ #define ak_skey_secure_flag              (0x00000100)
+ #define ak_skey_secure_class_large       (0x000001ff)
+ #define ak_skey_secure_arena_size         (262144)
+
+/*! \brief Заголовок арены, размещаемый в начале ее закрепленной области. */
+ typedef union skey_secure_arena {
+  struct {
+   /*! \brief Следующая арена. */
+    union skey_secure_arena *next;
+   /*! \brief Полный размер отображения памяти (включая защитные страницы). */
+    size_t size;
+  } value;
+  /*! \brief Выравнивание заголовка. */
+   ak_uint8 padding[64];
+ } *ak_skey_secure_arena;
+
+ static struct skey_secure_heap {
+  /*! \brief Списки свободных блоков. */
+   ak_skey_pool_header head[ak_skey_pool_classes_count];
+  /*! \brief Список выделенных арен. */
+   ak_skey_secure_arena arenas;
+  /*! \brief Указатель на начало нераспределенной части текущей арены. */
+   ak_uint8 *ptr;
+  /*! \brief Размер нераспределенной части текущей арены. */
+   size_t left;
+  /*! \brief Количество выданных и не возвращенных блоков. */
+   size_t used;
+  /*! \brief Размер страницы памяти. */
+   size_t page;
+  /*! \brief Флаг того, что сообщение о невозможности закрепления памяти уже выводилось. */
+   bool_t warned;
+ } skey_secure_heap = {{ NULL }, NULL, NULL, 0, 0, 0, ak_false };
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \param rt Тип криптографического ресурса.
     \return Функция возвращает константную строку на человеко читаемое имя ключеовго ресурса.      */
@@ -53,28 +166,21 @@
 }
 
 /* ----------------------------------------------------------------------------------------------- */
-/*! Выработанный функцией номер является уникальным (в рамках библиотеки) и может однозначно
-    идентифицировать некоторый объект, например, секретный ключ.
-
-    \param data вектор, куда помещается номер
-    \param size размер вектора (в октетах); данная величина не должна превосходить 32-х.
+/*! \brief Функция вырабатывает базовое значение для уникальных номеров текущей сессии.
+    \param hm массив, куда помещается результат; длина массива должна быть равна 32 октетам.
     \return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае,
     возвращается номер ошибки.                                                                     */
 /* ----------------------------------------------------------------------------------------------- */
- int ak_libakrypt_generate_unique_number( ak_pointer data, const size_t size )
+ static int ak_libakrypt_generate_unique_base( ak_uint8 *hm )
 {
   time_t tm = 0;
   size_t len = 0;
   struct hash ctx;
-  ak_uint8 out[64], hm[32];
+  ak_uint8 out[64];
   ak_uint64 rvalue = 0;
   int error = ak_error_ok;
   const char *version =  ak_libakrypt_version();
 
-  if( data == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
-                                                           "using null pointer to result buffer" );
-  if( !size ) return ak_error_message( ak_error_zero_length, __func__,
-                                                                 "using buffer with zero length" );
   if(( error = ak_hash_create_streebog256( &ctx )) != ak_error_ok )
     return ak_error_message( error, __func__ , "wrong creation of hash function context" );
 
@@ -85,19 +191,6 @@
   if(( len = strlen( version )) > sizeof( out )) goto run_point;
   memcpy( out, version, len ); /* сначала версия библиотеки */
 
- /* добавляем уникальный номер ключа в рамках теущей сессии
-    это не позволит в один интервал времени создать более одного ключа с одинаковым номером */
-  if( len + 2 > sizeof( out )) goto run_point;
-#ifdef AK_HAVE_PTHREAD_H
-  pthread_mutex_lock( &session_unique_number_mutex );
-#endif
-  session_unique_number++;
-#ifdef AK_HAVE_PTHREAD_H
-  pthread_mutex_unlock( &session_unique_number_mutex );
-#endif
-  memcpy( out+len, &session_unique_number, sizeof( ak_uint32 )); /* потом время генерации номера ключа */
-  len += sizeof( ak_uint32 );
-
  /* заполняем стандартное начало вектора: текущее время */
   if( len + sizeof( time_t ) > sizeof( out )) goto run_point;
   tm = time( NULL );
@@ -119,25 +212,401 @@
   }
 
  /* перед хешированием мы имеем вектор
-      версия библиотеки || номер в сессии || время || (как бы) случайный мусор
+      версия библиотеки || время || (как бы) случайный мусор
 
-    - в итеративных утилитах, типа aktool, номер, скорее всего, будет равен нулю
     - (как бы) случайный мусор зависит не только от времени старта программы,
       но от номера текущего процесса и идентфикатора польхователя, что позволяет надеятся на то,
       что два стартовавших одновременно процесса на одной машине дадут два разных результата.
 
-    далее, вычисляем номер и перемещаем его в заданную память */
+    далее, вычисляем базовое значение и перемещаем его в заданную память */
   run_point:
-   memset( data, 0, size );
-   memset( hm, 0, sizeof( hm ));
-   if(( error = ak_hash_ptr( &ctx, out, sizeof( out ), hm, sizeof( hm ))) != ak_error_ok )
+   memset( hm, 0, 32 );
+   if(( error = ak_hash_ptr( &ctx, out, sizeof( out ), hm, 32 )) != ak_error_ok )
      ak_error_message( error, __func__, "incorrect creation an unique number" );
-    else memcpy( data, hm, ak_min( size, sizeof( hm )));
 
   ak_hash_destroy( &ctx );
  return error;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция выделяет память для хранения внутренних данных ключа (например, развернутых
+    раундовых ключей), используя тот же способ выделения памяти, что и для самого ключа:
+    для ключей, размещенных в защищенной куче, память также выделяется из защищенной кучи.
+    Выделенная память освобождается функцией ak_skey_pool_free().
+
+    \param skey Контекст секретного ключа
+    \param size Размер выделяемой памяти (в октетах).
+    \return Указатель на выделенную память. В случае ошибки возвращается NULL, а код ошибки
+    может быть получен с помощью вызова функции ak_error_get_value().                              */
+/* ----------------------------------------------------------------------------------------------- */
+ ak_pointer ak_skey_alloc_data( ak_skey skey, const size_t size )
+{
+  if( skey == NULL ) {
+    ak_error_message( ak_error_null_pointer, __func__ , "using a null pointer to secret key context" );
+    return NULL;
+  }
+  if( skey->policy == secure_policy ) return ak_skey_secure_alloc( size );
+ return ak_skey_pool_alloc( size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Выработанный функцией номер является уникальным (в рамках библиотеки) и может однозначно
+    идентифицировать некоторый объект, например, секретный ключ.
+
+    Для исключения вычисления хеш-функции при создании каждого ключа, хеш-функция вычисляется
+    только один раз, при первом вызове; полученное значение используется в качестве базового.
+    Номер вырабатывается путем сложения по модулю 2 базового значения и порядкового
+    номера вызова функции в рамках текущей сессии. После вызова fork() дочерний процесс
+    вырабатывает собственное базовое значение.
+
+    \param data вектор, куда помещается номер
+    \param size размер вектора (в октетах); данная величина не должна превосходить 32-х.
+    \return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае,
+    возвращается номер ошибки.                                                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_libakrypt_generate_unique_number( ak_pointer data, const size_t size )
+{
+  size_t i = 0;
+  ak_uint8 hm[32];
+  ak_uint64 counter = 0;
+  int error = ak_error_ok;
+
+  if( data == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                           "using null pointer to result buffer" );
+  if( !size ) return ak_error_message( ak_error_zero_length, __func__,
+                                                                 "using buffer with zero length" );
+#ifdef AK_HAVE_PTHREAD_H
+  pthread_once( &session_unique_atfork_once, ak_libakrypt_unique_number_atfork_register );
+  pthread_mutex_lock( &session_unique_number_mutex );
+#else
+ #ifdef AK_HAVE_UNISTD_H
+  if( session_unique_pid != getpid( )) {
+    session_unique_base_ready = ak_false;
+    session_unique_pid = getpid();
+  }
+ #endif
+#endif
+  if( !session_unique_base_ready ) {
+    if(( error = ak_libakrypt_generate_unique_base( session_unique_base )) == ak_error_ok )
+      session_unique_base_ready = ak_true;
+  }
+  counter = ++session_unique_number;
+  memcpy( hm, session_unique_base, sizeof( hm ));
+#ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_unlock( &session_unique_number_mutex );
+#endif
+  if( error != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect creation of session base value" );
+
+ /* добавляем номер вызова в рамках текущей сессии;
+    это не позволит в рамках одного процесса создать более одного ключа с одинаковым номером */
+  for( i = 0; i < sizeof( ak_uint64 ); i++ ) hm[i] ^= ( ak_uint8 )( counter >> ( i << 3 ));
+
+  memset( data, 0, size );
+  memcpy( data, hm, ak_min( size, sizeof( hm )));
+  memset( hm, 0, sizeof( hm ));
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция возвращает номер класса пула, в блоках которого может быть размещена
+    область памяти заданного размера.                                                              */
+/* ----------------------------------------------------------------------------------------------- */
+ static ak_uint32 ak_skey_pool_get_index( const size_t size )
+{
+  ak_uint32 idx = 0;
+  for( idx = 0; idx < ak_skey_pool_classes_count; idx++ )
+     if( size <= ( (size_t)64 << idx )) return idx;
+ return ak_skey_pool_class_none;
+}
+
+#if defined( AK_HAVE_SYSMMAN_H ) && defined( AK_HAVE_UNISTD_H )
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция создает отображение памяти, окруженное защитными страницами, и закрепляет
+    его доступную часть в оперативной памяти. Функция должна вызываться при захваченном
+    мьютексе пула.
+
+    \param size Размер доступной области (кратен размеру страницы).
+    \return Указатель на начало доступной области или NULL в случае ошибки.                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static ak_uint8 *ak_skey_secure_map( const size_t size )
+{
+  ak_uint8 *base = NULL;
+  size_t page = skey_secure_heap.page;
+
+  if(( base = mmap( NULL, size + 2*page, PROT_READ | PROT_WRITE,
+                                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 )) == MAP_FAILED ) {
+    ak_error_message( ak_error_out_of_memory, __func__, "wrong mapping of secure memory" );
+    return NULL;
+  }
+  mprotect( base, page, PROT_NONE );
+  mprotect( base + page + size, page, PROT_NONE );
+ #ifdef MADV_DONTDUMP
+  madvise( base, size + 2*page, MADV_DONTDUMP );
+ #endif
+  if(( mlock( base + page, size ) != 0 ) && !skey_secure_heap.warned ) {
+    skey_secure_heap.warned = ak_true;
+    if( ak_log_get_level() >= ak_log_standard ) ak_error_message( ak_error_ok, __func__,
+                    "secure memory cannot be locked in RAM (check RLIMIT_MEMLOCK value)" );
+  }
+ return base + page;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция освобождает отображение памяти, созданное функцией ak_skey_secure_map().     */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_skey_secure_unmap( ak_uint8 *ptr, const size_t size )
+{
+  munlock( ptr, size );
+  munmap( ptr - skey_secure_heap.page, size + 2*skey_secure_heap.page );
+}
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция выделяет область памяти для хранения ключевой информации из защищенной кучи:
+    память закрепляется в оперативной памяти (не выгружается в файл подкачки),
+    не включается в дампы памяти и отделена от остальной памяти процесса защитными страницами.
+    Закрепление выполняется один раз для целой арены, поэтому создание большого количества ключей
+    не приводит к системному вызову на каждый ключ. Выделенная память не очищается и
+    освобождается функцией ak_skey_pool_free().
+
+    Если платформа не поддерживает отображение памяти, функция эквивалентна ak_skey_pool_alloc().
+
+    \param size Размер выделяемой памяти (в октетах).
+    \return Указатель на выделенную память. В случае ошибки возвращается NULL, а код ошибки
+    может быть получен с помощью вызова функции ak_error_get_value().                              */
+/* ----------------------------------------------------------------------------------------------- */
+ ak_pointer ak_skey_secure_alloc( const size_t size )
+{
+#if defined( AK_HAVE_SYSMMAN_H ) && defined( AK_HAVE_UNISTD_H )
+  size_t len = 0;
+  ak_uint8 *ptr = NULL;
+  ak_skey_pool_header header = NULL;
+  ak_uint32 idx = ak_skey_pool_get_index( size );
+
+  if( size == 0 ) {
+    ak_error_message( ak_error_zero_length, __func__, "using a zero length for memory size" );
+    return NULL;
+  }
+  if( size > ((size_t)-1 ) >> 1 ) {
+    ak_error_message( ak_error_wrong_length, __func__, "using a very huge length value" );
+    return NULL;
+  }
+
+ #ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_lock( &skey_pool_mutex );
+ #endif
+  if( skey_secure_heap.page == 0 ) {
+    long page = sysconf( _SC_PAGESIZE );
+    skey_secure_heap.page = ( page > 0 ) ? ( size_t )page : 4096;
+  }
+
+  if( idx == ak_skey_pool_class_none ) {
+   /* большой блок размещается в отдельном отображении */
+    len = ( sizeof( union skey_pool_header ) + size + skey_secure_heap.page - 1 )
+                                                              &~( skey_secure_heap.page - 1 );
+    if(( ptr = ak_skey_secure_map( len )) != NULL ) {
+      header = ( ak_skey_pool_header ) ptr;
+      header->value.index = ak_skey_secure_class_large;
+      header->value.size = len;
+    }
+  } else {
+      if(( header = skey_secure_heap.head[idx] ) != NULL ) {
+        skey_secure_heap.head[idx] = header->value.next;
+      } else {
+         /* размер блока с заголовком округляется до размера строки кеша */
+          len = ( sizeof( union skey_pool_header ) + ((size_t)64 << idx ) + 63 )&~( size_t )63;
+          if( skey_secure_heap.left < len ) {
+            if(( ptr = ak_skey_secure_map( ak_skey_secure_arena_size )) != NULL ) {
+              (( ak_skey_secure_arena ) ptr )->value.next = skey_secure_heap.arenas;
+              (( ak_skey_secure_arena ) ptr )->value.size = ak_skey_secure_arena_size;
+              skey_secure_heap.arenas = ( ak_skey_secure_arena ) ptr;
+              skey_secure_heap.ptr = ptr + sizeof( union skey_secure_arena );
+              skey_secure_heap.left = ak_skey_secure_arena_size - sizeof( union skey_secure_arena );
+            }
+          }
+          if( skey_secure_heap.left >= len ) {
+            header = ( ak_skey_pool_header ) skey_secure_heap.ptr;
+            skey_secure_heap.ptr += len;
+            skey_secure_heap.left -= len;
+          }
+        }
+      if( header != NULL ) {
+        header->value.index = ak_skey_secure_flag | idx;
+        header->value.size = 0;
+      }
+    }
+  if( header != NULL ) {
+    header->value.next = NULL;
+    skey_secure_heap.used++;
+  }
+ #ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_unlock( &skey_pool_mutex );
+ #endif
+
+  if( header == NULL ) {
+    ak_error_message( ak_error_out_of_memory, __func__ ,
+                                             "incorrect secure memory allocation for key buffer" );
+    return NULL;
+  }
+ return ( ak_pointer )( header+1 );
+#else
+ return ak_skey_pool_alloc( size );
+#endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция выделяет выровненную область памяти для хранения ключевой информации.
+    Если в пуле присутствует свободный блок подходящего размера, то он выдается повторно,
+    без обращения к функциям выделения памяти. Выделенная память не очищается.
+
+    \param size Размер выделяемой памяти (в октетах).
+    \return Указатель на выделенную память. В случае ошибки возвращается NULL, а код ошибки
+    может быть получен с помощью вызова функции ak_error_get_value().                              */
+/* ----------------------------------------------------------------------------------------------- */
+ ak_pointer ak_skey_pool_alloc( const size_t size )
+{
+  ak_skey_pool_header header = NULL;
+  ak_uint32 idx = ak_skey_pool_get_index( size );
+
+  if( size == 0 ) {
+    ak_error_message( ak_error_zero_length, __func__, "using a zero length for memory size" );
+    return NULL;
+  }
+  if( size > ((size_t)-1 ) - sizeof( union skey_pool_header )) {
+    ak_error_message( ak_error_wrong_length, __func__, "using a very huge length value" );
+    return NULL;
+  }
+
+  if( idx != ak_skey_pool_class_none ) {
+   #ifdef AK_HAVE_PTHREAD_H
+    pthread_mutex_lock( &skey_pool_mutex );
+   #endif
+    if(( header = skey_pool.head[idx] ) != NULL ) {
+      skey_pool.head[idx] = header->value.next;
+      skey_pool.count[idx]--;
+    }
+   #ifdef AK_HAVE_PTHREAD_H
+    pthread_mutex_unlock( &skey_pool_mutex );
+   #endif
+  }
+
+  if( header == NULL ) {
+    if(( header = ak_aligned_malloc( sizeof( union skey_pool_header ) +
+        ( idx == ak_skey_pool_class_none ? size : ((size_t)64 << idx )))) == NULL ) {
+      ak_error_message( ak_error_out_of_memory, __func__ ,
+                                                    "incorrect memory allocation for key buffer" );
+      return NULL;
+    }
+  }
+  header->value.next = NULL;
+  header->value.index = idx;
+
+ return ( ak_pointer )( header+1 );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция возвращает в пул блок памяти, выделенный ранее функцией ak_skey_pool_alloc().
+    Очистка содержимого блока должна быть выполнена до вызова функции.
+    Если количество хранимых в пуле блоков превышает значение опции `skey_pool_size`,
+    то память освобождается.
+
+    \param ptr Указатель на память, выделенную функцией ak_skey_pool_alloc().
+    \return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае,
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_skey_pool_free( ak_pointer ptr )
+{
+  ak_int64 limit = 0;
+  ak_skey_pool_header header = NULL;
+
+  if( ptr == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                                 "using a null pointer to memory" );
+  header = (( ak_skey_pool_header ) ptr ) - 1;
+#if defined( AK_HAVE_SYSMMAN_H ) && defined( AK_HAVE_UNISTD_H )
+ /* блоки защищенной кучи возвращаются в ее списки без ограничения количества */
+  if(( header->value.index & ~( ak_uint32 )ak_skey_secure_class_large ) == 0 &&
+     ( header->value.index & ak_skey_secure_flag )) {
+   #ifdef AK_HAVE_PTHREAD_H
+    pthread_mutex_lock( &skey_pool_mutex );
+   #endif
+    if( header->value.index == ak_skey_secure_class_large )
+      ak_skey_secure_unmap(( ak_uint8 *) header, header->value.size );
+     else {
+      header->value.next = skey_secure_heap.head[ header->value.index^ak_skey_secure_flag ];
+      skey_secure_heap.head[ header->value.index^ak_skey_secure_flag ] = header;
+     }
+    skey_secure_heap.used--;
+   #ifdef AK_HAVE_PTHREAD_H
+    pthread_mutex_unlock( &skey_pool_mutex );
+   #endif
+    return ak_error_ok;
+  }
+#endif
+  if( header->value.index < ak_skey_pool_classes_count ) {
+    limit = ak_libakrypt_get_option_by_name( "skey_pool_size" );
+   #ifdef AK_HAVE_PTHREAD_H
+    pthread_mutex_lock( &skey_pool_mutex );
+   #endif
+    if( (ak_int64) skey_pool.count[header->value.index] < limit ) {
+      header->value.next = skey_pool.head[header->value.index];
+      skey_pool.head[header->value.index] = header;
+      skey_pool.count[header->value.index]++;
+      header = NULL;
+    }
+   #ifdef AK_HAVE_PTHREAD_H
+    pthread_mutex_unlock( &skey_pool_mutex );
+   #endif
+  }
+  if( header != NULL ) free( header );
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция освобождает все хранящиеся в пуле блоки памяти, а также арены защищенной кучи
+    (если все выделенные из них блоки возвращены).
+    Функция вызывается при завершении работы с библиотекой.
+
+    \return Функция возвращает \ref ak_error_ok (ноль).                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_skey_pool_destroy( void )
+{
+  ak_uint32 idx = 0;
+  ak_skey_pool_header header = NULL;
+#if defined( AK_HAVE_SYSMMAN_H ) && defined( AK_HAVE_UNISTD_H )
+  ak_skey_secure_arena arena = NULL;
+#endif
+
+ #ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_lock( &skey_pool_mutex );
+ #endif
+  for( idx = 0; idx < ak_skey_pool_classes_count; idx++ ) {
+     while(( header = skey_pool.head[idx] ) != NULL ) {
+       skey_pool.head[idx] = header->value.next;
+       memset( header, 0, sizeof( union skey_pool_header ) + ((size_t)64 << idx ));
+       free( header );
+     }
+     skey_pool.count[idx] = 0;
+  }
+#if defined( AK_HAVE_SYSMMAN_H ) && defined( AK_HAVE_UNISTD_H )
+  if( skey_secure_heap.used == 0 ) {
+    while(( arena = skey_secure_heap.arenas ) != NULL ) {
+      skey_secure_heap.arenas = arena->value.next;
+      memset( arena, 0, ak_skey_secure_arena_size );
+      ak_skey_secure_unmap(( ak_uint8 *) arena, ak_skey_secure_arena_size );
+    }
+    for( idx = 0; idx < ak_skey_pool_classes_count; idx++ ) skey_secure_heap.head[idx] = NULL;
+    skey_secure_heap.ptr = NULL;
+    skey_secure_heap.left = 0;
+  }
+#endif
+ #ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_unlock( &skey_pool_mutex );
+ #endif
+ return ak_error_ok;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \details Функция выделяет массив памяти, достаточный для размещения секретного ключа и
     его маски (размер выделяемой памяти в точности равен удвленному разхмеру секретного ключа).
@@ -173,6 +642,26 @@
       skey->key = ptr;
       break;
 
+    case pool_policy:
+     /* используем память из пула ранее выделенных блоков */
+      if(( ptr = ak_skey_pool_alloc( size << 1 )) == NULL )
+        return ak_error_message( ak_error_get_value(), __func__,
+                                                    "incorrect memory allocation for key buffer" );
+      if( skey->key != NULL ) ak_skey_free_memory( skey );
+      memset( ptr, 0, size << 1 );
+      skey->key = ptr;
+      break;
+
+    case secure_policy:
+     /* используем закрепленную память защищенной кучи */
+      if(( ptr = ak_skey_secure_alloc( size << 1 )) == NULL )
+        return ak_error_message( ak_error_get_value(), __func__,
+                                                    "incorrect memory allocation for key buffer" );
+      if( skey->key != NULL ) ak_skey_free_memory( skey );
+      memset( ptr, 0, size << 1 );
+      skey->key = ptr;
+      break;
+
     default:
       return ak_error_message( ak_error_undefined_value, __func__,
                                                             "using unexpected allocation policy" );
@@ -211,6 +700,12 @@
       free( skey->key );
       break;
 
+    case pool_policy:
+    case secure_policy:
+      skey->policy = undefined_policy;
+      ak_skey_pool_free( skey->key );
+      break;
+
     default:
       return ak_error_message( ak_error_undefined_value, __func__,
                                     "using secret key conetxt with unexpected allocation policy" );
@@ -283,7 +778,9 @@
                                                               "using a zero length for key size" );
  /* Инициализируем данные базовыми значениями */
   skey->key = NULL;
-  if(( error = ak_skey_alloc_memory( skey, size, malloc_policy )) != ak_error_ok ) {
+  if(( error = ak_skey_alloc_memory( skey, size,
+         ak_libakrypt_get_option_by_name( "skey_secure_memory" ) ? secure_policy : pool_policy ))
+                                                                            != ak_error_ok ) {
     ak_error_message( error, __func__ ,"wrong allocation memory of internal secret key buffer" );
     ak_skey_destroy( skey );
     return error;
@@ -294,7 +791,7 @@
   memset( &(skey->resource), 0, sizeof( struct resource )); /* ресурс ключа не определен */
 
  /* инициализируем генератор масок */
-  if(( error = ak_random_create_lcg( &skey->generator )) != ak_error_ok ) {
+  if(( error = ak_random_create_xorshift128( &skey->generator )) != ak_error_ok ) {
     ak_error_message( error, __func__ , "wrong creation of random generator" );
     ak_skey_destroy( skey );
     return error;
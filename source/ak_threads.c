@@ -0,0 +1,258 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  Copyright (c) 2020 by Axel Kenzo, axelkenzo@mail.ru                                            */
+/*                                                                                                 */
+/*  Файл ak_threads.c                                                                              */
+/*  - содержит реализацию пула потоков, используемого для параллельного выполнения                 */
+/*    криптографических преобразований                                                            */
+/* ----------------------------------------------------------------------------------------------- */
+ #include <libakrypt.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+#ifdef AK_HAVE_UNISTD_H
+ #include <unistd.h>
+#endif
+#ifdef AK_HAVE_PTHREAD_H
+ #include <pthread.h>
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Максимальное количество потоков, создаваемых библиотекой. */
+ #define ak_parallel_max_threads   (256)
+
+/* ----------------------------------------------------------------------------------------------- */
+#ifdef AK_HAVE_PTHREAD_H
+/*! \brief Внутреннее состояние пула потоков. */
+ static struct parallel_pool {
+  /*! \brief Созданные потоки. */
+   pthread_t threads[ak_parallel_max_threads];
+  /*! \brief Количество созданных потоков. */
+   size_t count;
+  /*! \brief Функция, обрабатывающая элементы текущего задания. */
+   ak_function_parallel *func;
+  /*! \brief Аргумент функции. */
+   ak_pointer arg;
+  /*! \brief Общее количество элементов текущего задания. */
+   size_t total;
+  /*! \brief Индекс следующего необработанного элемента. */
+   size_t next;
+  /*! \brief Количество обработанных элементов. */
+   size_t done;
+  /*! \brief Номер текущего задания. */
+   ak_uint64 generation;
+  /*! \brief Первая ошибка, возникшая при выполнении задания. */
+   int error;
+  /*! \brief Флаг завершения работы потоков. */
+   bool_t shutdown;
+ } parallel_pool;
+
+/*! \brief Мьютекс, защищающий внутреннее состояние пула. */
+ static pthread_mutex_t parallel_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+/*! \brief Мьютекс, обеспечивающий выполнение не более одного задания в каждый момент времени. */
+ static pthread_mutex_t parallel_job_mutex = PTHREAD_MUTEX_INITIALIZER;
+/*! \brief Условная переменная, сигнализирующая о появлении нового задания. */
+ static pthread_cond_t parallel_start_cond = PTHREAD_COND_INITIALIZER;
+/*! \brief Условная переменная, сигнализирующая о завершении задания. */
+ static pthread_cond_t parallel_done_cond = PTHREAD_COND_INITIALIZER;
+/*! \brief Флаг однократной регистрации обработчика fork(). */
+ static pthread_once_t parallel_atfork_once = PTHREAD_ONCE_INIT;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Обработчик, вызываемый в дочернем процессе после fork().
+    \details В дочернем процессе существует только поток, вызвавший fork(), поэтому потоки пула,
+    унаследованные от родительского процесса, не должны ни ожидаться, ни использоваться.
+    Функция обнуляет состояние пула и заново инициализирует объекты синхронизации;
+    при следующем вызове ak_libakrypt_parallel_run() потоки будут созданы заново.                 */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_libakrypt_parallel_atfork_child( void )
+{
+  memset( &parallel_pool, 0, sizeof( struct parallel_pool ));
+  pthread_mutex_init( &parallel_pool_mutex, NULL );
+  pthread_mutex_init( &parallel_job_mutex, NULL );
+  pthread_cond_init( &parallel_start_cond, NULL );
+  pthread_cond_init( &parallel_done_cond, NULL );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_libakrypt_parallel_atfork_register( void )
+{
+  pthread_atfork( NULL, NULL, ak_libakrypt_parallel_atfork_child );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция обрабатывает элементы текущего задания, пока они не закончатся.
+    \details Функция вызывается при захваченном мьютексе `parallel_pool_mutex`
+    и освобождает его на время обработки каждого элемента.                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_libakrypt_parallel_process( void )
+{
+  int error = ak_error_ok;
+  size_t idx = 0;
+
+  while( parallel_pool.next < parallel_pool.total ) {
+    idx = parallel_pool.next++;
+    pthread_mutex_unlock( &parallel_pool_mutex );
+    error = parallel_pool.func( parallel_pool.arg, idx );
+    pthread_mutex_lock( &parallel_pool_mutex );
+    if(( error != ak_error_ok ) && ( parallel_pool.error == ak_error_ok ))
+      parallel_pool.error = error;
+    if( ++parallel_pool.done == parallel_pool.total )
+      pthread_cond_broadcast( &parallel_done_cond );
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Основная функция потока пула. */
+/* ----------------------------------------------------------------------------------------------- */
+ static void *ak_libakrypt_parallel_worker( void *ptr )
+{
+  ak_uint64 seen = 0;
+
+  pthread_mutex_lock( &parallel_pool_mutex );
+  seen = parallel_pool.generation;
+  (void)ptr;
+  for( ;; ) {
+     while(( !parallel_pool.shutdown ) && ( seen == parallel_pool.generation ))
+       pthread_cond_wait( &parallel_start_cond, &parallel_pool_mutex );
+     if( parallel_pool.shutdown ) break;
+     seen = parallel_pool.generation;
+     ak_libakrypt_parallel_process();
+  }
+  pthread_mutex_unlock( &parallel_pool_mutex );
+
+ return NULL;
+}
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Количество потоков определяется опцией `threads_count`. Если значение опции равно нулю,
+    то используется количество доступных процессорных ядер. Если библиотека собрана без
+    поддержки потоков, функция всегда возвращает единицу.
+
+    @return Количество потоков (включая вызывающий поток), между которыми распределяются
+    вычисления.                                                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ size_t ak_libakrypt_get_threads_count( void )
+{
+#ifdef AK_HAVE_PTHREAD_H
+  ak_int64 count = ak_libakrypt_get_option_by_name( "threads_count" );
+
+  if( count <= 0 ) {
+   #ifdef _SC_NPROCESSORS_ONLN
+    count = sysconf( _SC_NPROCESSORS_ONLN );
+   #endif
+    if( count <= 0 ) count = 1;
+  }
+ return ( size_t )ak_min( count, ak_parallel_max_threads );
+#else
+ return 1;
+#endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вызывает `func( arg, i )` для всех значений \f$ i = 0, \ldots, count-1 \f$.
+    Элементы задания распределяются между потоками пула и вызывающим потоком; порядок
+    их обработки не определен. Функция возвращает управление после обработки всех элементов.
+
+    Потоки создаются при первом вызове функции и существуют до вызова
+    ak_libakrypt_parallel_destroy() (функция вызывается при завершении работы с библиотекой).
+    Если пул уже занят выполнением другого задания (например, при вложенном вызове),
+    то элементы задания обрабатываются последовательно вызывающим потоком.
+    После вызова fork() дочерний процесс не использует потоки родительского процесса
+    и создает собственный пул при первом вызове функции.
+
+    @param func Функция обработки одного элемента задания.
+    @param arg Аргумент, передаваемый функции обработки.
+    @param count Количество элементов задания.
+
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код первой из возникших ошибок.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_libakrypt_parallel_run( ak_function_parallel *func, ak_pointer arg, const size_t count )
+{
+  size_t idx = 0;
+  int error = ak_error_ok, result = ak_error_ok;
+#ifdef AK_HAVE_PTHREAD_H
+  size_t threads = 0;
+#endif
+
+  if( func == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                            "using null pointer to job function" );
+  if( !count ) return ak_error_ok;
+
+#ifdef AK_HAVE_PTHREAD_H
+  if(( count > 1 ) && (( threads = ak_libakrypt_get_threads_count()) > 1 ) &&
+     ( pthread_once( &parallel_atfork_once, ak_libakrypt_parallel_atfork_register ) == 0 ) &&
+     ( pthread_mutex_trylock( &parallel_job_mutex ) == 0 )) {
+
+    pthread_mutex_lock( &parallel_pool_mutex );
+   /* при необходимости, создаем недостающие потоки */
+    parallel_pool.shutdown = ak_false;
+    while( parallel_pool.count < threads - 1 ) {
+      if( pthread_create( parallel_pool.threads + parallel_pool.count, NULL,
+                                                   ak_libakrypt_parallel_worker, NULL ) != 0 ) {
+        ak_error_message( ak_error_not_ready, __func__, "incorrect creation of thread" );
+        break;
+      }
+      parallel_pool.count++;
+    }
+
+   /* публикуем задание и участвуем в его выполнении */
+    parallel_pool.func = func;
+    parallel_pool.arg = arg;
+    parallel_pool.total = count;
+    parallel_pool.next = parallel_pool.done = 0;
+    parallel_pool.error = ak_error_ok;
+    parallel_pool.generation++;
+    pthread_cond_broadcast( &parallel_start_cond );
+
+    ak_libakrypt_parallel_process();
+    while( parallel_pool.done < parallel_pool.total )
+      pthread_cond_wait( &parallel_done_cond, &parallel_pool_mutex );
+    result = parallel_pool.error;
+    parallel_pool.func = NULL;
+    parallel_pool.arg = NULL;
+    parallel_pool.total = 0;
+
+    pthread_mutex_unlock( &parallel_pool_mutex );
+    pthread_mutex_unlock( &parallel_job_mutex );
+    return result;
+  }
+#endif
+
+ /* последовательное выполнение */
+  for( idx = 0; idx < count; idx++ )
+     if((( error = func( arg, idx )) != ak_error_ok ) && ( result == ak_error_ok )) result = error;
+
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @return Функция возвращает \ref ak_error_ok (ноль).                                          */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_libakrypt_parallel_destroy( void )
+{
+#ifdef AK_HAVE_PTHREAD_H
+  size_t idx = 0, count = 0;
+
+  pthread_mutex_lock( &parallel_job_mutex );
+  pthread_mutex_lock( &parallel_pool_mutex );
+  parallel_pool.shutdown = ak_true;
+  count = parallel_pool.count;
+  pthread_cond_broadcast( &parallel_start_cond );
+  pthread_mutex_unlock( &parallel_pool_mutex );
+
+  for( idx = 0; idx < count; idx++ ) pthread_join( parallel_pool.threads[idx], NULL );
+
+  pthread_mutex_lock( &parallel_pool_mutex );
+  parallel_pool.count = 0;
+  parallel_pool.shutdown = ak_false;
+  pthread_mutex_unlock( &parallel_pool_mutex );
+  pthread_mutex_unlock( &parallel_job_mutex );
+#endif
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                                                                                    ak_threads.c */
+/* ----------------------------------------------------------------------------------------------- */
@@ -988,7 +988,9 @@
 #endif
 
 /* ----------------------------------------------------------------------------------------------- */
-/*! Если это возможно, то функция возвращает память, выравненную по границе 16 байт.
+/*! Если это возможно, то функция возвращает память, выравненную по границе 32 байт
+    (такое выравнивание требуется для контекстов секретных ключей). Размер выделяемой
+    памяти округляется вверх до величины, кратной 32.
     @param size Размер выделяемой памяти в байтах.
     @return Указатель на выделенную память.                                                        */
 /* ----------------------------------------------------------------------------------------------- */
@@ -997,14 +999,13 @@
  return
 #ifndef __MINGW32__
  #ifdef AK_HAVE_STDALIGN_H
-  aligned_alloc( 16,
+  aligned_alloc( 32, ( size + 31 )&~( size_t )31 );
  #else
-  malloc(
+  malloc( size );
  #endif
 #else
-  malloc(
+  malloc( size );
 #endif
-  size );
 }
 
 /* ----------------------------------------------------------------------------------------------- */
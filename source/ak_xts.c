@@ -926,6 +926,86 @@
  return ak_error_not_equal_data;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*                      потоковая обработка данных в режиме xtsmac                                 */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_xtsmac_stream_authenticate( ak_aead_stream ctx,
+                                                     const ak_pointer adata, const size_t size )
+{
+  return ak_xtsmac_authentication_update(( ak_xtsmac_ctx )ctx->state,
+                                                            ctx->authenticationKey, adata, size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_xtsmac_stream_encrypt( ak_aead_stream ctx,
+                                          const ak_pointer in, ak_pointer out, const size_t size )
+{
+  return ak_xtsmac_encryption_update(( ak_xtsmac_ctx )ctx->state,
+                                                              ctx->encryptionKey, in, out, size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_xtsmac_stream_decrypt( ak_aead_stream ctx,
+                                          const ak_pointer in, ak_pointer out, const size_t size )
+{
+  return ak_xtsmac_decryption_update(( ak_xtsmac_ctx )ctx->state,
+                                                              ctx->encryptionKey, in, out, size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_xtsmac_stream_finalize( ak_aead_stream ctx, ak_pointer out, const size_t out_size )
+{
+  return ak_xtsmac_authentication_finalize(( ak_xtsmac_ctx )ctx->state,
+                                                           ctx->authenticationKey, out, out_size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция подготавливает контекст к обработке нового сообщения в режиме `xtsmac`.
+    Все фрагменты ассоциированных данных, а также все фрагменты шифруемых данных,
+    кроме последних, должны иметь длину, кратную 16 октетам. Длина последнего фрагмента
+    шифруемых данных, если она не кратна 16 октетам, должна быть больше 16 октетов.
+
+    Фрагменты обрабатываются функциями ak_aead_stream_authenticate(), ak_aead_stream_encrypt()
+    (ak_aead_stream_decrypt()) и ak_aead_stream_finalize().
+
+    @param ctx Контекст потокового шифрования.
+    @param encryptionKey Ключ шифрования (указатель на struct bckey).
+    @param authenticationKey Ключ выработки имитовставки (указатель на struct bckey).
+    @param iv Указатель на синхропосылку.
+    @param iv_size Длина синхропосылки в октетах.
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_xtsmac_stream_clean( ak_aead_stream ctx, ak_pointer encryptionKey,
+                         ak_pointer authenticationKey, const ak_pointer iv, const size_t iv_size )
+{
+  int error = ak_error_ok;
+
+  if( ctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                         "using null pointer to stream context" );
+  if(( encryptionKey == NULL ) || ( authenticationKey == NULL ))
+    return ak_error_message( ak_error_null_pointer, __func__ ,"using null pointer to secret key" );
+  if( ((ak_bckey)encryptionKey)->bsize != ((ak_bckey)authenticationKey)->bsize )
+    return ak_error_message( ak_error_not_equal_data, __func__,
+                                                    "different block sizes for given secret keys");
+  memset( ctx, 0, sizeof( struct aead_stream ));
+  if(( error = ak_xtsmac_authentication_clean(( ak_xtsmac_ctx )ctx->state,
+                                             authenticationKey, iv, iv_size )) != ak_error_ok ) {
+    ak_ptr_wipe( ctx->state, sizeof( ctx->state ),
+                                              &((ak_bckey)authenticationKey)->key.generator );
+    return ak_error_message( error, __func__,
+                                           "incorrect initialization of internal xtsmac context" );
+  }
+  ctx->encryptionKey = encryptionKey;
+  ctx->authenticationKey = authenticationKey;
+  ctx->authenticate = ak_xtsmac_stream_authenticate;
+  ctx->encrypt = ak_xtsmac_stream_encrypt;
+  ctx->decrypt = ak_xtsmac_stream_decrypt;
+  ctx->finalize = ak_xtsmac_stream_finalize;
+
+ return ak_error_ok;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*                                                                                       ak_xts.c  */
 /* ----------------------------------------------------------------------------------------------- */
@@ -53,6 +53,13 @@
  int ak_bckey_kuznechik_init_gost_tables( void );
 /** @} */
 
+/* ----------------------------------------------------------------------------------------------- */
+/** \addtogroup random-doc
+ @{ */
+/*! \brief Установка способа уничтожения данных функцией ak_ptr_wipe(). */
+ void ak_ptr_wipe_set_with_random( const bool_t );
+/** @} */
+
 /* ----------------------------------------------------------------------------------------------- */
 /** \addtogroup mac-doc Вычисление кодов целостности (хеширование и имитозащита)
  @{ */
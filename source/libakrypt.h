@@ -103,6 +103,12 @@ extern "C" {
  #define ak_error_certificate_not_equal_names (-160)
 /*! \brief Ошибка чтения сертификата с неверным итервалом использования. */
  #define ak_error_certificate_validity        (-161)
+/*! \brief Ошибка поиска открытого ключа, необходимого для проверки сертификата. */
+ #define ak_error_certificate_verify_key      (-162)
+/*! \brief Ошибка проверки электронной подписи под сертификатом. */
+ #define ak_error_certificate_signature       (-163)
+/*! \brief Ошибка динамического контроля криптографических механизмов. */
+ #define ak_error_control_test                (-164)
 
 /* ----------------------------------------------------------------------------------------------- */
 /** \addtogroup options-doc Инициализация и настройка параметров библиотеки
@@ -139,10 +145,42 @@ extern "C" {
  dll_export int ak_libakrypt_create_home_filename( char * , const size_t , char * , const int );
 /*! \brief Функция выводит в заданный файл параметры эллиптической кривой. */
  dll_export int ak_libakrypt_print_curve( FILE * , const char * );
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция, обрабатывающая один элемент задания, выполняемого пулом потоков. */
+ typedef int ( ak_function_parallel )( ak_pointer , const size_t );
+/*! \brief Функция возвращает количество потоков, используемых библиотекой для вычислений. */
+ dll_export size_t ak_libakrypt_get_threads_count( void );
+/*! \brief Функция выполняет задание, распределяя его элементы между потоками библиотеки. */
+ dll_export int ak_libakrypt_parallel_run( ak_function_parallel * , ak_pointer , const size_t );
+/*! \brief Функция останавливает потоки, созданные библиотекой. */
+ dll_export int ak_libakrypt_parallel_destroy( void );
 /** \addtogroup tests-doc Тестирование криптографических механизмов
  @{ */
+/*! \brief Группы тестов динамического контроля криптографических механизмов. */
+ typedef enum {
+  /*! \brief Умножение в конечных полях характеристики два. */
+   gfn_control_test,
+  /*! \brief Алгоритмы бесключевого хеширования. */
+   hash_control_test,
+  /*! \brief Алгоритмы блочного шифрования и режимы их использования. */
+   block_cipher_control_test,
+  /*! \brief Алгоритмы выработки имитовставки. */
+   mac_control_test,
+  /*! \brief Эллиптические кривые и алгоритмы электронной подписи. */
+   asymmetric_control_test,
+  /*! \brief Количество групп тестов. */
+   control_tests_count
+ } control_test_group_t;
+
 /*! \brief Функция выполняет динамическое тестирование работоспособности криптографических преобразований. */
  dll_export bool_t ak_libakrypt_dynamic_control_test( void );
+/*! \brief Функция выполняет тестирование группы механизмов при их первом использовании. */
+ dll_export bool_t ak_libakrypt_control_test_on_first_use( const control_test_group_t );
+/*! \brief Функция возвращает имя группы тестов динамического контроля. */
+ dll_export const char *ak_libakrypt_get_control_test_name( const control_test_group_t );
+/*! \brief Функция возвращает результат и время выполнения группы тестов динамического контроля. */
+ dll_export int ak_libakrypt_get_control_test_result( const control_test_group_t , double * );
 /*! \brief Функция тестирования корректности реализации операций умножения в полях характеристики два. */
  dll_export bool_t ak_libakrypt_test_gfn_multiplication( void );
  /*! \brief Функция тестирует все определяемые библиотекой параметры эллиптических кривых,
@@ -406,6 +444,13 @@ extern "C" {
        ak_uint64 val;
      /*! \brief Внутреннее состояние xorshift32 генератора */
        ak_uint32 value;
+     /*! \brief Внутреннее состояние четырех генераторов xorshift128+ */
+       struct {
+        /*! \brief первые половины внутренних состояний */
+         ak_uint64 s0[4];
+        /*! \brief вторые половины внутренних состояний */
+         ak_uint64 s1[4];
+       } xorshift;
      /*! \brief Файловый дескриптор */
        int fd;
     #ifdef AK_HAVE_WINDOWS_H
@@ -420,6 +465,16 @@ extern "C" {
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Инициализация контекста линейного конгруэнтного генератора псевдо-случайных чисел. */
  dll_export int ak_random_create_lcg( ak_random );
+/*! \brief Инициализация контекста генератора xorshift128+, вырабатывающего 32 октета за один шаг. */
+ dll_export int ak_random_create_xorshift128( ak_random );
+/*! \brief Инициализация контекста генератора mt19937-64 (64-х битный вихрь Мерсенна). */
+ dll_export int ak_random_create_mt19937( ak_random );
+/*! \brief Инициализация контекста генератора на основе блочного шифра "Кузнечик" с внутренним буфером. */
+ dll_export int ak_random_create_drbg( ak_random );
+/*! \brief Инициализация контекста генератора, использующего экземпляр drbg-kuznechik текущего потока. */
+ dll_export int ak_random_create_drbg_thread( ak_random );
+/*! \brief Удаление экземпляра генератора drbg-kuznechik, принадлежащего текущему потоку. */
+ dll_export int ak_random_drbg_thread_destroy( void );
  /*! \brief Инициализация контекста генератора, считывающего случайные значения из заданного файла. */
  dll_export int ak_random_create_file( ak_random , const char * );
 #if defined(__unix__) || defined(__APPLE__)
@@ -487,13 +542,20 @@ extern "C" {
 /*! \brief Флаг, который определяет, можно ли использовать значение внутреннего буффера в режиме omac. */
  #define ak_key_flag_omac_buffer_used   (0x0000000000000200ULL)
 
+/*! \brief Флаг, который определяет, что дополнительные ключи алгоритма cmac вычислены. */
+ #define ak_key_flag_cmac_subkeys       (0x0000000000000400ULL)
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Способ выделения памяти для хранения секретной информации. */
  typedef enum {
   /*! \brief Механизм выделения памяти не определен. */
    undefined_policy,
   /*! \brief Выделение памяти через стандартный malloc */
-   malloc_policy
+   malloc_policy,
+  /*! \brief Повторное использование выровненных блоков памяти из пула */
+   pool_policy,
+  /*! \brief Закрепленная в оперативной памяти защищенная куча (без выгрузки и дампов) */
+   secure_policy
 
 } memory_allocation_policy_t;
 
@@ -602,6 +664,16 @@ extern "C" {
  dll_export int ak_skey_alloc_memory( ak_skey , size_t , memory_allocation_policy_t );
 /*! \brief Функция освобождения выделенной ранее памяти. */
  dll_export int ak_skey_free_memory( ak_skey );
+/*! \brief Выделение выровненной памяти для ключевой информации из пула блоков. */
+ dll_export ak_pointer ak_skey_pool_alloc( const size_t );
+/*! \brief Выделение закрепленной памяти для ключевой информации из защищенной кучи. */
+ dll_export ak_pointer ak_skey_secure_alloc( const size_t );
+/*! \brief Выделение памяти для внутренних данных ключа согласно способу выделения памяти ключа. */
+ dll_export ak_pointer ak_skey_alloc_data( ak_skey , const size_t );
+/*! \brief Возвращение блока памяти в пул. */
+ dll_export int ak_skey_pool_free( ak_pointer );
+/*! \brief Освобождение всех хранящихся в пуле блоков памяти. */
+ dll_export int ak_skey_pool_destroy( void );
 /*! \brief Инициализация структуры секретного ключа. */
  dll_export int ak_skey_create( ak_skey , size_t );
 /*! \brief Очистка структуры секретного ключа. */
@@ -648,6 +720,8 @@ extern "C" {
  typedef int ( ak_function_bckey_create ) ( ak_bckey );
 /*! \brief Функция зашифрования/расширования одного блока информации. */
  typedef void ( ak_function_bckey )( ak_skey, ak_pointer, ak_pointer );
+/*! \brief Функция зашифрования/расширования нескольких последовательно расположенных блоков. */
+ typedef void ( ak_function_bckey_blocks )( ak_skey, ak_pointer, ak_pointer, size_t );
 /*! \brief Функция, предназначенная для зашифрования/расшифрования области памяти заданного размера */
  typedef int ( ak_function_bckey_encrypt )( ak_bckey, ak_pointer, ak_pointer, size_t,
                                                                                 ak_pointer, size_t );
@@ -668,10 +742,20 @@ extern "C" {
    ak_function_bckey *encrypt;
   /*! \brief Функция расширования одного блока информации. */
    ak_function_bckey *decrypt;
+  /*! \brief Функция зашифрования нескольких последовательно расположенных блоков информации
+      (может быть не определена). */
+   ak_function_bckey_blocks *encrypt_blocks;
+  /*! \brief Функция расшифрования нескольких последовательно расположенных блоков информации
+      (может быть не определена). */
+   ak_function_bckey_blocks *decrypt_blocks;
   /*! \brief Функция развертки ключа. */
    ak_function_skey *schedule_keys;
   /*! \brief Функция уничтожения развернутых ключей. */
    ak_function_skey *delete_keys;
+  /*! \brief Дополнительные ключи K1 и K2 алгоритма cmac (хранятся в маскированном виде). */
+   ak_uint64 cmac_subkeys[4];
+  /*! \brief Маска дополнительных ключей алгоритма cmac. */
+   ak_uint64 cmac_mask[4];
 };
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -692,6 +776,8 @@ dll_export int ak_bckey_create_rc6( ak_bckey );
 /*! \brief Присвоение ключу алгоритма блочного шифрования значения, выработанного из пароля. */
  dll_export int ak_bckey_set_key_from_password( ak_bckey ,
                                 const ak_pointer , const size_t , const ak_pointer , const size_t );
+/*! \brief Замена значения ключа алгоритма блочного шифрования без повторной инициализации. */
+ dll_export int ak_bckey_rekey( ak_bckey, const ak_pointer , const size_t );
 /** @} */
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -741,6 +827,8 @@ dll_export int ak_bckey_create_rc6( ak_bckey );
 /*! \brief Шифрование данных в режиме гаммирования из ГОСТ Р 34.13-2015
    (counter mode, ctr). */
  dll_export int ak_bckey_ctr( ak_bckey , ak_pointer , ak_pointer , size_t , ak_pointer , size_t );
+/*! \brief Выработка гаммы режима гаммирования из ГОСТ Р 34.13-2015 без наложения на данные. */
+ dll_export int ak_bckey_ctr_keystream( ak_bckey , ak_pointer , size_t , ak_pointer , size_t );
 /*! \brief Шифрование данных в режиме гаммирования с обратной связью по выходу
    (output feedback, ofb). */
  dll_export int ak_bckey_ofb( ak_bckey , ak_pointer , ak_pointer , size_t , ak_pointer , size_t );
@@ -766,8 +854,17 @@ dll_export int ak_bckey_create_rc6( ak_bckey );
 /* ----------------------------------------------------------------------------------------------- */
 /** \addtogroup mac-doc Вычисление кодов целостности (хеширование и имитозащита)
  @{ */ 
+/*! \brief Максимальное количество сообщений, обрабатываемых одновременно функцией
+    ak_bckey_cmac_batch(). */
+ #define ak_bckey_cmac_batch_lanes      (8)
+
 /*! \brief Вычисление имитовставки согласно ГОСТ Р 34.13-2015. */
  dll_export int ak_bckey_cmac( ak_bckey , ak_pointer , const size_t , ak_pointer , const size_t );
+/*! \brief Вычисление имитовставок для нескольких сообщений на одном ключе. */
+ dll_export int ak_bckey_cmac_batch( ak_bckey , const size_t , ak_pointer * , const size_t * ,
+                                                                    ak_pointer * , const size_t );
+/*! \brief Вычисление и сохранение дополнительных ключей алгоритма cmac. */
+ dll_export int ak_bckey_cmac_set_subkeys( ak_bckey );
 /*! \brief Очистка внутреннего состояния секретного ключа. */
  dll_export int ak_bckey_cmac_clean( ak_bckey );
 /*! \brief Обновление внутреннего состояния секретного ключа при вычислении имитовставки
@@ -776,6 +873,70 @@ dll_export int ak_bckey_create_rc6( ak_bckey );
 /*! \brief Завершение вычисления имитовставки согласно ГОСТ Р 34.13-2015. */
  dll_export int ak_bckey_cmac_finalize( ak_bckey , const ak_pointer , const size_t ,
                                                                        ak_pointer , const size_t );
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Контекст алгоритма выработки имитовставки `OMAC-ACPKM` из Р 1323565.1.017—2018. */
+/*! Алгоритм вычисляет имитовставку по аналогии с ГОСТ Р 34.13-2015, однако сообщение
+    разбивается на секции фиксированной длины, каждая из которых обрабатывается на своем ключе.
+    Ключи секций вырабатываются из основного ключа с помощью преобразования ACPKM-Master,
+    поэтому ресурс основного ключа не ограничивает длину обрабатываемых данных.                   */
+/* ----------------------------------------------------------------------------------------------- */
+ typedef struct omac_acpkm {
+  /*! \brief Основной ключ алгоритма (не изменяется в ходе вычислений). */
+   struct bckey key;
+  /*! \brief Ключ преобразования ACPKM-Master, изменяемый после обработки каждой его секции. */
+   struct bckey master;
+  /*! \brief Ключ текущей секции сообщения. */
+   struct bckey skey;
+  /*! \brief Счетчик режима гаммирования преобразования ACPKM-Master. */
+   ak_uint64 ctr[2];
+  /*! \brief Текущее значение сцепления. */
+   ak_uint64 yaout[2];
+  /*! \brief Дополнительный ключ текущей секции (в маскированном виде). */
+   ak_uint64 akey[2];
+  /*! \brief Маска дополнительного ключа. */
+   ak_uint64 amask[2];
+  /*! \brief Буффер, содержащий последний (возможно, неполный) блок данных. */
+   ak_uint8 data[16];
+  /*! \brief Количество октетов в буффере. */
+   size_t length;
+  /*! \brief Длина секции сообщения в октетах. */
+   size_t section_size;
+  /*! \brief Длина секции преобразования ACPKM-Master в блоках. */
+   size_t master_section_size;
+  /*! \brief Количество октетов, обработанных на ключе текущей секции. */
+   size_t section_count;
+  /*! \brief Количество блоков, выработанных на текущем ключе ACPKM-Master. */
+   size_t master_count;
+  /*! \brief Флаг изменения ключа ACPKM-Master в ходе вычислений. */
+   bool_t master_changed;
+ } *ak_omac_acpkm;
+
+/*! \brief Создание контекста алгоритма `OMAC-ACPKM` на основе блочного шифра Магма. */
+ dll_export int ak_omac_acpkm_create_magma( ak_omac_acpkm );
+/*! \brief Создание контекста алгоритма `OMAC-ACPKM` на основе блочного шифра Кузнечик. */
+ dll_export int ak_omac_acpkm_create_kuznechik( ak_omac_acpkm );
+/*! \brief Уничтожение контекста алгоритма `OMAC-ACPKM`. */
+ dll_export int ak_omac_acpkm_destroy( ak_omac_acpkm );
+/*! \brief Присвоение ключу алгоритма `OMAC-ACPKM` константного значения. */
+ dll_export int ak_omac_acpkm_set_key( ak_omac_acpkm , const ak_pointer , const size_t );
+/*! \brief Присвоение ключу алгоритма `OMAC-ACPKM` случайного значения. */
+ dll_export int ak_omac_acpkm_set_key_random( ak_omac_acpkm , ak_random );
+/*! \brief Присвоение ключу алгоритма `OMAC-ACPKM` значения, выработанного из пароля. */
+ dll_export int ak_omac_acpkm_set_key_from_password( ak_omac_acpkm , const ak_pointer ,
+                                                const size_t , const ak_pointer , const size_t );
+/*! \brief Установка длин секций сообщения и преобразования ACPKM-Master (в октетах). */
+ dll_export int ak_omac_acpkm_set_section_size( ak_omac_acpkm , const size_t , const size_t );
+/*! \brief Очистка внутреннего состояния алгоритма `OMAC-ACPKM`. */
+ dll_export int ak_omac_acpkm_clean( ak_omac_acpkm );
+/*! \brief Обновление внутреннего состояния алгоритма `OMAC-ACPKM`. */
+ dll_export int ak_omac_acpkm_update( ak_omac_acpkm , const ak_pointer , const size_t );
+/*! \brief Завершение вычисления имитовставки алгоритма `OMAC-ACPKM`. */
+ dll_export int ak_omac_acpkm_finalize( ak_omac_acpkm , const ak_pointer , const size_t ,
+                                                                       ak_pointer , const size_t );
+/*! \brief Вычисление имитовставки `OMAC-ACPKM` для заданной области памяти. */
+ dll_export int ak_omac_acpkm_ptr( ak_omac_acpkm , const ak_pointer , const size_t ,
+                                                                       ak_pointer , const size_t );
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Функция очистки контекста хеширования. */
  typedef int ( ak_function_clean )( ak_pointer );
@@ -995,6 +1156,154 @@ dll_export int ak_bckey_create_rc6( ak_bckey );
  dll_export int ak_bckey_decrypt_ctr_hmac( ak_pointer , ak_pointer , const ak_pointer ,
     const size_t , const ak_pointer , ak_pointer , const size_t , const ak_pointer , const size_t ,
                                                                           ak_pointer, const size_t );
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Контекст потокового аутентифицированного шифрования.
+    \details Контекст позволяет зашифровывать (расшифровывать) сообщение последовательными
+    фрагментами с одновременной выработкой имитовставки, не размещая все сообщение в памяти.
+    Шифрование и вычисление имитовставки выполняются за один проход по данным, небольшими
+    участками, размещаемыми в кэш-памяти процессора. Результат совпадает с результатом
+    однократного вызова функции аутентифицированного шифрования для всего сообщения.
+
+    Ключи, используемые контекстом, не должны изменяться до завершения обработки сообщения. */
+ typedef struct aead_stream {
+  /*! \brief Ключ шифрования. */
+   ak_pointer encryptionKey;
+  /*! \brief Ключ выработки имитовставки. */
+   ak_pointer authenticationKey;
+  /*! \brief Внутреннее состояние режима. */
+   ak_uint64 state[16];
+  /*! \brief Значение синхропосылки или текущее значение счетчика режима гаммирования. */
+   ak_uint8 ivector[16];
+  /*! \brief Длина синхропосылки. */
+   size_t ivector_size;
+  /*! \brief Буффер для последнего (возможно, неполного) блока аутентифицируемых данных. */
+   ak_uint8 buffer[16];
+  /*! \brief Количество октетов в буффере. */
+   size_t buflen;
+  /*! \brief Флаги состояния контекста. */
+   ak_uint32 flags;
+  /*! \brief Функция обработки ассоциированных данных. */
+   int ( *authenticate )( struct aead_stream * , const ak_pointer , const size_t );
+  /*! \brief Функция зашифрования фрагмента данных. */
+   int ( *encrypt )( struct aead_stream * , const ak_pointer , ak_pointer , const size_t );
+  /*! \brief Функция расшифрования фрагмента данных. */
+   int ( *decrypt )( struct aead_stream * , const ak_pointer , ak_pointer , const size_t );
+  /*! \brief Функция выработки имитовставки. */
+   int ( *finalize )( struct aead_stream * , ak_pointer , const size_t );
+ } *ak_aead_stream;
+
+/*! \brief Инициализация контекста потокового шифрования в режиме `xtsmac`. */
+ dll_export int ak_bckey_xtsmac_stream_clean( ak_aead_stream , ak_pointer , ak_pointer ,
+                                                                const ak_pointer , const size_t );
+/*! \brief Инициализация контекста потокового шифрования в режиме `ctr-cmac`. */
+ dll_export int ak_bckey_ctr_cmac_stream_clean( ak_aead_stream , ak_pointer , ak_pointer ,
+                                                                const ak_pointer , const size_t );
+/*! \brief Инициализация контекста потокового шифрования в режиме `ctr-hmac`. */
+ dll_export int ak_bckey_ctr_hmac_stream_clean( ak_aead_stream , ak_pointer , ak_pointer ,
+                                                                const ak_pointer , const size_t );
+/*! \brief Инициализация контекста потокового шифрования для режима с заданным идентификатором. */
+ dll_export int ak_aead_stream_clean( ak_aead_stream , ak_oid , ak_pointer , ak_pointer ,
+                                                                const ak_pointer , const size_t );
+/*! \brief Обработка фрагмента ассоциированных данных. */
+ dll_export int ak_aead_stream_authenticate( ak_aead_stream , const ak_pointer , const size_t );
+/*! \brief Зашифрование фрагмента данных с одновременным обновлением имитовставки. */
+ dll_export int ak_aead_stream_encrypt( ak_aead_stream , const ak_pointer , ak_pointer ,
+                                                                                   const size_t );
+/*! \brief Расшифрование фрагмента данных с одновременным обновлением имитовставки. */
+ dll_export int ak_aead_stream_decrypt( ak_aead_stream , const ak_pointer , ak_pointer ,
+                                                                                   const size_t );
+/*! \brief Выработка имитовставки и очистка контекста потокового шифрования. */
+ dll_export int ak_aead_stream_finalize( ak_aead_stream , ak_pointer , const size_t );
+/** @} */
+
+/* ----------------------------------------------------------------------------------------------- */
+/** \addtogroup aead-chunks-doc Аутентифицированное шифрование данных, разбитых на фрагменты
+ @{ */
+/*! \brief Длина заголовка зашифрованных данных (в октетах). */
+ #define ak_aead_chunks_header_size          (128)
+/*! \brief Длина открытой части завершающей записи (индекса) зашифрованных данных (в октетах). */
+ #define ak_aead_chunks_footer_data_size      (32)
+/*! \brief Длина фрагмента открытого текста, используемая по-умолчанию. */
+ #define ak_aead_chunks_default_size       (65536)
+
+/*! \brief Контекст шифрования данных, разбитых на независимо зашифровываемые фрагменты. */
+/*! \details Каждый фрагмент зашифровывается в режиме `mgm` или `xtsmac` на собственных
+    ключах, вырабатываемых из мастер-ключа, и сопровождается имитовставкой. Контекст не может
+    одновременно использоваться несколькими потоками; для многопоточной обработки следует
+    создавать копии контекста с помощью функции ak_aead_chunks_create_copy().                     */
+ typedef struct aead_chunks {
+  /*! \brief Идентификатор режима аутентифицированного шифрования. */
+   ak_oid oid;
+  /*! \brief Длина фрагмента открытого текста (в октетах). */
+   size_t chunk;
+  /*! \brief Длина блока используемого шифра, совпадает с длиной имитовставки фрагмента. */
+   size_t bsize;
+  /*! \brief Минимальная длина непустого последнего фрагмента. */
+   size_t minimal;
+  /*! \brief Заголовок зашифрованных данных. */
+   ak_uint8 header[ak_aead_chunks_header_size];
+  /*! \brief Мастер-ключ, используемый для выработки ключей фрагментов. */
+   struct bckey master;
+  /*! \brief Ключ шифрования текущего фрагмента. */
+   struct bckey ekey;
+  /*! \brief Ключ имитозащиты текущего фрагмента. */
+   struct bckey akey;
+  /*! \brief Ресурс ключей фрагмента. */
+   ak_int64 resource;
+ } *ak_aead_chunks;
+
+/*! \brief Создание контекста и выработка мастер-ключа из пароля для зашифрования данных. */
+ dll_export int ak_aead_chunks_create( ak_aead_chunks , ak_oid , const size_t ,
+                                                   const ak_pointer , const size_t , ak_random );
+/*! \brief Создание контекста по заголовку зашифрованных данных и паролю. */
+ dll_export int ak_aead_chunks_create_from_header( ak_aead_chunks , const ak_pointer ,
+                                                                 const ak_pointer , const size_t );
+/*! \brief Создание копии контекста для использования в другом потоке. */
+ dll_export int ak_aead_chunks_create_copy( ak_aead_chunks , ak_aead_chunks );
+/*! \brief Уничтожение контекста. */
+ dll_export int ak_aead_chunks_destroy( ak_aead_chunks );
+/*! \brief Количество фрагментов и длина последнего фрагмента для данных заданной длины. */
+ dll_export ak_uint64 ak_aead_chunks_get_count( ak_aead_chunks , const ak_uint64 , size_t * );
+/*! \brief Длина завершающей записи (индекса) зашифрованных данных. */
+ dll_export size_t ak_aead_chunks_get_footer_size( ak_aead_chunks );
+/*! \brief Зашифрование фрагмента с заданным номером. */
+ dll_export int ak_aead_chunks_encrypt( ak_aead_chunks , const ak_uint64 , const bool_t ,
+                                                 const ak_pointer , ak_pointer , const size_t );
+/*! \brief Расшифрование фрагмента с заданным номером и проверка его имитовставки. */
+ dll_export int ak_aead_chunks_decrypt( ak_aead_chunks , const ak_uint64 , const bool_t ,
+                                                 const ak_pointer , ak_pointer , const size_t );
+/*! \brief Формирование завершающей записи (индекса) зашифрованных данных. */
+ dll_export int ak_aead_chunks_create_footer( ak_aead_chunks , const ak_uint64 , ak_pointer );
+/*! \brief Проверка завершающей записи (индекса) и получение длины открытого текста. */
+ dll_export int ak_aead_chunks_check_footer( ak_aead_chunks , const ak_pointer , ak_uint64 * );
+
+/*! \brief Контекст для чтения произвольных фрагментов зашифрованного файла. */
+ typedef struct aead_file {
+  /*! \brief Дескриптор зашифрованного файла. */
+   struct file fp;
+  /*! \brief Контекст расшифрования фрагментов. */
+   struct aead_chunks ctx;
+  /*! \brief Длина открытого текста (в октетах). */
+   ak_uint64 size;
+  /*! \brief Общее количество фрагментов. */
+   ak_uint64 count;
+  /*! \brief Длина последнего фрагмента открытого текста. */
+   size_t last;
+  /*! \brief Буффер для зашифрованного фрагмента. */
+   ak_uint8 *buffer;
+  /*! \brief Последний расшифрованный фрагмент. */
+   ak_uint8 *plain;
+  /*! \brief Номер последнего расшифрованного фрагмента. */
+   ak_uint64 cached;
+ } *ak_aead_file;
+
+/*! \brief Открытие зашифрованного файла для чтения с произвольным доступом. */
+ dll_export int ak_aead_file_open( ak_aead_file , const char * , const ak_pointer , const size_t );
+/*! \brief Расшифрование фрагмента открытого текста, начинающегося с заданного смещения. */
+ dll_export ssize_t ak_aead_file_read( ak_aead_file , const ak_uint64 , ak_pointer , const size_t );
+/*! \brief Закрытие зашифрованного файла. */
+ dll_export int ak_aead_file_close( ak_aead_file );
 /** @} */
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -1583,9 +1892,76 @@ dll_export int ak_bckey_create_rc6( ak_bckey );
  dll_export int ak_asn1_export_to_pemfile( ak_asn1 , const char * , crypto_content_t );
 /*! \brief Экспорт ASN.1 дерева в файл. */
  dll_export int ak_asn1_export_to_file( ak_asn1 , const char * , export_format_t , crypto_content_t );
+/*! \brief Экспорт ASN.1 дерева в область памяти в der или pem формате. */
+ dll_export int ak_asn1_export_to_ptr( ak_asn1 , ak_pointer , size_t * ,
+                                                              export_format_t , crypto_content_t );
 /*! \brief Импорт ASN.1 дерева из файла, содержащего der-последовательность. */
  dll_export int ak_asn1_import_from_file( ak_asn1 , const char * );
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Максимальная глубина вложенности уровней, обрабатываемых курсором der-последовательности. */
+ #define ak_asn1_cursor_max_depth      (32)
+/*! \brief Размер внутреннего буффера курсора, используемого при чтении данных из файла (в октетах). */
+ #define ak_asn1_cursor_buffer_size  (4096)
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Курсор для последовательного чтения der-последовательности без построения ASN.1 дерева.
+    \details Курсор позволяет перебирать узлы der-последовательности, расположенной в памяти
+    или в файле, переходить на низлежащие уровни и возвращаться обратно, а также считывать
+    данные примитивных узлов. При чтении из файла используется буффер фиксированного размера,
+    поэтому объем используемой памяти не зависит от размера обрабатываемых данных.              */
+/* ----------------------------------------------------------------------------------------------- */
+ typedef struct asn1_cursor {
+  /*! \brief указатель на der-последовательность, расположенную в памяти */
+   ak_uint8 *ptr;
+  /*! \brief дескриптор файла, содержащего der-последовательность */
+   struct file fp;
+  /*! \brief флаг, определяющий, что данные считываются из файла */
+   bool_t is_file;
+  /*! \brief общая длина der-последовательности (в октетах) */
+   size_t size;
+  /*! \brief смещение (от начала der-последовательности) текущего считываемого октета */
+   size_t offset;
+  /*! \brief тег текущего узла */
+   ak_uint8 tag;
+  /*! \brief длина данных текущего узла */
+   size_t len;
+  /*! \brief смещение, с которого начинаются данные текущего узла */
+   size_t data_offset;
+  /*! \brief смещение, с которого начинается следующий узел */
+   size_t next_offset;
+  /*! \brief флаг, определяющий, что текущий узел определен */
+   bool_t has_current;
+  /*! \brief текущий уровень вложенности */
+   size_t depth;
+  /*! \brief смещения, на которых заканчиваются пройденные уровни */
+   size_t end[ ak_asn1_cursor_max_depth ];
+  /*! \brief количество октетов, находящихся во внутреннем буффере */
+   size_t bufsize;
+  /*! \brief индекс текущего октета во внутреннем буффере */
+   size_t bufpos;
+  /*! \brief внутренний буффер, используемый при чтении данных из файла */
+   ak_uint8 buffer[ ak_asn1_cursor_buffer_size ];
+ } *ak_asn1_cursor;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Создание курсора для der-последовательности, расположенной в памяти. */
+ dll_export int ak_asn1_cursor_create_ptr( ak_asn1_cursor , const ak_pointer , const size_t );
+/*! \brief Создание курсора для der-последовательности, хранящейся в файле. */
+ dll_export int ak_asn1_cursor_create_file( ak_asn1_cursor , const char * );
+/*! \brief Уничтожение курсора der-последовательности. */
+ dll_export int ak_asn1_cursor_destroy( ak_asn1_cursor );
+/*! \brief Перемещение курсора к следующему узлу текущего уровня. */
+ dll_export bool_t ak_asn1_cursor_next( ak_asn1_cursor );
+/*! \brief Переход курсора на уровень, образуемый текущим составным узлом. */
+ dll_export int ak_asn1_cursor_enter( ak_asn1_cursor );
+/*! \brief Пропуск оставшихся узлов текущего уровня и возврат на уровень выше. */
+ dll_export int ak_asn1_cursor_leave( ak_asn1_cursor );
+/*! \brief Получение данных, хранящихся в текущем примитивном узле. */
+ dll_export int ak_asn1_cursor_get_primitive( ak_asn1_cursor , ak_pointer , size_t * );
+/*! \brief Декодирование текущего узла и добавление его к заданному уровню ASN.1 дерева. */
+ dll_export int ak_asn1_cursor_get_asn1( ak_asn1_cursor , ak_asn1 );
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Функция выводит в заданный файл закодированное ASN.1 дерево. */
  dll_export int ak_libakrypt_print_asn1( const char * , FILE *);
@@ -1801,6 +2177,21 @@ dll_export int ak_bckey_create_rc6( ak_bckey );
    открытого ключа, расположенного в памяти */
  dll_export int ak_verifykey_import_from_ptr_as_certificate( ak_verifykey ,
                             ak_verifykey , const ak_pointer , const size_t , ak_certificate_opts );
+/*! \brief Функция загружает хранилище доверенных сертификатов из заданного каталога. */
+ dll_export int ak_certificate_store_load( const char * );
+/*! \brief Функция ищет в хранилище доверенных сертификатов открытый ключ
+    с заданным идентификатором и создает его копию. */
+ dll_export int ak_certificate_store_find_by_key_identifier( ak_verifykey , const ak_pointer ,
+                                                                                   const size_t );
+/*! \brief Функция ищет в хранилище доверенных сертификатов открытый ключ
+    владельца с заданным расширенным именем и создает его копию. */
+ dll_export int ak_certificate_store_find_by_name( ak_verifykey , ak_tlv );
+/*! \brief Функция возвращает количество сертификатов в хранилище доверенных сертификатов. */
+ dll_export size_t ak_certificate_store_count( void );
+/*! \brief Функция удаляет все сертификаты из хранилища доверенных сертификатов. */
+ dll_export int ak_certificate_store_destroy( void );
+/*! \brief Функция очищает кеш сертификатов, подпись под которыми была успешно проверена. */
+ dll_export int ak_certificate_cache_clean( void );
 /** @} *//** \addtogroup cert-tlv-doc Функции создания расширений сертификатов открытых ключей
  @{ */
 /*! \brief Создание расширения, содержащего идентификатор открытого ключа
@@ -1889,6 +2280,44 @@ dll_export int ak_bckey_create_rc6( ak_bckey );
    } type;
  } *ak_blomkey;
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Контейнер мастер-ключа схемы Блома, отображенный в память. */
+/*! Строки мастер-ключа, хранящегося в контейнере, расшифровываются по мере необходимости,
+    см. функции ak_blomkey_container_open() и ak_blomkey_container_read_row(). */
+ typedef struct blomkey_container {
+  /*! \brief ключ шифрования строк мастер-ключа */
+   struct bckey ekey;
+  /*! \brief ключ имитозащиты строк мастер-ключа */
+   struct bckey ikey;
+  /*! \brief файл, содержащий контейнер */
+   struct file fs;
+  /*! \brief указатель на отображенное в память содержимое файла */
+   ak_uint8 *data;
+  /*! \brief заголовок контейнера */
+   ak_uint8 header[16];
+  /*! \brief количество октетов, образующих один элемент конечного поля */
+   ak_uint32 count;
+  /*! \brief размер матрицы */
+   ak_uint32 size;
+ } *ak_blomkey_container;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Кэш ключей парной связи, вырабатываемых из ключа абонента схемы Блома. */
+/*! Ключи парной связи хранятся в замаскированном виде; кэш не предназначен для одновременного
+    использования несколькими потоками, см. функцию ak_blomkey_cache_get_pairwise_key(). */
+ typedef struct blomkey_cache {
+  /*! \brief ключ абонента, из которого вырабатываются ключи парной связи */
+   ak_blomkey bkey;
+  /*! \brief массив элементов кэша */
+   ak_pointer entries;
+  /*! \brief количество множеств, на которые разбит массив элементов */
+   size_t sets;
+  /*! \brief счетчик обращений к кэшу */
+   ak_uint64 clock;
+  /*! \brief генератор, используемый для выработки масок хранимых ключей и очистки памяти */
+   struct random generator;
+ } *ak_blomkey_cache;
+
 /* ----------------------------------------------------------------------------------------------- */
 /** \addtogroup skey-blom-doc Реализация схемы Блома распределения ключевой информации
  @{ *//*! \brief Функция создает мастер-ключ для схемы Блома. */
@@ -1897,9 +2326,16 @@ dll_export int ak_bckey_create_rc6( ak_bckey );
 /*! \brief Функция создает ключ абонента для схемы Блома. */
  dll_export int ak_blomkey_create_abonent_key( ak_blomkey , ak_blomkey ,
                                                                        ak_pointer , const size_t );
+/*! \brief Функция создает ключи для нескольких абонентов за один проход по мастер-ключу. */
+ dll_export int ak_blomkey_create_abonent_keys( ak_blomkey , ak_blomkey , const size_t ,
+                                                                   ak_pointer * , const size_t * );
 /*! \brief Функция создает ключ парной связи (в виде последовательности октетов) */
  dll_export int ak_blomkey_create_pairwise_key_as_ptr( ak_blomkey ,
                                                  ak_pointer , const size_t , ak_pointer , size_t );
+/*! \brief Функция создает ключи парной связи с несколькими абонентами за один проход
+    по ключу абонента */
+ dll_export int ak_blomkey_create_pairwise_keys_as_ptr( ak_blomkey , const size_t ,
+                                     ak_pointer * , const size_t * , ak_pointer , const size_t );
 /*! \brief Функция создает ключ парной связи и помещает его в контекст секретного ключа */
  dll_export ak_pointer ak_blomkey_new_pairwise_key( ak_blomkey , ak_pointer ,
                                                                            const size_t , ak_oid );
@@ -1914,6 +2350,24 @@ dll_export int ak_bckey_create_rc6( ak_bckey );
 /*! \brief Импорт ключа из заданного файла */
  dll_export int ak_blomkey_import_from_file_with_password( ak_blomkey ,
                                                             const char * , const size_t , char * );
+/*! \brief Создание кэша ключей парной связи */
+ dll_export int ak_blomkey_cache_create( ak_blomkey_cache , ak_blomkey , const size_t );
+/*! \brief Получение ключа парной связи с использованием кэша */
+ dll_export int ak_blomkey_cache_get_pairwise_key( ak_blomkey_cache , ak_pointer ,
+                                                     const size_t , ak_pointer , const size_t );
+/*! \brief Уничтожение кэша ключей парной связи */
+ dll_export int ak_blomkey_cache_destroy( ak_blomkey_cache );
+/*! \brief Открытие контейнера мастер-ключа без расшифрования ключевых данных */
+ dll_export int ak_blomkey_container_open( ak_blomkey_container ,
+                                                      const char * , const size_t , const char * );
+/*! \brief Расшифрование строки мастер-ключа, хранящегося в контейнере */
+ dll_export int ak_blomkey_container_read_row( ak_blomkey_container , const ak_uint32 ,
+                                                                       ak_pointer , const size_t );
+/*! \brief Выработка ключей абонентов из мастер-ключа, хранящегося в контейнере */
+ dll_export int ak_blomkey_container_create_abonent_keys( ak_blomkey_container , ak_blomkey ,
+                                                 const size_t , ak_pointer * , const size_t * );
+/*! \brief Закрытие контейнера мастер-ключа */
+ dll_export int ak_blomkey_container_close( ak_blomkey_container );
 /** @} *//** @} */
 
 #ifdef __cplusplus